@@ -263,6 +263,15 @@ CEXPORT int indigoNormalize (int structure, const char *options);
 //    "ignore_radicals" : do not consider atom radicals while searching
 CEXPORT int indigoAutomap (int reaction, const char *mode);
 
+// Automatic atom-to-atom mapping for an array of reactions. Reactions are
+// mapped in place in "aam-threads" worker threads with the same mode as
+// for indigoAutomap(). Mapping time in milliseconds is stored in the
+// "aam-time" property of each reaction, and the error message of the
+// reactions that failed is stored in the "aam-error" property. Items that
+// are not reactions are counted as failed and get the "aam-error" too.
+// Returns the number of mapped reactions.
+CEXPORT int indigoAutomapBatch (int reactions, const char *mode);
+
 // Returns mapping number. It might appear that there is more them 
 // one atom with the same number in AAM
 // Value 0 means no mapping number has been specified.
@@ -562,6 +571,20 @@ CEXPORT int indigoUnfoldHydrogens (int item);
 
 CEXPORT int indigoLayout (int object);
 
+// Layout of a molecule after an edit. Atoms near the given atoms and
+// bonds are laid out again, the others keep their coordinates.
+CEXPORT int indigoLayoutIncremental (int molecule, int natoms, int *atoms, int nbonds, int *bonds);
+
+// Layout of an array of molecules in "layout-threads" worker threads.
+// The error message of the items that are not molecules or failed is
+// stored in their "layout-error" property. Returns the number of laid out molecules.
+CEXPORT int indigoLayoutBatch (int molecules);
+
+// Adds the ring systems of the molecules from a Molfile or SDF with 2D
+// coordinates to the layout templates of the process. Templates from
+// the last loaded file are tried first. Returns the number of templates.
+CEXPORT int indigoLoadLayoutTemplatesFromFile (const char *filename);
+
 CEXPORT const char * indigoSmiles (int item);
 
 // Returns a "mapping" if there is an exact match, zero otherwise
@@ -639,6 +662,8 @@ CEXPORT const char * indigoCheckAmbiguousH (int handle);
 //                 substructure screening
 //   "full"    -- "Full fingerprint", which has all the mentioned
 //                 fingerprint types included
+// Substructure and full fingerprints of reactions end with the reacting
+// centers part, which is used for the screening as in the ringo index.
 CEXPORT int indigoFingerprint (int item, const char *type);
 
 // Counts the nonzero (i.e. one) bits in a fingerprint
@@ -832,8 +857,19 @@ CEXPORT int indigoToBuffer (int handle, char **buf, int *size);
 // reactions with R-Sites replaced by the actual substituents.
 CEXPORT int indigoReactionProductEnumerate (int reaction, int monomers);
 
+// Same as indigoReactionProductEnumerate, but returns an iterator that builds
+// the products on demand. indigoTell() returns the number of products returned
+// so far, and indigoAt() continues the enumeration from the given product index,
+// so a long enumeration can be resumed.
+CEXPORT int indigoIterateReactionProductEnumeration (int reaction, int monomers);
+
+// Applies the transformation to a molecule or to an array of molecules.
+// The reaction can be a query reaction or a transformer.
 CEXPORT int indigoTransform (int reaction, int monomers);
 
+// Prepares the transformation once for applying it to many molecules
+CEXPORT int indigoCreateTransformer (int reaction);
+
 /* Debug functionality */
 
 // Returns internal type of an object
@@ -27,6 +27,14 @@ CEXPORT const char* indigoInchiGetInchi (int molecule);
 
 CEXPORT const char* indigoInchiGetInchiKey (const char *inchi_string);
 
+// InChI and InChIKey of the molecules from an array or an iterator,
+// computed in "inchi-threads" worker threads (one by default, zero means
+// automatic).
+// Returns a new array with the molecules. Their "inchi" and "inchi-key"
+// properties are set, or "inchi-error" if the item is not a molecule or
+// can not be loaded, or the InChI was not generated.
+CEXPORT int indigoInchiGetInchiBatch (int molecules);
+
 CEXPORT const char* indigoInchiGetWarning ();
 
 CEXPORT const char* indigoInchiGetLog ();
@@ -37,6 +37,8 @@ class IndigoInchi(object):
         self._lib.indigoInchiGetInchi.argtypes = [c_int]
         self._lib.indigoInchiGetInchiKey.restype = c_char_p
         self._lib.indigoInchiGetInchiKey.argtypes = [c_char_p]
+        self._lib.indigoInchiGetInchiBatch.restype = c_int
+        self._lib.indigoInchiGetInchiBatch.argtypes = [c_int]
         self._lib.indigoInchiGetWarning.restype = c_char_p
         self._lib.indigoInchiGetWarning.argtypes = []
         self._lib.indigoInchiGetLog.restype = c_char_p
@@ -67,6 +69,10 @@ class IndigoInchi(object):
         self.indigo._setSessionId()
         return self.indigo._checkResultString(self._lib.indigoInchiGetInchiKey(inchi.encode('ascii')))
 
+    def getInchiBatch(self, molecules):
+        self.indigo._setSessionId()
+        return self.indigo.IndigoObject(self.indigo, self.indigo._checkResult(self._lib.indigoInchiGetInchiBatch(molecules.id)))
+
     def getWarning(self):
         self.indigo._setSessionId()
         return self.indigo._checkResultString(self._lib.indigoInchiGetWarning())
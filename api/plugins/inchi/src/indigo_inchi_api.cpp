@@ -17,6 +17,7 @@
 #include "indigo_inchi_core.h"
                       
 #include "indigo_internal.h"
+#include "indigo_array.h"
 #include "indigo_molecule.h"
 #include "option_manager.h"
 
@@ -35,10 +36,13 @@ class IndigoInchiContext : public IndigoPluginContext
 {
 public:
    IndigoInchi inchi;
+   // Threads for indigoInchiGetInchiBatch(): 1 - serial mode, 0 - automatic
+   int nthreads;
 
    virtual void init ()
    {
       inchi.clear();
+      nthreads = 1;
    }
 };
 
@@ -103,6 +107,108 @@ CEXPORT const char* indigoInchiGetInchiKey (const char *inchi_string)
    INDIGO_END(0)
 }
 
+static void _setProperty (IndigoObject &obj, const char *name, const char *value)
+{
+   RedBlackStringObjMap< Array<char> > *props = obj.getProperties();
+
+   if (props == 0)
+      return;
+
+   if (value == 0)
+   {
+      if (props->at2(name) != 0)
+         props->remove(name);
+   }
+   else if (props->at2(name) != 0)
+      props->at(name).readString(value, true);
+   else
+      props->value(props->insert(name)).readString(value, true);
+}
+
+CEXPORT int indigoInchiGetInchiBatch (int molecules)
+{
+   INDIGO_BEGIN
+   {
+      IndigoInchiContext &context = indigoInchiGetInstance();
+      IndigoObject &obj = self.getObject(molecules);
+      AutoPtr<IndigoArray> result(new IndigoArray());
+      int i;
+
+      // Molecules are loaded here, because Indigo objects
+      // can not be accessed from the worker threads
+      if (IndigoArray::is(obj))
+      {
+         IndigoArray &array = IndigoArray::cast(obj);
+
+         for (i = 0; i < array.objects.size(); i++)
+            result->objects.add(array.objects[i]->clone());
+      }
+      else
+      {
+         IndigoObject *item;
+
+         while ((item = obj.next()) != 0)
+            result->objects.add(item);
+      }
+
+      // Only the loaded molecules are passed to the batch, the items
+      // that can not be loaded get their own error
+      QS_DEF(Array<Molecule *>, mols);
+      QS_DEF(ObjArray< Array<char> >, load_errors);
+      mols.clear();
+      load_errors.clear();
+      for (i = 0; i < result->objects.size(); i++)
+      {
+         Array<char> &load_error = load_errors.push();
+
+         try
+         {
+            mols.push(&result->objects[i]->getMolecule());
+         }
+         catch (Exception &e)
+         {
+            load_error.readString(e.message(), true);
+         }
+      }
+
+      IndigoInchiBatch batch(context.inchi);
+
+      batch.make(mols, context.nthreads);
+
+      int mol_idx = 0;
+      for (i = 0; i < result->objects.size(); i++)
+      {
+         IndigoObject &item = *result->objects[i];
+         const char *error = 0;
+
+         if (load_errors[i].size() > 0)
+            error = load_errors[i].ptr();
+         else
+         {
+            if (batch.errors[mol_idx].size() > 0)
+               error = batch.errors[mol_idx].ptr();
+            mol_idx++;
+         }
+
+         if (error == 0)
+         {
+            _setProperty(item, "inchi", batch.inchis[mol_idx - 1].ptr());
+            _setProperty(item, "inchi-key", batch.keys[mol_idx - 1].ptr());
+            _setProperty(item, "inchi-error", 0);
+         }
+         else
+         {
+            _setProperty(item, "inchi", 0);
+            _setProperty(item, "inchi-key", 0);
+            _setProperty(item, "inchi-error", error);
+         }
+      }
+
+      return self.addObject(result.release());
+   }
+   INDIGO_END(-1)
+}
+
 CEXPORT const char* indigoInchiGetWarning ()
 {
    IndigoInchi &indigo_inchi = indigoInchiGetInstance().inchi;
@@ -137,6 +243,13 @@ void indigoInchiSetInchiOptions (const char *options)
    inchi.setOptions(options);
 }
 
+void indigoInchiSetThreadsCount (int value)
+{
+   if (value < 0)
+      throw IndigoError("%d is bad InChI threads count", value);
+   indigoInchiGetInstance().nthreads = value;
+}
+
 class _IndigoInchiOptionsHandlersSetter
 {
 public:
@@ -149,6 +262,7 @@ _IndigoInchiOptionsHandlersSetter::_IndigoInchiOptionsHandlersSetter ()
    OsLocker locker(mgr.lock);
    
    mgr.setOptionHandlerString("inchi-options", indigoInchiSetInchiOptions);
+   mgr.setOptionHandlerInt("inchi-threads", indigoInchiSetThreadsCount);
 }
 
 _IndigoInchiOptionsHandlersSetter _indigo_inchi_options_handlers_setter;
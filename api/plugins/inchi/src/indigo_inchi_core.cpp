@@ -18,6 +18,7 @@
 #include "molecule/molecule.h"
 #include "molecule/elements.h"
 #include "molecule/molecule_dearom.h"
+#include "molecule/molecule_inchi_key.h"
 
 #include "mode.h"
 
@@ -25,8 +26,8 @@
 
 using namespace indigo;
 
-// Inchi doesn't seem to support multithreading
-static OsLock inchi_lock;
+// InChI library keeps its state per thread (see INCHI_TLS in mode.h),
+// so it is called from several threads without a lock
 
 namespace indigo
 {
@@ -120,9 +121,6 @@ static inchi_BondType getInchiBondType (int bond_order)
 
 void IndigoInchi::loadMoleculeFromAux (const char *aux, Molecule &mol)
 {
-   // lock
-   OsLocker locker(inchi_lock);
-
    InchiMemObject<inchi_Input> data_inp_obj(Free_inchi_Input);
    inchi_Input &data_inp = data_inp_obj.ref(); 
 
@@ -146,9 +144,6 @@ void IndigoInchi::loadMoleculeFromAux (const char *aux, Molecule &mol)
 
 void IndigoInchi::loadMoleculeFromInchi (const char *inchi_string, Molecule &mol)
 {
-   // lock
-   OsLocker locker(inchi_lock);
-
    inchi_InputINCHI inchi_input;
    inchi_input.szInChI = (char *)inchi_string;
    inchi_input.szOptions = (char *)options.ptr();
@@ -565,9 +560,6 @@ void IndigoInchi::saveMoleculeIntoInchi (Molecule &mol, Array<char> &inchi)
 
    InchiMemObject<inchi_Output> inchi_output_obj(FreeINCHI);
    inchi_Output &output = inchi_output_obj.ref();
-   
-   // lock
-   OsLocker locker(inchi_lock);
 
    int ret = GetINCHI(&input, &output);
 
@@ -607,8 +599,12 @@ void IndigoInchi::saveMoleculeIntoInchi (Molecule &mol, Array<char> &inchi)
 
 void IndigoInchi::InChIKey (const char *inchi, Array<char> &output)
 {
-   // lock
-   OsLocker locker(inchi_lock);
+   // Standard InChIKey is computed natively, the other keys by the library
+   if (MoleculeInChIKey::isStandard(inchi))
+   {
+      MoleculeInChIKey::compute(inchi, output);
+      return;
+   }
 
    output.resize(28);
    output.zerofill();
@@ -632,3 +628,105 @@ void IndigoInchi::InChIKey (const char *inchi, Array<char> &output)
    }
 }
 
+//
+// IndigoInchiBatch
+//
+
+IndigoInchiBatch::IndigoInchiBatch (const IndigoInchi &prototype) :
+   _prototype(prototype)
+{
+   _molecules = 0;
+}
+
+void IndigoInchiBatch::make (Array<Molecule *> &molecules, int nthreads)
+{
+   _molecules = &molecules;
+
+   inchis.clear();
+   keys.clear();
+   errors.clear();
+   for (int i = 0; i < molecules.size(); i++)
+   {
+      inchis.push();
+      keys.push();
+      errors.push();
+   }
+
+   if (nthreads == 1 || molecules.size() < 2)
+   {
+      for (int i = 0; i < molecules.size(); i++)
+         _makeOne(i);
+      return;
+   }
+
+   IndigoInchiBatchDispatcher dispatcher(*this, molecules.size());
+
+   dispatcher.run(nthreads > 0 ? nthreads : -1);
+}
+
+void IndigoInchiBatch::_makeOne (int idx)
+{
+   try
+   {
+      IndigoInchi inchi;
+
+      inchi.options.copy(_prototype.options);
+      inchi.saveMoleculeIntoInchi(*_molecules->at(idx), inchis[idx]);
+      IndigoInchi::InChIKey(inchis[idx].ptr(), keys[idx]);
+   }
+   catch (Exception &e)
+   {
+      inchis[idx].clear();
+      keys[idx].clear();
+      errors[idx].readString(e.message(), true);
+   }
+}
+
+//
+// IndigoInchiBatchDispatcher
+//
+
+IndigoInchiBatchDispatcher::IndigoInchiBatchDispatcher (IndigoInchiBatch &batch, int count) :
+   OsCommandDispatcher(OsCommandDispatcher::HANDLING_ORDER_ANY, false),
+   _batch(batch), _count(count)
+{
+   _next_molecule = 0;
+}
+
+OsCommand * IndigoInchiBatchDispatcher::_allocateCommand ()
+{
+   return new IndigoInchiBatchCommand(_batch);
+}
+
+bool IndigoInchiBatchDispatcher::_setupCommand (OsCommand &command)
+{
+   if (_next_molecule >= _count)
+      return false;
+
+   IndigoInchiBatchCommand &cmd = (IndigoInchiBatchCommand &)command;
+
+   cmd.molecule_idx = _next_molecule++;
+   return true;
+}
+
+//
+// IndigoInchiBatchCommand
+//
+
+IndigoInchiBatchCommand::IndigoInchiBatchCommand (IndigoInchiBatch &batch) :
+   _batch(batch)
+{
+   molecule_idx = -1;
+}
+
+void IndigoInchiBatchCommand::clear ()
+{
+   molecule_idx = -1;
+   OsCommand::clear();
+}
+
+void IndigoInchiBatchCommand::execute (OsCommandResult &result)
+{
+   // Each molecule has its own result slots
+   _batch._makeOne(molecule_idx);
+}
@@ -17,6 +17,8 @@
 
 #include "base_cpp/array.h"
 #include "base_cpp/exception.h"
+#include "base_cpp/obj_array.h"
+#include "base_cpp/os_thread_wrapper.h"
 
 #include "inchi_api.h"
 
@@ -59,9 +61,65 @@ public:
    DECL_EXCEPTION_NO_EXP(Error);
 
 private:
+   friend class IndigoInchiBatch;
+
    Array<char> options;
 };
 
+// InChI and InChIKey of many molecules in the worker threads, with
+// the options of the given instance. Each molecule gets its own
+// IndigoInchi, errors are collected instead of being thrown.
+class IndigoInchiBatch
+{
+public:
+   IndigoInchiBatch (const IndigoInchi &prototype);
+
+   // nthreads: 1 - serial mode, 0 - automatic
+   void make (Array<Molecule *> &molecules, int nthreads);
+
+   // Empty InChI and InChIKey for the failed molecules
+   ObjArray< Array<char> > inchis;
+   ObjArray< Array<char> > keys;
+   ObjArray< Array<char> > errors;
+
+protected:
+   friend class IndigoInchiBatchCommand;
+
+   void _makeOne (int idx);
+
+   const IndigoInchi &_prototype;
+   Array<Molecule *> *_molecules;
+};
+
+class IndigoInchiBatchDispatcher : public OsCommandDispatcher
+{
+public:
+   IndigoInchiBatchDispatcher (IndigoInchiBatch &batch, int count);
+
+protected:
+   virtual OsCommand* _allocateCommand ();
+
+   virtual bool _setupCommand (OsCommand &command);
+
+   IndigoInchiBatch &_batch;
+   int _count;
+   int _next_molecule;
+};
+
+class IndigoInchiBatchCommand : public OsCommand
+{
+public:
+   IndigoInchiBatchCommand (IndigoInchiBatch &batch);
+
+   virtual void execute (OsCommandResult &result);
+   virtual void clear ();
+
+   int molecule_idx;
+
+private:
+   IndigoInchiBatch &_batch;
+};
+
 }
 
 #endif // __indigo_inchi_core_h__
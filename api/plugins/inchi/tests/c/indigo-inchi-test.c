@@ -4,6 +4,19 @@
 
 #include "indigo.h"
 #include "indigo-inchi.h"
+#include "inchi_api.h"
+
+/* Well-known standard InChIKeys */
+static const char *inchi_keys[][2] =
+{
+   {"InChI=1S/C2H6O/c1-2-3/h3H,2H2,1H3", "LFQSCWFLJHTTHZ-UHFFFAOYSA-N"},
+   {"InChI=1S/C6H6/c1-2-4-6-5-3-1/h1-6H", "UHOVQNZJYSORNB-UHFFFAOYSA-N"}
+};
+
+static const char *sdf_files[] =
+{
+   "normalization.sdf", "set1.sdf", "set5_left.sdf", "set5_right.sdf", "test_stereo.sdf"
+};
 
 void onError (const char *message, void *context)
 {
@@ -11,8 +24,99 @@ void onError (const char *message, void *context)
    exit(-1);
 }
 
+/* Compares the native standard InChIKey with the one of the InChI library */
+int testInchiKey (const char *inchi)
+{
+   char lib_key[28];
+   const char *key;
+
+   /* InChI can be in the Indigo output buffer that is reused for the key */
+   if (GetINCHIKeyFromINCHI(inchi, 0, 0, lib_key, 0, 0) != INCHIKEY_OK)
+   {
+      printf("InChI library failed to compute InChIKey: %s\n", inchi);
+      return 0;
+   }
+   key = indigoInchiGetInchiKey(inchi);
+   if (strcmp(key, lib_key) != 0)
+   {
+      printf("InChIKey mismatch: %s != %s\n", key, lib_key);
+      return 0;
+   }
+   return 1;
+}
+
+int testInchiKeySDFile (const char *filename)
+{
+   int iter, item, count = 0, ok = 1;
+
+   iter = indigoIterateSDFile(filename);
+   while ((item = indigoNext(iter)))
+   {
+      if (!testInchiKey(indigoInchiGetInchi(item)))
+         ok = 0;
+      indigoFree(item);
+      count++;
+   }
+   indigoFree(iter);
+   if (count == 0)
+   {
+      printf("No molecules in %s\n", filename);
+      return 0;
+   }
+   return ok;
+}
+
+/* Items that are not molecules get their own error in the batch */
+int testInchiBatch (void)
+{
+   const char *smiles[] = {"CCO", "CC>>CO", "c1ccccc1"};
+   int arr, obj, result, iter, item, ok = 1;
+   unsigned int i;
+
+   arr = indigoCreateArray();
+   for (i = 0; i < sizeof(smiles) / sizeof(smiles[0]); i++)
+   {
+      if (i == 1)
+         obj = indigoLoadReactionFromString(smiles[i]);
+      else
+         obj = indigoLoadMoleculeFromString(smiles[i]);
+      indigoArrayAdd(arr, obj);
+      indigoFree(obj);
+   }
+
+   indigoSetOptionInt("inchi-threads", 2);
+   result = indigoInchiGetInchiBatch(arr);
+   indigoSetOptionInt("inchi-threads", 1);
+
+   i = 0;
+   iter = indigoIterateArray(result);
+   while ((item = indigoNext(iter)))
+   {
+      int is_error = indigoHasProperty(item, "inchi-error");
+
+      if (is_error != (i == 1) || indigoHasProperty(item, "inchi") == is_error)
+      {
+         printf("Batch InChI item %d is invalid\n", i);
+         ok = 0;
+      }
+      else if (!is_error && strcmp(indigoGetProperty(item, "inchi-key"), inchi_keys[i / 2][1]) != 0)
+      {
+         printf("Batch InChIKey is invalid for %s\n", smiles[i]);
+         ok = 0;
+      }
+      indigoFree(item);
+      i++;
+   }
+   indigoFree(iter);
+   indigoFree(result);
+   indigoFree(arr);
+   return ok && i == sizeof(smiles) / sizeof(smiles[0]);
+}
+
 int main (void)
 {
+   char filename[1024];
+   unsigned int i;
    int m;
    const char *inchi = "InChI=1S/C10H20N2O2/c11-7-1-5-2-8(12)10(14)4-6(5)3-9(7)13/h5-10,13-14H,1-4,11-12H2";
    const char *res_inchi;
@@ -28,5 +132,25 @@ int main (void)
       printf("Converted Inchi is invalid: %s != %s\n", inchi, res_inchi);
       exit(-1);
    }
+
+   printf("%s\n", indigoInchiGetInchiKey(inchi));
+   for (i = 0; i < sizeof(inchi_keys) / sizeof(inchi_keys[0]); i++)
+   {
+      if (strcmp(indigoInchiGetInchiKey(inchi_keys[i][0]), inchi_keys[i][1]) != 0)
+      {
+         printf("InChIKey is invalid for %s: %s\n", inchi_keys[i][0], indigoInchiGetInchiKey(inchi_keys[i][0]));
+         exit(-1);
+      }
+   }
+   if (!testInchiKey(inchi))
+      exit(-1);
+   for (i = 0; i < sizeof(sdf_files) / sizeof(sdf_files[0]); i++)
+   {
+      sprintf(filename, "%s/%s", INCHI_TEST_DATA_DIR, sdf_files[i]);
+      if (!testInchiKeySDFile(filename))
+         exit(-1);
+   }
+   if (!testInchiBatch())
+      exit(-1);
    return 0;
 }
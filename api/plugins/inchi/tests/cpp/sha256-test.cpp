@@ -0,0 +1,84 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "base_cpp/sha256.h"
+
+using namespace indigo;
+
+// Known-answer vectors from FIPS 180-2
+static const char *messages[][2] =
+{
+   {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+   {"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+   {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+    "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"}
+};
+
+static void toHex (const byte *digest, char *hex)
+{
+   for (int i = 0; i < SHA256::DIGEST_SIZE; i++)
+      sprintf(hex + 2 * i, "%02x", digest[i]);
+}
+
+static bool check (const char *name, const byte *digest, const char *expected)
+{
+   char hex[2 * SHA256::DIGEST_SIZE + 1];
+
+   toHex(digest, hex);
+   if (strcmp(hex, expected) != 0)
+   {
+      printf("SHA-256 is invalid for %s: %s != %s\n", name, hex, expected);
+      return false;
+   }
+   return true;
+}
+
+int main (void)
+{
+   byte digest[SHA256::DIGEST_SIZE];
+   bool ok = true;
+
+   for (unsigned i = 0; i < sizeof(messages) / sizeof(messages[0]); i++)
+   {
+      const char *msg = messages[i][0];
+
+      SHA256::get(msg, (int)strlen(msg), digest);
+      ok = check(msg, digest, messages[i][1]) && ok;
+
+      // The same message fed by single bytes
+      SHA256 sha;
+      for (const char *p = msg; *p != 0; p++)
+         sha.update(p, 1);
+      sha.final(digest);
+      ok = check(msg, digest, messages[i][1]) && ok;
+   }
+
+   // One million of 'a' covers the length encoding of the long messages
+   {
+      char block[1000];
+      SHA256 sha;
+
+      memset(block, 'a', sizeof(block));
+      for (int i = 0; i < 1000; i++)
+         sha.update(block, sizeof(block));
+      sha.final(digest);
+      ok = check("1000000 x 'a'", digest,
+         "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0") && ok;
+   }
+
+   return ok ? 0 : 1;
+}
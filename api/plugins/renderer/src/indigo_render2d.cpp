@@ -141,6 +141,14 @@ void indigoRenderSetGridMargins (int x, int y)
    rp.cnvOpt.gridMarginY = y;
 }
 
+void indigoRenderSetGridThreads (int value)
+{
+   RenderParams& rp = indigoRendererGetInstance().renderParams;
+   if (value < 0)
+      throw IndigoError("%d is bad grid threads count", value);
+   rp.cnvOpt.gridThreads = value;
+}
+
 void indigoRenderSetBondLength (float length)
 {
    RenderParams& rp = indigoRendererGetInstance().renderParams;
@@ -193,6 +201,12 @@ void indigoRenderSetBoldBondDetection (int enabled)
    rp.rOpt.boldBondDetection = enabled != 0;
 }
 
+void indigoRenderSetSvgDirect (int enabled)
+{
+   RenderParams& rp = indigoRendererGetInstance().renderParams;
+   rp.rOpt.svgDirect = enabled != 0;
+}
+
 void indigoRenderSetColoring (int enabled)
 {
    RenderParams& rp = indigoRendererGetInstance().renderParams;
@@ -416,6 +430,43 @@ void indigoRenderSetGridTitleProperty (const char* prop)
    rp.cnvOpt.titleProp.appendString(prop, true);
 }                                      
 
+// Identifies the molecule object and the state of the molecule for the
+// kept item trees. The edit revision does not count the changes of the
+// stereo configuration, so these are hashed.
+static void _getSourceKey (int object, BaseMolecule &mol, Array<char> &key)
+{
+   key.clear();
+
+   // R-group fragments are separate molecules with their own revisions
+   if (mol.rgroups.getRGroupCount() > 0)
+      return;
+
+   dword hash = 0;
+   int i, atom, type, group, pyramid[4];
+
+   for (i = mol.stereocenters.begin(); i < mol.stereocenters.end(); i = mol.stereocenters.next(i))
+   {
+      mol.stereocenters.get(i, atom, type, group, pyramid);
+      hash = hash * 31 + atom;
+      hash = hash * 31 + type;
+      hash = hash * 31 + group;
+      for (int j = 0; j < 4; j++)
+         hash = hash * 31 + pyramid[j];
+   }
+   for (i = mol.edgeBegin(); i < mol.edgeEnd(); i = mol.edgeNext(i))
+   {
+      hash = hash * 31 + mol.cis_trans.getParity(i);
+      hash = hash * 31 + mol.getBondDirection(i);
+   }
+
+   ArrayOutput output(key);
+
+   output.printf("%d %p %d %d %d %d %d %d %x", object, &mol, mol.getEditRevision(),
+      mol.data_sgroups.size(), mol.superatoms.size(), mol.repeating_units.size(),
+      mol.multiple_groups.size(), mol.generic_sgroups.size(), hash);
+   output.writeChar(0);
+}
+
 CEXPORT int indigoRender (int object, int output)
 {
    INDIGO_BEGIN
@@ -427,13 +478,23 @@ CEXPORT int indigoRender (int object, int output)
 
       IndigoObject &obj = self.getObject(object);
 
+      rp.sourceKey.clear();
+
       if (IndigoBaseMolecule::is(obj))
       {
-         if (obj.getBaseMolecule().isQueryMolecule())
-            rp.mol.reset(new QueryMolecule());
+         _getSourceKey(object, obj.getBaseMolecule(), rp.sourceKey);
+
+         // The kept item tree is drawn without a copy of the molecule
+         if (RenderParamInterface::hasTree(rp))
+            rp.mol.reset(NULL);
          else
-            rp.mol.reset(new Molecule());
-         rp.mol->clone_KeepIndices(self.getObject(object).getBaseMolecule());
+         {
+            if (obj.getBaseMolecule().isQueryMolecule())
+               rp.mol.reset(new QueryMolecule());
+            else
+               rp.mol.reset(new Molecule());
+            rp.mol->clone_KeepIndices(self.getObject(object).getBaseMolecule());
+         }
          rp.rmode = RENDER_MOL;
       }
       else if (IndigoBaseReaction::is(obj))
@@ -470,6 +531,7 @@ CEXPORT int indigoRenderGrid (int objects, int* refAtoms, int nColumns, int outp
    {
       RenderParams& rp = indigoRendererGetInstance().renderParams;
       rp.clearArrays();
+      rp.sourceKey.clear();
 
       PtrArray<IndigoObject>& objs = IndigoArray::cast(self.getObject(objects)).objects;
       if (IndigoBaseMolecule::is(*objs[0]))
@@ -641,6 +703,7 @@ _IndigoRenderingOptionsHandlersSetter::_IndigoRenderingOptionsHandlersSetter ()
    mgr.setOptionHandlerBool("render-implicit-hydrogens-visible", indigoRenderSetImplicitHydrogenVisible);
    mgr.setOptionHandlerBool("render-highlighted-labels-visible", indigoRenderSetHighlightedLabelsVisible);
    mgr.setOptionHandlerBool("render-bold-bond-detection", indigoRenderSetBoldBondDetection);
+   mgr.setOptionHandlerBool("render-svg-direct", indigoRenderSetSvgDirect);
 
    mgr.setOptionHandlerFloat("render-bond-length", indigoRenderSetBondLength);
    mgr.setOptionHandlerFloat("render-relative-thickness", indigoRenderSetRelativeThickness);
@@ -666,6 +729,7 @@ _IndigoRenderingOptionsHandlersSetter::_IndigoRenderingOptionsHandlersSetter ()
    mgr.setOptionHandlerFloat("render-grid-title-font-size", indigoRenderSetTitleFontSize);
    mgr.setOptionHandlerString("render-grid-title-property", indigoRenderSetGridTitleProperty);
    mgr.setOptionHandlerInt("render-grid-title-offset", indigoRenderSetTitleOffset);
+   mgr.setOptionHandlerInt("render-grid-threads", indigoRenderSetGridThreads);
 }
 
 _IndigoRenderingOptionsHandlersSetter _indigo_rendering_options_handlers_setter;
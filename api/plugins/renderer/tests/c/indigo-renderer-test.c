@@ -51,6 +51,225 @@ void testHDC ()
 
 }
 
+static char * renderToMemory (int object, int *size)
+{
+   int buffer_object = indigoWriteBuffer();
+   char *raw_ptr, *result;
+
+   indigoRender(object, buffer_object);
+   indigoToBuffer(buffer_object, &raw_ptr, size);
+   result = (char *)malloc(*size);
+   memcpy(result, raw_ptr, *size);
+   indigoFree(buffer_object);
+   return result;
+}
+
+// Item tree of a molecule is kept between the renders. It should be
+// rebuilt when an option that changes the items is changed.
+void testTreeOptions ()
+{
+   int molecule, clone;
+   int atoms[] = {0, 1};
+   char *first, *second, *expected;
+   int first_size, second_size, expected_size;
+
+   molecule = indigoLoadMoleculeFromString("CCO");
+   indigoLayout(molecule);
+   indigoAddDataSGroup(molecule, 2, atoms, 0, 0, "color", "1, 0, 0");
+   clone = indigoClone(molecule);
+
+   indigoSetOption("render-output-format", "png");
+   indigoSetOption("render-atom-color-property", "");
+   first = renderToMemory(molecule, &first_size);
+
+   indigoSetOption("render-atom-color-property", "color");
+   second = renderToMemory(molecule, &second_size);
+   expected = renderToMemory(clone, &expected_size);
+
+   if ((first_size == second_size && memcmp(first, second, first_size) == 0) ||
+       second_size != expected_size || memcmp(second, expected, second_size) != 0)
+   {
+      fprintf(stderr, "Error: render-atom-color-property is not applied to the kept molecule\n");
+      exit(-1);
+   }
+
+   indigoSetOption("render-atom-color-property", "");
+   free(first);
+   free(second);
+   free(expected);
+   indigoFree(clone);
+   indigoFree(molecule);
+}
+
+// Checks that the tags are balanced and the character
+// references are known, which is enough for the renderer output
+static int isWellFormedXml (const char *xml, int size)
+{
+   const char *p = xml, *end = xml + size;
+   const char *stack[64];
+   int depth = 0, root_closed = 0;
+
+   while (p < end)
+   {
+      if (*p == '<')
+      {
+         const char *close = memchr(p, '>', end - p);
+         const char *name;
+         int len;
+
+         if (close == 0)
+            return 0;
+         if (p[1] == '?' || p[1] == '!')
+         {
+            p = close + 1;
+            continue;
+         }
+         if (root_closed)
+            return 0;
+         name = p[1] == '/' ? p + 2 : p + 1;
+         len = (int)strcspn(name, " \t\r\n/>");
+         if (p[1] == '/')
+         {
+            if (depth == 0 || strncmp(stack[depth - 1], name, len) != 0 ||
+                strcspn(stack[depth - 1], " \t\r\n/>") != (size_t)len)
+               return 0;
+            if (--depth == 0)
+               root_closed = 1;
+         }
+         else if (close[-1] != '/')
+         {
+            if (depth == 64)
+               return 0;
+            stack[depth++] = name;
+         }
+         p = close + 1;
+      }
+      else if (*p == '&')
+      {
+         if (strncmp(p, "&amp;", 5) != 0 && strncmp(p, "&lt;", 4) != 0 &&
+             strncmp(p, "&gt;", 4) != 0 && strncmp(p, "&quot;", 6) != 0 &&
+             strncmp(p, "&apos;", 6) != 0 && strncmp(p, "&#", 2) != 0)
+            return 0;
+         p++;
+      }
+      else
+         p++;
+   }
+   return depth == 0 && root_closed;
+}
+
+static int containsText (const char *data, int size, const char *text)
+{
+   int len = (int)strlen(text), i;
+
+   for (i = 0; i + len <= size; i++)
+      if (memcmp(data + i, text, len) == 0)
+         return 1;
+   return 0;
+}
+
+// SVG is written either by cairo or directly by the renderer
+// with "render-svg-direct". Both outputs should be valid SVG.
+void testSvg ()
+{
+   const char *modes[] = {"false", "true"};
+   int molecule, i;
+
+   // Charges, wedges and the atom labels
+   molecule = indigoLoadMoleculeFromString("C[C@H]([NH3+])[C@@H](Cl)C(=O)[O-].[NH4+]");
+   indigoLayout(molecule);
+
+   indigoSetOption("render-output-format", "svg");
+   indigoSetOption("render-comment", "Amines & \"acids\" <test>");
+
+   for (i = 0; i < 2; i++)
+   {
+      char *svg;
+      int size, direct = (i == 1);
+
+      indigoSetOption("render-svg-direct", modes[i]);
+      svg = renderToMemory(molecule, &size);
+
+      if (!isWellFormedXml(svg, size) || !containsText(svg, size, "<svg") ||
+          !containsText(svg, size, "<use"))
+      {
+         fprintf(stderr, "Error: invalid SVG with render-svg-direct=%s\n", modes[i]);
+         exit(-1);
+      }
+      // Cairo draws the text as glyph paths
+      if (direct && (!containsText(svg, size, "<text") ||
+                     !containsText(svg, size, "Amines &amp; &quot;acids&quot; &lt;test&gt;")))
+      {
+         fprintf(stderr, "Error: SVG text is not written or escaped\n");
+         exit(-1);
+      }
+      free(svg);
+   }
+
+   indigoSetOption("render-svg-direct", "false");
+   indigoSetOption("render-comment", "");
+   indigoFree(molecule);
+}
+
+static char * renderGridToMemory (int objects, int columns, int *size)
+{
+   int buffer_object = indigoWriteBuffer();
+   char *raw_ptr, *result;
+
+   indigoRenderGrid(objects, 0, columns, buffer_object);
+   indigoToBuffer(buffer_object, &raw_ptr, size);
+   result = (char *)malloc(*size);
+   memcpy(result, raw_ptr, *size);
+   indigoFree(buffer_object);
+   return result;
+}
+
+// Grid cells are rendered in "render-grid-threads" worker threads
+// for PNG. The image should be the same as in serial mode.
+void testGridThreads ()
+{
+   const char *smiles[] = {
+      "CC(C)Cc1ccc(cc1)C(C)C(O)=O",
+      "COc1ccc2cc(ccc2c1)C(C)C(O)=O",
+      "OC(=O)Cc1ccccc1Nc1c(Cl)cccc1Cl",
+      "CC(=O)Oc1ccccc1C(O)=O",
+      "C[C@H]([NH3+])C([O-])=O",
+      "C1CCC2(CC1)CCCCC2",
+      "c1ccc2ccccc2c1"
+   };
+   int array = indigoCreateArray();
+   char *serial, *threaded;
+   int serial_size, threaded_size, i;
+
+   for (i = 0; i < (int)(sizeof(smiles) / sizeof(smiles[0])); i++)
+   {
+      int mol = indigoLoadMoleculeFromString(smiles[i]);
+
+      indigoArrayAdd(array, mol);
+      indigoFree(mol);
+   }
+
+   indigoSetOption("render-output-format", "png");
+   indigoSetOption("render-comment", "Grid");
+
+   indigoSetOptionInt("render-grid-threads", 1);
+   serial = renderGridToMemory(array, 3, &serial_size);
+   indigoSetOptionInt("render-grid-threads", 4);
+   threaded = renderGridToMemory(array, 3, &threaded_size);
+   indigoSetOptionInt("render-grid-threads", 1);
+
+   if (serial_size != threaded_size || memcmp(serial, threaded, serial_size) != 0)
+   {
+      fprintf(stderr, "Error: grid rendered in threads differs from the serial one\n");
+      exit(-1);
+   }
+
+   indigoSetOption("render-comment", "");
+   free(serial);
+   free(threaded);
+   indigoFree(array);
+}
+
 int main (void)
 {
    int m;
@@ -67,5 +286,8 @@ int main (void)
    indigoRenderToFile(m, "indigo-renderer-test.png"); 
 
    testHDC();
+   testTreeOptions();
+   testSvg();
+   testGridThreads();
    return 0;
 }
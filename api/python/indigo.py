@@ -827,6 +827,16 @@ class IndigoObject(object):
         self.dispatcher._setSessionId()
         return self.dispatcher._checkResult(Indigo._lib.indigoLayout(self.id))
 
+    def layoutIncremental(self, atoms, bonds):
+        self.dispatcher._setSessionId()
+        arr_atoms = (c_int * len(atoms))()
+        for i in range(len(atoms)):
+            arr_atoms[i] = atoms[i]
+        arr_bonds = (c_int * len(bonds))()
+        for i in range(len(bonds)):
+            arr_bonds[i] = bonds[i]
+        return self.dispatcher._checkResult(Indigo._lib.indigoLayoutIncremental(self.id, len(arr_atoms), arr_atoms, len(arr_bonds), arr_bonds))
+
     def smiles(self):
         self.dispatcher._setSessionId()
         return self.dispatcher._checkResultString(Indigo._lib.indigoSmiles(self.id))
@@ -1288,8 +1298,12 @@ class Indigo(object):
         Indigo._lib.indigoCreateDecomposer.argtypes = [c_int]
         Indigo._lib.indigoReactionProductEnumerate.restype = c_int
         Indigo._lib.indigoReactionProductEnumerate.argtypes = [c_int, c_int]
+        Indigo._lib.indigoIterateReactionProductEnumeration.restype = c_int
+        Indigo._lib.indigoIterateReactionProductEnumeration.argtypes = [c_int, c_int]
         Indigo._lib.indigoTransform.restype = c_int
         Indigo._lib.indigoTransform.argtypes = [c_int, c_int]
+        Indigo._lib.indigoCreateTransformer.restype = c_int
+        Indigo._lib.indigoCreateTransformer.argtypes = [c_int]
         Indigo._lib.indigoDbgBreakpoint.restype = None
         Indigo._lib.indigoDbgBreakpoint.argtypes = None
         Indigo._lib.indigoClone.restype = c_int
@@ -1348,6 +1362,8 @@ class Indigo(object):
         Indigo._lib.indigoNormalize.argtypes = [c_int, c_char_p]
         Indigo._lib.indigoAutomap.restype = c_int
         Indigo._lib.indigoAutomap.argtypes = [c_int, c_char_p]
+        Indigo._lib.indigoAutomapBatch.restype = c_int
+        Indigo._lib.indigoAutomapBatch.argtypes = [c_int, c_char_p]
         Indigo._lib.indigoGetAtomMappingNumber.restype = c_int
         Indigo._lib.indigoGetAtomMappingNumber.argtypes = [c_int, c_int]
         Indigo._lib.indigoSetAtomMappingNumber.restype = c_int
@@ -1622,6 +1638,12 @@ class Indigo(object):
         Indigo._lib.indigoUnfoldHydrogens.argtypes = [c_int]
         Indigo._lib.indigoLayout.restype = c_int
         Indigo._lib.indigoLayout.argtypes = [c_int]
+        Indigo._lib.indigoLayoutIncremental.restype = c_int
+        Indigo._lib.indigoLayoutIncremental.argtypes = [c_int, c_int, POINTER(c_int), c_int, POINTER(c_int)]
+        Indigo._lib.indigoLayoutBatch.restype = c_int
+        Indigo._lib.indigoLayoutBatch.argtypes = [c_int]
+        Indigo._lib.indigoLoadLayoutTemplatesFromFile.restype = c_int
+        Indigo._lib.indigoLoadLayoutTemplatesFromFile.argtypes = [c_char_p]
         Indigo._lib.indigoSmiles.restype = c_char_p
         Indigo._lib.indigoSmiles.argtypes = [c_int]
         Indigo._lib.indigoName.restype = c_char_p
@@ -1978,10 +2000,32 @@ class Indigo(object):
         monomers = self.convertToArray(monomers)
         return self.IndigoObject(self, self._checkResult(Indigo._lib.indigoReactionProductEnumerate(replacedaction.id, monomers.id)), replacedaction)
 
+    def iterateReactionProductEnumeration(self, replacedaction, monomers):
+        self._setSessionId()
+        monomers = self.convertToArray(monomers)
+        return self.IndigoObject(self, self._checkResult(Indigo._lib.indigoIterateReactionProductEnumeration(replacedaction.id, monomers.id)), replacedaction)
+
     def transform(self, reaction, monomers):
         self._setSessionId()
         return self._checkResult(Indigo._lib.indigoTransform(reaction.id, monomers.id))
 
+    def layoutBatch(self, molecules):
+        self._setSessionId()
+        return self._checkResult(Indigo._lib.indigoLayoutBatch(molecules.id))
+
+    def loadLayoutTemplatesFromFile(self, filename):
+        self._setSessionId()
+        return self._checkResult(Indigo._lib.indigoLoadLayoutTemplatesFromFile(filename.encode('ascii')))
+
+    def automapBatch(self, reactions, mode=''):
+        self._setSessionId()
+        mode = '' if mode is None else mode
+        return self._checkResult(Indigo._lib.indigoAutomapBatch(reactions.id, mode.encode('ascii')))
+
+    def createTransformer(self, reaction):
+        self._setSessionId()
+        return self.IndigoObject(self, self._checkResult(Indigo._lib.indigoCreateTransformer(reaction.id)), reaction)
+
     def loadBuffer(self, buf):
         self._setSessionId()
         values = (c_byte * len(buf))()
@@ -47,6 +47,7 @@ void Indigo::init ()
    deconvolution_aromatization = true;
    deco_save_ap_bond_orders = false;
    deco_ignore_errors = true;
+   deco_threads = 1;
    molfile_saving_mode = 0;
    molfile_saving_no_chiral = false;
    filename_encoding = ENCODING_ASCII;
@@ -61,12 +62,16 @@ void Indigo::init ()
    max_embeddings = 10000;
 
    layout_max_iterations = 0;
+   layout_threads = 1;
 
    molfile_saving_skip_date = false;
 
    smiles_saving_write_name = false;
 
    aam_cancellation_timeout = 0;
+   aam_threads = 1;
+   scaffold_threads = 1;
+   scaffold_timeout = 0;
    cancellation_timeout = 0;
 
    preserve_ordering_in_serialize = false;
@@ -111,6 +111,11 @@ int IndigoArrayElement::getIndex ()
    return idx;
 }
 
+RedBlackStringObjMap< Array<char> > * IndigoArrayElement::getProperties ()
+{
+   return array->objects[idx]->getProperties();
+}
+
 IndigoArrayIter::IndigoArrayIter (IndigoArray &arr) : IndigoObject(ARRAY_ITER)
 {
    _arr = &arr;
@@ -58,6 +58,8 @@ public:
 
    virtual int getIndex ();
 
+   virtual RedBlackStringObjMap< Array<char> > * getProperties ();
+
    IndigoArray *array;
    int idx;
 };
@@ -41,9 +41,11 @@ IndigoObject(IndigoObject::DECONVOLUTION),
 save_ap_bond_orders(false),
 ignore_errors(false),
 aromatize(true),
+nthreads(1),
 cbEmbedding(0),
 embeddingUserdata(0),
-_userDefinedScaffold(false)
+_userDefinedScaffold(false),
+_scaffoldAromaticity(false)
 {
 }
 
@@ -92,16 +94,35 @@ void IndigoDeconvolution::setScaffold (QueryMolecule& scaffold) {
          _scaffold.resetAtom(i, qatom.release());
       }
    }
-
+   /*
+    * Precalculate the scaffold automorphisms and aromaticity check
+    */
+   DecompositionEnumerator::calculateAutoMaps(_scaffold, _scaffoldAutoMaps);
+   _scaffoldAromaticity = AromaticityMatcher::isNecessary(_scaffold);
 }
 
 void IndigoDeconvolution::makeRGroups (QueryMolecule& scaffold) {
 
    setScaffold(scaffold);
-   
+
+   if(_deconvolutionElems.size() > 0 && _fullScaffold.vertexCount() == 0)
+      throw Error("error: scaffold vertex count equals 0");
+
+   _aromOptions = indigoGetInstance().arom_options;
+
+   if (nthreads != 1 && _deconvolutionElems.size() > 1) {
+      IndigoDeconvolutionDispatcher dispatcher(*this);
+      dispatcher.run(nthreads > 0 ? nthreads : -1);
+   } else {
+      for (int mol_idx = 0; mol_idx < _deconvolutionElems.size(); ++mol_idx)
+         matchScaffold(_deconvolutionElems[mol_idx], false);
+   }
+   /*
+    * Full scaffold is changed in the molecules order
+    */
    for (int mol_idx = 0; mol_idx < _deconvolutionElems.size(); ++mol_idx) {
       IndigoDeconvolutionElem& elem = _deconvolutionElems[mol_idx];
-      makeRGroup(elem, false, true);
+      _makeRGroupsForMatches(elem, true);
    }
 }
 
@@ -109,37 +130,37 @@ void IndigoDeconvolution::makeRGroup(IndigoDeconvolutionElem& elem, bool all_mat
 
    if(_fullScaffold.vertexCount() == 0)
       throw Error("error: scaffold vertex count equals 0");
-   
+
+   _aromOptions = indigoGetInstance().arom_options;
+
+   matchScaffold(elem, all_matches);
+   _makeRGroupsForMatches(elem, change_scaffold);
+}
+
+void IndigoDeconvolution::matchScaffold(IndigoDeconvolutionElem& elem, bool all_matches) {
+
    Molecule& mol_in = elem.mol_in;
    
    DecompositionEnumerator& deco_enum = elem.deco_enum;
-   if (mol_in.vertexCount() == 0) {
-      deco_enum.contexts.clear();
+   deco_enum.contexts.clear();
+   if (mol_in.vertexCount() == 0)
       return;
-   }
 
    if(aromatize)
-   {
-      Indigo &indigo = indigoGetInstance();
-      MoleculeAromatizer::aromatizeBonds(mol_in, indigo.arom_options);
-   }
+      MoleculeAromatizer::aromatizeBonds(mol_in, _aromOptions);
 
    /*
     * Set enumerator parameters
     */
-   if (aromatize && AromaticityMatcher::isNecessary(_scaffold))
-   {
-      Indigo &indigo = indigoGetInstance();
-      deco_enum.am.reset(new AromaticityMatcher(_scaffold, mol_in, indigo.arom_options));
-   }
+   if (aromatize && _scaffoldAromaticity)
+      deco_enum.am.reset(new AromaticityMatcher(_scaffold, mol_in, _aromOptions));
 
    deco_enum.fmcache.reset(new MoleculeSubstructureMatcher::FragmentMatchCache);
    deco_enum.fmcache->clear();
    deco_enum.all_matches = all_matches;
    deco_enum.remove_rsites = _userDefinedScaffold;
-   deco_enum.contexts.clear();
    deco_enum.deco = this;
-   deco_enum.calculateAutoMaps(_scaffold);
+   deco_enum.setAutoMaps(_scaffoldAutoMaps);
 
    /*
     * Create substructure enumerator and set up options
@@ -156,6 +177,14 @@ void IndigoDeconvolution::makeRGroup(IndigoDeconvolutionElem& elem, bool all_mat
     * Find subgraph
     */
    emb_enum.process();
+}
+
+void IndigoDeconvolution::_makeRGroupsForMatches(IndigoDeconvolutionElem& elem, bool change_scaffold) {
+   Molecule& mol_in = elem.mol_in;
+   DecompositionEnumerator& deco_enum = elem.deco_enum;
+
+   if (mol_in.vertexCount() == 0)
+      return;
 
    if(deco_enum.contexts.size() == 0) {
       if(ignore_errors) {
@@ -1157,20 +1186,32 @@ int IndigoDeconvolution::_getRgScore(Array<int>& rg_map) const {
 }
 
 void IndigoDeconvolution::DecompositionEnumerator::calculateAutoMaps(Graph& sub) {
+   calculateAutoMaps(sub, _scafAutoMaps);
+}
+
+void IndigoDeconvolution::DecompositionEnumerator::setAutoMaps(ObjList< Array<int> >& auto_maps) {
+   _scafAutoMaps.clear();
+   for (int i = auto_maps.begin(); i != auto_maps.end(); i = auto_maps.next(i)) {
+      int idx = _scafAutoMaps.add();
+      _scafAutoMaps.at(idx).copy(auto_maps[i]);
+   }
+}
+
+void IndigoDeconvolution::DecompositionEnumerator::calculateAutoMaps(Graph& sub, ObjList< Array<int> >& auto_maps) {
    /*
     * Set callbacks
     */
    AutomorphismSearch auto_search;
    auto_search.cb_check_automorphism = _cbAutoCheckAutomorphism;
    auto_search.getcanon = false;
-   auto_search.context = &_scafAutoMaps;
+   auto_search.context = &auto_maps;
    /*
     * Add direct order automap
     */
-   _scafAutoMaps.clear();
+   auto_maps.clear();
 
-   int l_idx = _scafAutoMaps.add();
-   Array<int>& d_map = _scafAutoMaps.at(l_idx);
+   int l_idx = auto_maps.add();
+   Array<int>& d_map = auto_maps.at(l_idx);
    d_map.resize(sub.vertexEnd());
    for (int i = 0; i < d_map.size(); ++i) {
       d_map[i] = i;
@@ -1463,6 +1504,45 @@ bool IndigoDeconvolution::DecompositionEnumerator::_cbAutoCheckAutomorphism (Gra
    return false;
 }
 
+IndigoDeconvolutionDispatcher::IndigoDeconvolutionDispatcher(IndigoDeconvolution& deco) :
+OsCommandDispatcher(OsCommandDispatcher::HANDLING_ORDER_ANY, false),
+_deco(deco),
+_next(0) {
+}
+
+OsCommand* IndigoDeconvolutionDispatcher::_allocateCommand () {
+   return new IndigoDeconvolutionCommand(_deco);
+}
+
+bool IndigoDeconvolutionDispatcher::_setupCommand (OsCommand& command) {
+   int size = _deco.getItems().size();
+   if (_next >= size)
+      return false;
+
+   IndigoDeconvolutionCommand& cmd = (IndigoDeconvolutionCommand&)command;
+   cmd.begin = _next;
+   cmd.end = __min(_next + MOLECULES_PER_COMMAND, size);
+   _next = cmd.end;
+   return true;
+}
+
+IndigoDeconvolutionCommand::IndigoDeconvolutionCommand(IndigoDeconvolution& deco) :
+begin(0),
+end(0),
+_deco(deco) {
+}
+
+void IndigoDeconvolutionCommand::execute (OsCommandResult& ) {
+   for (int i = begin; i < end; ++i)
+      _deco.matchScaffold(_deco.getItems()[i], false);
+}
+
+void IndigoDeconvolutionCommand::clear () {
+   begin = 0;
+   end = 0;
+   OsCommand::clear();
+}
+
 
 CEXPORT int indigoDecomposeMolecules (int scaffold, int structures) {
    INDIGO_BEGIN
@@ -1473,6 +1553,7 @@ CEXPORT int indigoDecomposeMolecules (int scaffold, int structures) {
       deco->save_ap_bond_orders = self.deco_save_ap_bond_orders;
       deco->ignore_errors = self.deco_ignore_errors;
       deco->aromatize = self.deconvolution_aromatization;
+      deco->nthreads = self.deco_threads;
       int i;
 
       for (i = 0; i < mol_array.objects.size(); i++)
@@ -21,6 +21,7 @@
 #include "molecule/molecule_arom_match.h"
 #include "molecule/molecule_substructure_matcher.h"
 #include "base_cpp/obj_list.h"
+#include "base_cpp/os_thread_wrapper.h"
 
 #ifdef _WIN32
 #pragma warning(push)
@@ -44,6 +45,11 @@ public:
    void setScaffold (QueryMolecule& scaffold);
    void makeRGroups (QueryMolecule& scaffold);
    void makeRGroup (IndigoDeconvolutionElem& elem, bool all_matches, bool change_scaffold);
+   /*
+    * Scaffold embeddings of a molecule. Changes only the molecule and its
+    * enumerator so it can be called for different molecules in parallel
+    */
+   void matchScaffold (IndigoDeconvolutionElem& elem, bool all_matches);
 
    QueryMolecule& getDecomposedScaffold() { return _fullScaffold; }
    ObjArray<IndigoDeconvolutionElem>& getItems () {return _deconvolutionElems;}
@@ -59,6 +65,10 @@ public:
     * Aromatize
     */
    bool aromatize;
+   /*
+    * Number of threads for makeRGroups: one - serial mode, zero - automatic
+    */
+   int nthreads;
 
    int (*cbEmbedding) (const int *sub_vert_map, const int *sub_edge_map, const void* info, void* userdata);
    void *embeddingUserdata;
@@ -74,6 +84,8 @@ public:
       AutoPtr<MoleculeSubstructureMatcher::FragmentMatchCache> fmcache;
        
       void calculateAutoMaps(Graph& sub);
+      void setAutoMaps(ObjList< Array<int> >& auto_maps);
+      static void calculateAutoMaps(Graph& sub, ObjList< Array<int> >& auto_maps);
       bool shouldContinue(int* map, int size);
       void addMatch(IndigoDecompositionMatch& match, Graph& sub, Graph& super);
 
@@ -99,6 +111,7 @@ public:
    DECL_ERROR;
 private:
    void _parseOptions(const char* options);
+   void _makeRGroupsForMatches(IndigoDeconvolutionElem& elem, bool change_scaffold);
    
    void _addFullRGroup(IndigoDecompositionMatch& deco_match, Array<int>& auto_map, int rg_idx, int new_rg_idx);
 
@@ -118,7 +131,46 @@ private:
    QueryMolecule _fullScaffold;
    bool _userDefinedScaffold;
    ObjArray<IndigoDeconvolutionElem> _deconvolutionElems;
+   /*
+    * Data of the scaffold that is the same for all the molecules
+    */
+   ObjList< Array<int> > _scaffoldAutoMaps;
+   bool _scaffoldAromaticity;
+   AromaticityOptions _aromOptions;
+
+};
+
+/*
+ * Scaffold matching of the molecules in the worker threads. Each command
+ * takes a few consecutive molecules. R-groups are created afterwards in
+ * the molecules order, so their numbering does not depend on the threads
+ */
+class IndigoDeconvolutionDispatcher : public OsCommandDispatcher {
+public:
+   IndigoDeconvolutionDispatcher(IndigoDeconvolution& deco);
 
+protected:
+   enum {
+      MOLECULES_PER_COMMAND = 8
+   };
+   virtual OsCommand* _allocateCommand ();
+   virtual bool _setupCommand (OsCommand& command);
+
+   IndigoDeconvolution& _deco;
+   int _next;
+};
+
+class IndigoDeconvolutionCommand : public OsCommand {
+public:
+   IndigoDeconvolutionCommand(IndigoDeconvolution& deco);
+
+   virtual void execute (OsCommandResult& result);
+   virtual void clear ();
+
+   int begin;
+   int end;
+private:
+   IndigoDeconvolution& _deco;
 };
 
 class DLLEXPORT IndigoDeconvolutionElem : public IndigoObject
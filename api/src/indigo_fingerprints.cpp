@@ -141,6 +141,9 @@ CEXPORT int indigoFingerprint (int item, const char *type)
          builder.process();
          AutoPtr<IndigoFingerprint> fp(new IndigoFingerprint());
          fp->bytes.copy(builder.get(), self.fp_params.fingerprintSizeExtOrdSim() * 2);
+         if (!builder.skip_ord)
+            fp->bytes.concat(builder.getReactingCenters(),
+                             ReactionFingerprintBuilder::fingerprintSizeReactingCenters());
          return self.addObject(fp.release());
       }
       else
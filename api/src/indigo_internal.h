@@ -132,7 +132,9 @@ public:
       SAVER,
       ATTACHMENT_POINTS_ITER,
       DECOMPOSITION_MATCH,
-      DECOMPOSITION_MATCH_ITER
+      DECOMPOSITION_MATCH_ITER,
+      PRODUCT_ENUMERATOR_ITER,
+      TRANSFORMER
    };
 
    int type;
@@ -195,16 +197,26 @@ struct DLLEXPORT ProductEnumeratorParams
       is_one_tube = false;
       is_self_react = false;
       is_layout = true;
+      is_products_layout = true;
       max_deep_level = 2;
       max_product_count = 1000;
+      is_max_product_count_set = false;
+      is_unique_products = true;
+      nthreads = 1;
+      transform_nthreads = 1;
    }
 
    bool is_multistep_reactions;
    bool is_one_tube;
    bool is_self_react;
    bool is_layout;
+   bool is_products_layout;
    int max_deep_level;
    int max_product_count;
+   bool is_max_product_count_set; // the iterator has no products limit by default
+   bool is_unique_products;
+   int nthreads;
+   int transform_nthreads;
 };
 
 class DLLEXPORT Indigo
@@ -245,6 +257,7 @@ public:
    bool deconvolution_aromatization;
    bool deco_save_ap_bond_orders;
    bool deco_ignore_errors;
+   int deco_threads; //default is one - serial mode, zero - automatic
 
    int  molfile_saving_mode; // MolfileSaver::MODE_***, default is zero
    bool molfile_saving_no_chiral;
@@ -258,8 +271,13 @@ public:
    int max_embeddings;
 
    int layout_max_iterations; // default is zero -- no limit
+   int layout_threads; // default is one - serial mode, zero - automatic
 
    int aam_cancellation_timeout; //default is zero - no timeout
+   int aam_threads; //default is one - serial mode, zero - automatic
+
+   int scaffold_threads; //default is one - serial mode, zero - automatic
+   int scaffold_timeout; //default is zero - no timeout
 
    int cancellation_timeout; // default is 0 seconds - no timeout
    TimeoutCancellationHandler timeout_cancellation_handler;
@@ -16,21 +16,44 @@
 #include "base_cpp/cancellation_handler.h"
 #include "layout/reaction_layout.h"
 #include "layout/molecule_layout.h"
+#include "layout/molecule_layout_parallel.h"
+#include "layout/layout_pattern_store.h"
 #include "reaction/base_reaction.h"
 #include "indigo_molecule.h"
 #include "indigo_reaction.h"
+#include "indigo_array.h"
+
+static void _markLayoutBonds (BaseMolecule &mol)
+{
+   mol.clearBondDirections();
+   mol.stereocenters.markBonds();
+   mol.allene_stereo.markBonds();
+
+   for (int i = 1; i <= mol.rgroups.getRGroupCount(); i++)
+   {
+      RGroup &rgp = mol.rgroups.getRGroup(i);
+
+      for (int j = rgp.fragments.begin(); j != rgp.fragments.end();
+               j = rgp.fragments.next(j))
+      {
+         rgp.fragments[j]->clearBondDirections();
+         rgp.fragments[j]->stereocenters.markBonds();
+         rgp.fragments[j]->allene_stereo.markBonds();
+      }
+   }
+}
 
 CEXPORT int indigoLayout (int object)
 {
    INDIGO_BEGIN
    {
       IndigoObject &obj = self.getObject(object);
-      int i;
 
       if (IndigoBaseMolecule::is(obj) || obj.type == IndigoObject::SUBMOLECULE) {
          BaseMolecule &mol = obj.getBaseMolecule();
          MoleculeLayout ml(mol);
          ml.max_iterations = self.layout_max_iterations;
+         ml.nthreads = self.layout_threads;
          ml.bond_length = 1.6f;
 
          TimeoutCancellationHandler cancellation(self.cancellation_timeout);
@@ -47,29 +70,10 @@ CEXPORT int indigoLayout (int object)
          }
 
          ml.make();
-         if (obj.type != IndigoObject::SUBMOLECULE)
-         {
-            // Not for submolecule yet
-            mol.clearBondDirections();
-            mol.stereocenters.markBonds();
-            mol.allene_stereo.markBonds();
-         }
 
+         // Not for submolecule yet
          if (obj.type != IndigoObject::SUBMOLECULE)
-         {
-            for (i = 1; i <= mol.rgroups.getRGroupCount(); i++)
-            {
-               RGroup &rgp = mol.rgroups.getRGroup(i);
-
-               for (int j = rgp.fragments.begin(); j != rgp.fragments.end();
-                        j = rgp.fragments.next(j))
-               {
-                  rgp.fragments[j]->clearBondDirections();
-                  rgp.fragments[j]->stereocenters.markBonds();
-                  rgp.fragments[j]->allene_stereo.markBonds();
-               }
-            }
-         }
+            _markLayoutBonds(mol);
       } else if (IndigoBaseReaction::is(obj)) {
          BaseReaction &rxn = obj.getBaseReaction();
          ReactionLayout rl(rxn);
@@ -83,4 +87,115 @@ CEXPORT int indigoLayout (int object)
       return 0;
    }
    INDIGO_END(-1)
+}
+
+CEXPORT int indigoLayoutIncremental (int molecule, int natoms, int *atoms, int nbonds, int *bonds)
+{
+   INDIGO_BEGIN
+   {
+      BaseMolecule &mol = self.getObject(molecule).getBaseMolecule();
+      QS_DEF(Array<int>, changed_atoms);
+      QS_DEF(Array<int>, changed_bonds);
+
+      changed_atoms.copy(atoms, natoms);
+      changed_bonds.copy(bonds, nbonds);
+
+      MoleculeLayout ml(mol);
+      ml.max_iterations = self.layout_max_iterations;
+      ml.nthreads = self.layout_threads;
+      ml.bond_length = 1.6f;
+
+      TimeoutCancellationHandler cancellation(self.cancellation_timeout);
+      ml.setCancellationHandler(&cancellation);
+
+      ml.makeIncremental(changed_atoms, changed_bonds);
+
+      _markLayoutBonds(mol);
+      return 0;
+   }
+   INDIGO_END(-1)
+}
+
+static void _setLayoutError (IndigoObject &obj, const char *message)
+{
+   RedBlackStringObjMap< Array<char> > *props = obj.getProperties();
+
+   if (props == 0)
+      return;
+
+   if (message == 0)
+   {
+      if (props->at2("layout-error") != 0)
+         props->remove("layout-error");
+   }
+   else if (props->at2("layout-error") != 0)
+      props->at("layout-error").readString(message, true);
+   else
+      props->value(props->insert("layout-error")).readString(message, true);
+}
+
+CEXPORT int indigoLayoutBatch (int molecules)
+{
+   INDIGO_BEGIN
+   {
+      IndigoArray &array = IndigoArray::cast(self.getObject(molecules));
+
+      // Molecules are loaded here, because Indigo objects
+      // can not be accessed from the worker threads. The items
+      // that can not be loaded are not passed to the batch.
+      QS_DEF(Array<BaseMolecule *>, mols);
+      QS_DEF(ObjArray< Array<char> >, load_errors);
+      mols.clear();
+      load_errors.clear();
+      for (int i = 0; i < array.objects.size(); i++)
+      {
+         Array<char> &load_error = load_errors.push();
+
+         try
+         {
+            mols.push(&array.objects[i]->getBaseMolecule());
+         }
+         catch (Exception &e)
+         {
+            load_error.readString(e.message(), true);
+         }
+      }
+
+      MoleculeLayoutBatch batch;
+      batch.max_iterations = self.layout_max_iterations;
+      batch.bond_length = 1.6f;
+      batch.cancellation_timeout = self.cancellation_timeout;
+
+      batch.make(mols, self.layout_threads);
+
+      int mol_idx = 0;
+      for (int i = 0; i < array.objects.size(); i++)
+      {
+         if (load_errors[i].size() > 0)
+            _setLayoutError(*array.objects[i], load_errors[i].ptr());
+         else
+         {
+            if (batch.errors[mol_idx].size() == 0)
+            {
+               _markLayoutBonds(*mols[mol_idx]);
+               _setLayoutError(*array.objects[i], 0);
+            }
+            else
+               _setLayoutError(*array.objects[i], batch.errors[mol_idx].ptr());
+            mol_idx++;
+         }
+      }
+
+      return mols.size() - batch.failedCount();
+   }
+   INDIGO_END(-1)
+}
+
+CEXPORT int indigoLoadLayoutTemplatesFromFile (const char *filename)
+{
+   INDIGO_BEGIN
+   {
+      return LayoutPatternStore::getInstance().loadLibrary(filename);
+   }
+   INDIGO_END(-1)
 }
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include "indigo_io.h"
 #include "indigo_molecule.h"
 #include "indigo_reaction.h"
+#include "indigo_product_enumerator.h"
 #include "molecule/sdf_loader.h"
 #include "molecule/rdf_loader.h"
 #include "molecule/molfile_loader.h"
@@ -551,6 +552,8 @@ CEXPORT int indigoTell (int handle)
          return ((IndigoCmlMolecule &)obj).tell();
       if (obj.type == IndigoObject::CML_REACTION)
          return ((IndigoCmlReaction &)obj).tell();
+      if (obj.type == IndigoObject::PRODUCT_ENUMERATOR_ITER)
+         return ((IndigoProductEnumeratorIter &)obj).tell();
 
       throw IndigoError("indigoTell(): not applicable to %s", obj.debugInfo());
    }
@@ -25,6 +25,7 @@
 #include "molecule/sdf_loader.h"
 #include "molecule/rdf_loader.h"
 #include "indigo_array.h"
+#include "indigo_product_enumerator.h"
 #include "molecule/icm_saver.h"
 #include "molecule/icm_loader.h"
 #include "reaction/icr_saver.h"
@@ -424,6 +425,13 @@ CEXPORT int indigoAt (int item, int index)
             return 0;
          return self.addObject(newobj);
       }
+      else if (obj.type == IndigoObject::PRODUCT_ENUMERATOR_ITER)
+      {
+         IndigoObject * newobj = ((IndigoProductEnumeratorIter &)obj).at(index);
+         if (newobj == 0)
+            return 0;
+         return self.addObject(newobj);
+      }
       else if (IndigoArray::is(obj))
       {
          IndigoArray &arr = IndigoArray::cast(obj);
@@ -55,6 +55,13 @@ static void indigoDecoIgnoreErrors (int enabled)
    Indigo &self = indigoGetInstance();
    self.deco_ignore_errors = (enabled != 0);
 }
+static void indigoDecoSetThreadsCount (int value)
+{
+   Indigo &self = indigoGetInstance();
+   if (value < 0)
+      throw IndigoError("%d is bad decomposition threads count", value);
+   self.deco_threads = value;
+}
 
 static void indigoSetMolfileSavingMode (const char *mode)
 {
@@ -163,12 +170,42 @@ static void indigoSetLayoutMaxIterations (int value)
    self.layout_max_iterations = value;
 }
 
+static void indigoSetLayoutThreadsCount (int value)
+{
+   Indigo &self = indigoGetInstance();
+   if (value < 0)
+      throw IndigoError("%d is bad layout threads count", value);
+   self.layout_threads = value;
+}
+
 static void indigoAAMSetCancellationTimeout (int value)
 {
    Indigo &self = indigoGetInstance();
    self.aam_cancellation_timeout = value;
 }
 
+static void indigoAAMSetThreadsCount (int value)
+{
+   Indigo &self = indigoGetInstance();
+   if (value < 0)
+      throw IndigoError("%d is bad automapping threads count", value);
+   self.aam_threads = value;
+}
+
+static void indigoSetScaffoldThreadsCount (int value)
+{
+   Indigo &self = indigoGetInstance();
+   if (value < 0)
+      throw IndigoError("%d is bad scaffold threads count", value);
+   self.scaffold_threads = value;
+}
+
+static void indigoSetScaffoldTimeout (int value)
+{
+   Indigo &self = indigoGetInstance();
+   self.scaffold_timeout = value;
+}
+
 static void indigoSetCancellationTimeout (int value)
 {
    Indigo &self = indigoGetInstance();
@@ -216,6 +253,7 @@ _IndigoBasicOptionsHandlersSetter::_IndigoBasicOptionsHandlersSetter ()
    mgr.setOptionHandlerBool("deconvolution-aromatization", indigoDeconvolutionAromatization);
    mgr.setOptionHandlerBool("deco-save-ap-bond-orders", indigoDecoSaveAPBondOrders);
    mgr.setOptionHandlerBool("deco-ignore-errors", indigoDecoIgnoreErrors);
+   mgr.setOptionHandlerInt("deco-threads", indigoDecoSetThreadsCount);
    mgr.setOptionHandlerString("molfile-saving-mode", indigoSetMolfileSavingMode);
    mgr.setOptionHandlerBool("molfile-saving-no-chiral", indigoSetMolfileSavingNoChiral);
    mgr.setOptionHandlerBool("molfile-saving-skip-date", indigoSetMolfileSavingSkipDate);
@@ -231,8 +269,12 @@ _IndigoBasicOptionsHandlersSetter::_IndigoBasicOptionsHandlersSetter ()
    mgr.setOptionHandlerInt("max-embeddings", indigoSetMaxEmbeddings);
 
    mgr.setOptionHandlerInt("layout-max-iterations", indigoSetLayoutMaxIterations);
+   mgr.setOptionHandlerInt("layout-threads", indigoSetLayoutThreadsCount);
 
    mgr.setOptionHandlerInt("aam-timeout", indigoAAMSetCancellationTimeout);
+   mgr.setOptionHandlerInt("aam-threads", indigoAAMSetThreadsCount);
+   mgr.setOptionHandlerInt("scaffold-threads", indigoSetScaffoldThreadsCount);
+   mgr.setOptionHandlerInt("scaffold-timeout", indigoSetScaffoldTimeout);
    mgr.setOptionHandlerInt("timeout", indigoSetCancellationTimeout);
 
    mgr.setOptionHandlerBool("serialize-preserve-ordering", indigoSetPreserveOrderingInSerialize);
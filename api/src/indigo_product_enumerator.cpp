@@ -12,7 +12,10 @@
  * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
  ***************************************************************************/
 
+#include <limits.h>
+
 #include "indigo_internal.h"
+#include "indigo_product_enumerator.h"
 #include "indigo_reaction.h"
 #include "indigo_array.h"
 #include "base_cpp/scanner.h"
@@ -37,12 +40,9 @@ struct ProductEnumeratorCallbackData
    ObjArray<Reaction> *out_reactions;
 };
 
-static void product_proc( Molecule &product, Array<int> &monomers_indices, void *userdata )
+static void _buildProductReaction( ReactionProductEnumerator &rpe, Molecule &product,
+                                   Array<int> &monomers_indices, Reaction &reaction )
 {
-   ProductEnumeratorCallbackData *rpe_data = (ProductEnumeratorCallbackData *)userdata;
-
-   Reaction &reaction = rpe_data->out_reactions->push();
-
    QS_DEF(Molecule, new_product);
    new_product.clear();
    new_product.clone(product, NULL, NULL);   
@@ -50,52 +50,81 @@ static void product_proc( Molecule &product, Array<int> &monomers_indices, void
    reaction.clear();
 
    for (int i = 0; i < monomers_indices.size(); i++)
-      reaction.addReactantCopy(rpe_data->rpe->getMonomer(monomers_indices[i]), NULL, NULL);
+      reaction.addReactantCopy(rpe.getMonomer(monomers_indices[i]), NULL, NULL);
 
    reaction.addProductCopy(new_product, NULL, NULL);
 
    reaction.name.copy(product.name);
 }
 
+static void _layoutProductReaction( Reaction &reaction )
+{
+   ReactionLayout layout(reaction);
+   layout.make();
+   reaction.markStereocenterBonds();
+}
+
+static void product_proc( Molecule &product, Array<int> &monomers_indices, void *userdata )
+{
+   ProductEnumeratorCallbackData *rpe_data = (ProductEnumeratorCallbackData *)userdata;
+
+   Reaction &reaction = rpe_data->out_reactions->push();
+
+   _buildProductReaction(*rpe_data->rpe, product, monomers_indices, reaction);
+}
+
+// Adds the monomers to the enumerator and returns true if any of them has coordinates
+static bool _setupEnumerator( ReactionProductEnumerator &rpe, QueryReaction &query_rxn,
+                              IndigoArray &monomers_object )
+{
+   Indigo &self = indigoGetInstance();
+   bool has_coord = false;
+
+   rpe.arom_options = self.arom_options;
+
+   if (monomers_object.objects.size() < query_rxn.reactantsCount())
+      throw IndigoError("Too small monomers array");
+
+   int user_reactant_idx = 0;
+   for (int i = query_rxn.reactantBegin();
+            i != query_rxn.reactantEnd();
+            i = query_rxn.reactantNext(i))
+   {
+      IndigoArray &reactant_monomers_object = IndigoArray::cast(*monomers_object.objects[i]);
+      
+      for (int j = 0; j < reactant_monomers_object.objects.size(); j++)
+      {
+         Molecule &monomer = reactant_monomers_object.objects[j]->getMolecule();
+         if (monomer.have_xyz)
+            has_coord = true;
+         rpe.addMonomer(i, monomer);
+      }
+      user_reactant_idx++;
+   }
+
+   rpe.is_multistep_reaction = self.rpe_params.is_multistep_reactions;
+   rpe.is_one_tube = self.rpe_params.is_one_tube;
+   rpe.is_self_react = self.rpe_params.is_self_react;
+   rpe.max_deep_level = self.rpe_params.max_deep_level;
+   rpe.max_product_count = self.rpe_params.max_product_count;
+   rpe.is_same_keeping = !self.rpe_params.is_unique_products;
+   rpe.nthreads = self.rpe_params.nthreads;
+
+   return has_coord;
+}
+
 CEXPORT int indigoReactionProductEnumerate (int reaction, int monomers)
 {
    INDIGO_BEGIN
    {
-      bool has_coord = false;
-
       QueryReaction &query_rxn = self.getObject(reaction).getQueryReaction();
       IndigoArray &monomers_object = IndigoArray::cast(self.getObject(monomers));
 
       ReactionProductEnumerator rpe(query_rxn);
-      rpe.arom_options = self.arom_options;
 
       ObjArray<Reaction> out_reactions;
 
-      if (monomers_object.objects.size() < query_rxn.reactantsCount())
-         throw IndigoError("Too small monomers array");
-
-      int user_reactant_idx = 0;
-      for (int i = query_rxn.reactantBegin();
-               i != query_rxn.reactantEnd();
-               i = query_rxn.reactantNext(i))
-      {
-         IndigoArray &reactant_monomers_object = IndigoArray::cast(*monomers_object.objects[i]);
-         
-         for (int j = 0; j < reactant_monomers_object.objects.size(); j++)
-         {
-            Molecule &monomer = reactant_monomers_object.objects[j]->getMolecule();
-            if (monomer.have_xyz)
-               has_coord = true;
-            rpe.addMonomer(i, monomer);
-         }
-         user_reactant_idx++;
-      }
-
-      rpe.is_multistep_reaction = self.rpe_params.is_multistep_reactions;
-      rpe.is_one_tube = self.rpe_params.is_one_tube;
-      rpe.is_self_react = self.rpe_params.is_self_react;
-      rpe.max_deep_level = self.rpe_params.max_deep_level;
-      rpe.max_product_count = self.rpe_params.max_product_count;
+      bool has_coord = _setupEnumerator(rpe, query_rxn, monomers_object);
 
       rpe.product_proc = product_proc;
 
@@ -110,12 +139,8 @@ CEXPORT int indigoReactionProductEnumerate (int reaction, int monomers)
 
       for (int i = 0; i < out_reactions.size(); i++)
       {
-         if (has_coord)
-         {
-            ReactionLayout layout(out_reactions[i]);
-            layout.make();
-            out_reactions[i].markStereocenterBonds();
-         }
+         if (has_coord && self.rpe_params.is_products_layout)
+            _layoutProductReaction(out_reactions[i]);
 
          QS_DEF(IndigoReaction, indigo_rxn);
          indigo_rxn.rxn.clone(out_reactions[i], NULL, NULL, NULL);
@@ -128,17 +153,170 @@ CEXPORT int indigoReactionProductEnumerate (int reaction, int monomers)
    INDIGO_END(-1)
 }
 
+IndigoProductEnumeratorIter::IndigoProductEnumeratorIter (QueryReaction &reaction, IndigoArray &monomers) :
+IndigoObject(PRODUCT_ENUMERATOR_ITER)
+{
+   _reaction.clone(reaction, NULL, NULL, NULL);
+   _rpe.reset(new ReactionProductEnumerator(_reaction));
+
+   bool has_coord = _setupEnumerator(_rpe.ref(), _reaction, monomers);
+
+   ProductEnumeratorParams &params = indigoGetInstance().rpe_params;
+
+   _layout = has_coord && params.is_products_layout;
+
+   // Products are not accumulated by the iterator, so the default
+   // limit is applied only for indigoReactionProductEnumerate()
+   if (!params.is_max_product_count_set)
+      _rpe->max_product_count = INT_MAX;
+
+   // Products are built by the single producer thread that
+   // is suspended until the returned products are taken
+   _rpe->nthreads = 1;
+   _stream.reset(new ReactionProductEnumeratorStream(_rpe.ref(), MAX_BUFFERED_PRODUCTS));
+
+   _index = 0;
+   _stream->start();
+}
+
+IndigoProductEnumeratorIter::~IndigoProductEnumeratorIter ()
+{
+   // The producer thread uses the enumerator
+   _stream.free();
+}
+
+const char * IndigoProductEnumeratorIter::debugInfo ()
+{
+   return "<product enumerator iterator>";
+}
+
+bool IndigoProductEnumeratorIter::_fetch ()
+{
+   if (_next_product.get() != 0)
+      return true;
+
+   AutoPtr<IndigoReaction> product(new IndigoReaction());
+
+   if (!_stream->next(product->rxn))
+      return false;
+
+   _next_product.reset(product.release());
+   return true;
+}
+
+IndigoObject * IndigoProductEnumeratorIter::next ()
+{
+   if (!_fetch())
+      return 0;
+
+   if (_layout)
+      _layoutProductReaction(_next_product->rxn);
+
+   _index++;
+   return _next_product.release();
+}
+
+bool IndigoProductEnumeratorIter::hasNext ()
+{
+   return _fetch();
+}
+
+IndigoObject * IndigoProductEnumeratorIter::at (int index)
+{
+   if (index < 0)
+      throw IndigoError("indigoAt(): invalid product index %d", index);
+
+   // Deduplication of the products depends on all the previous
+   // products, so the enumeration is started from the beginning
+   if (index < _index)
+   {
+      _next_product.free();
+      _index = 0;
+      _stream->start();
+   }
+
+   if (_index < index && _next_product.get() != 0)
+   {
+      _next_product.free();
+      _index++;
+   }
+
+   while (_index < index)
+   {
+      if (!_stream->skip())
+         return 0;
+      _index++;
+   }
+
+   return next();
+}
+
+int IndigoProductEnumeratorIter::tell ()
+{
+   return _index;
+}
+
+CEXPORT int indigoIterateReactionProductEnumeration (int reaction, int monomers)
+{
+   INDIGO_BEGIN
+   {
+      QueryReaction &query_rxn = self.getObject(reaction).getQueryReaction();
+      IndigoArray &monomers_object = IndigoArray::cast(self.getObject(monomers));
+
+      return self.addObject(new IndigoProductEnumeratorIter(query_rxn, monomers_object));
+   }
+   INDIGO_END(-1)
+}
+
+IndigoTransformer::IndigoTransformer (QueryReaction &reaction) :
+IndigoObject(TRANSFORMER)
+{
+   ReactionTransformation rt;
+
+   rt.arom_options = indigoGetInstance().arom_options;
+   rt.prepare(reaction, prepared);
+}
+
+IndigoTransformer::~IndigoTransformer ()
+{
+}
+
+const char * IndigoTransformer::debugInfo ()
+{
+   return "<transformer>";
+}
+
+CEXPORT int indigoCreateTransformer (int reaction)
+{
+   INDIGO_BEGIN
+   {
+      QueryReaction &query_rxn = self.getObject(reaction).getQueryReaction();
+
+      return self.addObject(new IndigoTransformer(query_rxn));
+   }
+   INDIGO_END(-1)
+}
+
 CEXPORT int indigoTransform (int reaction, int monomers)
 {
    INDIGO_BEGIN
    {
       IndigoObject &monomers_object = self.getObject(monomers);
-      QueryReaction &query_rxn = self.getObject(reaction).getQueryReaction();
+      IndigoObject &reaction_object = self.getObject(reaction);
 
       ReactionTransformation rt;
       rt.arom_options = self.arom_options;
       rt.layout_flag = self.rpe_params.is_layout;
 
+      // The reaction is prepared only once for all the monomers
+      QS_DEF(ReactionTransformation::PreparedReaction, prepared_rxn);
+      ReactionTransformation::PreparedReaction *prepared = &prepared_rxn;
+
+      if (reaction_object.type == IndigoObject::TRANSFORMER)
+         prepared = &((IndigoTransformer &)reaction_object).prepared;
+      else
+         rt.prepare(reaction_object.getQueryReaction(), prepared_rxn);
+
       // Try to work with molecule first
       bool is_mol = false;
       try 
@@ -156,14 +334,19 @@ CEXPORT int indigoTransform (int reaction, int monomers)
       if (is_mol)
       {
          Molecule &mol = monomers_object.getMolecule();
-         rt.transform(mol, query_rxn);
+         rt.transform(mol, *prepared);
       }
       else if (monomers_object.type == IndigoObject::ARRAY)
       {
          IndigoArray &monomers_array = IndigoArray::cast(self.getObject(monomers));
 
+         QS_DEF(Array<Molecule *>, molecules);
+         molecules.clear();
+
          for (int i = 0; i < monomers_array.objects.size(); i++)
-            rt.transform(monomers_array.objects[i]->getMolecule(), query_rxn);
+            molecules.push(&monomers_array.objects[i]->getMolecule());
+
+         rt.transform(molecules, *prepared, self.rpe_params.transform_nthreads);
       }
       else
          throw IndigoError("%s is not a molecule or array of molecules", self.getObject(monomers).debugInfo());
@@ -206,6 +389,35 @@ void indigoProductEnumeratorSetMaximumProductsCount (int max_pr_cnt)
 {
    Indigo &self = indigoGetInstance();
    self.rpe_params.max_product_count = max_pr_cnt;
+   self.rpe_params.is_max_product_count_set = true;
+}
+
+void indigoProductEnumeratorSetUniqueProductsFlag (int is_unique_products)
+{
+   Indigo &self = indigoGetInstance();
+   self.rpe_params.is_unique_products = (is_unique_products != 0);
+}
+
+void indigoProductEnumeratorSetThreadsCount (int nthreads)
+{
+   Indigo &self = indigoGetInstance();
+   if (nthreads < 0)
+      throw IndigoError("%d is bad reaction product enumerator threads count", nthreads);
+   self.rpe_params.nthreads = nthreads;
+}
+
+void indigoProductEnumeratorSetProductsLayoutFlag (int layout_flag)
+{
+   Indigo &self = indigoGetInstance();
+   self.rpe_params.is_products_layout = (layout_flag != 0);
+}
+
+void indigoProductEnumeratorSetTransformThreadsCount (int nthreads)
+{
+   Indigo &self = indigoGetInstance();
+   if (nthreads < 0)
+      throw IndigoError("%d is bad transformation threads count", nthreads);
+   self.rpe_params.transform_nthreads = nthreads;
 }
 
 void indigoProductEnumeratorSetLayoutFlag (int layout_flag)
@@ -232,7 +444,11 @@ _IndigoRPEOptionsHandlersSetter::_IndigoRPEOptionsHandlersSetter ()
    mgr.setOptionHandlerBool("rpe-self-reaction", indigoProductEnumeratorSetSelfReactionFlag);
    mgr.setOptionHandlerInt("rpe-max-depth", indigoProductEnumeratorSetMaximumSearchDepth);
    mgr.setOptionHandlerInt("rpe-max-products-count", indigoProductEnumeratorSetMaximumProductsCount);
+   mgr.setOptionHandlerBool("rpe-unique-products", indigoProductEnumeratorSetUniqueProductsFlag);
+   mgr.setOptionHandlerInt("rpe-threads", indigoProductEnumeratorSetThreadsCount);
+   mgr.setOptionHandlerBool("rpe-layout", indigoProductEnumeratorSetProductsLayoutFlag);
    mgr.setOptionHandlerBool("transform-layout", indigoProductEnumeratorSetLayoutFlag);
+   mgr.setOptionHandlerInt("transform-threads", indigoProductEnumeratorSetTransformThreadsCount);
 }
 
 _IndigoRPEOptionsHandlersSetter _indigo_rpe_options_handlers_setter;
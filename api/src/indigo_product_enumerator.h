@@ -0,0 +1,89 @@
+/****************************************************************************
+ * Copyright (C) 2010-2011 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __indigo_product_enumerator__
+#define __indigo_product_enumerator__
+
+#include "indigo_internal.h"
+#include "indigo_reaction.h"
+#include "base_cpp/auto_ptr.h"
+#include "base_cpp/obj_array.h"
+#include "molecule/molecule.h"
+#include "reaction/query_reaction.h"
+#include "reaction/reaction_product_enumerator.h"
+#include "reaction/reaction_product_enumerator_stream.h"
+#include "reaction/reaction_transformation.h"
+
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+class IndigoArray;
+
+// Iterator over the enumerated reaction products. Products are built
+// by the producer thread that waits while MAX_BUFFERED_PRODUCTS products
+// are not taken, so only these products are kept in memory, and the
+// SMILES of the products if the "rpe-unique-products" option is enabled.
+// The number of products returned so far is a cursor for indigoAt(),
+// that restarts the enumeration if the index is behind the cursor.
+class IndigoProductEnumeratorIter : public IndigoObject
+{
+public:
+   IndigoProductEnumeratorIter (QueryReaction &reaction, IndigoArray &monomers);
+   virtual ~IndigoProductEnumeratorIter ();
+
+   virtual IndigoObject * next ();
+   virtual bool hasNext ();
+
+   virtual const char * debugInfo ();
+
+   IndigoObject * at (int index);
+
+   int tell ();
+
+   enum { MAX_BUFFERED_PRODUCTS = 100 };
+
+protected:
+   QueryReaction _reaction;
+   AutoPtr<ReactionProductEnumerator> _rpe;
+   AutoPtr<ReactionProductEnumeratorStream> _stream;
+
+   // Product taken by hasNext() and not returned yet
+   AutoPtr<IndigoReaction> _next_product;
+
+   int _index;
+   bool _layout;
+
+   bool _fetch ();
+};
+
+// Reaction prepared by indigoCreateTransformer() for applying
+// to many molecules with indigoTransform()
+class IndigoTransformer : public IndigoObject
+{
+public:
+   IndigoTransformer (QueryReaction &reaction);
+   virtual ~IndigoTransformer ();
+
+   virtual const char * debugInfo ();
+
+   ReactionTransformation::PreparedReaction prepared;
+};
+
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+
+#endif
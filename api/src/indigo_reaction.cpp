@@ -20,6 +20,7 @@
 #include "reaction/rxnfile_saver.h"
 #include "base_cpp/output.h"
 #include "reaction/reaction_automapper.h"
+#include "reaction/reaction_automapper_parallel.h"
 #include "base_cpp/auto_ptr.h"
 #include "indigo_array.h"
 #include "reaction/rsmiles_loader.h"
@@ -563,13 +564,10 @@ CEXPORT int indigoAutomap (int reaction, const char *mode)
          return 0;
       }
       /*
-       * Set timeout
+       * Set time limit, the best mapping found within it is kept
        */
-      AutoPtr<TimeoutCancellationHandler> timeout;
-      if(self.aam_cancellation_timeout > 0) {
-         timeout.create(self.aam_cancellation_timeout);
-         ram.cancellation = timeout.get();
-      }
+      ram.time_limit = self.aam_cancellation_timeout;
+      ram.nthreads = self.aam_threads;
       /*
        * Launch automap
        */
@@ -580,6 +578,80 @@ CEXPORT int indigoAutomap (int reaction, const char *mode)
    INDIGO_END(-1);
 }
 
+static void _setReactionProperty (IndigoObject &obj, const char *name, const char *value)
+{
+   RedBlackStringObjMap< Array<char> > *props = obj.getProperties();
+
+   if (props == 0)
+      return;
+
+   if (value == 0)
+   {
+      if (props->at2(name) != 0)
+         props->remove(name);
+   }
+   else if (props->at2(name) != 0)
+      props->at(name).readString(value, true);
+   else
+      props->value(props->insert(name)).readString(value, true);
+}
+
+CEXPORT int indigoAutomapBatch (int reactions, const char *mode)
+{
+   INDIGO_BEGIN
+   {
+      IndigoArray &array = IndigoArray::cast(self.getObject(reactions));
+
+      // Reactions are loaded here, because Indigo objects
+      // can not be accessed from the worker threads
+      QS_DEF(Array<BaseReaction *>, rxns);
+      QS_DEF(ObjArray< Array<char> >, load_errors);
+      rxns.clear();
+      load_errors.clear();
+      for (int i = 0; i < array.objects.size(); i++)
+      {
+         Array<char> &load_error = load_errors.push();
+
+         try
+         {
+            rxns.push(&array.objects[i]->getBaseReaction());
+         }
+         catch (IndigoError &e)
+         {
+            // Reported as the error of this item only
+            rxns.push(0);
+            load_error.readString(e.message(), true);
+         }
+      }
+
+      Reaction empty;
+      ReactionAutomapper settings(empty);
+      settings.arom_options = self.arom_options;
+      settings.time_limit = self.aam_cancellation_timeout;
+
+      int nmode = readAAMOptions(mode, settings);
+
+      ReactionAutomapperBatch batch(settings);
+      batch.automap(rxns, nmode, self.aam_threads);
+
+      for (int i = 0; i < array.objects.size(); i++)
+      {
+         IndigoObject &obj = *array.objects[i];
+         char time_str[32];
+
+         snprintf(time_str, NELEM(time_str), "%d", batch.times[i]);
+         _setReactionProperty(obj, "aam-time", time_str);
+         if (load_errors[i].size() > 0)
+            _setReactionProperty(obj, "aam-error", load_errors[i].ptr());
+         else
+            _setReactionProperty(obj, "aam-error", batch.errors[i].size() > 0 ? batch.errors[i].ptr() : 0);
+      }
+
+      return array.objects.size() - batch.failedCount();
+   }
+   INDIGO_END(-1);
+}
+
 CEXPORT int indigoGetAtomMappingNumber (int reaction, int reaction_atom)
 {
    INDIGO_BEGIN
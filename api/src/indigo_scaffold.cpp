@@ -76,6 +76,8 @@ CEXPORT int indigoExtractCommonScaffold (int structures, const char* options)
       }
       if(max_iterations > 0)
          msd.maxIterations = max_iterations;
+      msd.nthreads = self.scaffold_threads;
+      msd.timeLimit = self.scaffold_timeout;
 
       if (approximate)
          msd.extractApproximateScaffold(scaf->max_scaffold);
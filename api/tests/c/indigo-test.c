@@ -24,6 +24,578 @@ void testTransform ()
    indigoFree(transformation);
 }
 
+// Permutations of the reactants are searched in the worker threads with
+// "aam-threads". The mapping should be the same as in serial mode.
+void testAutomapThreads ()
+{
+   const char *reactions[] = {
+      "CC(=O)O.OCC>>CC(=O)OCC",
+      "C1=CC=CC=C1.ClCl.[Fe]>>ClC1=CC=CC=C1.Cl",
+      "CC(C)(C)OC(=O)N1CCC(CC1)C(O)=O.NCc1ccccc1.CN(C)C=O>>CC(C)(C)OC(=O)N1CCC(CC1)C(=O)NCc1ccccc1",
+      "CC(C)Cc1ccc(cc1)C(C)C(O)=O>>CCCCc1ccc(cc1)C(C)C(O)=O"
+   };
+   int i;
+
+   for (i = 0; i < (int)(sizeof(reactions) / sizeof(reactions[0])); i++)
+   {
+      int serial = indigoLoadReactionFromString(reactions[i]);
+      int parallel = indigoLoadReactionFromString(reactions[i]);
+      char *expected;
+
+      indigoSetOptionInt("aam-threads", 1);
+      indigoAutomap(serial, "discard");
+      expected = strdup(indigoSmiles(serial));
+
+      indigoSetOptionInt("aam-threads", 2);
+      indigoAutomap(parallel, "discard");
+      if (strcmp(expected, indigoSmiles(parallel)) != 0)
+      {
+         printf("Automapping in threads differs: %s != %s\n", indigoSmiles(parallel), expected);
+         exit(-1);
+      }
+
+      free(expected);
+      indigoFree(parallel);
+      indigoFree(serial);
+   }
+   indigoSetOptionInt("aam-threads", 1);
+}
+
+// Exact scaffold search in threads gives the same scaffolds as the serial one
+void testScaffoldThreads ()
+{
+   const char *molecules[] = {
+      "CC(C)Cc1ccc(cc1)C(C)C(O)=O",
+      "COc1ccc2cc(ccc2c1)C(C)C(O)=O",
+      "OC(=O)Cc1ccccc1Nc1c(Cl)cccc1Cl",
+      "CC(=O)Oc1ccccc1C(O)=O"
+   };
+   char *expected = 0;
+   int threads;
+
+   for (threads = 1; threads <= 2; threads++)
+   {
+      int array = indigoCreateArray();
+      int scaffold, all, count;
+      int i;
+
+      for (i = 0; i < (int)(sizeof(molecules) / sizeof(molecules[0])); i++)
+         indigoArrayAdd(array, indigoLoadMoleculeFromString(molecules[i]));
+
+      indigoSetOptionInt("scaffold-threads", threads);
+      scaffold = indigoExtractCommonScaffold(array, "exact");
+      all = indigoAllScaffolds(scaffold);
+      count = indigoCount(all);
+
+      if (expected == 0)
+         expected = strdup(indigoSmiles(scaffold));
+      else if (strcmp(expected, indigoSmiles(scaffold)) != 0)
+      {
+         printf("Scaffold search in threads differs: %s != %s\n", indigoSmiles(scaffold), expected);
+         exit(-1);
+      }
+      if (count < 1)
+      {
+         printf("No scaffolds are found\n");
+         exit(-1);
+      }
+
+      indigoFree(all);
+      indigoFree(scaffold);
+      indigoFree(array);
+   }
+   free(expected);
+   indigoSetOptionInt("scaffold-threads", 1);
+}
+
+static void setReactingCenters (int reaction, int molecules, int rc, int rc_hetero)
+{
+   int mol, bonds, bond;
+
+   while ((mol = indigoNext(molecules)))
+   {
+      bonds = indigoIterateBonds(mol);
+      while ((bond = indigoNext(bonds)))
+      {
+         const char *end = indigoSymbol(indigoDestination(bond));
+         int hetero = strcmp(end, "O") == 0 || strcmp(end, "H") == 0;
+
+         indigoSetReactingCenter(reaction, bond, hetero ? rc_hetero : rc);
+         indigoFree(bond);
+      }
+      indigoFree(bonds);
+      indigoFree(mol);
+   }
+   indigoFree(molecules);
+}
+
+// Reacting center of a query hydrogen that can be implicit in the target
+// must not screen out the matching reaction
+void testReactingCentersScreening ()
+{
+   int query = indigoLoadQueryReactionFromString("[C:1][H]>>[C:1]O");
+   int target = indigoLoadReactionFromString("[CH3:1][CH3:2]>>[CH3:1][CH2:2]O");
+   int query_fp, target_fp, matcher, match;
+
+   setReactingCenters(query, indigoIterateReactants(query), INDIGO_RC_UNMARKED, INDIGO_RC_MADE_OR_BROKEN);
+   setReactingCenters(target, indigoIterateReactants(target), INDIGO_RC_UNCHANGED, INDIGO_RC_UNCHANGED);
+   setReactingCenters(target, indigoIterateProducts(target), INDIGO_RC_UNCHANGED, INDIGO_RC_MADE_OR_BROKEN);
+
+   matcher = indigoSubstructureMatcher(target, "");
+   match = indigoMatch(matcher, query);
+   if (match == 0)
+   {
+      printf("Reaction query does not match\n");
+      exit(-1);
+   }
+
+   query_fp = indigoFingerprint(query, "sub");
+   target_fp = indigoFingerprint(target, "sub");
+   if (indigoCommonBits(query_fp, target_fp) != indigoCountBits(query_fp))
+   {
+      printf("Matching reaction is screened out\n");
+      exit(-1);
+   }
+
+   indigoFree(target_fp);
+   indigoFree(query_fp);
+   indigoFree(match);
+   indigoFree(matcher);
+   indigoFree(target);
+   indigoFree(query);
+}
+
+// A batch item that is not a reaction gets its own error
+void testAutomapBatch ()
+{
+   int array = indigoCreateArray();
+   int reaction = indigoLoadReactionFromString("CC(=O)O.OCC>>CC(=O)OCC");
+   int molecule = indigoLoadMoleculeFromString("CCO");
+   int mapped;
+
+   indigoArrayAdd(array, reaction);
+   indigoArrayAdd(array, molecule);
+   mapped = indigoAutomapBatch(array, "discard");
+   if (mapped != 1 || indigoHasProperty(indigoAt(array, 0), "aam-error") ||
+       !indigoHasProperty(indigoAt(array, 1), "aam-error"))
+   {
+      printf("Automap batch errors are invalid: %d mapped\n", mapped);
+      exit(-1);
+   }
+   indigoFree(molecule);
+   indigoFree(reaction);
+   indigoFree(array);
+}
+
+// Molecules are laid out in "layout-threads" worker threads, the items
+// that are not molecules get "layout-error"
+static int layoutBatch (int threads)
+{
+   const char *smiles[] = {
+      "CC(C)Cc1ccc(cc1)C(C)C(O)=O",
+      "C1CC2CCC1CC2",
+      "CC>>CO",
+      "OC(=O)Cc1ccccc1Nc1c(Cl)cccc1Cl",
+      "C1CCC2(CC1)CCCCC2"
+   };
+   int array = indigoCreateArray();
+   int i, obj, laid_out;
+
+   for (i = 0; i < (int)(sizeof(smiles) / sizeof(smiles[0])); i++)
+   {
+      if (i == 2)
+         obj = indigoLoadReactionFromString(smiles[i]);
+      else
+         obj = indigoLoadMoleculeFromString(smiles[i]);
+      indigoArrayAdd(array, obj);
+      indigoFree(obj);
+   }
+
+   indigoSetOptionInt("layout-threads", threads);
+   laid_out = indigoLayoutBatch(array);
+   indigoSetOptionInt("layout-threads", 1);
+
+   for (i = 0; i < indigoCount(array); i++)
+   {
+      if (indigoHasProperty(indigoAt(array, i), "layout-error") != (i == 2))
+      {
+         printf("Layout batch error is invalid for item %d\n", i);
+         exit(-1);
+      }
+   }
+   if (laid_out != 4)
+   {
+      printf("Layout batch laid out %d molecules instead of 4\n", laid_out);
+      exit(-1);
+   }
+   return array;
+}
+
+void testLayoutBatch ()
+{
+   int serial = layoutBatch(1);
+   int threaded = layoutBatch(4);
+   int i;
+
+   for (i = 0; i < indigoCount(serial); i++)
+   {
+      int atoms1, atoms2, atom1, atom2;
+
+      if (i == 2)
+         continue;
+      atoms1 = indigoIterateAtoms(indigoAt(serial, i));
+      atoms2 = indigoIterateAtoms(indigoAt(threaded, i));
+      while ((atom1 = indigoNext(atoms1)) && (atom2 = indigoNext(atoms2)))
+      {
+         float xyz1[3];
+         float *xyz2;
+
+         // indigoXYZ returns the same buffer for every atom
+         memcpy(xyz1, indigoXYZ(atom1), sizeof(xyz1));
+         xyz2 = indigoXYZ(atom2);
+         if (xyz1[0] != xyz2[0] || xyz1[1] != xyz2[1])
+         {
+            printf("Layout in threads differs for item %d\n", i);
+            exit(-1);
+         }
+         indigoFree(atom1);
+         indigoFree(atom2);
+      }
+      indigoFree(atoms1);
+      indigoFree(atoms2);
+   }
+   indigoFree(threaded);
+   indigoFree(serial);
+}
+
+static int createAmines (int count, int duplicate)
+{
+   int amines = indigoCreateArray();
+   char smiles[256];
+   int i, mol;
+
+   for (i = 1; i <= count; i++)
+   {
+      memset(smiles, 'C', i);
+      strcpy(smiles + i, "N");
+      mol = indigoLoadMoleculeFromString(smiles);
+      indigoArrayAdd(amines, mol);
+      if (duplicate)
+         indigoArrayAdd(amines, mol);
+      indigoFree(mol);
+   }
+   return amines;
+}
+
+static int createAcids (int count)
+{
+   int acids = indigoCreateArray();
+   char smiles[256];
+   int i, mol;
+
+   for (i = 1; i <= count; i++)
+   {
+      memset(smiles, 'C', i);
+      strcpy(smiles + i, "(=O)O");
+      mol = indigoLoadMoleculeFromString(smiles);
+      indigoArrayAdd(acids, mol);
+      indigoFree(mol);
+   }
+   return acids;
+}
+
+static int countProducts (int iter)
+{
+   int count = 0, item;
+
+   while ((item = indigoNext(iter)) != 0)
+   {
+      count++;
+      indigoFree(item);
+   }
+   return count;
+}
+
+// The iterator builds the products in a producer thread that waits
+// while the buffered products are not taken. The products should be
+// the same as for the whole enumeration.
+void testProductEnumeratorIter ()
+{
+   int reaction = indigoLoadReactionSmartsFromString("[C:1](=O)[OH].[N:2]>>[C:1](=O)[N:2]");
+   int monomers = indigoCreateArray();
+   int acids = createAcids(12);
+   int amines = createAmines(110, 0);
+   int iter, products, item, i, count;
+
+   indigoArrayAdd(monomers, acids);
+   indigoArrayAdd(monomers, amines);
+
+   // The default products limit is not applied to the iterator
+   iter = indigoIterateReactionProductEnumeration(reaction, monomers);
+   count = countProducts(iter);
+   indigoFree(iter);
+   products = indigoReactionProductEnumerate(reaction, monomers);
+   if (count != 12 * 110 || indigoCount(products) != 1000)
+   {
+      printf("Products count is invalid: %d iterated, %d enumerated\n", count, indigoCount(products));
+      exit(-1);
+   }
+   indigoFree(products);
+
+   indigoSetOptionInt("rpe-max-products-count", 5000);
+   products = indigoReactionProductEnumerate(reaction, monomers);
+   iter = indigoIterateReactionProductEnumeration(reaction, monomers);
+   for (i = 0; i < indigoCount(products); i++)
+   {
+      int product = indigoAt(products, i);
+      char *expected = strdup(indigoSmiles(product));
+
+      indigoFree(product);
+      item = indigoNext(iter);
+      if (item == 0 || strcmp(expected, indigoSmiles(item)) != 0)
+      {
+         printf("Iterated product %d differs: %s\n", i, expected);
+         exit(-1);
+      }
+      free(expected);
+      indigoFree(item);
+   }
+   if (indigoNext(iter) != 0)
+   {
+      printf("Too many iterated products\n");
+      exit(-1);
+   }
+   indigoFree(iter);
+
+   // indigoAt() skips the products forward and restarts the enumeration
+   // backward, the iterator is freed while its producer thread waits
+   iter = indigoIterateReactionProductEnumeration(reaction, monomers);
+   for (i = 0; i < 4; i++)
+   {
+      int pos = (i == 2) ? 10 : 700 + i;
+      int product = indigoAt(products, pos);
+      char *expected = strdup(indigoSmiles(product));
+
+      indigoFree(product);
+      item = indigoAt(iter, pos);
+      if (item == 0 || strcmp(expected, indigoSmiles(item)) != 0)
+      {
+         printf("Product %d returned by indigoAt() differs: %s\n", pos, expected);
+         exit(-1);
+      }
+      free(expected);
+      indigoFree(item);
+   }
+   indigoFree(iter);
+   indigoFree(products);
+
+   // Duplicate products are removed unless "rpe-unique-products" is disabled
+   indigoFree(amines);
+   indigoFree(monomers);
+   amines = createAmines(110, 1);
+   monomers = indigoCreateArray();
+   indigoArrayAdd(monomers, acids);
+   indigoArrayAdd(monomers, amines);
+   iter = indigoIterateReactionProductEnumeration(reaction, monomers);
+   count = countProducts(iter);
+   indigoFree(iter);
+   indigoSetOptionBool("rpe-unique-products", 0);
+   iter = indigoIterateReactionProductEnumeration(reaction, monomers);
+   if (count != 12 * 110 || countProducts(iter) != 2 * 12 * 110)
+   {
+      printf("Duplicate products are processed incorrectly\n");
+      exit(-1);
+   }
+   indigoFree(iter);
+   indigoSetOptionBool("rpe-unique-products", 1);
+
+   indigoFree(amines);
+   indigoFree(acids);
+   indigoFree(monomers);
+   indigoFree(reaction);
+}
+
+// Compares the products of the serial and threaded enumeration
+static void checkThreadedProducts (int reaction, int monomers, const char *name)
+{
+   int serial, threaded, i;
+
+   indigoSetOptionInt("rpe-threads", 1);
+   serial = indigoReactionProductEnumerate(reaction, monomers);
+   indigoSetOptionInt("rpe-threads", 4);
+   threaded = indigoReactionProductEnumerate(reaction, monomers);
+   indigoSetOptionInt("rpe-threads", 1);
+
+   if (indigoCount(serial) != indigoCount(threaded))
+   {
+      printf("%s: %d serial products, %d threaded\n", name, indigoCount(serial), indigoCount(threaded));
+      exit(-1);
+   }
+   for (i = 0; i < indigoCount(serial); i++)
+   {
+      int serial_item = indigoAt(serial, i);
+      int threaded_item = indigoAt(threaded, i);
+      char *expected = strdup(indigoSmiles(serial_item));
+
+      if (strcmp(expected, indigoSmiles(threaded_item)) != 0)
+      {
+         printf("%s: threaded product %d differs: %s\n", name, i, expected);
+         exit(-1);
+      }
+      free(expected);
+      indigoFree(serial_item);
+      indigoFree(threaded_item);
+   }
+   indigoFree(serial);
+   indigoFree(threaded);
+}
+
+// Workers pass the products of a monomer by portions, so 110 amines give
+// several portions for each acid. The products and their order should be
+// the same as in the serial mode, including the stop by the products limit
+void testProductEnumeratorThreads ()
+{
+   int reaction = indigoLoadReactionSmartsFromString("[C:1](=O)[OH].[N:2]>>[C:1](=O)[N:2]");
+   int acids = createAcids(12);
+   int amines = createAmines(110, 1);
+   int monomers = indigoCreateArray();
+
+   indigoArrayAdd(monomers, acids);
+   indigoArrayAdd(monomers, amines);
+
+   indigoSetOptionInt("rpe-max-products-count", 1000);
+   checkThreadedProducts(reaction, monomers, "limited");
+   indigoSetOptionInt("rpe-max-products-count", 5000);
+   checkThreadedProducts(reaction, monomers, "unique");
+   indigoSetOptionBool("rpe-unique-products", 0);
+   checkThreadedProducts(reaction, monomers, "duplicates");
+   indigoSetOptionBool("rpe-unique-products", 1);
+
+   indigoFree(monomers);
+   indigoFree(amines);
+   indigoFree(acids);
+   indigoFree(reaction);
+}
+
+// Compares R-groups of the decomposed molecules: numbers and fragments
+static void checkDecomposedRGroups (int serial_mol, int threaded_mol, int idx)
+{
+   int serial_rgroups = indigoIterateRGroups(serial_mol);
+   int threaded_rgroups = indigoIterateRGroups(threaded_mol);
+   int serial_rgroup, threaded_rgroup;
+
+   while ((serial_rgroup = indigoNext(serial_rgroups)))
+   {
+      int serial_frags, threaded_frags, serial_frag, threaded_frag;
+
+      threaded_rgroup = indigoNext(threaded_rgroups);
+      if (threaded_rgroup == 0 || indigoIndex(serial_rgroup) != indigoIndex(threaded_rgroup))
+      {
+         printf("Molecule %d: R-group R%d is numbered differently in threads\n", idx, indigoIndex(serial_rgroup));
+         exit(-1);
+      }
+      serial_frags = indigoIterateRGroupFragments(serial_rgroup);
+      threaded_frags = indigoIterateRGroupFragments(threaded_rgroup);
+      while ((serial_frag = indigoNext(serial_frags)))
+      {
+         char *expected = strdup(indigoSmiles(serial_frag));
+
+         threaded_frag = indigoNext(threaded_frags);
+         if (threaded_frag == 0 || strcmp(expected, indigoSmiles(threaded_frag)) != 0)
+         {
+            printf("Molecule %d: R%d fragment differs in threads: %s\n", idx, indigoIndex(serial_rgroup), expected);
+            exit(-1);
+         }
+         free(expected);
+         indigoFree(serial_frag);
+         indigoFree(threaded_frag);
+      }
+      indigoFree(serial_frags);
+      indigoFree(threaded_frags);
+      indigoFree(serial_rgroup);
+      indigoFree(threaded_rgroup);
+   }
+   if (indigoNext(threaded_rgroups) != 0)
+   {
+      printf("Molecule %d: more R-groups in threads\n", idx);
+      exit(-1);
+   }
+   indigoFree(serial_rgroups);
+   indigoFree(threaded_rgroups);
+}
+
+// Molecules are matched in threads by portions of 8, the full scaffold
+// and the R-group numbers should be the same as in the serial mode
+void testDecompositionThreads ()
+{
+   const char *molecules[] = {
+      "Cc1ccccc1", "Oc1ccccc1", "Nc1ccccc1", "Clc1ccccc1",
+      "Cc1ccc(O)cc1", "Cc1cccc(N)c1", "Oc1ccccc1Cl", "CCc1ccccc1",
+      "Brc1ccc(Br)cc1", "Cc1ccc(C)c(C)c1", "OC(=O)c1ccccc1", "Cc1cc(O)cc(N)c1",
+      "Fc1ccccc1F", "COc1ccc(cc1)C(C)=O", "Cc1c(C)c(C)c(C)c(C)c1C", "Nc1ccc(cc1)S(O)(=O)=O"
+   };
+   int array = indigoCreateArray();
+   int scaffold = indigoLoadQueryMoleculeFromString("c1ccccc1");
+   int serial, threaded, serial_iter, threaded_iter, serial_item, threaded_item;
+   char *expected;
+   int i;
+
+   for (i = 0; i < (int)(sizeof(molecules) / sizeof(molecules[0])); i++)
+      indigoArrayAdd(array, indigoLoadMoleculeFromString(molecules[i]));
+
+   indigoSetOptionInt("deco-threads", 1);
+   serial = indigoDecomposeMolecules(scaffold, array);
+   indigoSetOptionInt("deco-threads", 4);
+   threaded = indigoDecomposeMolecules(scaffold, array);
+   indigoSetOptionInt("deco-threads", 1);
+
+   expected = strdup(indigoSmiles(indigoDecomposedMoleculeScaffold(serial)));
+   if (strcmp(expected, indigoSmiles(indigoDecomposedMoleculeScaffold(threaded))) != 0)
+   {
+      printf("Decomposition in threads gives another scaffold: %s != %s\n",
+         indigoSmiles(indigoDecomposedMoleculeScaffold(threaded)), expected);
+      exit(-1);
+   }
+   free(expected);
+
+   serial_iter = indigoIterateDecomposedMolecules(serial);
+   threaded_iter = indigoIterateDecomposedMolecules(threaded);
+   i = 0;
+   while ((serial_item = indigoNext(serial_iter)))
+   {
+      int serial_mol, threaded_mol;
+
+      threaded_item = indigoNext(threaded_iter);
+      if (threaded_item == 0)
+      {
+         printf("Decomposition in threads has fewer molecules\n");
+         exit(-1);
+      }
+      serial_mol = indigoDecomposedMoleculeWithRGroups(serial_item);
+      threaded_mol = indigoDecomposedMoleculeWithRGroups(threaded_item);
+      expected = strdup(indigoSmiles(serial_mol));
+      if (strcmp(expected, indigoSmiles(threaded_mol)) != 0)
+      {
+         printf("Molecule %d is decomposed differently in threads: %s != %s\n", i, indigoSmiles(threaded_mol), expected);
+         exit(-1);
+      }
+      free(expected);
+      checkDecomposedRGroups(serial_mol, threaded_mol, i);
+
+      indigoFree(serial_mol);
+      indigoFree(threaded_mol);
+      indigoFree(serial_item);
+      indigoFree(threaded_item);
+      i++;
+   }
+   indigoFree(serial_iter);
+   indigoFree(threaded_iter);
+   indigoFree(serial);
+   indigoFree(threaded);
+   indigoFree(scaffold);
+   indigoFree(array);
+}
+
 int main (void)
 {
    int m;
@@ -42,6 +614,14 @@ int main (void)
    }
    
    testTransform();
+   testAutomapThreads();
+   testAutomapBatch();
+   testLayoutBatch();
+   testScaffoldThreads();
+   testDecompositionThreads();
+   testReactingCentersScreening();
+   testProductEnumeratorIter();
+   testProductEnumeratorThreads();
    
    return 0;
 }
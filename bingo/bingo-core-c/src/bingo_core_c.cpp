@@ -16,6 +16,7 @@
 
 #include "base_cpp/profiling.h"
 #include "gzip/gzip_scanner.h"
+#include "core/bingo_query_cache.h"
 
 using namespace indigo::bingo_core;
 
@@ -140,6 +141,13 @@ CEXPORT int bingoSetConfigInt (const char *name, int value)
          self.bingo_context->nthreads = value;
       else if (strcasecmp(name, "timeout") == 0)
          self.bingo_context->timeout = value;
+      else if (strcasecmp(name, "query-cache-size") == 0 || strcasecmp(name, "query_cache_size") == 0)
+      {
+         // Megabytes of the search results cache of the process, zero disables it
+         if (value < 0 || value > 2047)
+            throw BingoError("query cache size should be from 0 to 2047 megabytes, got %d", value);
+         BingoQueryCache::getInstance().setMaxMemory(value * 1024 * 1024);
+      }
       else
       {
          bool set = true;
@@ -184,7 +192,7 @@ CEXPORT int bingoGetConfigInt (const char *name, int *value)
       else if (strcasecmp(name, "fp-size-bytes") == 0 || strcasecmp(name, "fp_size_bytes") == 0)
          *value = self.bingo_context->fp_parameters.fingerprintSize();
       else if (strcasecmp(name, "reaction-fp-size-bytes") == 0 || strcasecmp(name, "reaction_fp_size_bytes") == 0)
-         *value = self.bingo_context->fp_parameters.fingerprintSizeExtOrd() * 2;
+         *value = RingoIndex::getFingerprintSize(self.bingo_context->fp_parameters);
       else if (strcasecmp(name, "SUB_SCREENING_MAX_BITS") == 0)
          *value = self.sub_screening_max_bits;
       else if (strcasecmp(name, "SIM_SCREENING_PASS_MARK") == 0)
@@ -193,6 +201,8 @@ CEXPORT int bingoGetConfigInt (const char *name, int *value)
          *value = self.bingo_context->nthreads;
       else if (strcasecmp(name, "timeout") == 0)
          *value = self.bingo_context->timeout;
+      else if (strcasecmp(name, "query-cache-size") == 0 || strcasecmp(name, "query_cache_size") == 0)
+         *value = BingoQueryCache::getInstance().getMaxMemory() / (1024 * 1024);
       else
          throw BingoError("unknown parameter name: %s", name);
    }
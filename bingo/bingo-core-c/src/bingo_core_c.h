@@ -105,6 +105,11 @@ CEXPORT int mangoIndexReadPreparedMolecule (int *id,
                  const char **fingerprint_buf, int *fingerprint_buf_len,
                  const char **fingerprint_sim_str, 
                  float *mass, int *sim_fp_bits_count);
+/*
+ * Descriptors of the prepared molecule for the range filtering
+ * (see MangoDescriptorFilter for the descriptors order)
+ */
+CEXPORT int mangoIndexReadPreparedDescriptors (const float **descriptors, int *count);
 
 CEXPORT int mangoGetHash (bool for_index, int index, int *count, dword *hash);
 CEXPORT int mangoGetAtomCount (const char *target_buf, int target_buf_len);
@@ -163,8 +168,18 @@ CEXPORT int ringoIndexProcessSingleRecord ();
 CEXPORT int ringoIndexReadPreparedReaction (int *id, 
                  const char **crf_buf, int *crf_buf_len,
                  const char **fingerprint_buf, int *fingerprint_buf_len);
+/*
+ * Number of ones in the difference fingerprint of the prepared reaction
+ * (the last part of the fingerprint used for the similarity search)
+ */
+CEXPORT int ringoIndexReadPreparedSimBitsCount (int *sim_fp_bits_count);
 
 CEXPORT int ringoSetupMatch (const char *search_type, const char *query, const char *options);
+CEXPORT int ringoSimilarityGetBitMinMaxBoundsArray (int count, int* target_ones,
+                                                    int **min_bound_ptr, int **max_bound_ptr);
+
+CEXPORT int ringoSimilarityGetScore (float *score);
+CEXPORT int ringoSimilaritySetMinMaxBounds (float min_bound, float max_bound);
 // Return value:
 //   1 if the query is a substructure of the taret
 //   0 if it is not
@@ -97,6 +97,19 @@ CEXPORT int mangoIndexReadPreparedMolecule (int *id,
    BINGO_END(-2, -2)
 }
 
+CEXPORT int mangoIndexReadPreparedDescriptors (const float **descriptors, int *count)
+{
+   BINGO_BEGIN
+   {
+      const Array<float> &values = self.mango_index->getDescriptors();
+
+      *descriptors = values.ptr();
+      *count = values.size();
+      return 1;
+   }
+   BINGO_END(-2, -2)
+}
+
 CEXPORT int mangoGetHash (bool for_index, int index, int *count, dword *hash)
 {
    BINGO_BEGIN
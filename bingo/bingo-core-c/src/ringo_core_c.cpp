@@ -77,13 +77,23 @@ CEXPORT int ringoIndexReadPreparedReaction (int *id,
       *crf_buf_len = crf.size();
 
       *fingerprint_buf = (const char *)self.ringo_index->getFingerprint();
-      *fingerprint_buf_len = self.bingo_context->fp_parameters.fingerprintSizeExtOrd() * 2;
+      *fingerprint_buf_len = RingoIndex::getFingerprintSize(self.bingo_context->fp_parameters);
 
       return 1;
    }
    BINGO_END(-2, -2)
 }
 
+CEXPORT int ringoIndexReadPreparedSimBitsCount (int *sim_fp_bits_count)
+{
+   BINGO_BEGIN
+   {
+      *sim_fp_bits_count = self.ringo_index->getFpSimilarityBitsCount();
+      return 1;
+   }
+   BINGO_END(-2, -2)
+}
+
 void _ringoCheckPseudoAndCBDM (BingoCore &self)
 {
    if (self.bingo_context == 0)
@@ -131,6 +141,14 @@ CEXPORT int ringoSetupMatch (const char *search_type, const char *query, const c
             self.ringo_search_type = BingoCore::_EXACT;
             return 1;
          }
+         else if (strcasecmp(search_type, "RSIM") == 0)
+         {
+            RingoSimilarity &similarity = self.ringo_context->similarity;
+            similarity.loadQuery(query);
+            similarity.setMetrics(options);
+            self.ringo_search_type = BingoCore::_SIMILARITY;
+            return 1;
+         }
          else
          {
             self.ringo_search_type = BingoCore::_UNDEF;
@@ -142,6 +160,58 @@ CEXPORT int ringoSetupMatch (const char *search_type, const char *query, const c
    BINGO_END(-2, -2)
 }
 
+CEXPORT int ringoSimilarityGetBitMinMaxBoundsArray (int count, int* target_ones, 
+                                                    int **min_bound_ptr, int **max_bound_ptr)
+{
+   BINGO_BEGIN
+   {
+      if (self.ringo_search_type != BingoCore::_SIMILARITY)
+         throw BingoError("Undefined search type");
+      RingoSimilarity &similarity = self.ringo_context->similarity;
+
+      self.buffer.resize(sizeof(int) * 2 * count);
+
+      int *min_bounds = (int *)self.buffer.ptr();
+      int *max_bounds = min_bounds + count;
+      for (int i = 0; i < count; i++)
+      {
+         max_bounds[i] = similarity.getUpperBound(target_ones[i]);
+         min_bounds[i] = similarity.getLowerBound(target_ones[i]);
+      }
+
+      *min_bound_ptr = min_bounds;
+      *max_bound_ptr = max_bounds;
+   }
+   BINGO_END(1, -2)
+}
+
+CEXPORT int ringoSimilarityGetScore (float *score)
+{
+   BINGO_BEGIN
+   {
+      if (self.ringo_search_type != BingoCore::_SIMILARITY)
+         throw BingoError("Undefined search type");
+      RingoSimilarity &similarity = self.ringo_context->similarity;
+      *score = similarity.getSimilarityScore();
+   }
+   BINGO_END(-2, 1)
+}
+
+CEXPORT int ringoSimilaritySetMinMaxBounds (float min_bound, float max_bound)
+{
+   BINGO_BEGIN
+   {
+      if (self.ringo_search_type != BingoCore::_SIMILARITY)
+         throw BingoError("Undefined search type");
+      RingoSimilarity &similarity = self.ringo_context->similarity;
+      similarity.bottom = min_bound;
+      similarity.top = max_bound;
+      similarity.include_bottom = true;
+      similarity.include_top = true;
+   }
+   BINGO_END(1, -2)
+}
+
 // Return value:
 //   1 if the query is a substructure of the taret
 //   0 if it is not
@@ -171,6 +241,13 @@ CEXPORT int ringoMatchTarget (const char *target, int target_buf_len)
             exact.loadTarget(scanner);
             return exact.matchLoadedTarget() ? 1 : 0;
          }
+         else if (self.ringo_search_type == BingoCore::_SIMILARITY)
+         {
+            RingoSimilarity &similarity = self.ringo_context->similarity;
+            similarity.calc(scanner);
+            // Score should be obtained by calling ringoSimilarityGetScore
+            return 1;
+         }
          else
             throw BingoError("Invalid search type");
       }
@@ -207,6 +284,11 @@ CEXPORT int ringoMatchTargetBinary (const char *target_bin, int target_bin_len)
             RingoExact &exact = self.ringo_context->exact;
             return exact.matchBinary(scanner) ? 1 : 0;
          }
+         else if (self.ringo_search_type == BingoCore::_SIMILARITY)
+         {
+            RingoSimilarity &similarity = self.ringo_context->similarity;
+            return similarity.matchBinary(scanner) ? 1 : 0;
+         }
          else
             throw BingoError("Invalid search type");
       }
@@ -372,7 +454,14 @@ CEXPORT int ringoGetQueryFingerprint (const char **query_fp, int *query_fp_len)
          RingoSubstructure &substructure = self.ringo_context->substructure;
 
          self.buffer.copy((const char*)substructure.getQueryFingerprint(), 
-            self.bingo_context->fp_parameters.fingerprintSizeExtOrd() * 2);
+            RingoIndex::getFingerprintSize(self.bingo_context->fp_parameters));
+      }
+      else if (self.ringo_search_type == BingoCore::_SIMILARITY)
+      {
+         RingoSimilarity &similarity = self.ringo_context->similarity;
+
+         self.buffer.copy((const char*)similarity.getQueryFingerprint(), 
+            RingoIndex::getFingerprintSize(self.bingo_context->fp_parameters));
       }
       else
          throw BingoError("Invalid search type");
@@ -0,0 +1,320 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include "core/bingo_query_cache.h"
+
+#include <string.h>
+
+#include "base_c/bitarray.h"
+#include "base_cpp/output.h"
+#include "base_cpp/profiling.h"
+#include "base_cpp/tlscont.h"
+
+IMPL_ERROR(BingoQueryCache, "query cache");
+
+// Hits of a section are packed either as the differences
+// between the successive indices or as a plain bitset,
+// whichever is shorter
+enum
+{
+   _PACKED_DELTAS = 0,
+   _PACKED_BITSET = 1
+};
+
+static int _packedSize (dword value)
+{
+   int size = 1;
+
+   while (value >= 0x80)
+   {
+      value >>= 7;
+      size++;
+   }
+   return size;
+}
+
+//
+// BingoQueryCache::Result
+//
+
+BingoQueryCache::Result::Result ()
+{
+}
+
+void BingoQueryCache::Result::clear ()
+{
+   _sections.clear();
+   _offsets.clear();
+   _data.clear();
+}
+
+void BingoQueryCache::Result::copy (const Result &other)
+{
+   _sections.copy(other._sections);
+   _offsets.copy(other._offsets);
+   _data.copy(other._data);
+}
+
+void BingoQueryCache::Result::_writePacked (dword value)
+{
+   while (value >= 0x80)
+   {
+      _data.push((byte)((value & 0x7F) | 0x80));
+      value >>= 7;
+   }
+   _data.push((byte)value);
+}
+
+dword BingoQueryCache::Result::_readPacked (const byte *&ptr)
+{
+   dword value = 0;
+   int shift = 0;
+
+   while (*ptr & 0x80)
+   {
+      value |= (dword)(*ptr & 0x7F) << shift;
+      shift += 7;
+      ptr++;
+   }
+   value |= (dword)(*ptr) << shift;
+   ptr++;
+   return value;
+}
+
+void BingoQueryCache::Result::addSection (int section_idx, const Array<int> &hits)
+{
+   int i;
+
+   if (_sections.size() > 0 && _sections.top() >= section_idx)
+      throw Error("sections should be added in ascending order");
+
+   _sections.push(section_idx);
+   _offsets.push(_data.size());
+
+   int deltas_size = _packedSize(hits.size());
+   int prev = -1;
+
+   for (i = 0; i < hits.size(); i++)
+   {
+      if (hits[i] <= prev)
+         throw Error("hits should be in ascending order");
+      deltas_size += _packedSize(hits[i] - prev - 1);
+      prev = hits[i];
+   }
+
+   int bitset_bytes = (prev + 8) / 8;
+
+   if (bitset_bytes + _packedSize(bitset_bytes) < deltas_size)
+   {
+      _data.push(_PACKED_BITSET);
+      _writePacked(bitset_bytes);
+
+      int begin = _data.size();
+
+      _data.resize(begin + bitset_bytes);
+      memset(_data.ptr() + begin, 0, bitset_bytes);
+      for (i = 0; i < hits.size(); i++)
+         bitSetBit(_data.ptr() + begin, hits[i], 1);
+   }
+   else
+   {
+      _data.push(_PACKED_DELTAS);
+      _writePacked(hits.size());
+
+      prev = -1;
+      for (i = 0; i < hits.size(); i++)
+      {
+         _writePacked(hits[i] - prev - 1);
+         prev = hits[i];
+      }
+   }
+}
+
+int BingoQueryCache::Result::sectionsCount () const
+{
+   return _sections.size();
+}
+
+int BingoQueryCache::Result::getSectionIdx (int idx) const
+{
+   return _sections[idx];
+}
+
+void BingoQueryCache::Result::getSectionHits (int idx, Array<int> &hits) const
+{
+   const byte *ptr = _data.ptr() + _offsets[idx];
+   int type = *ptr++;
+   int count = _readPacked(ptr);
+   int i;
+
+   hits.clear();
+
+   if (type == _PACKED_BITSET)
+   {
+      for (i = 0; i < count * 8; i++)
+         if (bitGetBit(ptr, i))
+            hits.push(i);
+   }
+   else
+   {
+      int prev = -1;
+
+      for (i = 0; i < count; i++)
+      {
+         prev += _readPacked(ptr) + 1;
+         hits.push(prev);
+      }
+   }
+}
+
+int BingoQueryCache::Result::memorySize () const
+{
+   return _sections.sizeInBytes() + _offsets.sizeInBytes() + _data.sizeInBytes();
+}
+
+//
+// BingoQueryCache
+//
+
+static BingoQueryCache _bingo_query_cache;
+
+BingoQueryCache::BingoQueryCache ()
+{
+   _memory = 0;
+   _max_memory = DEFAULT_MAX_MEMORY;
+}
+
+BingoQueryCache & BingoQueryCache::getInstance ()
+{
+   return _bingo_query_cache;
+}
+
+void BingoQueryCache::buildKey (const char *index_id, int index_version, const char *search_type,
+                                const char *query, const char *options, Array<char> &key)
+{
+   ArrayOutput output(key);
+
+   output.printf("%s;%d;%s;%s;%s", index_id, index_version,
+      search_type != 0 ? search_type : "", options != 0 ? options : "",
+      query != 0 ? query : "");
+   output.writeChar(0);
+}
+
+bool BingoQueryCache::get (const char *key, Result &result)
+{
+   OsLocker locker(_lock);
+
+   _Entry *entry = _entries.at2(key);
+
+   if (entry == 0)
+   {
+      profIncCounter("bingo.query_cache.misses", 1);
+      return false;
+   }
+
+   // Move the entry to the most recently used end
+   int node = _lru[entry->lru_idx];
+
+   _lru.remove(entry->lru_idx);
+   entry->lru_idx = _lru.add(node);
+
+   result.copy(entry->result);
+   profIncCounter("bingo.query_cache.hits", 1);
+   return true;
+}
+
+void BingoQueryCache::put (const char *index_id, const char *key, const Result &result)
+{
+   OsLocker locker(_lock);
+
+   int memory = _entryMemory(index_id, key, result);
+
+   if (memory > _max_memory)
+      return;
+
+   _Entry *existing = _entries.at2(key);
+
+   if (existing != 0)
+      _remove(_lru[existing->lru_idx]);
+
+   _evict(memory);
+
+   int node = _entries.insert(key);
+   _Entry &entry = _entries.value(node);
+
+   entry.index_id.readString(index_id, true);
+   entry.result.copy(result);
+   entry.lru_idx = _lru.add(node);
+   entry.memory = memory;
+   _memory += memory;
+}
+
+void BingoQueryCache::invalidate (const char *index_id)
+{
+   OsLocker locker(_lock);
+   QS_DEF(Array<int>, to_remove);
+
+   to_remove.clear();
+   for (int i = _entries.begin(); i != _entries.end(); i = _entries.next(i))
+      if (strcmp(_entries.value(i).index_id.ptr(), index_id) == 0)
+         to_remove.push(i);
+
+   for (int i = 0; i < to_remove.size(); i++)
+      _remove(to_remove[i]);
+}
+
+void BingoQueryCache::clear ()
+{
+   OsLocker locker(_lock);
+
+   _entries.clear();
+   _lru.clear();
+   _memory = 0;
+}
+
+void BingoQueryCache::setMaxMemory (int max_memory)
+{
+   OsLocker locker(_lock);
+
+   _max_memory = max_memory;
+   _evict(0);
+}
+
+int BingoQueryCache::getMaxMemory ()
+{
+   return _max_memory;
+}
+
+int BingoQueryCache::_entryMemory (const char *index_id, const char *key, const Result &result)
+{
+   return result.memorySize() + (int)strlen(key) + (int)strlen(index_id) + 2 + (int)sizeof(_Entry);
+}
+
+void BingoQueryCache::_remove (int node)
+{
+   _Entry &entry = _entries.value(node);
+
+   _memory -= entry.memory;
+   _lru.remove(entry.lru_idx);
+   _entries.remove(node);
+}
+
+void BingoQueryCache::_evict (int required_memory)
+{
+   while (_lru.size() > 0 && _memory + required_memory > _max_memory)
+   {
+      _remove(_lru[_lru.begin()]);
+      profIncCounter("bingo.query_cache.evictions", 1);
+   }
+}
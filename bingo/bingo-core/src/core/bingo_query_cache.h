@@ -0,0 +1,123 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __bingo_query_cache__
+#define __bingo_query_cache__
+
+#include "base_cpp/array.h"
+#include "base_cpp/list.h"
+#include "base_cpp/red_black.h"
+#include "base_cpp/exception.h"
+#include "base_cpp/os_sync_wrapper.h"
+
+using namespace indigo;
+
+// Process-wide cache of the search results. Results are stored as
+// compressed hit sets per index section. Cache key is built from the
+// index identifier, index version, query and search options, so the
+// results of a modified index are never returned. Least recently used
+// results are evicted when the memory limit is reached.
+//
+// The cache is used by the PostgreSQL search engines and by the Oracle
+// fast index fetch. Each backend or session is a separate process, so it
+// has its own cache that is not shared with the others and is lost when
+// the process exits. In PostgreSQL the limit is set by the
+// QUERY_CACHE_SIZE config parameter in megabytes, Oracle uses the
+// default limit.
+class BingoQueryCache
+{
+public:
+   enum
+   {
+      DEFAULT_MAX_MEMORY = 16 * 1024 * 1024
+   };
+
+   // Search result: ascending hit indices for each index section
+   class Result
+   {
+   public:
+      Result ();
+
+      void clear ();
+      void copy (const Result &other);
+
+      // Sections should be added in ascending order
+      void addSection (int section_idx, const Array<int> &hits);
+
+      int  sectionsCount () const;
+      int  getSectionIdx (int idx) const;
+      void getSectionHits (int idx, Array<int> &hits) const;
+
+      int  memorySize () const;
+
+   protected:
+      Array<int>  _sections;
+      Array<int>  _offsets;
+      Array<byte> _data;
+
+      void _writePacked (dword value);
+      static dword _readPacked (const byte *&ptr);
+
+   private:
+      Result (const Result &); // no implicit copy
+   };
+
+   BingoQueryCache ();
+
+   static BingoQueryCache & getInstance ();
+
+   static void buildKey (const char *index_id, int index_version, const char *search_type,
+                         const char *query, const char *options, Array<char> &key);
+
+   // Returns true and copies the result if the key is cached
+   bool get (const char *key, Result &result);
+   void put (const char *index_id, const char *key, const Result &result);
+
+   // Removes all the results of the index
+   void invalidate (const char *index_id);
+   void clear ();
+
+   void setMaxMemory (int max_memory);
+   int  getMaxMemory ();
+
+   DECL_ERROR;
+
+protected:
+   struct _Entry
+   {
+      Array<char> index_id;
+      Result      result;
+      // Element of _lru that refers to this entry
+      int         lru_idx;
+      // Memory of the result, the key and the entry itself
+      int         memory;
+   };
+
+   RedBlackStringObjMap<_Entry> _entries;
+   // Nodes of _entries from the least to the most recently used
+   List<int> _lru;
+   OsLock _lock;
+
+   int   _memory;
+   int   _max_memory;
+
+   static int _entryMemory (const char *index_id, const char *key, const Result &result);
+   void _remove (int node);
+   void _evict (int required_memory);
+
+private:
+   BingoQueryCache (const BingoQueryCache &); // no implicit copy
+};
+
+#endif
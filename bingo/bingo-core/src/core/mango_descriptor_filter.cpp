@@ -0,0 +1,230 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include "core/mango_descriptor_filter.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base_cpp/output.h"
+#include "base_cpp/tlscont.h"
+
+IMPL_ERROR(MangoDescriptorFilter, "descriptor filter");
+
+const char * MangoDescriptorFilter::descriptor_names[MangoDescriptorFilter::DESCRIPTORS_COUNT] =
+   {"MASS", "ATOMS", "RINGS", "HBD", "HBA", "C", "N", "O", "P", "S", "H"};
+
+MangoDescriptorFilter::MangoDescriptorFilter ()
+{
+   clear();
+}
+
+void MangoDescriptorFilter::clear ()
+{
+   for (int i = 0; i < DESCRIPTORS_COUNT; i++)
+   {
+      _has_min[i] = false;
+      _has_max[i] = false;
+      _strict_min[i] = false;
+      _strict_max[i] = false;
+      _min[i] = 0;
+      _max[i] = 0;
+   }
+}
+
+bool MangoDescriptorFilter::isEmpty () const
+{
+   for (int i = 0; i < DESCRIPTORS_COUNT; i++)
+      if (hasCondition(i))
+         return false;
+
+   return true;
+}
+
+bool MangoDescriptorFilter::hasConditions (const char *options)
+{
+   if (options == 0)
+      return false;
+
+   QS_DEF(Array<char>, options_buf);
+   MangoDescriptorFilter filter;
+
+   options_buf.readString(options, true);
+   filter.extract(options_buf);
+   return !filter.isEmpty();
+}
+
+bool MangoDescriptorFilter::hasCondition (int descriptor) const
+{
+   return _has_min[descriptor] || _has_max[descriptor];
+}
+
+void MangoDescriptorFilter::setMin (int descriptor, float value, bool strict)
+{
+   if (_has_min[descriptor] && (_min[descriptor] > value ||
+       (_min[descriptor] == value && _strict_min[descriptor])))
+      return;
+
+   _min[descriptor] = value;
+   _strict_min[descriptor] = strict;
+   _has_min[descriptor] = true;
+}
+
+void MangoDescriptorFilter::setMax (int descriptor, float value, bool strict)
+{
+   if (_has_max[descriptor] && (_max[descriptor] < value ||
+       (_max[descriptor] == value && _strict_max[descriptor])))
+      return;
+
+   _max[descriptor] = value;
+   _strict_max[descriptor] = strict;
+   _has_max[descriptor] = true;
+}
+
+int MangoDescriptorFilter::findDescriptor (const char *name)
+{
+   for (int i = 0; i < DESCRIPTORS_COUNT; i++)
+      if (strcasecmp(descriptor_names[i], name) == 0)
+         return i;
+
+   return -1;
+}
+
+bool MangoDescriptorFilter::_parseCondition (const char *token)
+{
+   const char *op = token;
+
+   while (isalpha(*op))
+      op++;
+
+   if (op == token || (*op != '<' && *op != '>' && *op != '='))
+      return false;
+
+   QS_DEF(Array<char>, name);
+
+   name.copy(token, (int)(op - token));
+   name.push(0);
+
+   int descriptor = findDescriptor(name.ptr());
+
+   if (descriptor < 0)
+      return false;
+
+   char op_char = *op++;
+   bool strict = true;
+
+   if (*op == '=')
+   {
+      strict = false;
+      op++;
+   }
+
+   char *end;
+   float value = (float)strtod(op, &end);
+
+   if (end == op || *end != 0)
+      throw Error("can not parse descriptor condition '%s'", token);
+
+   if (op_char == '<')
+      setMax(descriptor, value, strict);
+   else if (op_char == '>')
+      setMin(descriptor, value, strict);
+   else
+   {
+      setMin(descriptor, value, false);
+      setMax(descriptor, value, false);
+   }
+   return true;
+}
+
+void MangoDescriptorFilter::extract (Array<char> &options)
+{
+   QS_DEF(Array<char>, rest);
+   QS_DEF(Array<char>, token);
+   int i = 0;
+
+   rest.clear();
+
+   while (i < options.size() && options[i] != 0)
+   {
+      if (isspace(options[i]))
+      {
+         i++;
+         continue;
+      }
+
+      token.clear();
+      while (i < options.size() && options[i] != 0 && !isspace(options[i]))
+         token.push(options[i++]);
+      token.push(0);
+
+      if (_parseCondition(token.ptr()))
+         continue;
+
+      if (rest.size() > 0)
+         rest.push(' ');
+      rest.appendString(token.ptr(), false);
+   }
+
+   rest.push(0);
+   options.copy(rest);
+}
+
+bool MangoDescriptorFilter::match (int descriptor, float value) const
+{
+   if (_has_min[descriptor])
+   {
+      if (value < _min[descriptor] || (_strict_min[descriptor] && value == _min[descriptor]))
+         return false;
+   }
+   if (_has_max[descriptor])
+   {
+      if (value > _max[descriptor] || (_strict_max[descriptor] && value == _max[descriptor]))
+         return false;
+   }
+   return true;
+}
+
+bool MangoDescriptorFilter::matchRange (const float *min_values, const float *max_values) const
+{
+   for (int i = 0; i < DESCRIPTORS_COUNT; i++)
+   {
+      if (_has_min[i])
+      {
+         if (max_values[i] < _min[i] || (_strict_min[i] && max_values[i] == _min[i]))
+            return false;
+      }
+      if (_has_max[i])
+      {
+         if (min_values[i] > _max[i] || (_strict_max[i] && min_values[i] == _max[i]))
+            return false;
+      }
+   }
+   return true;
+}
+
+void MangoDescriptorFilter::toString (Array<char> &str) const
+{
+   ArrayOutput output(str);
+
+   for (int i = 0; i < DESCRIPTORS_COUNT; i++)
+   {
+      if (_has_min[i])
+         output.printf(" %s>%s%g", descriptor_names[i], _strict_min[i] ? "" : "=", _min[i]);
+      if (_has_max[i])
+         output.printf(" %s<%s%g", descriptor_names[i], _strict_max[i] ? "" : "=", _max[i]);
+   }
+   output.writeChar(0);
+}
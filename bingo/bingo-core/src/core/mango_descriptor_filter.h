@@ -0,0 +1,85 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __mango_descriptor_filter__
+#define __mango_descriptor_filter__
+
+#include "base_cpp/array.h"
+#include "base_cpp/exception.h"
+
+using namespace indigo;
+
+// Range conditions on the molecule descriptors computed by MangoIndex.
+// Conditions are checked against the per-section minimum and maximum
+// values first, and then against the values of the screened candidates,
+// so the candidates are pruned before the CMF verification.
+class MangoDescriptorFilter
+{
+public:
+   enum
+   {
+      DESCRIPTOR_MASS = 0,
+      DESCRIPTOR_ATOMS,
+      DESCRIPTOR_RINGS,
+      DESCRIPTOR_HB_DONORS,
+      DESCRIPTOR_HB_ACCEPTORS,
+      // counters of MangoIndex::counted_elements follow
+      DESCRIPTOR_COUNTED_ELEMENTS,
+      DESCRIPTORS_COUNT = DESCRIPTOR_COUNTED_ELEMENTS + 6
+   };
+
+   static const char * descriptor_names[DESCRIPTORS_COUNT];
+
+   MangoDescriptorFilter ();
+
+   void clear ();
+   bool isEmpty () const;
+
+   // Bound is excluded if 'strict' is true
+   void setMin (int descriptor, float value, bool strict);
+   void setMax (int descriptor, float value, bool strict);
+
+   // Extracts conditions like "MASS<500" or "HBD<=5" from the search
+   // options and removes them. Other options are left unchanged.
+   void extract (Array<char> &options);
+
+   // Returns true if the search options have any descriptor conditions.
+   // Only the Postgres index stores the descriptor columns, so the other
+   // cartridges refuse such options with this check
+   static bool hasConditions (const char *options);
+
+   bool hasCondition (int descriptor) const;
+
+   // Returns false if none of the values in the ranges can pass
+   bool matchRange (const float *min_values, const float *max_values) const;
+   bool match (int descriptor, float value) const;
+
+   void toString (Array<char> &str) const;
+
+   static int findDescriptor (const char *name);
+
+   DECL_ERROR;
+
+protected:
+   float _min[DESCRIPTORS_COUNT];
+   float _max[DESCRIPTORS_COUNT];
+   bool  _has_min[DESCRIPTORS_COUNT];
+   bool  _has_max[DESCRIPTORS_COUNT];
+   bool  _strict_min[DESCRIPTORS_COUNT];
+   bool  _strict_max[DESCRIPTORS_COUNT];
+
+   bool _parseCondition (const char *token);
+};
+
+#endif
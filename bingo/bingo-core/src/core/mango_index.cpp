@@ -117,6 +117,41 @@ void MangoIndex::prepare (Scanner &molfile, Output &output,
    MoleculeMass mass_calulator;
    mass_calulator.relative_atomic_mass_map = &_context->relative_atomic_mass_map;
    _molecular_mass = mass_calulator.molecularWeight(mol);
+
+   // Calculate descriptors for the range filtering
+   int i, heavy_atoms = 0, hb_donors = 0, hb_acceptors = 0;
+
+   for (i = mol.vertexBegin(); i != mol.vertexEnd(); i = mol.vertexNext(i))
+   {
+      if (mol.isPseudoAtom(i) || mol.isRSite(i))
+      {
+         heavy_atoms++;
+         continue;
+      }
+
+      int number = mol.getAtomNumber(i);
+
+      if (number != ELEM_H)
+         heavy_atoms++;
+
+      // Lipinski's definition: N and O atoms are acceptors,
+      // and hydrogens attached to them are donors
+      if (number == ELEM_N || number == ELEM_O)
+      {
+         hb_acceptors++;
+         hb_donors += mol.getAtomTotalH(i);
+      }
+   }
+
+   _descriptors.clear_resize(MangoDescriptorFilter::DESCRIPTORS_COUNT);
+   _descriptors[MangoDescriptorFilter::DESCRIPTOR_MASS] = _molecular_mass;
+   _descriptors[MangoDescriptorFilter::DESCRIPTOR_ATOMS] = (float)heavy_atoms;
+   _descriptors[MangoDescriptorFilter::DESCRIPTOR_RINGS] =
+      (float)(mol.edgeCount() - mol.vertexCount() + mol.countComponents());
+   _descriptors[MangoDescriptorFilter::DESCRIPTOR_HB_DONORS] = (float)hb_donors;
+   _descriptors[MangoDescriptorFilter::DESCRIPTOR_HB_ACCEPTORS] = (float)hb_acceptors;
+   for (i = 0; i < (int)NELEM(counted_elements); i++)
+      _descriptors[MangoDescriptorFilter::DESCRIPTOR_COUNTED_ELEMENTS + i] = (float)_counted_elem_counters[i];
 }
 
 
@@ -165,6 +200,11 @@ float MangoIndex::getMolecularMass () const
    return _molecular_mass;
 }
 
+const Array<float> & MangoIndex::getDescriptors () const
+{
+   return _descriptors;
+}
+
 int MangoIndex::getFpSimilarityBitsCount () const
 {
    return _fp_sim_bits_count;
@@ -184,5 +224,6 @@ void MangoIndex::clear ()
            
    _counted_elems_str.clear();
    _molecular_mass = -1;
+   _descriptors.clear();
    _fp_sim_bits_count = -1;
 }
@@ -19,6 +19,7 @@
 #include "base_cpp/output.h"
 #include "core/mango_matchers.h"
 #include "core/bingo_index.h"
+#include "core/mango_descriptor_filter.h"
 
 using namespace indigo;
 
@@ -49,6 +50,9 @@ public:
    
    float getMolecularMass() const;
 
+   // Descriptors for the range filtering (see MangoDescriptorFilter)
+   const Array<float> & getDescriptors () const;
+
    int getFpSimilarityBitsCount () const;
 
    static const int counted_elements[6];
@@ -78,6 +82,8 @@ private:
    // Molecular mass
    float _molecular_mass;
 
+   Array<float> _descriptors;
+
    // Number of one bits in similarity fingerprint
    int _fp_sim_bits_count;
 };
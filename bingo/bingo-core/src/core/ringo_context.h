@@ -34,6 +34,7 @@ public:
 
    RingoSubstructure substructure;
    RingoExact exact;
+   RingoSimilarity similarity;
    RingoAAM ringoAAM;
 
    DECL_ERROR;
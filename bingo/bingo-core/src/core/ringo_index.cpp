@@ -14,6 +14,7 @@
 
 #include "core/ringo_index.h"
 
+#include "base_c/bitarray.h"
 #include "base_cpp/output.h"
 #include "base_cpp/os_sync_wrapper.h"
 #include "core/mango_index.h"
@@ -59,6 +60,16 @@ void RingoIndex::prepare (Scanner &rxnfile, Output &output, OsLock *lock_for_exc
 
       builder.process();
       _fp.copy(builder.get(), _context->fp_parameters.fingerprintSizeExtOrdSim() * 2);
+      _fp.concat(builder.getReactingCenters(), ReactionFingerprintBuilder::fingerprintSizeReactingCenters());
+
+      // Similarity bits of the reactants and products are not used for
+      // the screening, so the difference fingerprint is stored instead
+      int ext_ord_size = _context->fp_parameters.fingerprintSizeExtOrd() * 2;
+      int diff_size = _context->fp_parameters.fingerprintSizeSim() * 2;
+
+      memcpy(_fp.ptr() + ext_ord_size, builder.getDiff(), diff_size);
+      _fp_sim_bits_count = bitGetOnesCount(builder.getDiff(), diff_size);
+      output.writeBinaryWord((word)_fp_sim_bits_count);
    }
 
    ArrayOutput output_crf(_crf);
@@ -93,8 +104,20 @@ const char * RingoIndex::getHashStr ()
    return _hash_str.ptr();
 }
 
+int RingoIndex::getFingerprintSize (const MoleculeFingerprintParameters &parameters)
+{
+   return parameters.fingerprintSizeExtOrdSim() * 2 +
+      ReactionFingerprintBuilder::fingerprintSizeReactingCenters();
+}
+
+int RingoIndex::getFpSimilarityBitsCount ()
+{
+   return _fp_sim_bits_count;
+}
+
 void RingoIndex::clear ()
 {
    _fp.clear();
+   _fp_sim_bits_count = 0;
    _crf.clear();
 }
@@ -23,24 +23,46 @@
 
 using namespace indigo;
 
+namespace indigo
+{
+   struct MoleculeFingerprintParameters;
+}
+
 class BingoContext;
 
 class RingoIndex : public BingoIndex
 {
 public:
+   enum
+   {
+      // Version of the stored reaction fingerprint. Indexes of the earlier
+      // releases have version 0 and have to be rebuilt
+      INDEX_VERSION = 1
+   };
+
    virtual void prepare (Scanner &rxnfile, Output &fi_output, OsLock *lock_for_exclusive_access);
    
+   // Substructure fingerprint of the reactants and products followed
+   // by the reaction difference fingerprint for the similarity search
+   // and by the reacting centers fingerprint
    const byte * getFingerprint ();
    const Array<char> & getCrf ();
    dword getHash ();
    const char * getHashStr ();
 
+   int getFpSimilarityBitsCount ();
+
    void clear ();
 
+   static int getFingerprintSize (const MoleculeFingerprintParameters &parameters);
+
 private:
    Array<byte> _fp;
    Array<char> _crf;
    dword       _hash;
    Array<char> _hash_str;
+
+   // Number of one bits in the difference fingerprint
+   int _fp_sim_bits_count;
 };
 #endif
@@ -20,6 +20,7 @@
 #include "reaction/reaction.h"
 #include "reaction/query_reaction.h"
 #include "reaction/reaction_neighborhood_counters.h"
+#include "core/mango_matchers.h"
 
 using namespace indigo;
 
@@ -112,6 +113,30 @@ protected:
    Reaction _reaction;
 };
 
+// Similarity of the reaction difference fingerprints (see
+// ReactionFingerprintBuilder::getDiff). Metrics and bounds
+// are the same as for the molecule similarity.
+class RingoSimilarity : public MangoSimilarity
+{
+public:
+   explicit RingoSimilarity (BingoContext &context);
+
+   void loadQuery (const Array<char> &buf);
+   void loadQuery (Scanner &scanner);
+   void loadQuery (const char *str);
+
+   float calc (const Array<char> &target_buf);
+   float calc (Scanner &scanner);
+
+   bool matchBinary (const Array<char> &buf);
+   bool matchBinary (Scanner &scanner);
+
+   DECL_ERROR;
+protected:
+   // Returns the number of ones in the difference fingerprint
+   int _buildFingerprint (Reaction &reaction, Array<byte> &fp);
+};
+
 class RingoExact
 {
 public:
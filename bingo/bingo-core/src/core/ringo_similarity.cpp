@@ -0,0 +1,131 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ * 
+ * This file is part of Indigo toolkit.
+ * 
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ * 
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include "core/ringo_matchers.h"
+#include "base_c/bitarray.h"
+#include "base_cpp/scanner.h"
+#include "core/bingo_context.h"
+#include "core/ringo_index.h"
+#include "molecule/molecule_fingerprint.h"
+#include "reaction/crf_loader.h"
+#include "reaction/reaction_auto_loader.h"
+#include "reaction/reaction_fingerprint.h"
+
+IMPL_ERROR(RingoSimilarity, "ringo similarity");
+
+RingoSimilarity::RingoSimilarity (BingoContext &context) :
+MangoSimilarity(context)
+{
+}
+
+int RingoSimilarity::_buildFingerprint (Reaction &reaction, Array<byte> &fp)
+{
+   const MoleculeFingerprintParameters &parameters = _context.fp_parameters;
+   int ext_ord_size = parameters.fingerprintSizeExtOrd() * 2;
+   int diff_size = parameters.fingerprintSizeSim() * 2;
+
+   ReactionFingerprintBuilder builder(reaction, parameters);
+
+   builder.skip_ext = true;
+   builder.skip_ord = true;
+   builder.process();
+
+   // The same layout as the fingerprint of RingoIndex, so
+   // the query fingerprint can screen the index directly
+   fp.clear_resize(RingoIndex::getFingerprintSize(parameters));
+   fp.zerofill();
+   memcpy(fp.ptr() + ext_ord_size, builder.getDiff(), diff_size);
+
+   return bitGetOnesCount(builder.getDiff(), diff_size);
+}
+
+void RingoSimilarity::loadQuery (Scanner &scanner)
+{
+   QS_DEF(Reaction, query);
+
+   ReactionAutoLoader loader(scanner);
+
+   loader.treat_x_as_pseudoatom = _context.treat_x_as_pseudoatom;
+   loader.ignore_closing_bond_direction_mismatch =
+           _context.ignore_closing_bond_direction_mismatch;
+   loader.loadReaction(query);
+
+   query.aromatize(AromaticityOptions::BASIC);
+
+   _query_ones = _buildFingerprint(query, _query_fp);
+}
+
+void RingoSimilarity::loadQuery (const Array<char> &buf)
+{
+   BufferScanner scanner(buf);
+
+   loadQuery(scanner);
+}
+
+void RingoSimilarity::loadQuery (const char *str)
+{
+   BufferScanner scanner(str);
+
+   loadQuery(scanner);
+}
+
+float RingoSimilarity::calc (Scanner &scanner)
+{
+   QS_DEF(Reaction, target);
+   QS_DEF(Array<byte>, target_fp);
+
+   ReactionAutoLoader loader(scanner);
+
+   loader.treat_x_as_pseudoatom = _context.treat_x_as_pseudoatom;
+   loader.ignore_closing_bond_direction_mismatch =
+           _context.ignore_closing_bond_direction_mismatch;
+   loader.loadReaction(target);
+
+   target.aromatize(AromaticityOptions::BASIC);
+
+   int target_ones = _buildFingerprint(target, target_fp);
+   int common = bitCommonOnes(_query_fp.ptr(), target_fp.ptr(), target_fp.size());
+
+   return _similarity(_query_ones, target_ones, common, metrics,
+      _numerator_value, _denominator_value);
+}
+
+float RingoSimilarity::calc (const Array<char> &target_buf)
+{
+   BufferScanner scanner(target_buf);
+
+   return calc(scanner);
+}
+
+bool RingoSimilarity::matchBinary (Scanner &scanner)
+{
+   QS_DEF(Reaction, target);
+   QS_DEF(Array<byte>, target_fp);
+
+   CrfLoader loader(_context.cmf_dict, scanner);
+
+   loader.loadReaction(target);
+
+   int target_ones = _buildFingerprint(target, target_fp);
+   int common = bitCommonOnes(_query_fp.ptr(), target_fp.ptr(), target_fp.size());
+
+   return match(target_ones, common);
+}
+
+bool RingoSimilarity::matchBinary (const Array<char> &buf)
+{
+   BufferScanner scanner(buf);
+
+   return matchBinary(scanner);
+}
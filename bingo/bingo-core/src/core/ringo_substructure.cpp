@@ -140,6 +140,7 @@ void RingoSubstructure::_validateQueryData ()
    builder.process();
    
    _query_fp.copy(builder.get(), _context.fp_parameters.fingerprintSizeExtOrdSim() * 2);
+   _query_fp.concat(builder.getReactingCenters(), ReactionFingerprintBuilder::fingerprintSizeReactingCenters());
    
    _query_data_valid = true;
 }
@@ -122,6 +122,24 @@ create or replace function RExact_blob (context_id in binary_integer,
                           params, params indicator short,
                           return indicator short, return OCINumber);
 /
+create or replace function RSim_clob (context_id in binary_integer,
+  target in CLOB, query in CLOB, params in VARCHAR2) return NUMBER
+  AS language C name "oraRingoSim" library bingolib
+  with context parameters(context, context_id, 
+                          target, target indicator short,
+                          query,  query  indicator short, 
+                          params, params indicator short,
+                          return indicator short, return OCINumber);
+/
+create or replace function RSim_blob (context_id in binary_integer,
+  target in BLOB, query in CLOB, params in VARCHAR2) return NUMBER
+  AS language C name "oraRingoSim" library bingolib
+  with context parameters(context, context_id, 
+                          target, target indicator short,
+                          query,  query  indicator short, 
+                          params, params indicator short,
+                          return indicator short, return OCINumber);
+/
 create or replace procedure ringoDropIndex (context_id in binary_integer)  
   AS language C name "oraRingoDropIndex" library bingolib
   with context parameters(context, context_id);
@@ -13,6 +13,7 @@
 drop indextype ReactionIndex force;
 drop operator RSub force;
 drop operator RExact force;
+drop operator RSim force;
 drop operator RSmarts force;
 drop package RingoPackage;
 drop type RingoIndex force;
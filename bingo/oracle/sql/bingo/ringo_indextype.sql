@@ -93,6 +93,32 @@ create or replace operator RExact binding
   (BLOB,  VARCHAR2, VARCHAR2) return NUMBER with index context, scan context RingoIndex
                                           using RingoPackage.RExact;
 
+create or replace operator RSim binding
+  (VARCHAR2,  CLOB) return NUMBER with index context, scan context RingoIndex
+                                          using RingoPackage.RSim,
+  (VARCHAR2,  CLOB, VARCHAR2) return NUMBER with index context, scan context RingoIndex
+                                          using RingoPackage.RSim,
+  (VARCHAR2,  VARCHAR2) return NUMBER with index context, scan context RingoIndex
+                                          using RingoPackage.RSim,
+  (VARCHAR2,  VARCHAR2, VARCHAR2) return NUMBER with index context, scan context RingoIndex
+                                          using RingoPackage.RSim,
+  (CLOB,  CLOB) return NUMBER with index context, scan context RingoIndex
+                                          using RingoPackage.RSim,
+  (CLOB,  CLOB, VARCHAR2) return NUMBER with index context, scan context RingoIndex
+                                          using RingoPackage.RSim,
+  (CLOB,  VARCHAR2) return NUMBER with index context, scan context RingoIndex
+                                          using RingoPackage.RSim,
+  (CLOB,  VARCHAR2, VARCHAR2) return NUMBER with index context, scan context RingoIndex
+                                          using RingoPackage.RSim,
+  (BLOB,  CLOB) return NUMBER with index context, scan context RingoIndex
+                                          using RingoPackage.RSim,
+  (BLOB,  CLOB, VARCHAR2) return NUMBER with index context, scan context RingoIndex
+                                          using RingoPackage.RSim,
+  (BLOB,  VARCHAR2) return NUMBER with index context, scan context RingoIndex
+                                          using RingoPackage.RSim,
+  (BLOB,  VARCHAR2, VARCHAR2) return NUMBER with index context, scan context RingoIndex
+                                          using RingoPackage.RSim;
+
 
 create or replace operator AAM binding  
   (VARCHAR2, VARCHAR2) return CLOB using RingoPackage.AAM,
@@ -122,6 +148,7 @@ create or replace operator RFingerprint binding
 grant execute on RSub to public;
 grant execute on RSubHi to public;
 grant execute on RExact to public;
+grant execute on RSim to public;
 grant execute on RSmarts to public;
 grant execute on RSmartsHi to public;
 grant execute on AAM to public;
@@ -157,7 +184,19 @@ create or replace indextype ReactionIndex for
    RExact(BLOB, CLOB),
    RExact(BLOB, CLOB, VARCHAR2),
    RExact(BLOB, VARCHAR2),
-   RExact(BLOB, VARCHAR2, VARCHAR2)
+   RExact(BLOB, VARCHAR2, VARCHAR2),
+   RSim(VARCHAR2, CLOB),
+   RSim(VARCHAR2, CLOB, VARCHAR2),
+   RSim(VARCHAR2, VARCHAR2),
+   RSim(VARCHAR2, VARCHAR2, VARCHAR2),
+   RSim(CLOB, CLOB),
+   RSim(CLOB, CLOB, VARCHAR2),
+   RSim(CLOB, VARCHAR2),
+   RSim(CLOB, VARCHAR2, VARCHAR2),
+   RSim(BLOB, CLOB),
+   RSim(BLOB, CLOB, VARCHAR2),
+   RSim(BLOB, VARCHAR2),
+   RSim(BLOB, VARCHAR2, VARCHAR2)
    using RingoIndex;
 
 associate statistics with packages RingoPackage using RingoStat;
@@ -101,6 +101,31 @@ CREATE OR REPLACE PACKAGE RingoPackage IS
                  scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
    function RExact (target in BLOB, query in CLOB, params in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
                  scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+   function RSim (target in VARCHAR2, query in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+   function RSim (target in VARCHAR2, query in VARCHAR2, params in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+   function RSim (target in VARCHAR2, query in CLOB, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+   function RSim (target in VARCHAR2, query in CLOB, params in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+   function RSim (target in CLOB, query in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+   function RSim (target in CLOB, query in VARCHAR2, params in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+   function RSim (target in CLOB, query in CLOB, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+   function RSim (target in CLOB, query in CLOB, params in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+   function RSim (target in BLOB, query in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+   function RSim (target in BLOB, query in VARCHAR2, params in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+   function RSim (target in BLOB, query in CLOB, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+   function RSim (target in BLOB, query in CLOB, params in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER;
+
 
    function AAM (target in VARCHAR2, params in VARCHAR2) return CLOB;
    function AAM (target in CLOB, params in VARCHAR2) return CLOB;
@@ -384,6 +409,75 @@ CREATE OR REPLACE PACKAGE BODY RingoPackage IS
       return RExact_blob(context_id, target, query, params);
    end RExact;
 
+   function RSim (target in VARCHAR2, query in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+            scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER IS
+   begin
+      return RSim(to_clob(target), to_clob(query), null, indexctx, scanctx, scanflg);
+   end RSim;
+   function RSim (target in VARCHAR2, query in VARCHAR2, params in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+            scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER IS
+   begin
+      return RSim(to_clob(target), to_clob(query), params, indexctx, scanctx, scanflg);
+   end RSim;
+   function RSim (target in VARCHAR2, query in CLOB, indexctx IN sys.ODCIIndexCtx,
+            scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER IS
+   begin
+      return RSim(to_clob(target), query, null, indexctx, scanctx, scanflg);
+   end RSim;
+   function RSim (target in VARCHAR2, query in CLOB, params in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+            scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER IS
+   begin
+      return RSim(to_clob(target), query, params, indexctx, scanctx, scanflg);
+   end RSim;
+   function RSim (target in CLOB, query in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+            scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER IS
+   begin
+      return RSim(target, to_clob(query), null, indexctx, scanctx, scanflg);
+   end RSim;
+   function RSim (target in CLOB, query in VARCHAR2, params in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+            scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER IS
+   begin
+      return RSim(target, to_clob(query), params, indexctx, scanctx, scanflg);
+   end RSim;
+   function RSim (target in CLOB, query in CLOB, indexctx IN sys.ODCIIndexCtx,
+            scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER IS
+   begin
+      return RSim(target, query, null, indexctx, scanctx, scanflg);
+   end RSim;
+   function RSim (target in CLOB, query in CLOB, params in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER IS
+      context_id binary_integer := 0;
+   begin
+      if indexctx.IndexInfo is not null then
+         context_id := BingoPackage.getContextID(indexctx.IndexInfo);
+      end if;
+      return RSim_clob(context_id, target, query, params);
+   end RSim;
+   function RSim (target in BLOB, query in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER IS
+   begin
+      return RSim(target, to_clob(query), null, indexctx, scanctx, scanflg);
+   end RSim;
+   function RSim (target in BLOB, query in VARCHAR2, params in VARCHAR2,
+            indexctx IN sys.ODCIIndexCtx, scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER IS
+   begin
+      return RSim(target, to_clob(query), params, indexctx, scanctx, scanflg);
+   end RSim;
+   function RSim (target in BLOB, query in CLOB, indexctx IN sys.ODCIIndexCtx,
+                 scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER IS
+   begin
+      return RSim(target, query, null, indexctx, scanctx, scanflg);
+   end RSim;
+   function RSim (target in BLOB, query in CLOB, params in VARCHAR2, indexctx IN sys.ODCIIndexCtx,
+            scanctx in out RingoIndex, scanflg IN NUMBER) return NUMBER IS
+      context_id binary_integer := 0;
+   begin
+      if indexctx.IndexInfo is not null then
+         context_id := BingoPackage.getContextID(indexctx.IndexInfo);
+      end if;
+      return RSim_blob(context_id, target, query, params);
+   end RSim;
+
 
    function AAM (target in VARCHAR2, params in VARCHAR2) return CLOB IS
    begin
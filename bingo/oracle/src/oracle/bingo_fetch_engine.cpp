@@ -21,4 +21,113 @@ CP_DEF(BingoFetchEngine);
 BingoFetchEngine::BingoFetchEngine () : CP_INIT, TL_CP_GET(matched)
 {
    matched.clear();
+   _cache_hit = false;
+   _cache_recording = false;
+   _cache_hits_count = 0;
+   _cache_position = -1;
+   _cache_hit_idx = 0;
+}
+
+void BingoFetchEngine::_initResultCache (const char *index_id, int index_version, const char *search_type,
+                                         const Array<char> &query, const char *options)
+{
+   QS_DEF(Array<char>, query_str);
+
+   query_str.copy(query);
+   query_str.push(0);
+
+   _cache_index_id.readString(index_id, true);
+   BingoQueryCache::buildKey(index_id, index_version, search_type, query_str.ptr(), options, _cache_key);
+
+   _cache_result.clear();
+   _cache_recorded.clear();
+   _cache_section_hits.clear();
+   _cache_position = -1;
+   _cache_hit_idx = 0;
+   _cache_hits_count = 0;
+
+   _cache_hit = BingoQueryCache::getInstance().get(_cache_key.ptr(), _cache_result);
+   _cache_recording = !_cache_hit;
+
+   if (_cache_hit)
+   {
+      // The count is needed for the selectivity
+      for (int i = 0; i < _cache_result.sectionsCount(); i++)
+      {
+         _cache_result.getSectionHits(i, _cache_section_hits);
+         _cache_hits_count += _cache_section_hits.size();
+      }
+      _cache_section_hits.clear();
+   }
+}
+
+void BingoFetchEngine::_recordCachedHit (int storage_idx)
+{
+   if (!_cache_recording)
+      return;
+
+   _cache_recorded.push(storage_idx);
+
+   // Too large results are not cached
+   if (_cache_recorded.sizeInBytes() > BingoQueryCache::getInstance().getMaxMemory())
+   {
+      _cache_recording = false;
+      _cache_recorded.clear();
+   }
+}
+
+bool BingoFetchEngine::_nextCachedHit (int &storage_idx)
+{
+   while (_cache_hit_idx >= _cache_section_hits.size())
+   {
+      ++_cache_position;
+      if (_cache_position >= _cache_result.sectionsCount())
+         return false;
+      _cache_result.getSectionHits(_cache_position, _cache_section_hits);
+      _cache_hit_idx = 0;
+   }
+
+   storage_idx = _cache_result.getSectionIdx(_cache_position) * _CACHE_SECTION_SIZE +
+                 _cache_section_hits[_cache_hit_idx++];
+   return true;
+}
+
+static int _cmpStorageIndices (int a, int b, void *context)
+{
+   return a - b;
+}
+
+void BingoFetchEngine::_putResultCache ()
+{
+   // Only the results of the entire fetch are cached
+   if (!_cache_recording)
+      return;
+   _cache_recording = false;
+
+   // Hits of the screening blocks and of the parallel matching
+   // are recorded in arbitrary order
+   _cache_recorded.qsort(_cmpStorageIndices, 0);
+
+   QS_DEF(Array<int>, hits);
+   int i = 0;
+
+   _cache_result.clear();
+   while (i < _cache_recorded.size())
+   {
+      int section = _cache_recorded[i] / _CACHE_SECTION_SIZE;
+
+      hits.clear();
+      for (; i < _cache_recorded.size() && _cache_recorded[i] / _CACHE_SECTION_SIZE == section; i++)
+      {
+         int hit = _cache_recorded[i] % _CACHE_SECTION_SIZE;
+
+         if (hits.size() == 0 || hits.top() != hit)
+            hits.push(hit);
+      }
+      _cache_result.addSection(section, hits);
+   }
+
+   BingoQueryCache::getInstance().put(_cache_index_id.ptr(), _cache_key.ptr(), _cache_result);
+   _cache_result.clear();
+   _cache_recorded.clear();
 }
@@ -18,6 +18,7 @@
 #include "oracle/ora_wrap.h"
 #include "base_cpp/list.h"
 #include "base_cpp/tlscont.h"
+#include "core/bingo_query_cache.h"
 
 using namespace indigo;
 
@@ -38,6 +39,35 @@ public:
 
    CP_DECL;
    TL_CP_DECL(List<OraRowidText>, matched);
+
+protected:
+   // Search result cache. Storage indices of the hits are recorded while
+   // the entire index is fetched and are put into BingoQueryCache at the
+   // end. The next identical search returns them without screening and
+   // matching until the index version changes.
+   enum
+   {
+      _CACHE_SECTION_SIZE = 65536
+   };
+
+   void _initResultCache (const char *index_id, int index_version, const char *search_type,
+                          const Array<char> &query, const char *options);
+   void _recordCachedHit (int storage_idx);
+   bool _nextCachedHit (int &storage_idx);
+   void _putResultCache ();
+
+   bool _cache_hit;
+   bool _cache_recording;
+   int  _cache_hits_count;
+
+private:
+   Array<char> _cache_index_id;
+   Array<char> _cache_key;
+   Array<int>  _cache_recorded;
+   Array<int>  _cache_section_hits;
+   int         _cache_position;
+   int         _cache_hit_idx;
+   BingoQueryCache::Result _cache_result;
 };
 
 #endif
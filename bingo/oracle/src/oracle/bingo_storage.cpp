@@ -19,6 +19,7 @@
 #include "base_cpp/shmem.h"
 #include "base_cpp/auto_ptr.h"
 #include "oracle/ora_logger.h"
+#include "core/bingo_query_cache.h"
 
 IMPL_ERROR(BingoStorage, "storage");
 
@@ -50,9 +51,18 @@ BingoStorage::BingoStorage (OracleEnv &env, int context_id)
 
 BingoStorage::~BingoStorage ()
 {
+   _dropCachedResults();
    delete _shmem_state;
 }
 
+void BingoStorage::_dropCachedResults ()
+{
+   // The age is kept in the shared state that is zeroed when it is
+   // created again, so the cached results are valid only while this
+   // process stays attached to it
+   BingoQueryCache::getInstance().invalidate(_shmem_id.ptr());
+}
+
 void BingoStorage::create (OracleEnv &env)
 {
    const char *tn = _table_name.ptr();
@@ -65,6 +75,7 @@ void BingoStorage::create (OracleEnv &env)
 void BingoStorage::drop (OracleEnv &env)
 {
    OracleStatement::executeSingle(env, "BEGIN DropTable('%s'); END;", _table_name.ptr());
+   _dropCachedResults();
    delete _shmem_state;
    _shmem_state = 0;
    _age_loaded = -1;
@@ -76,6 +87,7 @@ void BingoStorage::truncate (OracleEnv &env)
 
    OracleStatement::executeSingle(env, "TRUNCATE TABLE %s", tn);
    OracleStatement::executeSingle(env, "INSERT INTO %s VALUES(0, EMPTY_BLOB())", tn);
+   _dropCachedResults();
    delete _shmem_state;
    _shmem_state = 0;
    _age_loaded = -1;
@@ -343,6 +355,16 @@ int BingoStorage::count ()
    return _index.size();
 }
 
+const char * BingoStorage::getID ()
+{
+   return _shmem_id.ptr();
+}
+
+int BingoStorage::getAge ()
+{
+   return _age_loaded;
+}
+
 void BingoStorage::get (int n, Array<char> &out)
 {
    const _Addr &addr = _index[n];
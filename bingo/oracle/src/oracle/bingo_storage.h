@@ -50,6 +50,11 @@ public:
    
    int  count ();
    void get (int n, Array<char> &out);
+
+   // Identifier of the storage and the version of its loaded contents,
+   // used by the search result cache
+   const char * getID ();
+   int  getAge ();
    
    DECL_ERROR;
    
@@ -96,6 +101,7 @@ protected:
    
    void   * _getShared (SharedMemory * &sh_mem, char *name, int shared_size, bool allow_first);
    _State * _getState  (bool allow_first);
+   void     _dropCachedResults ();
    void     _insertLOB (OracleEnv &env, int no);
    OracleLOB * _getLob (OracleEnv &env, int no);
    void  _finishTopLob (OracleEnv &env);
@@ -17,11 +17,13 @@
 
 #include "base_cpp/profiling.h"
 #include "oracle/mango_fast_index.h"
+#include "oracle/mango_fast_index_parallel.h"
 #include "core/mango_matchers.h"
 #include "oracle/mango_oracle.h"
 #include "oracle/mango_shadow_table.h"
 #include "oracle/mango_fetch_context.h"
 #include "oracle/bingo_oracle_context.h"
+#include "base_cpp/output.h"
 #include "base_cpp/scanner.h"
 #include "oracle/rowid_loader.h"
 #include "base_c/bitarray.h"
@@ -33,6 +35,7 @@ _context(context)
 {
    _fetch_type = 0;
    _last_id = -1;
+   _query_smarts = false;
 }
 
 MangoFastIndex::~MangoFastIndex ()
@@ -55,6 +58,19 @@ void MangoFastIndex::_decompressRowid (const Array<char> &stored, OraRowidText &
    rid.ptr()[18] = 0;
 }
 
+void MangoFastIndex::setQuery (const Array<char> &query_buf, const char *params, bool smarts)
+{
+   _query_buf.copy(query_buf);
+   if (params != 0)
+      _query_params.readString(params, true);
+   else
+   {
+      _query_params.clear();
+      _query_params.push(0);
+   }
+   _query_smarts = smarts;
+}
+
 bool MangoFastIndex::getLastRowid (OraRowidText &id)
 {
    if (_last_id < 0)
@@ -123,6 +139,7 @@ void MangoFastIndex::_match (OracleEnv &env, int idx)
       OraRowidText & rid = matched.at(matched.add());
 
       _decompressRowid(stored, rid);
+      _recordCachedHit(idx);
 
       profIncTimer("match.found", profTimerGetTime(tall));
       _matched++;
@@ -134,12 +151,63 @@ void MangoFastIndex::_match (OracleEnv &env, int idx)
    }
 }
 
+bool MangoFastIndex::_isParallel ()
+{
+   if (_context.context().context().nthreads == 1)
+      return false;
+
+   // Coordinates are loaded from the shadow table that can be
+   // accessed only from the main thread
+   if (_fetch_type == _SUBSTRUCTURE && _context.substructure.needCoords())
+      return false;
+
+   return true;
+}
+
+void MangoFastIndex::_addMatched (int idx)
+{
+   BingoStorage &storage = this->_context.context().context().storage;
+   QS_DEF(Array<char>, stored);
+
+   storage.get(idx, stored);
+
+   OraRowidText & rid = matched.at(matched.add());
+
+   _decompressRowid(stored, rid);
+   _recordCachedHit(idx);
+   _matched++;
+}
+
+void MangoFastIndex::_matchParallel (OracleEnv &env, const Array<int> &ids)
+{
+   if (ids.size() == 0)
+      return;
+
+   if (_dispatcher.get() == 0)
+      _dispatcher.create(*this);
+
+   profTimerStart(tpar, "match.parallel");
+
+   int nthreads = _context.context().context().nthreads;
+
+   _dispatcher->setup(ids);
+   if (nthreads <= 0)
+      _dispatcher->run();
+   else
+      _dispatcher->run(nthreads);
+
+   profTimerStop(tpar);
+   profIncCounter("match.parallel.candidates", ids.size());
+}
+
 void MangoFastIndex::fetch (OracleEnv &env, int max_matches)
 {  
    env.dbgPrintf("requested %d hits\n", max_matches);
    matched.clear();
    
-   if (_fetch_type == _SUBSTRUCTURE || _fetch_type == _TAUTOMER_SUBSTRUCTURE)
+   if (_cache_hit)
+      _fetchCached(max_matches);
+   else if (_fetch_type == _SUBSTRUCTURE || _fetch_type == _TAUTOMER_SUBSTRUCTURE)
       _fetchSubstructure(env, max_matches);
    else if (_fetch_type == _SIMILARITY)
       _fetchSimilarity(env, max_matches);
@@ -151,10 +219,26 @@ void MangoFastIndex::_fetchSubstructure (OracleEnv &env, int max_matches)
 {
    BingoFingerprints &fingerprints = _context.context().fingerprints;
 
+   bool parallel = _isParallel();
+   QS_DEF(Array<int>, ids);
+
    if (fingerprints.ableToScreen(_screening))
    {
       while (matched.size() < max_matches)
       {
+         if (_screening.passed.size() > 0 && parallel)
+         {
+            ids.clear();
+            while (_screening.passed.size() > 0 && ids.size() < PARALLEL_CHUNK_SIZE)
+            {
+               int idx = _screening.passed.begin();
+               ids.push(_screening.passed.at(idx));
+               _screening.passed.remove(idx);
+            }
+            _matchParallel(env, ids);
+            continue;
+         }
+
          if (_screening.passed.size() > 0)
          {
             int idx = _screening.passed.begin();
@@ -180,6 +264,7 @@ void MangoFastIndex::_fetchSubstructure (OracleEnv &env, int max_matches)
          else
          {
             env.dbgPrintfTS("screening ended\n");
+            _putResultCache();
             break;
          }
 
@@ -189,10 +274,46 @@ void MangoFastIndex::_fetchSubstructure (OracleEnv &env, int max_matches)
    }
    else
    {
-      while (matched.size() < max_matches && _cur_idx < _context.context().context().storage.count())
-         _match(env, _cur_idx++);
+      int count = _context.context().context().storage.count();
+
+      if (parallel)
+      {
+         while (matched.size() < max_matches && _cur_idx < count)
+         {
+            ids.clear();
+            while (_cur_idx < count && ids.size() < PARALLEL_CHUNK_SIZE)
+               ids.push(_cur_idx++);
+            _matchParallel(env, ids);
+         }
+      }
+      else
+      {
+         while (matched.size() < max_matches && _cur_idx < count)
+            _match(env, _cur_idx++);
+      }
 
       env.dbgPrintfTS("%d molecules matched of tested %d\n", matched.size(), _cur_idx);
+      if (_cur_idx >= count)
+         _putResultCache();
+   }
+}
+
+void MangoFastIndex::_fetchCached (int max_matches)
+{
+   BingoStorage &storage = _context.context().context().storage;
+   QS_DEF(Array<char>, stored);
+   int idx;
+
+   profTimerStart(tcached, "fetch.cached");
+   while (matched.size() < max_matches && _nextCachedHit(idx))
+   {
+      _last_id = idx;
+      storage.get(idx, stored);
+
+      OraRowidText &rid = matched.at(matched.add());
+
+      _decompressRowid(stored, rid);
+      _matched++;
    }
 }
 
@@ -213,6 +334,7 @@ void MangoFastIndex::_fetchSimilarity (OracleEnv &env, int max_matches)
       if (!fingerprints.countOnes_Init(env, _screening))
       {
          env.dbgPrintfTS("screening ended\n");
+         _putResultCache();
          break;
       }
 
@@ -308,9 +430,11 @@ void MangoFastIndex::_fetchSimilarity (OracleEnv &env, int max_matches)
             if (_context.similarity.match(target_ones[i], _screening.one_counters[i]))
             {
                OraRowidText &rid = matched.at(matched.add());
+               int idx = fingerprints.getStorageIndex_NoMap(_screening, i);
 
-               storage.get(fingerprints.getStorageIndex_NoMap(_screening, i), stored);
+               storage.get(idx, stored);
                _decompressRowid(stored, rid);
+               _recordCachedHit(idx);
               _matched++;
             }
             else
@@ -320,8 +444,20 @@ void MangoFastIndex::_fetchSimilarity (OracleEnv &env, int max_matches)
       else if (_screening.passed.size() > 0)
       {
          profTimerStart(tfine, "sim.fetch.fine");
-         for (i = _screening.passed.begin(); i != _screening.passed.end(); i = _screening.passed.next(i))
-            _match(env, fingerprints.getStorageIndex_NoMap(_screening, _screening.passed[i]));
+         if (_isParallel())
+         {
+            QS_DEF(Array<int>, ids);
+
+            ids.clear();
+            for (i = _screening.passed.begin(); i != _screening.passed.end(); i = _screening.passed.next(i))
+               ids.push(fingerprints.getStorageIndex_NoMap(_screening, _screening.passed[i]));
+            _matchParallel(env, ids);
+         }
+         else
+         {
+            for (i = _screening.passed.begin(); i != _screening.passed.end(); i = _screening.passed.next(i))
+               _match(env, fingerprints.getStorageIndex_NoMap(_screening, _screening.passed[i]));
+         }
          profTimerStop(tfine);
       }
       env.dbgPrintf("done\n");
@@ -350,9 +486,11 @@ void MangoFastIndex::prepareSubstructure (OracleEnv &env)
    env.dbgPrintfTS("Have %d bits in query fingerprint\n", _screening.query_ones.size());
 
    _fetch_type = _SUBSTRUCTURE;
+   _dispatcher.free();
    _cur_idx = 0;
    _matched = 0;
    _unmatched = 0;
+   _prepareResultCache(env, _query_smarts ? "smarts" : "sub", _query_params.ptr());
 }
 
 void MangoFastIndex::prepareSimilarity (OracleEnv &env)
@@ -362,9 +500,19 @@ void MangoFastIndex::prepareSimilarity (OracleEnv &env)
    _context.context().fingerprints.validate(env);
    _context.context().fingerprints.screenInit(_context.similarity.getQueryFingerprint(), _screening);
    _fetch_type = _SIMILARITY;
+   _dispatcher.free();
    _cur_idx = 0;
    _matched = 0;
    _unmatched = 0;
+
+   // Similarity bounds are the part of the query
+   MangoSimilarity &similarity = _context.similarity;
+   QS_DEF(Array<char>, sim_options);
+   ArrayOutput sim_options_out(sim_options);
+   sim_options_out.printf("%g %g %d %d %s", similarity.bottom, similarity.top,
+      similarity.include_bottom ? 1 : 0, similarity.include_top ? 1 : 0, _query_params.ptr());
+   sim_options_out.writeChar(0);
+   _prepareResultCache(env, "sim", sim_options.ptr());
 }
 
 void MangoFastIndex::prepareTautomerSubstructure (OracleEnv &env)
@@ -374,13 +522,31 @@ void MangoFastIndex::prepareTautomerSubstructure (OracleEnv &env)
    _context.context().fingerprints.validate(env);
    _context.context().fingerprints.screenInit(_context.tautomer.getQueryFingerprint(), _screening);
    _fetch_type = _TAUTOMER_SUBSTRUCTURE;
+   _dispatcher.free();
    _cur_idx = 0;
    _matched = 0;
    _unmatched = 0;
+   _prepareResultCache(env, "taut", _query_params.ptr());
+}
+
+void MangoFastIndex::_prepareResultCache (OracleEnv &env, const char *search_type, const char *options)
+{
+   BingoStorage &storage = _context.context().context().storage;
+
+   BingoFetchEngine::_initResultCache(storage.getID(), storage.getAge(), search_type, _query_buf, options);
+   if (_cache_hit)
+      env.dbgPrintfTS("%d hits are taken from the search result cache\n", _cache_hits_count);
 }
 
 float MangoFastIndex::calcSelectivity (OracleEnv &env, int total_count)
 {
+   if (_cache_hit)
+   {
+      if (total_count <= 0)
+         return 0;
+      return (float)_cache_hits_count / total_count;
+   }
+
    if (_matched + _unmatched == 0)
       throw Error("calcSelectivity() called before fetch()");
 
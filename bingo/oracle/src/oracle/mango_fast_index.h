@@ -20,10 +20,12 @@
 #include "molecule/molecule.h"
 #include "oracle/bingo_fetch_engine.h"
 #include "oracle/bingo_fingerprints.h"
+#include "base_cpp/auto_ptr.h"
 
 using namespace indigo;
 
 class MangoFetchContext;
+class MangoFastIndexDispatcher;
 
 class MangoFastIndex : public BingoFetchEngine
 {
@@ -35,6 +37,10 @@ public:
    void prepareSimilarity           (OracleEnv &env);
    void prepareTautomerSubstructure (OracleEnv &env);
 
+   // Query and its parameters are kept to setup the matchers
+   // of the worker threads for the parallel fetch
+   void setQuery (const Array<char> &query_buf, const char *params, bool smarts);
+
    virtual void fetch (OracleEnv &env, int maxrows);
    virtual bool end ();
    virtual float calcSelectivity (OracleEnv &env, int total_count);
@@ -42,10 +48,20 @@ public:
 
    virtual bool getLastRowid (OraRowidText &id);
 
+   enum
+   {
+      // Number of candidates verified by one worker command
+      PARALLEL_BATCH_SIZE = 50,
+      // Maximum number of candidates verified by one parallel run
+      PARALLEL_CHUNK_SIZE = 2000
+   };
+
    DECL_ERROR;
 
 protected:
-   
+   friend class MangoFastIndexDispatcher;
+   friend class MangoFastIndexCommand;
+
    enum
    {
       _SUBSTRUCTURE = 1,
@@ -65,14 +81,27 @@ protected:
 
    BingoFingerprints::Screening _screening;
 
+   Array<char> _query_buf;
+   Array<char> _query_params;
+   bool        _query_smarts;
+
+   AutoPtr<MangoFastIndexDispatcher> _dispatcher;
+
    bool _loadCoords (OracleEnv &env, const char *rowid, Array<char> &coords);
    void _match (OracleEnv &env, int idx);
    int  _countOnes (int idx);
 
+   bool _isParallel ();
+   void _matchParallel (OracleEnv &env, const Array<int> &ids);
+   void _addMatched (int idx);
+
    void _decompressRowid (const Array<char> &stored, OraRowidText &rid);
 
    void _fetchSubstructure (OracleEnv &env, int maxrows);
    void _fetchSimilarity (OracleEnv &env, int maxrows);
+   void _fetchCached (int maxrows);
+
+   void _prepareResultCache (OracleEnv &env, const char *search_type, const char *options);
 
 private:
    MangoFastIndex (const MangoFastIndex &); // noimplicitcopy
@@ -0,0 +1,189 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include "oracle/mango_fast_index_parallel.h"
+
+#include "base_cpp/scanner.h"
+#include "oracle/mango_fast_index.h"
+#include "oracle/mango_fetch_context.h"
+#include "oracle/bingo_oracle_context.h"
+
+//
+// MangoFastIndexDispatcher
+//
+
+MangoFastIndexDispatcher::MangoFastIndexDispatcher (MangoFastIndex &fast_index) :
+   OsCommandDispatcher(OsCommandDispatcher::HANDLING_ORDER_SERIAL, false),
+   _fast_index(fast_index)
+{
+   _ids = 0;
+   _next_id = 0;
+}
+
+void MangoFastIndexDispatcher::setup (const Array<int> &ids)
+{
+   _ids = &ids;
+   _next_id = 0;
+}
+
+OsCommand * MangoFastIndexDispatcher::_allocateCommand ()
+{
+   return new MangoFastIndexCommand(_fast_index);
+}
+
+OsCommandResult * MangoFastIndexDispatcher::_allocateResult ()
+{
+   return new MangoFastIndexResult;
+}
+
+bool MangoFastIndexDispatcher::_setupCommand (OsCommand &command)
+{
+   if (_ids == 0 || _next_id >= _ids->size())
+      return false;
+
+   MangoFastIndexCommand &cmd = (MangoFastIndexCommand &)command;
+
+   int count = __min(_ids->size() - _next_id, (int)MangoFastIndex::PARALLEL_BATCH_SIZE);
+
+   cmd.ids.copy(_ids->ptr() + _next_id, count);
+   _next_id += count;
+   return true;
+}
+
+void MangoFastIndexDispatcher::_handleResult (OsCommandResult &result)
+{
+   MangoFastIndexResult &res = (MangoFastIndexResult &)result;
+
+   for (int i = 0; i < res.matched_ids.size(); i++)
+      _fast_index._addMatched(res.matched_ids[i]);
+
+   _fast_index._unmatched += res.unmatched;
+   if (res.last_id >= 0)
+      _fast_index._last_id = res.last_id;
+}
+
+//
+// MangoFastIndexCommand
+//
+
+MangoFastIndexCommand::MangoFastIndexCommand (MangoFastIndex &fast_index) :
+   _fast_index(fast_index)
+{
+}
+
+void MangoFastIndexCommand::clear ()
+{
+   ids.clear();
+   OsCommand::clear();
+}
+
+void MangoFastIndexCommand::_prepareMatchers ()
+{
+   MangoFetchContext &context = _fast_index._context;
+   BingoContext &bingo_context = context.context().context();
+   const Array<char> &query_buf = _fast_index._query_buf;
+   const char *params = _fast_index._query_params.ptr();
+
+   if (_fast_index._fetch_type == MangoFastIndex::_SUBSTRUCTURE)
+   {
+      if (_substructure.get() != 0)
+         return;
+
+      _substructure.create(bingo_context);
+
+      if (_fast_index._query_smarts)
+         _substructure->loadSMARTS(query_buf);
+      else
+      {
+         _substructure->parse(params);
+         _substructure->loadQuery(query_buf);
+      }
+   }
+   else if (_fast_index._fetch_type == MangoFastIndex::_TAUTOMER_SUBSTRUCTURE)
+   {
+      if (_tautomer.get() != 0)
+         return;
+
+      _tautomer.create(bingo_context);
+      _tautomer->parseSub(params);
+      _tautomer->loadQuery(query_buf);
+   }
+   else // _fetch_type == _SIMILARITY
+   {
+      if (_similarity.get() != 0)
+         return;
+
+      _similarity.create(bingo_context);
+      _similarity->setMetrics(params);
+      _similarity->loadQuery(query_buf);
+
+      _similarity->include_bottom = context.similarity.include_bottom;
+      _similarity->include_top = context.similarity.include_top;
+      _similarity->bottom = context.similarity.bottom;
+      _similarity->top = context.similarity.top;
+   }
+}
+
+bool MangoFastIndexCommand::_matchBinary (Scanner &scanner)
+{
+   if (_fast_index._fetch_type == MangoFastIndex::_SUBSTRUCTURE)
+      return _substructure->matchBinary(scanner, 0);
+   else if (_fast_index._fetch_type == MangoFastIndex::_TAUTOMER_SUBSTRUCTURE)
+      return _tautomer->matchBinary(scanner);
+   else // _fetch_type == _SIMILARITY
+      return _similarity->matchBinary(scanner);
+}
+
+void MangoFastIndexCommand::execute (OsCommandResult &result)
+{
+   MangoFastIndexResult &res = (MangoFastIndexResult &)result;
+
+   _prepareMatchers();
+
+   BingoStorage &storage = _fast_index._context.context().context().storage;
+   QS_DEF(Array<char>, stored);
+
+   for (int i = 0; i < ids.size(); i++)
+   {
+      res.last_id = ids[i];
+
+      // storage blocks are in shared memory and are not modified while fetching
+      storage.get(ids[i], stored);
+
+      if (stored[0] != 0)
+         continue; // molecule was removed from index
+
+      BufferScanner scanner(stored);
+
+      scanner.skip(1); // skip the deletion mark
+      scanner.skip(scanner.readByte()); // skip the compessed rowid
+      scanner.skip(2); // skip 'ord' bits count
+
+      if (_matchBinary(scanner))
+         res.matched_ids.push(ids[i]);
+      else
+         res.unmatched++;
+   }
+}
+
+//
+// MangoFastIndexResult
+//
+
+void MangoFastIndexResult::clear ()
+{
+   matched_ids.clear();
+   unmatched = 0;
+   last_id = -1;
+}
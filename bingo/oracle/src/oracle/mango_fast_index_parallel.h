@@ -0,0 +1,85 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __mango_fast_index_parallel_h__
+#define __mango_fast_index_parallel_h__
+
+#include "base_cpp/os_thread_wrapper.h"
+#include "base_cpp/auto_ptr.h"
+#include "core/mango_matchers.h"
+
+using namespace indigo;
+
+class MangoFastIndex;
+
+//
+// Classes for parallelized verification of the screened candidates.
+// Molecules are read from the shared-memory storage by the worker
+// threads, and the results are handled in the order of candidates.
+//
+
+class MangoFastIndexDispatcher : public OsCommandDispatcher
+{
+public:
+   MangoFastIndexDispatcher (MangoFastIndex &fast_index);
+
+   // Storage indices of the candidates for the next run
+   void setup (const Array<int> &ids);
+
+protected:
+   virtual OsCommand*         _allocateCommand ();
+   virtual OsCommandResult*   _allocateResult  ();
+
+   virtual bool _setupCommand (OsCommand &command);
+   virtual void _handleResult (OsCommandResult &result);
+
+   MangoFastIndex &_fast_index;
+   const Array<int> *_ids;
+   int _next_id;
+};
+
+class MangoFastIndexCommand : public OsCommand
+{
+public:
+   MangoFastIndexCommand (MangoFastIndex &fast_index);
+
+   virtual void execute (OsCommandResult &result);
+   virtual void clear ();
+
+   Array<int> ids;
+
+private:
+   MangoFastIndex &_fast_index;
+
+   // Commands are reused by the dispatcher, so each command
+   // loads the query into its own matchers only once
+   AutoPtr<MangoSubstructure> _substructure;
+   AutoPtr<MangoTautomer>     _tautomer;
+   AutoPtr<MangoSimilarity>   _similarity;
+
+   void _prepareMatchers ();
+   bool _matchBinary (Scanner &scanner);
+};
+
+class MangoFastIndexResult : public OsCommandResult
+{
+public:
+   virtual void clear ();
+
+   Array<int> matched_ids;
+   int unmatched;
+   int last_id;
+};
+
+#endif // __mango_fast_index_parallel_h__
@@ -27,6 +27,7 @@
 #include "oracle/ora_wrap.h"
 #include "oracle/ora_logger.h"
 #include "core/mango_matchers.h"
+#include "core/mango_descriptor_filter.h"
 #include "oracle/mango_oracle.h"
 #include "oracle/bingo_oracle_context.h"
 #include "molecule/smiles_loader.h"
@@ -149,6 +150,8 @@ static OCINumber * _mangoCommon (OCIExtProcContext *ctx, int context_id,
          throw BingoError("Null query given");
       if (params_ind != OCI_IND_NOTNULL)
          params = 0;
+      if (MangoDescriptorFilter::hasConditions(params))
+         throw BingoError("descriptor conditions are supported by Bingo PostgreSQL only: '%s'", params);
       
       if (target_ind == OCI_IND_NOTNULL)
       {
@@ -18,6 +18,7 @@
 #include "oracle/ora_wrap.h"
 #include "oracle/ora_logger.h"
 #include "core/mango_matchers.h"
+#include "core/mango_descriptor_filter.h"
 #include "oracle/mango_fetch_context.h"
 #include "oracle/bingo_oracle_context.h"
 #include "oracle/mango_oracle.h"
@@ -33,11 +34,15 @@ static void _mangoIndexStart (OracleEnv &env, MangoFetchContext &context,
    MangoShadowFetch &shadow_fetch = context.shadow_fetch.ref();
    MangoFastIndex   &fast_index   = context.fast_index.ref();
 
+   if (MangoDescriptorFilter::hasConditions(params))
+      throw BingoError("descriptor conditions are supported by Bingo PostgreSQL only: '%s'", params);
+
    if (strcasecmp(oper, "SUB") == 0)
    {
       if (context.substructure.parse(params))
       {
          context.substructure.loadQuery(query_buf);
+         fast_index.setQuery(query_buf, params, false);
 
          int right = bingoGetExactRightPart(env, p_strt, p_stop, flags);
 
@@ -55,6 +60,7 @@ static void _mangoIndexStart (OracleEnv &env, MangoFetchContext &context,
       else if (context.tautomer.parseSub(params))
       {
          context.tautomer.loadQuery(query_buf);
+         fast_index.setQuery(query_buf, params, false);
 
          int right = bingoGetExactRightPart(env, p_strt, p_stop, flags);
 
@@ -75,6 +81,7 @@ static void _mangoIndexStart (OracleEnv &env, MangoFetchContext &context,
    else if (strcasecmp(oper, "SMARTS") == 0)
    {
       context.substructure.loadSMARTS(query_buf);
+      fast_index.setQuery(query_buf, params, true);
 
       int right = bingoGetExactRightPart(env, p_strt, p_stop, flags);
       
@@ -116,6 +123,7 @@ static void _mangoIndexStart (OracleEnv &env, MangoFetchContext &context,
    {
       context.similarity.setMetrics(params);
       context.similarity.loadQuery(query_buf);
+      fast_index.setQuery(query_buf, params, false);
 
       float bottom = -0.1f;
       float top = 1.1f;
@@ -14,6 +14,7 @@
 
 #include "oracle/ringo_fast_index.h"
 
+#include "base_cpp/output.h"
 #include "base_cpp/profiling.h"
 #include "core/ringo_matchers.h"
 #include "oracle/ringo_oracle.h"
@@ -28,6 +29,7 @@ _context(context)
 {
    _fetch_type = 0;
    _last_id = -1;
+   _query_smarts = false;
 }
 
 RingoFastIndex::~RingoFastIndex ()
@@ -50,6 +52,19 @@ void RingoFastIndex::_decompressRowid (const Array<char> &stored, OraRowidText &
    rid.ptr()[18] = 0;
 }
 
+void RingoFastIndex::setQuery (const Array<char> &query_buf, const char *params, bool smarts)
+{
+   _query_buf.copy(query_buf);
+   if (params != 0)
+      _query_params.readString(params, true);
+   else
+   {
+      _query_params.clear();
+      _query_params.push(0);
+   }
+   _query_smarts = smarts;
+}
+
 void RingoFastIndex::_match (OracleEnv &env, int idx)
 {
    _last_id = idx;
@@ -66,9 +81,15 @@ void RingoFastIndex::_match (OracleEnv &env, int idx)
 
    scanner.skip(1); // skip the deletion mark
    scanner.skip(scanner.readByte()); // skip the compessed rowid
+   scanner.skip(2); // skip 'sim' bits count
    
    profTimerStart(tall, "match");
-   bool res = _context.substructure.matchBinary(scanner);
+   bool res;
+
+   if (_fetch_type == _SUBSTRUCTURE)
+      res = _context.substructure.matchBinary(scanner);
+   else // _fetch_type == _SIMILARITY
+      res = _context.similarity.matchBinary(scanner);
    profTimerStop(tall);
    
    if (res)
@@ -76,6 +97,7 @@ void RingoFastIndex::_match (OracleEnv &env, int idx)
       OraRowidText & rid = matched.at(matched.add());
 
       _decompressRowid(stored, rid);
+      _recordCachedHit(idx);
       profIncTimer("match.found", profTimerGetTime(tall));
       _matched++;
    }
@@ -94,7 +116,9 @@ void RingoFastIndex::fetch (OracleEnv &env, int max_matches)
    
    BingoFingerprints &fingerprints = _context.context().fingerprints;
    
-   if (_fetch_type == _SUBSTRUCTURE)
+   if (_cache_hit)
+      _fetchCached(max_matches);
+   else if (_fetch_type == _SUBSTRUCTURE)
    {
       if (fingerprints.ableToScreen(_screening))
       {
@@ -118,6 +142,7 @@ void RingoFastIndex::fetch (OracleEnv &env, int max_matches)
             else
             {
                env.dbgPrintfTS("screening ended\n");
+               _putResultCache();
                break;
             }
 
@@ -128,16 +153,178 @@ void RingoFastIndex::fetch (OracleEnv &env, int max_matches)
       }
       else
       {
-         while (matched.size() < max_matches && _cur_idx < _context.context().context().storage.count())
+         int count = _context.context().context().storage.count();
+
+         while (matched.size() < max_matches && _cur_idx < count)
             _match(env, _cur_idx++);
          
          env.dbgPrintfTS("%d reactions matched\n", matched.size());
+         if (_cur_idx >= count)
+            _putResultCache();
       }
    }
+   else if (_fetch_type == _SIMILARITY)
+      _fetchSimilarity(env, max_matches);
    else
       throw Error("unexpected fetch type: %d", _fetch_type);
 }
 
+void RingoFastIndex::_fetchCached (int max_matches)
+{
+   BingoStorage &storage = _context.context().context().storage;
+   QS_DEF(Array<char>, stored);
+   int idx;
+
+   profTimerStart(tcached, "fetch.cached");
+   while (matched.size() < max_matches && _nextCachedHit(idx))
+   {
+      _last_id = idx;
+      storage.get(idx, stored);
+
+      OraRowidText &rid = matched.at(matched.add());
+
+      _decompressRowid(stored, rid);
+      _matched++;
+   }
+}
+
+void RingoFastIndex::_fetchSimilarity (OracleEnv &env, int max_matches)
+{
+   BingoFingerprints &fingerprints = _context.context().fingerprints;
+   int i;
+
+   if (!fingerprints.ableToScreen(_screening))
+   {
+      env.dbgPrintfTS("no bits in query fingerprint, can not do similarity search\n");
+      return;
+   }
+
+   profTimerStart(tsimfetch, "sim.fetch");
+   while (matched.size() < max_matches)
+   {
+      if (!fingerprints.countOnes_Init(env, _screening))
+      {
+         env.dbgPrintfTS("screening ended\n");
+         break;
+      }
+
+      BingoStorage &storage = _context.context().context().storage;
+
+      QS_DEF(Array<int>, max_common_ones);
+      QS_DEF(Array<int>, min_common_ones);
+      QS_DEF(Array<int>, target_ones);
+      QS_DEF(Array<char>, stored);
+
+      max_common_ones.clear_resize(_screening.block->used);
+      min_common_ones.clear_resize(_screening.block->used);
+      target_ones.clear_resize(_screening.block->used);
+
+      for (i = 0; i < _screening.block->used; i++)
+      {
+         storage.get(fingerprints.getStorageIndex_NoMap(_screening, i), stored);
+
+         BufferScanner scanner(stored);
+
+         scanner.skip(1); // skip the deletion mark
+         scanner.skip(scanner.readByte()); // skip the compessed rowid
+         target_ones[i] = scanner.readBinaryWord();
+         max_common_ones[i] = _context.similarity.getUpperBound(target_ones[i]);
+         min_common_ones[i] = _context.similarity.getLowerBound(target_ones[i]);
+      }
+
+      bool first = true;
+      bool entire = false;
+
+      _screening.passed.clear();
+
+      while (true)
+      {
+         if (!fingerprints.countOnes_Next(env, _screening))
+         {
+            env.dbgPrintf("read all %d bits, writing %d results... ",
+               _screening.query_ones.size(), _screening.passed.size());
+
+            entire = true;
+            break;
+         }
+
+         if (first)
+         {
+            first = false;
+            for (i = 0; i < _screening.block->used; i++)
+            {
+               int min_possible_ones = _screening.one_counters[i];
+               int max_possible_ones = _screening.one_counters[i] +
+                            _screening.query_ones.size() - _screening.query_bit_idx;
+
+               if (min_possible_ones <= max_common_ones[i] &&
+                   max_possible_ones >= min_common_ones[i])
+                  _screening.passed.add(i);
+            }
+         }
+         else
+         {
+            int j;
+
+            for (j = _screening.passed.begin(); j != _screening.passed.end(); )
+            {
+               i = _screening.passed[j];
+
+               int min_possible_ones = _screening.one_counters[i];
+               int max_possible_ones = _screening.one_counters[i] +
+                            _screening.query_ones.size() - _screening.query_bit_idx;
+
+               int next_j = _screening.passed.next(j);
+
+               if (min_possible_ones > max_common_ones[i] ||
+                   max_possible_ones < min_common_ones[i])
+                  _screening.passed.remove(j);
+
+               j = next_j;
+            }
+         }
+
+         if (_screening.passed.size() <= _context.context().context().sim_screening_pass_mark)
+         { 
+            env.dbgPrintfTS("stopping reading fingerprints on bit %d/%d; have %d reactions to check...  ",
+               _screening.query_bit_idx, _screening.query_ones.size(), _screening.passed.size());
+            _unmatched += _screening.block->used - _screening.passed.size();
+            break;
+         }
+      }
+
+      if (entire)
+      {
+         for (i = 0; i < _screening.block->used; i++)
+         {
+            if (_context.similarity.match(target_ones[i], _screening.one_counters[i]))
+            {
+               OraRowidText &rid = matched.at(matched.add());
+               int idx = fingerprints.getStorageIndex_NoMap(_screening, i);
+
+               storage.get(idx, stored);
+               _decompressRowid(stored, rid);
+               _recordCachedHit(idx);
+              _matched++;
+            }
+            else
+               _unmatched++;
+         }
+      }
+      else if (_screening.passed.size() > 0)
+      {
+         profTimerStart(tfine, "sim.fetch.fine");
+         for (i = _screening.passed.begin(); i != _screening.passed.end(); i = _screening.passed.next(i))
+            _match(env, fingerprints.getStorageIndex_NoMap(_screening, _screening.passed[i]));
+         profTimerStop(tfine);
+      }
+      env.dbgPrintf("done\n");
+
+      fingerprints.countOnes_End(env, _screening);
+   }
+   profTimerStop(tsimfetch);
+}
+
 void RingoFastIndex::prepareSubstructure (OracleEnv &env)
 {
    env.dbgPrintf("preparing fastindex for reaction substructure search\n");
@@ -149,16 +336,54 @@ void RingoFastIndex::prepareSubstructure (OracleEnv &env)
    _cur_idx = 0;
    _matched = 0;
    _unmatched = 0;
+   _prepareResultCache(env, _query_smarts ? "rsmarts" : "rsub", _query_params.ptr());
+}
+
+void RingoFastIndex::prepareSimilarity (OracleEnv &env)
+{
+   env.dbgPrintf("preparing fastindex for reaction similarity search\n");
+
+   _context.context().context().storage.validate(env);
+   _context.context().fingerprints.validate(env);
+   _context.context().fingerprints.screenInit(_context.similarity.getQueryFingerprint(), _screening);
+   _fetch_type = _SIMILARITY;
+   _cur_idx = 0;
+   _matched = 0;
+   _unmatched = 0;
+
+   // Similarity bounds are the part of the query
+   RingoSimilarity &similarity = _context.similarity;
+   QS_DEF(Array<char>, sim_options);
+   ArrayOutput sim_options_out(sim_options);
+   sim_options_out.printf("%g %g %s", similarity.bottom, similarity.top, _query_params.ptr());
+   sim_options_out.writeChar(0);
+   _prepareResultCache(env, "rsim", sim_options.ptr());
+}
+
+void RingoFastIndex::_prepareResultCache (OracleEnv &env, const char *search_type, const char *options)
+{
+   BingoStorage &storage = _context.context().context().storage;
+
+   _initResultCache(storage.getID(), storage.getAge(), search_type, _query_buf, options);
+   if (_cache_hit)
+      env.dbgPrintfTS("%d hits are taken from the search result cache\n", _cache_hits_count);
 }
 
 float RingoFastIndex::calcSelectivity (OracleEnv &env, int total_count)
 {
+   if (_cache_hit)
+   {
+      if (total_count <= 0)
+         return 0;
+      return (float)_cache_hits_count / total_count;
+   }
+
    if (_matched + _unmatched == 0)
       throw Error("calcSelectivity() called before fetch()");
 
    BingoFingerprints &fingerprints = _context.context().fingerprints;
 
-   if (fingerprints.ableToScreen(_screening))
+   if (_fetch_type == _SUBSTRUCTURE && fingerprints.ableToScreen(_screening))
    {
       return (float)_matched * _screening.items_passed / (_screening.items_read * (_matched + _unmatched));
    }
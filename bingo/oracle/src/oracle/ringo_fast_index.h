@@ -29,6 +29,10 @@ public:
    virtual ~RingoFastIndex ();
 
    void prepareSubstructure         (OracleEnv &env);
+   void prepareSimilarity           (OracleEnv &env);
+
+   // Query and its parameters are kept for the search result cache
+   void setQuery (const Array<char> &query_buf, const char *params, bool smarts);
 
    virtual void fetch (OracleEnv &env, int maxrows);
    virtual bool end ();
@@ -44,7 +48,8 @@ public:
 protected:
    enum
    {
-      _SUBSTRUCTURE = 1
+      _SUBSTRUCTURE = 1,
+      _SIMILARITY = 2
    };
 
    RingoFetchContext &_context;
@@ -58,7 +63,14 @@ protected:
 
    BingoFingerprints::Screening _screening;
 
+   Array<char> _query_buf;
+   Array<char> _query_params;
+   bool        _query_smarts;
+
    void _match (OracleEnv &env, int idx);
+   void _fetchSimilarity (OracleEnv &env, int max_matches);
+   void _fetchCached (int max_matches);
+   void _prepareResultCache (OracleEnv &env, const char *search_type, const char *options);
    void _decompressRowid (const Array<char> &stored, OraRowidText &rid);
 private:
    RingoFastIndex (const RingoFastIndex &); // noimplicitcopy
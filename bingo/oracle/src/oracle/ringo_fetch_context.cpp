@@ -26,6 +26,7 @@ RingoFetchContext::RingoFetchContext (int id_, RingoOracleContext &context,
                                       const Array<char> &query_id) :
 substructure(context.context()),
 exact(context.context()),
+similarity(context.context()),
 _context(context)
 {
    id = id_;
@@ -40,6 +40,7 @@ public:
 
    RingoSubstructure substructure;
    RingoExact        exact;
+   RingoSimilarity   similarity;
 
    int         id;
    int         context_id;
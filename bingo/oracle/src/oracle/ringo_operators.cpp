@@ -345,3 +345,66 @@ ORAEXT OCINumber * oraRingoExact (OCIExtProcContext *ctx, int context_id,
 
    return result;
 }
+
+static OCINumber * _ringoSim (OracleEnv &env, RingoOracleContext &context,
+                              const Array<char> &query_buf,
+                              const Array<char> &target_buf, const char *params)
+{
+   RingoSimilarity &instance = context.similarity;
+
+   instance.setMetrics(params);
+   instance.loadQuery(query_buf);
+
+   TRY_READ_TARGET_RXN
+   {
+      float result = instance.calc(target_buf);
+
+      return OracleExtproc::createDouble(env, (double)result);
+   }
+   CATCH_READ_TARGET_RXN(return 0)
+}
+
+ORAEXT OCINumber * oraRingoSim (OCIExtProcContext *ctx, int context_id,
+    OCILobLocator *target_loc, short target_ind,
+    OCILobLocator *query_loc,  short query_ind,
+    const char    *params,     short params_ind,
+    short *return_ind)
+{
+   OCINumber *result = NULL;
+
+   ORABLOCK_BEGIN
+   {
+      *return_ind = OCI_IND_NULL;
+
+      OracleEnv env(ctx, logger);
+
+      if (query_ind  != OCI_IND_NOTNULL)
+         throw BingoError("Null query given");
+      if (target_ind != OCI_IND_NOTNULL)
+         throw BingoError("Null target given");
+      if (params_ind != OCI_IND_NOTNULL)
+         params = 0;
+
+      RingoOracleContext &context = RingoOracleContext::get(env, context_id, false);
+
+      QS_DEF(Array<char>, query_buf);
+      QS_DEF(Array<char>, target_buf);
+
+      OracleLOB target_lob(env, target_loc);
+      OracleLOB query_lob(env, query_loc);
+
+      target_lob.readAll(target_buf, false);
+      query_lob.readAll(query_buf, false);
+
+      result = _ringoSim(env, context, query_buf, target_buf, params);
+
+      if (result == 0)
+         // This is needed for Oracle 9. Returning NULL drops the extproc.
+         result = OracleExtproc::createInt(env, 0);
+      else
+         *return_ind = OCI_IND_NOTNULL;
+   }
+   ORABLOCK_END
+
+   return result;
+}
@@ -37,6 +37,22 @@ BingoOracleContext & RingoOracleContext::context ()
    return (BingoOracleContext &)_context;
 }
 
+void RingoOracleContext::checkIndexVersion (OracleEnv &env)
+{
+   int version = 0;
+
+   context().configGetInt(env, "RINGO_INDEX_VERSION", version);
+
+   if (version != RingoIndex::INDEX_VERSION)
+      throw BingoError("reaction index was built by the other bingo version "
+              "(index version %d, expected %d), please rebuild it", version, RingoIndex::INDEX_VERSION);
+}
+
+void RingoOracleContext::saveIndexVersion (OracleEnv &env)
+{
+   context().configSetInt(env, "RINGO_INDEX_VERSION", RingoIndex::INDEX_VERSION);
+}
+
 RingoOracleContext & RingoOracleContext::get (OracleEnv &env, int id, bool lock)
 {
    bool config_reloaded;
@@ -58,7 +74,7 @@ RingoOracleContext & RingoOracleContext::get (OracleEnv &env, int id, bool lock)
 
    if (config_reloaded)
    {
-      roc->fingerprints.init(context, context.fp_parameters.fingerprintSizeExtOrdSim() * 2);
+      roc->fingerprints.init(context, RingoIndex::getFingerprintSize(context.fp_parameters));
 
       roc->ringoAAM.treat_x_as_pseudoatom = context.treat_x_as_pseudoatom;
       roc->substructure.treat_x_as_pseudoatom = context.treat_x_as_pseudoatom;
@@ -41,6 +41,10 @@ public:
    BingoFingerprints fingerprints;
 
    static RingoOracleContext & get (OracleEnv &env, int id, bool lock);
+
+   // Throws an error if the index was built with the other record layout
+   void checkIndexVersion (OracleEnv &env);
+   void saveIndexVersion (OracleEnv &env);
 };
 
 extern const char *bad_reaction_warning;
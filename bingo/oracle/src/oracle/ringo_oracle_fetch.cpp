@@ -35,6 +35,7 @@ static void _ringoIndexStart (OracleEnv &env, RingoFetchContext &context,
          throw BingoError("can not parse parameters: %s", params);
       
       context.substructure.loadQuery(query_buf);
+      fast_index.setQuery(query_buf, params, false);
 
       int right = bingoGetExactRightPart(env, p_strt, p_stop, 64);
 
@@ -52,6 +53,7 @@ static void _ringoIndexStart (OracleEnv &env, RingoFetchContext &context,
    else if (strcasecmp(oper, "RSMARTS") == 0)
    {
       context.substructure.loadSMARTS(query_buf);
+      fast_index.setQuery(query_buf, params, true);
 
       int right = bingoGetExactRightPart(env, p_strt, p_stop, 64);
 
@@ -76,6 +78,33 @@ static void _ringoIndexStart (OracleEnv &env, RingoFetchContext &context,
       shadow_fetch.prepareExact(env, right);
       context.fetch_engine = &shadow_fetch;
    }
+   else if (strcasecmp(oper, "RSIM") == 0)
+   {
+      context.similarity.setMetrics(params);
+      context.similarity.loadQuery(query_buf);
+      fast_index.setQuery(query_buf, params, false);
+
+      float bottom = -0.1f;
+      float top = 1.1f;
+
+      if (p_strt == 0 && p_stop == 0)
+         throw BingoError("no bounds for similarity search");
+
+      if (p_strt != 0)
+         bottom = OracleUtil::numberToFloat(env, p_strt);
+      if (p_stop != 0)
+         top = OracleUtil::numberToFloat(env, p_stop);
+
+      // the comparison flags are not passed for reactions,
+      // so both bounds are inclusive
+      context.similarity.include_bottom = true;
+      context.similarity.include_top = true;
+      context.similarity.bottom = bottom;
+      context.similarity.top = top;
+
+      fast_index.prepareSimilarity(env);
+      context.fetch_engine = &fast_index;
+   }
    else
       throw BingoError("unknown operator: %s", oper);
 }
@@ -115,6 +144,9 @@ ORAEXT int oraRingoIndexStart (OCIExtProcContext *ctx,
       bingoBuildQueryID(env, oper, query_buf, p_strt, p_stop, 0, params, query_id);
 
       RingoOracleContext &context = RingoOracleContext::get(env, context_id, false);
+
+      context.checkIndexVersion(env);
+
       RingoFetchContext *fetch_context = RingoFetchContext::findFresh(context_id, query_id);
 
       if (fetch_context == 0)
@@ -217,6 +249,8 @@ ORAEXT OCINumber * oraRingoIndexSelectivity (OCIExtProcContext *ctx, int context
 
       RingoOracleContext &context = RingoOracleContext::get(env, context_id, false);
 
+      context.checkIndexVersion(env);
+
       QS_DEF(Array<char>, query_id);
       QS_DEF(Array<char>, query_buf);
       OracleLOB query_lob(env, query_loc);
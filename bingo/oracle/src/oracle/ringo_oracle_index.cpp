@@ -213,6 +213,7 @@ ORAEXT void oraRingoCreateIndex (OCIExtProcContext *ctx,
       storage.finish(env);
       context.context().saveCmfDict(env);
       context.context().saveRidDict(env);
+      context.saveIndexVersion(env);
       OracleStatement::executeSingle(env, "COMMIT");
       RingoFetchContext::removeByContextID(context_id);
       RingoContext::remove(context_id);
@@ -281,6 +282,8 @@ ORAEXT void oraRingoIndexInsert (OCIExtProcContext *ctx, int context_id,
       
       RingoOracleContext &context = RingoOracleContext::get(env, context_id, true);
 
+      context.checkIndexVersion(env);
+
       env.dbgPrintf("inserting reaction with rowid %s\n", rowid);
       
       QS_DEF(RingoIndex, index);
@@ -22,6 +22,7 @@ extern "C" {
 #include "base_cpp/output.h"
 #include "base_cpp/tlscont.h"
 #include "bingo_pg_cursor.h"
+#include "bingo_pg_bulk_insert.h"
 
 
 extern "C" {
@@ -57,6 +58,9 @@ static void checkImportEmpty(Datum text_datum, BingoPgText& text) {
 
 class BingoImportHandler : public BingoPgCommon::BingoSessionHandler {
 public:
+   enum {
+      BULK_BATCH_SIZE = 1000
+   };
    class ImportColumn {
    public:
       ImportColumn() {}
@@ -161,10 +165,15 @@ public:
    };
    
 public:
-   BingoImportHandler(unsigned int func_id):BingoSessionHandler(func_id) {
+   BingoImportHandler(unsigned int func_id):BingoSessionHandler(func_id), _queryPlan(0) {
       SPI_connect();
    }
    virtual ~BingoImportHandler() {
+      /*
+       * Plan is freed on errors as well
+       */
+      if (_queryPlan != 0)
+         SPI_freeplan(_queryPlan);
       SPI_finish();
    }
    
@@ -307,6 +316,20 @@ public:
       }
       query_string.printf(")");
       query_string.writeChar(0);
+      /*
+       * Prepare the query plan once for all the structures
+       */
+      BINGO_PG_TRY
+      {
+         _queryPlan = SPI_prepare(query_str.ptr(), q_oids.size(), q_oids.ptr());
+      }
+      BINGO_PG_HANDLE(throw BingoPgError("can not import all the structures: SQL error: %s", message));
+      if (_queryPlan == 0)
+         throw BingoPgError("can not import all the structures: can not prepare a query: %s", SPI_result_code_string(SPI_result));
+      /*
+       * Bingo indexes are updated by batches after the table rows are inserted
+       */
+      BingoPgBulkInsert bulk_insert;
 
       int debug_idx = 0;
       /*
@@ -346,12 +369,14 @@ public:
             /*
              * Execute query
              */
-            spi_success = SPI_execute_with_args(query_str.ptr(), q_values.size(), q_oids.ptr(), q_values.ptr(), q_nulls.ptr(), false, 1);
+            spi_success = SPI_execute_plan(_queryPlan, q_values.ptr(), q_nulls.ptr(), false, 1);
             if (spi_success < 0)
                elog(WARNING, "can not insert a structure into a table: %s", SPI_result_code_string(spi_success));
          }
          BINGO_PG_HANDLE(throw BingoPgError("can not import all the structures: SQL error: %s", message));
 
+         if(debug_idx % BULK_BATCH_SIZE == 0)
+            bulk_insert.flush();
          if(debug_idx % 1000 == 0)
             elog(NOTICE, "bingo.import: %d structures processed", debug_idx);
          /*
@@ -359,7 +384,11 @@ public:
           */
          refresh();
       }
+      bulk_insert.flush();
+      refresh();
 
+      SPI_freeplan(_queryPlan);
+      _queryPlan = 0;
    }
 protected:
    int bingo_res;
@@ -371,6 +400,8 @@ protected:
    
 private:
    BingoImportHandler(const BingoImportHandler&); //no implicit copy
+
+   SPIPlanPtr _queryPlan;
 };
 
 class BingoImportSdfHandler : public BingoImportHandler {
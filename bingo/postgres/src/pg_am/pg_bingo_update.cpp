@@ -5,12 +5,14 @@ extern "C" {
 #include "utils/rel.h"
 #include "catalog/index.h"
 #include "storage/bufmgr.h"
+#include "storage/lmgr.h"
 }
 
 #ifdef qsort
 #undef qsort
 #endif
 #include "bingo_pg_build.h"
+#include "bingo_pg_bulk_insert.h"
 #include "bingo_pg_common.h"
 #include "bingo_postgres.h"
 #include "bingo_pg_text.h"
@@ -47,6 +49,15 @@ bingo_insert(PG_FUNCTION_ARGS) {
 
    PG_BINGO_BEGIN
    {
+      /*
+       * Defer insertion while bulk import
+       */
+      BingoPgBulkInsert* bulk_insert = BingoPgBulkInsert::getCurrent();
+      if (bulk_insert != 0) {
+         bulk_insert->addStructure(index, ht_ctid, values[0]);
+         PG_RETURN_BOOL(true);
+      }
+
       BingoPgWrapper rel_namespace;
       const char* index_schema = rel_namespace.getRelNameSpace(index->rd_id);
       
@@ -178,6 +189,27 @@ Datum bingo_vacuumcleanup(PG_FUNCTION_ARGS) {
    if (stats == NULL) {
       PG_RETURN_POINTER(NULL);
    }
+   /*
+    * Compact sections with removed structures. Autovacuum makes it in background.
+    * Vacuum lock does not conflict with scans and inserts, while compaction
+    * moves structures and rewrites the meta page. So an exclusive lock is taken,
+    * and compaction is skipped if the index is in use, as for the heap truncation
+    */
+   if (stats->tuples_removed > 0 && !ConditionalLockRelation(rel, AccessExclusiveLock)) {
+      elog(DEBUG1, "bingo: vacuum: index is in use, sections are not compacted");
+   } else if (stats->tuples_removed > 0) {
+      PG_BINGO_BEGIN
+      {
+         BingoPgWrapper rel_namespace;
+         const char* index_schema = rel_namespace.getRelNameSpace(rel->rd_id);
+
+         BingoPgBuild build_engine(rel, 0, index_schema, false);
+         build_engine.compactSections();
+      }
+      PG_BINGO_END
+
+      UnlockRelation(rel, AccessExclusiveLock);
+   }
    /*
     * update statistics
     */
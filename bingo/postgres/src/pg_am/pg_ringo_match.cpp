@@ -29,6 +29,12 @@ PGDLLEXPORT Datum _rsmarts_internal(PG_FUNCTION_ARGS);
 PG_FUNCTION_INFO_V1(_rexact_internal);
 PGDLLEXPORT Datum _rexact_internal(PG_FUNCTION_ARGS);
 
+PG_FUNCTION_INFO_V1(_rsim_internal);
+PGDLLEXPORT Datum _rsim_internal(PG_FUNCTION_ARGS);
+
+PG_FUNCTION_INFO_V1(getreactionsimilarity);
+PGDLLEXPORT Datum getreactionsimilarity(PG_FUNCTION_ARGS);
+
 }
 
 using namespace indigo;
@@ -140,3 +146,50 @@ Datum _rexact_internal(PG_FUNCTION_ARGS) {
 
    PG_RETURN_BOOL(result>0);
 }
+
+Datum _rsim_internal(PG_FUNCTION_ARGS) {
+   float min_bound = PG_GETARG_FLOAT4(0);
+   float max_bound = PG_GETARG_FLOAT4(1);
+   Datum query_datum = PG_GETARG_DATUM(2);
+   Datum target_datum = PG_GETARG_DATUM(3);
+   Datum options_datum = PG_GETARG_DATUM(4);
+   int result = 0;
+   bool res_bool = false;
+   PG_BINGO_BEGIN
+   {
+      _RingoContextHandler bingo_context(BingoPgCommon::REACT_SIM, fcinfo->flinfo->fn_oid);
+      float react_sim = 0;
+      result = bingo_context.matchInternal(query_datum, target_datum, options_datum);
+
+      if(result < 0)
+         PG_RETURN_NULL();
+
+      if (result > 0)
+         ringoSimilarityGetScore(&react_sim);
+
+      res_bool = (react_sim <= max_bound) && (react_sim >= min_bound);
+   }
+   PG_BINGO_END
+   PG_RETURN_BOOL(res_bool);
+}
+
+Datum getreactionsimilarity(PG_FUNCTION_ARGS) {
+   Datum target_datum = PG_GETARG_DATUM(0);
+   Datum query_datum = PG_GETARG_DATUM(1);
+   Datum options_datum = PG_GETARG_DATUM(2);
+
+   float res = 0;
+   PG_BINGO_BEGIN
+   {
+      int result = 0;
+      _RingoContextHandler bingo_context(BingoPgCommon::REACT_SIM, fcinfo->flinfo->fn_oid);
+      result = bingo_context.matchInternal(query_datum, target_datum, options_datum);
+      if(result < 0)
+         PG_RETURN_NULL();
+
+      if (result > 0)
+         ringoSimilarityGetScore(&res);
+   }
+   PG_BINGO_END
+   PG_RETURN_FLOAT4(res);
+}
@@ -82,6 +82,9 @@ void BingoPgCommon::getSearchTypeString(int type, indigo::Array<char>& result, b
          case(REACT_SMARTS):
             result.readString("RSMARTS", true);
             break;
+         case(REACT_SIM):
+            result.readString("RSIM", true);
+            break;
          default:
             break;
 
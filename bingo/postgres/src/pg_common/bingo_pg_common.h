@@ -37,6 +37,7 @@ public:
       REACT_SUB = 1,
       REACT_EXACT = 2,
       REACT_SMARTS = 3,
+      REACT_SIM = 4,
       MOL_MASS = 100/*pseudo types*/
    };
 
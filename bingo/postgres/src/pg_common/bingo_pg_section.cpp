@@ -41,6 +41,7 @@ _idxStrategy(idx_strategy){
       _sectionInfoBuffer.changeAccess(BINGO_PG_NOLOCK);
       _sectionInfo.n_blocks_for_map = bingo_idx.getMapSize();
       _sectionInfo.n_blocks_for_fp = bingo_idx.getFpSize();
+      _sectionInfo.n_descriptors = bingo_idx.getDescriptorsCount();
       /*
        * Initialize existing structures fingerprint
        */
@@ -63,7 +64,10 @@ _idxStrategy(idx_strategy){
       _sectionInfoBuffer.readBuffer(_index, _offset, BINGO_PG_READ);
       int data_len;
       BingoSectionInfoData* data = (BingoSectionInfoData*)_sectionInfoBuffer.getIndexData(data_len);
-      _sectionInfo = *data;
+      /*
+       * Section info of the old indexes is shorter
+       */
+      memcpy(&_sectionInfo, data, __min(data_len, (int)sizeof(_sectionInfo)));
       _sectionInfoBuffer.changeAccess(BINGO_PG_NOLOCK);
       
       _existStructures.reset(new BingoPgBufferCacheFp(offset + 1, _index, false));
@@ -96,6 +100,10 @@ _idxStrategy(idx_strategy){
       ++block_offset;
    }
    for (int i = 0; i < bin_count; ++i) {
+      /*
+       * Descriptor pages are placed among the binary buffers
+       */
+      block_offset = _skipDescriptorPages(block_offset);
       _offsetBin[i] = block_offset;
       ++block_offset;
    }
@@ -127,7 +135,7 @@ BingoPgSection::~BingoPgSection() {
       _sectionInfoBuffer.changeAccess(BINGO_PG_WRITE);
       int data_len;
       BingoSectionInfoData* data = (BingoSectionInfoData*)_sectionInfoBuffer.getIndexData(data_len);
-      *data = _sectionInfo;
+      memcpy(data, &_sectionInfo, __min(data_len, (int)sizeof(_sectionInfo)));
       _sectionInfoBuffer.changeAccess(BINGO_PG_NOLOCK);
    }
 }
@@ -141,6 +149,14 @@ void BingoPgSection::clear() {
    _sectionInfo.last_cmf = -1;
    _sectionInfo.last_xyz = -1;
    _sectionInfo.has_removed = 0;
+   _sectionInfo.n_descriptors = 0;
+   for (int idx = 0; idx < BINGO_DESCRIPTORS_MAX; ++idx) {
+      _sectionInfo.descriptors_min[idx] = 0;
+      _sectionInfo.descriptors_max[idx] = 0;
+   }
+   for (int idx = 0; idx < BINGO_DESCRIPTOR_GROUPS_MAX; ++idx) {
+      _sectionInfo.descriptor_offsets[idx] = -1;
+   }
    _sectionInfoBuffer.clear();
    _existStructures.reset(0);
    _buffersMap.clear();
@@ -189,6 +205,10 @@ void BingoPgSection::addStructure(BingoPgFpData& item_data) {
     * Set bits number
     */
     _setBitsCountData(item_data.getBitsCount());
+   /*
+    * Set descriptors
+    */
+   _setDescriptorsData(item_data.getDescriptors());
    /*
     * Set structure index
     */
@@ -207,7 +227,45 @@ void BingoPgSection::addStructure(BingoPgFpData& item_data) {
 }
 
 int BingoPgSection::getPagesCount() const {
-   return _buffersMap.size() + _buffersFp.size() + _buffersBin.size() + SECTION_META_PAGES + SECTION_BITSNUMBER_PAGES;
+   return _buffersMap.size() + _buffersFp.size() + _buffersBin.size() + SECTION_META_PAGES + SECTION_BITSNUMBER_PAGES + _getDescriptorPagesCount();
+}
+
+int BingoPgSection::_getDescriptorPagesCount() const {
+   int n_groups = 0;
+   for (int buf_idx = 0; buf_idx < SECTION_DESCRIPTOR_PAGES; ++buf_idx) {
+      if(_sectionInfo.descriptor_offsets[buf_idx] != -1)
+         ++n_groups;
+   }
+   return n_groups * _sectionInfo.n_descriptors;
+}
+
+int BingoPgSection::_getDescriptorBlock(int descriptor_idx, int buf_idx) const {
+   return _offset + _sectionInfo.descriptor_offsets[buf_idx] + descriptor_idx;
+}
+
+int BingoPgSection::_skipDescriptorPages(int block_offset) const {
+   /*
+    * Groups are allocated one by one, so their offsets are increasing
+    */
+   for (int buf_idx = 0; buf_idx < SECTION_DESCRIPTOR_PAGES; ++buf_idx) {
+      if(_sectionInfo.descriptor_offsets[buf_idx] == block_offset - _offset)
+         block_offset += _sectionInfo.n_descriptors;
+   }
+   return block_offset;
+}
+
+void BingoPgSection::_allocateDescriptorPages(int buf_idx) {
+   /*
+    * A page for each column is appended at the section end as for the binary buffers
+    */
+   int group_offset = getPagesCount();
+   for (int d_idx = 0; d_idx < _sectionInfo.n_descriptors; ++d_idx) {
+      BingoPgBuffer& descriptors_buffer = _descriptorBuffers[d_idx * SECTION_DESCRIPTOR_PAGES + buf_idx];
+      descriptors_buffer.writeNewBuffer(_index, _offset + group_offset + d_idx);
+      descriptors_buffer.formEmptyIndexTuple(SECTION_DESCRIPTORS_PER_BLOCK * sizeof(float));
+      descriptors_buffer.changeAccess(BINGO_PG_NOLOCK);
+   }
+   _sectionInfo.descriptor_offsets[buf_idx] = group_offset;
 }
 
 void BingoPgSection::getSectionStructures(BingoPgExternalBitset& section_bitset) {
@@ -280,6 +338,36 @@ void BingoPgSection::readSectionBitsCount(indigo::Array<int>& bits_number) {
    
 }
 
+void BingoPgSection::readSectionDescriptors(int descriptor_idx, indigo::Array<float>& values) {
+   if(descriptor_idx < 0 || descriptor_idx >= _sectionInfo.n_descriptors)
+      throw Error("internal error: descriptor %d is out of bounds %d", descriptor_idx, _sectionInfo.n_descriptors);
+
+   values.resize(_sectionInfo.n_structures);
+   values.zerofill();
+
+   if(_descriptorBuffers.size() == 0)
+      _descriptorBuffers.resize(_sectionInfo.n_descriptors * SECTION_DESCRIPTOR_PAGES);
+
+   int data_len, str_idx;
+   float* buffer_data;
+   int column_offset = descriptor_idx * SECTION_DESCRIPTOR_PAGES;
+   for (int buf_idx = 0; buf_idx < SECTION_DESCRIPTOR_PAGES; ++buf_idx) {
+      if(buf_idx * SECTION_DESCRIPTORS_PER_BLOCK >= _sectionInfo.n_structures)
+         break;
+
+      BingoPgBuffer& descriptors_buffer = _descriptorBuffers[column_offset + buf_idx];
+      descriptors_buffer.readBuffer(_index, _getDescriptorBlock(descriptor_idx, buf_idx), BINGO_PG_READ);
+      buffer_data = (float*) descriptors_buffer.getIndexData(data_len);
+      for (int page_str_idx = 0; page_str_idx < SECTION_DESCRIPTORS_PER_BLOCK; ++page_str_idx) {
+         str_idx = buf_idx * SECTION_DESCRIPTORS_PER_BLOCK + page_str_idx;
+         if (str_idx >= _sectionInfo.n_structures)
+            break;
+         values[str_idx] = buffer_data[page_str_idx];
+      }
+      descriptors_buffer.changeAccess(BINGO_PG_NOLOCK);
+   }
+}
+
 void BingoPgSection::_setCmfData(indigo::Array<char>& cmf_buf, int map_buf_idx, int map_idx) {
    /*
     * Set binary info
@@ -354,6 +442,43 @@ void BingoPgSection::_setBinData(indigo::Array<char>& buf, int& last_buf, ItemPo
    } BINGO_PG_HANDLE(throw Error("internal error: can not set block data: %s", message));
 }
 
+void BingoPgSection::_setDescriptorsData(const indigo::Array<float>& descriptors) {
+   int n_descriptors = _sectionInfo.n_descriptors;
+   if(n_descriptors == 0)
+      return;
+
+   if(descriptors.size() < n_descriptors)
+      throw Error("internal error: structure has %d descriptors while section requires %d", descriptors.size(), n_descriptors);
+
+   if(_descriptorBuffers.size() == 0)
+      _descriptorBuffers.resize(n_descriptors * SECTION_DESCRIPTOR_PAGES);
+
+   int data_len;
+   int buf_idx = _sectionInfo.n_structures / SECTION_DESCRIPTORS_PER_BLOCK;
+   int page_str_idx = _sectionInfo.n_structures % SECTION_DESCRIPTORS_PER_BLOCK;
+
+   if(_sectionInfo.descriptor_offsets[buf_idx] == -1)
+      _allocateDescriptorPages(buf_idx);
+
+   for (int d_idx = 0; d_idx < n_descriptors; ++d_idx) {
+      int column_buf_idx = d_idx * SECTION_DESCRIPTOR_PAGES + buf_idx;
+      BingoPgBuffer& descriptors_buffer = _descriptorBuffers[column_buf_idx];
+      descriptors_buffer.readBuffer(_index, _getDescriptorBlock(d_idx, buf_idx), BINGO_PG_WRITE);
+      float* buffer_data = (float*) descriptors_buffer.getIndexData(data_len);
+      buffer_data[page_str_idx] = descriptors[d_idx];
+      descriptors_buffer.changeAccess(BINGO_PG_NOLOCK);
+      /*
+       * Update the section value range
+       */
+      float& d_min = _sectionInfo.descriptors_min[d_idx];
+      float& d_max = _sectionInfo.descriptors_max[d_idx];
+      if(_sectionInfo.n_structures == 0 || descriptors[d_idx] < d_min)
+         d_min = descriptors[d_idx];
+      if(_sectionInfo.n_structures == 0 || descriptors[d_idx] > d_max)
+         d_max = descriptors[d_idx];
+   }
+}
+
 void BingoPgSection::_setBitsCountData(unsigned short bits_count) {
    
    if(_bitsCountBuffers.size() == 0)
@@ -22,7 +22,7 @@ class BingoPgExternalBitset;
  *    bits count buffers (16 blocks) |
  *    map buffers (64k / 500) |
  *    fp buffers (fp count) |
- *    binary buffers (dynamic)
+ *    binary and descriptor buffers (dynamic)
  */
 class BingoPgSection {
 public:
@@ -30,7 +30,9 @@ public:
    enum {
       SECTION_META_PAGES = 2,
       SECTION_BITSNUMBER_PAGES = 16,
-      SECTION_BITS_PER_BLOCK = 4000 /* 4000 * sizeof(unsigned short) < 8K*/
+      SECTION_BITS_PER_BLOCK = 4000, /* 4000 * sizeof(unsigned short) < 8K*/
+      SECTION_DESCRIPTORS_PER_BLOCK = 2000, /* 2000 * sizeof(float) < 8K*/
+      SECTION_DESCRIPTOR_PAGES = BINGO_DESCRIPTOR_GROUPS_MAX /* BINGO_MOLS_PER_SECTION / SECTION_DESCRIPTORS_PER_BLOCK */
    };
    BingoPgSection(BingoPgIndex& bingo_idx, int idx_strategy, int offset);
    ~BingoPgSection();
@@ -61,6 +63,10 @@ public:
    BingoPgBufferCacheBin& getBinBufferCache(int bin_idx);
 
    void readSectionBitsCount(indigo::Array<int>& bits_count);
+   /*
+    * Reads a descriptor column for all the section structures
+    */
+   void readSectionDescriptors(int descriptor_idx, indigo::Array<float>& values);
 
    const BingoSectionInfoData& getSectionInfo() const { return _sectionInfo;};
 
@@ -73,6 +79,11 @@ private:
    void _setXyzData(indigo::Array<char>& xyz_buf, int map_buf_idx, int map_idx);
    void _setBinData(indigo::Array<char>& buf, int& last_buf, ItemPointerData& item_data);
    void _setBitsCountData(unsigned short bits_count);
+   void _setDescriptorsData(const indigo::Array<float>& descriptors);
+   int _getDescriptorPagesCount() const;
+   int _getDescriptorBlock(int descriptor_idx, int buf_idx) const;
+   int _skipDescriptorPages(int block_offset) const;
+   void _allocateDescriptorPages(int buf_idx);
 
    BingoPgBufferCacheBin* _getBufferBin(int idx);
    
@@ -93,6 +104,7 @@ private:
    indigo::Array<int> _offsetBin;
 
    indigo::ObjArray<BingoPgBuffer> _bitsCountBuffers;
+   indigo::ObjArray<BingoPgBuffer> _descriptorBuffers;
 };
 
 #endif /* BINGO_PG_SECTION1_H */
@@ -13,6 +13,15 @@ extern "C" {
 #undef printf
 #endif
 
+/*
+ * Version of the index pages layout and of the stored fingerprints. Indexes
+ * with another version can not be read and have to be rebuilt. Version 0 is
+ * the layout without n_updates, n_descriptors, the section descriptors and
+ * the reaction difference and reacting centers fingerprints. Version 1 has
+ * all the descriptor pages of a section allocated before the map pages
+ */
+#define BINGO_INDEX_VERSION 2
+
 typedef struct BingoMetaPageData {
    int bingo_index_version;
    int n_molecules;
@@ -23,6 +32,15 @@ typedef struct BingoMetaPageData {
    int n_sections;
    int n_pages;
    int index_type;
+   /*
+    * Incremented on each index modification. Used as a version of
+    * the cached search results
+    */
+   int n_updates;
+   /*
+    * Number of the descriptor columns in each section
+    */
+   int n_descriptors;
 } BingoMetaPageData;
 
 typedef BingoMetaPageData *BingoMetaPage;
@@ -63,6 +81,12 @@ typedef struct BingoStdRdOptions {
    BingoIndexOptions index_parameters;
 } BingoStdRdOptions;
 
+#define BINGO_DESCRIPTORS_MAX 16
+/*
+ * Each descriptor page keeps 2000 values, so 32 pages for 64000 section structures
+ */
+#define BINGO_DESCRIPTOR_GROUPS_MAX 32
+
 typedef struct BingoSectionInfoData {
    int n_structures;
    int n_blocks_for_map;
@@ -72,6 +96,19 @@ typedef struct BingoSectionInfoData {
    int last_cmf;
    int last_xyz;
    char has_removed;
+   /*
+    * Descriptor columns and their value ranges within the section.
+    * Sections of the old indexes have no descriptors
+    */
+   int n_descriptors;
+   float descriptors_min[BINGO_DESCRIPTORS_MAX];
+   float descriptors_max[BINGO_DESCRIPTORS_MAX];
+   /*
+    * Descriptor pages are allocated on demand among the binary buffers: one
+    * page per column for each 2000 structures. Offsets of these page groups
+    * are relative to the section offset, -1 if the group is not allocated
+    */
+   int descriptor_offsets[BINGO_DESCRIPTOR_GROUPS_MAX];
 } BingoSectionInfoData;
 
 #endif	/* BINGO_PG_CONTEXT_H */
@@ -14,6 +14,7 @@ extern "C" {
 #include "bingo_core_c.h"
 #include "base_cpp/auto_ptr.h"
 #include "base_cpp/profiling.h"
+#include "base_cpp/tlscont.h"
 
 #include "pg_bingo_context.h"
 #include "bingo_pg_buffer.h"
@@ -25,6 +26,8 @@ extern "C" {
 #include "mango_pg_build_engine.h"
 #include "ringo_pg_build_engine.h"
 
+using namespace indigo;
+
 IMPL_ERROR(BingoPgBuild, "build engine");
 
 BingoPgBuild::BingoPgBuild(PG_OBJECT index_ptr, const char* schema_name, const char* index_schema, bool new_index):
@@ -225,4 +228,47 @@ void BingoPgBuild::flush() {
 
 }
 
+int BingoPgBuild::compactSections() {
+   profTimerStart(t0, "bingo_pg.compact");
+
+   if(_buildingState)
+      throw Error("can not compact sections while building");
+
+   QS_DEF(Array<int>, structures);
+   QS_DEF(Array<int>, removed_structures);
+   PtrArray<BingoPgFpData> data;
+   BingoPgExternalBitset section_bitset(BINGO_MOLS_PER_SECTION);
+   int compacted = 0;
+   for (int section_idx = 0; section_idx < _bufferIndex.getSectionNumber(); ++section_idx) {
+      int n_structures = _bufferIndex.getSectionStructuresNumber(section_idx);
+      _bufferIndex.getSectionBitset(section_idx, section_bitset);
+      int n_removed = n_structures - section_bitset.bitsNumber();
+
+      if (n_removed == 0 || n_removed * 100 < n_structures * COMPACT_REMOVED_PERCENT)
+         continue;
+
+      elog(DEBUG1, "bingo: compact: section %d has %d removed structures from %d", section_idx, n_removed, n_structures);
+      /*
+       * Remove shadow info for the removed structures
+       */
+      removed_structures.clear();
+      for (int mol_idx = 0; mol_idx < n_structures; ++mol_idx) {
+         if (!section_bitset.get(mol_idx))
+            removed_structures.push(mol_idx);
+      }
+      fp_engine->removeShadowInfo(section_idx, removed_structures);
+      /*
+       * Read existing structures and write them again into the same section
+       */
+      _bufferIndex.readSectionStructures(section_idx, structures, data);
+      _bufferIndex.rewriteSection(section_idx, data);
+      fp_engine->moveShadowInfo(section_idx, structures, data);
+
+      ++compacted;
+   }
 
+   if (compacted > 0)
+      elog(NOTICE, "bingo.index: %d sections were compacted", compacted);
+
+   return compacted;
+}
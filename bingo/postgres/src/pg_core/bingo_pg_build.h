@@ -21,7 +21,11 @@ class BingoPgConfig;
 class BingoPgBuild {
 public:
    enum {
-      MAX_CACHE_SIZE=100
+      MAX_CACHE_SIZE=100,
+      /*
+       * Sections with greater percent of removed structures are compacted
+       */
+      COMPACT_REMOVED_PERCENT=25
    };
    BingoPgBuild(PG_OBJECT index, const char* schema_name,const char* index_schema, bool new_index);
    ~BingoPgBuild();
@@ -35,6 +39,13 @@ public:
    void insertStructureParallel(PG_OBJECT item_ptr, uintptr_t text_ptr);
    void flush();
 
+   /*
+    * Merges removed structures out of the index sections. Sparse sections are
+    * rewritten in place with the existing structures only. The caller should
+    * hold an exclusive index lock. Returns number of compacted sections
+    */
+   int compactSections();
+
    DECL_ERROR;
 
 private:
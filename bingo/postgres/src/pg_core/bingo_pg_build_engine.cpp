@@ -12,8 +12,10 @@ extern "C" {
 
 #include "base_cpp/tlscont.h"
 #include "base_cpp/array.h"
+#include "base_cpp/output.h"
 
 #include "bingo_pg_index.h"
+#include "bingo_pg_common.h"
 
 using namespace indigo;
 
@@ -61,6 +63,56 @@ int BingoPgBuildEngine::getNthreads() {
 }
 
 
+/*
+ * Removes shadow rows for the given section structures. Rows are removed by batches
+ */
+void BingoPgBuildEngine::_removeShadowRows(const char* shadow_rel_name, int section_idx, const Array<int>& structures) {
+   QS_DEF(Array<char>, query_str);
+   for (int batch_begin = 0; batch_begin < structures.size(); batch_begin += SHADOW_BATCH_SIZE) {
+      int batch_end = __min(batch_begin + SHADOW_BATCH_SIZE, structures.size());
+      ArrayOutput query_out(query_str);
+      query_out.printf("DELETE FROM %s WHERE b_id IN (", shadow_rel_name);
+      for (int str_idx = batch_begin; str_idx < batch_end; ++str_idx) {
+         if (str_idx > batch_begin)
+            query_out.writeChar(',');
+         query_out.printf("'(%d, %d)'::tid", section_idx, structures[str_idx]);
+      }
+      query_out.printf(")");
+      query_out.writeChar(0);
+      BingoPgCommon::executeQuery(query_str);
+   }
+}
+
+/*
+ * Updates shadow rows mapping for the moved structures. Data keeps the new positions
+ */
+void BingoPgBuildEngine::_moveShadowRows(const char* shadow_rel_name, int section_idx, const Array<int>& structures, PtrArray<BingoPgFpData>& data) {
+   QS_DEF(Array<char>, query_str);
+   bool has_moved;
+   for (int batch_begin = 0; batch_begin < structures.size(); batch_begin += SHADOW_BATCH_SIZE) {
+      int batch_end = __min(batch_begin + SHADOW_BATCH_SIZE, structures.size());
+      has_moved = false;
+      ArrayOutput query_out(query_str);
+      query_out.printf("UPDATE %s SET b_id = bingo_map.new_id FROM (VALUES ", shadow_rel_name);
+      for (int str_idx = batch_begin; str_idx < batch_end; ++str_idx) {
+         BingoPgFpData& item = *data[str_idx];
+         /*
+          * Skip structures with the same position
+          */
+         if (item.getSectionIdx() == section_idx && item.getStructureIdx() == structures[str_idx])
+            continue;
+         if (has_moved)
+            query_out.writeChar(',');
+         query_out.printf("('(%d, %d)'::tid, '(%d, %d)'::tid)", section_idx, structures[str_idx], item.getSectionIdx(), item.getStructureIdx());
+         has_moved = true;
+      }
+      query_out.printf(") AS bingo_map(old_id, new_id) WHERE b_id = bingo_map.old_id");
+      query_out.writeChar(0);
+      if (has_moved)
+         BingoPgCommon::executeQuery(query_str);
+   }
+}
+
 int BingoPgBuildEngine::_getNextRecordCb (void *context) {
    BingoPgBuildEngine* engine = (BingoPgBuildEngine*)context;
 
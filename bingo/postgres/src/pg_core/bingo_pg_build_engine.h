@@ -16,6 +16,7 @@ extern "C" {
 #include "bingo_postgres.h"
 #include "base_cpp/auto_ptr.h"
 #include "base_cpp/obj_array.h"
+#include "base_cpp/ptr_array.h"
 
 #include "bingo_pg_text.h"
 #include "bingo_pg_search_engine.h"
@@ -28,6 +29,10 @@ class BingoPgConfig;
 
 class BingoPgBuildEngine {
 public:
+   enum {
+      SHADOW_BATCH_SIZE = 1000
+   };
+
    class StructCache {
    public:
       StructCache(){}
@@ -47,10 +52,16 @@ public:
 
    virtual int getType() const {return 0;}
    virtual int getFpSize() {return 0;}
+   virtual int getDescriptorsCount() {return 0;}
 
    virtual void prepareShadowInfo(const char* schema_name, const char* index_schema){}
    virtual void insertShadowInfo(BingoPgFpData&){}
    virtual void finishShadowProcessing(){}
+   /*
+    * Shadow info handling for the section compaction
+    */
+   virtual void removeShadowInfo(int section_idx, const indigo::Array<int>& structures){}
+   virtual void moveShadowInfo(int section_idx, const indigo::Array<int>& structures, indigo::PtrArray<BingoPgFpData>& data){}
 
    void loadDictionary(BingoPgIndex&);
    const char* getDictionary(int& size);
@@ -61,6 +72,9 @@ private:
 protected:
    void _setBingoContext();
 
+   static void _removeShadowRows(const char* shadow_rel_name, int section_idx, const indigo::Array<int>& structures);
+   static void _moveShadowRows(const char* shadow_rel_name, int section_idx, const indigo::Array<int>& structures, indigo::PtrArray<BingoPgFpData>& data);
+
    static int _getNextRecordCb (void *context);
    static void _processErrorCb (int id, void *context);
 
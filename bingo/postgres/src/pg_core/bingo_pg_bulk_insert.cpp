@@ -0,0 +1,115 @@
+extern "C" {
+#include "postgres.h"
+#include "fmgr.h"
+#include "access/heapam.h"
+#include "storage/lock.h"
+#include "utils/rel.h"
+#include "utils/memutils.h"
+}
+#ifdef qsort
+#undef qsort
+#endif
+
+#include "bingo_pg_bulk_insert.h"
+
+#include "base_cpp/profiling.h"
+#include "bingo_pg_common.h"
+
+using namespace indigo;
+
+IMPL_ERROR(BingoPgBulkInsert, "bulk insert");
+
+/*
+ * Current bulk insert for the backend
+ */
+static BingoPgBulkInsert* current_bulk_insert = 0;
+
+BingoPgBulkInsert::BingoPgBulkInsert() {
+   /*
+    * Deferred structures should live until the flush
+    */
+   _memoryContext = CurrentMemoryContext;
+   _previous = current_bulk_insert;
+   current_bulk_insert = this;
+}
+
+BingoPgBulkInsert::~BingoPgBulkInsert() {
+   current_bulk_insert = _previous;
+   for (int idx = 0; idx < _indexes.size(); ++idx) {
+      IndexData& index_data = _indexes[idx];
+      index_data.structures.clear();
+      if (index_data.index != 0) {
+         BINGO_PG_TRY {
+            relation_close((Relation)index_data.index, NoLock);
+         } BINGO_PG_HANDLE(elog(WARNING, "internal error: can not close index: %s", message));
+      }
+   }
+}
+
+BingoPgBulkInsert* BingoPgBulkInsert::getCurrent() {
+   return current_bulk_insert;
+}
+
+void BingoPgBulkInsert::addStructure(PG_OBJECT index, PG_OBJECT item_ptr, uintptr_t text_ptr) {
+   Relation index_rel = (Relation) index;
+   IndexData& index_data = _getIndexData(index_rel->rd_id);
+   StructData& struct_data = index_data.structures.push();
+   struct_data.ptr = *((ItemPointer) item_ptr);
+   /*
+    * Text is copied into the bulk memory context since the tuple context is reset
+    */
+   MemoryContext old_context = MemoryContextSwitchTo((MemoryContext)_memoryContext);
+   struct_data.text.init(text_ptr);
+   MemoryContextSwitchTo(old_context);
+}
+
+void BingoPgBulkInsert::flush() {
+   for (int idx = 0; idx < _indexes.size(); ++idx) {
+      _flushIndex(_indexes[idx]);
+   }
+}
+
+BingoPgBulkInsert::IndexData& BingoPgBulkInsert::_getIndexData(dword index_id) {
+   for (int idx = 0; idx < _indexes.size(); ++idx) {
+      if (_indexes[idx].indexId == index_id)
+         return _indexes[idx];
+   }
+   IndexData& result = _indexes.push();
+   result.indexId = index_id;
+   return result;
+}
+
+void BingoPgBulkInsert::_flushIndex(IndexData& index_data) {
+   profTimerStart(t0, "bingo_pg.bulk_flush");
+
+   if (index_data.structures.size() == 0)
+      return;
+   /*
+    * Index relation is opened once for the whole import
+    */
+   if (index_data.index == 0) {
+      BINGO_PG_TRY {
+         index_data.index = relation_open(index_data.indexId, RowExclusiveLock);
+      } BINGO_PG_HANDLE(throw Error("can not open index: %s", message));
+   }
+   Relation index_rel = (Relation) index_data.index;
+   BingoPgWrapper rel_namespace;
+   const char* index_schema = rel_namespace.getRelNameSpace(index_rel->rd_id);
+
+   /*
+    * Build engine is created for each batch. It reads the meta info and the
+    * dictionary that can be changed by the other backends since the previous
+    * batch, and writes them back in the destructor at the end of the batch
+    */
+   {
+      BingoPgBuild build_engine(index_data.index, 0, index_schema, false);
+
+      for (int str_idx = 0; str_idx < index_data.structures.size(); ++str_idx) {
+         StructData& struct_data = index_data.structures[str_idx];
+         build_engine.insertStructure(&struct_data.ptr, struct_data.text.getDatum());
+      }
+      build_engine.flush();
+   }
+
+   index_data.structures.clear();
+}
@@ -0,0 +1,82 @@
+/*
+ */
+
+#ifndef _BINGO_PG_BULK_INSERT_H__
+#define _BINGO_PG_BULK_INSERT_H__
+
+extern "C" {
+   #include "c.h"
+   #include "storage/itemptr.h"
+}
+
+#ifdef qsort
+#undef qsort
+#endif
+
+#include "base_cpp/auto_ptr.h"
+#include "base_cpp/obj_array.h"
+#include "base_cpp/exception.h"
+
+#include "bingo_postgres.h"
+#include "bingo_pg_text.h"
+#include "bingo_pg_build.h"
+
+/*
+ * Class for the deferred index insertion while bulk import
+ * Index insertions are collected while the heap rows are written and are
+ * processed by the build engine by batches (in parallel if nthreads is set)
+ */
+class BingoPgBulkInsert {
+public:
+   BingoPgBulkInsert();
+   ~BingoPgBulkInsert();
+
+   /*
+    * Returns current bulk insert or null if there is no bulk import
+    */
+   static BingoPgBulkInsert* getCurrent();
+
+   /*
+    * Defers a structure insertion into the index
+    */
+   void addStructure(PG_OBJECT index, PG_OBJECT item_ptr, uintptr_t text_ptr);
+   /*
+    * Inserts all the deferred structures into the indexes
+    */
+   void flush();
+
+   DECL_ERROR;
+
+private:
+   BingoPgBulkInsert(const BingoPgBulkInsert&); //no implicit copy
+
+   class StructData {
+   public:
+      StructData(){}
+      ~StructData(){}
+      ItemPointerData ptr;
+      BingoPgText text;
+   private:
+      StructData(const StructData&); //no implicit copy
+   };
+
+   class IndexData {
+   public:
+      IndexData():indexId(0), index(0){}
+      ~IndexData(){}
+      dword indexId;
+      PG_OBJECT index;
+      indigo::ObjArray<StructData> structures;
+   private:
+      IndexData(const IndexData&); //no implicit copy
+   };
+
+   IndexData& _getIndexData(dword index_id);
+   void _flushIndex(IndexData& index_data);
+
+   PG_OBJECT _memoryContext;
+   BingoPgBulkInsert* _previous;
+   indigo::ObjArray<IndexData> _indexes;
+};
+
+#endif /* BINGO_PG_BULK_INSERT_H */
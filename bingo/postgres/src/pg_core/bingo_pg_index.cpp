@@ -2,11 +2,13 @@ extern "C" {
 #include "postgres.h"
 #include "fmgr.h"
 #include "storage/bufmgr.h"
+#include "utils/rel.h"
 }
 #ifdef qsort
 #undef qsort
 #endif
 
+#include "base_c/bitarray.h"
 #include "base_cpp/profiling.h"
 #include "bingo_pg_index.h"
 #include "pg_bingo_context.h"
@@ -16,6 +18,7 @@ extern "C" {
 #include "bingo_pg_common.h"
 #include "bingo_pg_config.h"
 #include "bingo_core_c.h"
+#include "core/bingo_query_cache.h"
 
 IMPL_ERROR(BingoPgIndex, "bingo index");
 
@@ -34,6 +37,8 @@ _strategy(READING_STRATEGY) {
    _metaInfo.n_molecules = 0;
    _metaInfo.index_type = 0;
    _metaInfo.n_pages = 0;
+   _metaInfo.n_updates = 0;
+   _metaInfo.n_descriptors = 0;
    _currentSectionIdx = -1;
 }
 
@@ -44,10 +49,14 @@ void BingoPgIndex::writeBegin(BingoPgBuildEngine& fp_engine, BingoPgConfig& bing
    /*
     * Prepare meta info for writing
     */
+   _metaInfo.bingo_index_version = BINGO_INDEX_VERSION;
    _metaInfo.n_blocks_for_map = BINGO_MOLS_PER_FINGERBLOCK / BINGO_MOLS_PER_MAPBLOCK + 1;
    _metaInfo.n_blocks_for_fp = fp_engine.getFpSize();
    _metaInfo.index_type = fp_engine.getType();
+   _metaInfo.n_descriptors = fp_engine.getDescriptorsCount();
    _metaInfo.n_pages = 0;
+   if(_metaInfo.n_descriptors > BINGO_DESCRIPTORS_MAX)
+      throw Error("internal error: descriptors count %d is greater than maximum %d", _metaInfo.n_descriptors, BINGO_DESCRIPTORS_MAX);
    /*
     * Prepare meta pages
     */
@@ -111,6 +120,16 @@ void BingoPgIndex::readMetaInfo() {
     * Copy meta info
     */
    BingoMetaPage meta_page = BingoPageGetMeta(BufferGetPage(_metaBuffer.getBuffer()));
+   /*
+    * Meta info of the other versions has the other size and the other
+    * sections layout. The version is the first field in all of them
+    */
+   int index_version = meta_page->bingo_index_version;
+   if (index_version != BINGO_INDEX_VERSION) {
+      _metaBuffer.changeAccess(BINGO_PG_NOLOCK);
+      throw Error("index was built by the other bingo version (index version %d, expected %d). Please rebuild it with REINDEX",
+              index_version, BINGO_INDEX_VERSION);
+   }
    _metaInfo = *meta_page;
    /*
     * Return buffer pin
@@ -142,6 +161,13 @@ void BingoPgIndex::readConfigParameters(BingoPgConfig& bingo_config) {
  * Writes meta information
  */
 void BingoPgIndex::writeMetaInfo() {
+   /*
+    * Cached results of the previous index version are not valid anymore
+    */
+   char index_id[32];
+   snprintf(index_id, sizeof(index_id), "%u", ((Relation)_index)->rd_id);
+   BingoQueryCache::getInstance().invalidate(index_id);
+
    _metaBuffer.changeAccess(BINGO_PG_WRITE);
    BingoMetaPage meta_page = BingoPageGetMeta(BufferGetPage(_metaBuffer.getBuffer()));
    *meta_page = _metaInfo;
@@ -415,6 +441,7 @@ void BingoPgIndex::insertStructure(BingoPgFpData& data_item) {
     * Increment structures common number
     */
    ++_metaInfo.n_molecules;
+   ++_metaInfo.n_updates;
    if (_metaInfo.n_molecules % 1000 == 0) {
       elog(NOTICE, "bingo.index: %d structures processed", _metaInfo.n_molecules);
    }
@@ -482,10 +509,17 @@ void BingoPgIndex::getSectionBitsCount(int section_idx, indigo::Array<int>& bits
    current_section.readSectionBitsCount(bits_count);
 }
 
+void BingoPgIndex::getSectionDescriptors(int section_idx, int descriptor_idx, indigo::Array<float>& values) {
+   profTimerStart(t0, "bingo_pg.read_descriptors");
+   BingoPgSection& current_section = _jumpToSection(section_idx);
+   current_section.readSectionDescriptors(descriptor_idx, values);
+}
+
 void BingoPgIndex::removeStructure(int section_idx, int mol_idx) {
    BingoPgSection& current_section = _jumpToSection(section_idx);
    current_section.removeStructure(mol_idx);
    --_metaInfo.n_molecules;
+   ++_metaInfo.n_updates;
 }
 
 bool BingoPgIndex::isStructureRemoved(int section_idx, int mol_idx) {
@@ -497,6 +531,106 @@ bool BingoPgIndex::isStructureRemoved(ItemPointerData& cmf_item) {
    return isStructureRemoved(ItemPointerGetBlockNumber(&cmf_item), ItemPointerGetOffsetNumber(&cmf_item));
 }
 
+void BingoPgIndex::readSectionStructures(int section_idx, indigo::Array<int>& structures, indigo::PtrArray<BingoPgFpData>& data) {
+   profTimerStart(t0, "bingo_pg.read_section_structures");
+   structures.clear();
+   data.clear();
+
+   BingoPgSection& current_section = _jumpToSection(section_idx);
+   int n_structures = current_section.getStructuresNumber();
+
+   BingoPgExternalBitset section_bitset(BINGO_MOLS_PER_SECTION);
+   current_section.getSectionStructures(section_bitset);
+   /*
+    * Map existing structures to the dense positions
+    */
+   indigo::Array<int> dense_idx;
+   dense_idx.resize(n_structures);
+   dense_idx.fffill();
+   for (int mol_idx = section_bitset.begin(); mol_idx != section_bitset.end(); mol_idx = section_bitset.next(mol_idx)) {
+      dense_idx[mol_idx] = structures.size();
+      structures.push(mol_idx);
+   }
+   /*
+    * Restore fingerprints from the transposed blocks
+    */
+   int fp_bits = getFpSize();
+   int fp_bytes = (fp_bits + 7) / 8;
+   indigo::Array<char> fingerprints;
+   fingerprints.resize(structures.size() * fp_bytes);
+   fingerprints.zerofill();
+
+   BingoPgExternalBitset fp_bitset(BINGO_MOLS_PER_FINGERBLOCK);
+   for (int fp_idx = 0; fp_idx < fp_bits; ++fp_idx) {
+      current_section.getFpBufferCache(fp_idx).getCopy(fp_bitset);
+      fp_bitset.andWith(section_bitset);
+      for (int mol_idx = fp_bitset.begin(); mol_idx != fp_bitset.end(); mol_idx = fp_bitset.next(mol_idx)) {
+         bitSetBit(fingerprints.ptr() + dense_idx[mol_idx] * fp_bytes, fp_idx, 1);
+      }
+   }
+
+   indigo::Array<int> bits_count;
+   current_section.readSectionBitsCount(bits_count);
+   /*
+    * Restore descriptors from the columns
+    */
+   int n_descriptors = current_section.getSectionInfo().n_descriptors;
+   indigo::Array<float> descriptors;
+   indigo::Array<float> column;
+   descriptors.resize(structures.size() * n_descriptors);
+   for (int d_idx = 0; d_idx < n_descriptors; ++d_idx) {
+      current_section.readSectionDescriptors(d_idx, column);
+      for (int str_idx = 0; str_idx < structures.size(); ++str_idx)
+         descriptors[str_idx * n_descriptors + d_idx] = column[structures[str_idx]];
+   }
+   /*
+    * Read tid, cmf and xyz data
+    */
+   ItemPointerData tid_item;
+   for (int str_idx = 0; str_idx < structures.size(); ++str_idx) {
+      int mol_idx = structures[str_idx];
+      BingoPgFpData& item = data.add(new BingoPgFpData());
+
+      readTidItem(section_idx, mol_idx, &tid_item);
+      item.setTidItem(&tid_item);
+      readCmfItem(section_idx, mol_idx, item.getCmfBuf());
+      readXyzItem(section_idx, mol_idx, item.getXyzBuf());
+      item.setFingerPrints(fingerprints.ptr() + str_idx * fp_bytes, fp_bits);
+      item.setBitsCount(bits_count[mol_idx]);
+      item.setDescriptors(descriptors.ptr() + str_idx * n_descriptors, n_descriptors);
+      item.setSectionIdx(section_idx);
+      item.setStructureIdx(mol_idx);
+   }
+}
+
+void BingoPgIndex::rewriteSection(int section_idx, indigo::PtrArray<BingoPgFpData>& data) {
+   if(_strategy == READING_STRATEGY)
+      throw Error("can not rewrite a section while reading");
+
+   int offset = _getSectionOffset(section_idx);
+   /*
+    * Release the current section before the buffers are rewritten
+    */
+   _currentSection.free();
+   _currentSectionIdx = -1;
+   /*
+    * Write a new section over the old one. Binary buffers are allocated on
+    * insert and filled one by one, so a subset of the old structures always
+    * fits into the old pages and the next section is not overwritten
+    */
+   _currentSection.reset(new BingoPgSection(*this, BUILDING_STRATEGY, offset));
+   _currentSectionIdx = section_idx;
+
+   for (int str_idx = 0; str_idx < data.size(); ++str_idx) {
+      _currentSection->addStructure(*data[str_idx]);
+      data[str_idx]->setSectionIdx(section_idx);
+   }
+   /*
+    * Structures number is not changed, but the structures are moved
+    */
+   ++_metaInfo.n_updates;
+}
+
 void BingoPgIndex::readCmfItem(int section_idx, int mol_idx, indigo::Array<char>& cmf_buf) {
    profTimerStart(t0, "bingo_pg.read_cmf");
    /*
@@ -61,6 +61,8 @@ public:
    int getFpSize() const {return _metaInfo.n_blocks_for_fp;}
    int getMapSize() const {return _metaInfo.n_blocks_for_map;}
    int getDictCount() const {return _metaInfo.n_blocks_for_dictionary;}
+   int getIndexVersion() const {return _metaInfo.n_updates;}
+   int getDescriptorsCount() const {return _metaInfo.n_descriptors;}
 
    PG_OBJECT getIndexPtr() const {return _index;}
    INDEX_STRATEGY getIndexStrategy() const {return _strategy;}
@@ -92,10 +94,18 @@ public:
 
    void getSectionBitset(int section_idx, BingoPgExternalBitset& section_bitset);
    void getSectionBitsCount(int section_idx, indigo::Array<int>& bits_count);
+   void getSectionDescriptors(int section_idx, int descriptor_idx, indigo::Array<float>& values);
    
    void removeStructure(int section_idx, int mol_idx);
    bool isStructureRemoved(int section_idx, int mol_idx);
    bool isStructureRemoved(ItemPointerData&);
+
+   /*
+    * Section compaction. Reads all the existing structures of a section with
+    * their fingerprints and data and writes them densely over the same section
+    */
+   void readSectionStructures(int section_idx, indigo::Array<int>& structures, indigo::PtrArray<BingoPgFpData>& data);
+   void rewriteSection(int section_idx, indigo::PtrArray<BingoPgFpData>& data);
    
    void readDictionary(indigo::Array<char>& _dictionary);
    void writeDictionary(BingoPgBuildEngine&);
@@ -3,6 +3,7 @@ extern "C" {
 #include "fmgr.h"
 #include "storage/bufmgr.h"
 #include "access/itup.h"
+#include "utils/rel.h"
 }
 #ifdef qsort
 #undef qsort
@@ -17,6 +18,7 @@ extern "C" {
 #include "base_c/bitarray.h"
 #include "base_cpp/tlscont.h"
 #include "base_cpp/array.h"
+#include "base_cpp/output.h"
 #include "base_cpp/profiling.h"
 
 #include "bingo_core_c.h"
@@ -60,7 +62,11 @@ _currentIdx(-1),
 _blockBegin(0),
 _blockEnd(0),
 _bufferIndexPtr(0),
-_sectionBitset(BINGO_MOLS_PER_SECTION){
+_sectionBitset(BINGO_MOLS_PER_SECTION),
+_cacheHit(false),
+_cacheRecording(false),
+_cachePosition(-1),
+_cacheHitIdx(0){
    _bingoSession = bingoAllocateSessionID();
 }
 
@@ -97,6 +103,10 @@ void BingoPgSearchEngine::prepareQuerySearch(BingoPgIndex& bingo_idx, PG_OBJECT)
    _currentSection = -1;
    _currentIdx = -1;
    _fetchFound = false;
+   _cacheHit = false;
+   _cacheRecording = false;
+   _cacheResult.clear();
+   _cacheHits.clear();
    _blockBegin=0;
    _blockEnd=bingo_idx.getSectionNumber();
 }
@@ -156,6 +166,8 @@ bool BingoPgSearchEngine::_searchNextSub(PG_OBJECT result_ptr) {
     * Iterate through the sections bingo_index.readEnd()
     */
    for (; _currentSection < _blockEnd; ++_currentSection) {
+      if(!_prefilterSection(_currentSection))
+         continue;
       /*
        * Get section existing structures
        */
@@ -176,6 +188,8 @@ bool BingoPgSearchEngine::_searchNextSub(PG_OBJECT result_ptr) {
             bingo_index.andWithBitset(_currentSection, fp_block, _sectionBitset);
          }
       }
+      if (_sectionBitset.hasBits())
+         _filterSection(_currentSection);
       /*
        * If bitset is not null then matches are found
        */
@@ -210,6 +224,162 @@ void BingoPgSearchEngine::_setBingoContext() {
    bingoSetContext(0);
 }
 
+bool BingoPgSearchEngine::_searchNextSim(PG_OBJECT result_ptr) {
+
+   profTimerStart(t0, "bingo_pg.search_sim");
+   /*
+    * If there are mathces found on the previous steps
+    */
+   if(_fetchFound) {
+       if(_fetchForNext()) {
+          setItemPointer(result_ptr);
+          return true;
+       } else {
+          _fetchFound = false;
+          ++_currentSection;
+       }
+   }
+   
+   BingoPgFpData& query_data = _queryFpData.ref();
+   BingoPgIndex& bingo_index = *_bufferIndexPtr;
+   QS_DEF(Array<int>, bits_count);
+   QS_DEF(Array<int>, common_ones);
+   BingoPgExternalBitset screening_bitset(BINGO_MOLS_PER_SECTION);
+
+   int* min_bounds, * max_bounds;
+   /*
+    * Read first section
+    */
+   if(_currentSection < 0)
+      _currentSection = _blockBegin;
+   /*
+    * Iterate through the sections
+    */
+   for (; _currentSection < _blockEnd; ++_currentSection) {
+      _currentIdx = -1;
+      if(!_prefilterSection(_currentSection))
+         continue;
+      /*
+       * Get section existing structures
+       */
+      bingo_index.getSectionBitset(_currentSection, _sectionBitset);
+      int possible_str_count = _sectionBitset.bitsNumber();
+      /*
+       * If there is no bits then screen whole the structures
+       */
+      if (query_data.bitEnd() != 0 && possible_str_count > 0) {
+         /*
+          * Read structures bits count
+          */
+//         profTimerStart(t5, "mango_pg.get_section_bits");
+         bingo_index.getSectionBitsCount(_currentSection, bits_count);
+//         profTimerStop(t5);
+         /*
+          * Prepare min max bounds
+          */
+//         profTimerStart(t3, "mango_pg.get_min_max");
+         _getSimilarityBounds(bits_count.size(), bits_count.ptr(), &min_bounds, &max_bounds);
+//         profTimerStop(t3);
+
+         /*
+          * Prepare common bits array
+          */
+         common_ones.resize(bits_count.size());
+         common_ones.zerofill();
+         /*
+          * Iterate through the query bits
+          */
+         int iteration_idx = 0;
+         int fp_count = query_data.bitEnd();
+         for (int fp_idx = query_data.bitBegin(); fp_idx != query_data.bitEnd() && possible_str_count > 0; fp_idx = query_data.bitNext(fp_idx)) {
+            int fp_block = query_data.getBit(fp_idx);
+            /*
+             * Copy passed structures on each iteration step
+             */
+//            profTimerStart(t7, "mango_pg.copy");
+            screening_bitset.copy(_sectionBitset);
+//            profTimerStop(t7);
+
+            /*
+             * Get commons in fingerprint buffer
+             */
+            
+//            profTimerStart(t2, "mango_pg.andwith");
+            bingo_index.andWithBitset(_currentSection, fp_block, screening_bitset);
+//            profTimerStop(t2);
+
+//            profTimerStart(t4, "mango_pg.new_common_ones");
+            int screen_idx = screening_bitset.begin();
+            for (; screen_idx != screening_bitset.end() && possible_str_count > 0; screen_idx = screening_bitset.next(screen_idx)) {
+               /*
+                * Calculate new common ones
+                */
+               int& one_counter = common_ones[screen_idx];
+               ++one_counter;
+               /*
+                * If common ones is out of bounds then it is not passed the screening
+                */
+               if ((one_counter > max_bounds[screen_idx]) || ((one_counter + fp_count - iteration_idx) < min_bounds[screen_idx])) {
+                  _sectionBitset.set(screen_idx, false);
+                  --possible_str_count;
+               }
+            }
+//            profTimerStop(t4);
+            ++iteration_idx;
+         }
+
+         /*
+          * Screen the last time for all the possible structures
+          */
+//         profTimerStart(t6, "mango_pg.lst_screen");
+         int screen_idx = _sectionBitset.begin();
+         for (; screen_idx != _sectionBitset.end() && possible_str_count > 0; screen_idx = _sectionBitset.next(screen_idx)) {
+            int& one_counter = common_ones[screen_idx];
+            if ((one_counter > max_bounds[screen_idx]) || (one_counter < min_bounds[screen_idx])) {
+               /*
+                * Not passed screening
+                */
+               _sectionBitset.set(screen_idx, false);
+               --possible_str_count;
+            }
+         }
+//         profTimerStop(t6);
+
+      }
+      /*
+       * Return false on empty fingerprint
+       */
+      if(query_data.bitEnd() == 0)
+         return false;
+
+      if (_sectionBitset.hasBits())
+         _filterSection(_currentSection);
+      /*
+       * If bitset is not null then matches are found
+       */
+      if (_sectionBitset.hasBits()) {
+         /*
+          * Set first match as an answer
+          */
+         if(_fetchForNext()) {
+            profTimerStop(t0);
+            setItemPointer(result_ptr);
+            /*
+             * Set fetch found to return on the next steps
+             */
+            _fetchFound = true;
+            return true;
+         }
+
+      }
+   }
+
+   /*
+    * No matches or section ends
+    */
+   return false;
+}
+
 bool BingoPgSearchEngine::_fetchForNext() {
    /*
     * Seek for next target matched by fp engine
@@ -223,13 +393,81 @@ bool BingoPgSearchEngine::_fetchForNext() {
       /*
        * Match the next target
        */
-      if(matchTarget(_currentSection, _currentIdx))
+      if(matchTarget(_currentSection, _currentIdx)) {
+         if(_cacheRecording)
+            _cacheHits.push(_currentIdx);
          return true;
+      }
+   }
+   /*
+    * Section is finished. Record its hits
+    */
+   if(_cacheRecording && _cacheHits.size() > 0) {
+      _cacheResult.addSection(_currentSection, _cacheHits);
+      _cacheHits.clear();
+      /*
+       * Too large results are not cached
+       */
+      if(_cacheResult.memorySize() > BingoQueryCache::getInstance().getMaxMemory()) {
+         _cacheRecording = false;
+         _cacheResult.clear();
+      }
    }
 
    return false;
 }
 
+void BingoPgSearchEngine::_initResultCache(const char* search_type, const char* query, const char* options) {
+   Relation index = (Relation)_bufferIndexPtr->getIndexPtr();
+   char index_id[32];
+   snprintf(index_id, sizeof(index_id), "%u", index->rd_id);
+   _cacheIndexId.readString(index_id, true);
+   /*
+    * Results depend on the scanned blocks
+    */
+   QS_DEF(Array<char>, cache_options);
+   ArrayOutput cache_options_out(cache_options);
+   cache_options_out.printf("%d %d %s", _blockBegin, _blockEnd, options);
+   cache_options_out.writeChar(0);
+
+   BingoQueryCache::buildKey(index_id, _bufferIndexPtr->getIndexVersion(), search_type, query, cache_options.ptr(), _cacheKey);
+
+   _cacheResult.clear();
+   _cacheHits.clear();
+   _cachePosition = -1;
+   _cacheHitIdx = 0;
+
+   _cacheHit = BingoQueryCache::getInstance().get(_cacheKey.ptr(), _cacheResult);
+   _cacheRecording = !_cacheHit;
+}
+
+bool BingoPgSearchEngine::_searchNextCached(PG_OBJECT result_ptr) {
+   profTimerStart(t0, "bingo_pg.search_cached");
+   while (_cacheHitIdx >= _cacheHits.size()) {
+      ++_cachePosition;
+      if(_cachePosition >= _cacheResult.sectionsCount())
+         return false;
+      _currentSection = _cacheResult.getSectionIdx(_cachePosition);
+      _cacheResult.getSectionHits(_cachePosition, _cacheHits);
+      _cacheHitIdx = 0;
+   }
+
+   _currentIdx = _cacheHits[_cacheHitIdx++];
+   setItemPointer(result_ptr);
+   return true;
+}
+
+void BingoPgSearchEngine::_putResultCache() {
+   /*
+    * Only the results of the entire scan are cached
+    */
+   if(!_cacheRecording)
+      return;
+   _cacheRecording = false;
+   BingoQueryCache::getInstance().put(_cacheIndexId.ptr(), _cacheKey.ptr(), _cacheResult);
+   _cacheResult.clear();
+}
+
 void BingoPgSearchEngine::_getBlockParameters(Array<char>& params) {
    QS_DEF(Array<char>, block_params);
    QS_DEF(Array<char>, tmp);
@@ -14,6 +14,7 @@
 #include "pg_bingo_context.h"
 #include "bingo_pg_ext_bitset.h"
 #include "bingo_pg_buffer_cache.h"
+#include "core/bingo_query_cache.h"
 
 class BingoPgText;
 class BingoPgIndex;
@@ -51,6 +52,9 @@ public:
    void setBitsCount(unsigned short bits_count) {_bitsCount = bits_count;}
    unsigned short getBitsCount() const {return _bitsCount;}
 
+   void setDescriptors(const float* values, int count) {_descriptors.copy(values, count);}
+   const indigo::Array<float>& getDescriptors() const {return _descriptors;}
+
 private:
    BingoPgFpData(const BingoPgFpData&); //no implicit copy
 
@@ -65,6 +69,7 @@ protected:
    indigo::Array<char> _xyzBuf;
 
    indigo::Array<int> _fingerprintBits;
+   indigo::Array<float> _descriptors;
 
 };
 
@@ -93,12 +98,34 @@ protected:
 
    bool _searchNextCursor(PG_OBJECT result_ptr);
    bool _searchNextSub(PG_OBJECT result_ptr);
+   bool _searchNextSim(PG_OBJECT result_ptr);
 
    void _setBingoContext();
    bool _fetchForNext();
 
    void _getBlockParameters(indigo::Array<char>& params);
 
+   /*
+    * Range filtering by the section descriptors. Returns false if the whole section can be skipped
+    */
+   virtual bool _prefilterSection(int section_idx) {return true;}
+   /*
+    * Removes the structures with descriptors out of range from the section bitset
+    */
+   virtual void _filterSection(int section_idx) {}
+   /*
+    * Similarity bounds of the common bits count for the targets with the given bits counts
+    */
+   virtual int _getSimilarityBounds(int bits_count, int* target_bits, int** min_bounds, int** max_bounds) {return 0;}
+
+   /*
+    * Search results cache. Results are recorded while the whole index is scanned
+    * and are returned without screening and matching for the same query
+    */
+   void _initResultCache(const char* search_type, const char* query, const char* options);
+   bool _searchNextCached(PG_OBJECT result_ptr);
+   void _putResultCache();
+
    qword _bingoSession;
 
    bool _fetchFound;
@@ -113,6 +140,15 @@ protected:
    BingoPgExternalBitset _sectionBitset;
    indigo::AutoPtr<BingoPgFpData> _queryFpData;
    indigo::AutoPtr<BingoPgCursor> _searchCursor;
+
+   bool _cacheHit;
+   bool _cacheRecording;
+   int _cachePosition;
+   int _cacheHitIdx;
+   indigo::Array<char> _cacheIndexId;
+   indigo::Array<char> _cacheKey;
+   indigo::Array<int> _cacheHits;
+   BingoQueryCache::Result _cacheResult;
 };
 
 #endif	/* BINGO_PG_SEARCH_ENGINE_H */
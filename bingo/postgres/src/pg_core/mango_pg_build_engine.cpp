@@ -19,6 +19,7 @@ extern "C" {
 #include "bingo_pg_common.h"
 #include "bingo_pg_config.h"
 #include "bingo_pg_index.h"
+#include "core/mango_descriptor_filter.h"
 #include <float.h>
 
 
@@ -138,6 +139,10 @@ int MangoPgBuildEngine::getFpSize() {
    return result * 8;
 }
 
+int MangoPgBuildEngine::getDescriptorsCount() {
+   return MangoDescriptorFilter::DESCRIPTORS_COUNT;
+}
+
 
 void MangoPgBuildEngine::prepareShadowInfo(const char* schema_name, const char* index_schema) {
    /*
@@ -194,6 +199,16 @@ void MangoPgBuildEngine::finishShadowProcessing() {
 
 }
 
+void MangoPgBuildEngine::removeShadowInfo(int section_idx, const Array<int>& structures) {
+   _removeShadowRows(_shadowRelName.ptr(), section_idx, structures);
+   _removeShadowRows(_shadowHashRelName.ptr(), section_idx, structures);
+}
+
+void MangoPgBuildEngine::moveShadowInfo(int section_idx, const Array<int>& structures, PtrArray<BingoPgFpData>& data) {
+   _moveShadowRows(_shadowRelName.ptr(), section_idx, structures, data);
+   _moveShadowRows(_shadowHashRelName.ptr(), section_idx, structures, data);
+}
+
 void MangoPgBuildEngine::_processResultCb (void *context) {
    MangoPgBuildEngine* engine = (MangoPgBuildEngine*)context;
    ObjArray<StructCache>& struct_caches = *(engine->_structCaches);
@@ -280,6 +295,19 @@ bool MangoPgBuildEngine::_readPreparedInfo(int* id, MangoPgFpData& data, int fp_
    data.setFingerPrints(fp_buf, fp_size);
    data.setMass(mass);
    data.setBitsCount(sim_fp_bits_count);
+
+   /*
+    * Set descriptors for the range filtering
+    */
+   const float* descriptors;
+   int descriptors_count;
+   bingo_res = mangoIndexReadPreparedDescriptors(&descriptors, &descriptors_count);
+
+   CORE_HANDLE_WARNING(bingo_res, 1, "molecule build engine: error while reading descriptors for a record", bingoGetError());
+   if(bingo_res < 1)
+      return false;
+
+   data.setDescriptors(descriptors, descriptors_count);
    return true;
 }
 
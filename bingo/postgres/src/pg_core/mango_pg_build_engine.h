@@ -29,11 +29,14 @@ public:
    virtual void processStructures(indigo::ObjArray<StructCache>& struct_caches);
 
    virtual int getFpSize();
+   virtual int getDescriptorsCount();
    virtual int getType() const {return BINGO_INDEX_TYPE_MOLECULE;}
 
    virtual void prepareShadowInfo(const char* schema_name, const char* index_schema);
    virtual void insertShadowInfo(BingoPgFpData&);
    virtual void finishShadowProcessing();
+   virtual void removeShadowInfo(int section_idx, const indigo::Array<int>& structures);
+   virtual void moveShadowInfo(int section_idx, const indigo::Array<int>& structures, indigo::PtrArray<BingoPgFpData>& data);
 
 private:
    MangoPgBuildEngine(const MangoPgBuildEngine&); // no implicit copy
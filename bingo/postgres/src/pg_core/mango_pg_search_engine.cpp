@@ -135,6 +135,7 @@ void MangoPgSearchEngine::prepareQuerySearch(BingoPgIndex& bingo_idx, PG_OBJECT
       _searchType = BingoPgCommon::MOL_MASS;
    
    _queryFpData.reset(new MangoPgFpData());
+   _descriptorFilter.clear();
 
    _setBingoContext();
    
@@ -173,12 +174,17 @@ bool MangoPgSearchEngine::searchNext(PG_OBJECT result_ptr) {
    _setBingoContext();
    if (_searchType == BingoPgCommon::MOL_EXACT || _searchType == BingoPgCommon::MOL_GROSS || _searchType == BingoPgCommon::MOL_MASS) {
       result = _searchNextCursor(result_ptr);
+   } else if(_cacheHit) {
+      result = _searchNextCached(result_ptr);
    } else if(_searchType == BingoPgCommon::MOL_SUB || _searchType == BingoPgCommon::MOL_SMARTS) {
       result = _searchNextSub(result_ptr);
    } else if(_searchType == BingoPgCommon::MOL_SIM) {
       result = _searchNextSim(result_ptr);
    }
 
+   if(!result)
+      _putResultCache();
+
    return result;
 }
 
@@ -310,6 +316,10 @@ void MangoPgSearchEngine::_prepareSubSearch(PG_OBJECT scan_desc_ptr) {
     * Get block parameters and split search options
     */
    _getBlockParameters(search_options);
+   /*
+    * Get descriptor conditions
+    */
+   _prepareDescriptorFilter(scan_desc, search_options);
 
    /*
     * Set up matching parameters
@@ -327,6 +337,13 @@ void MangoPgSearchEngine::_prepareSubSearch(PG_OBJECT scan_desc_ptr) {
    int size_bits = fp_len * 8;
    data.setFingerPrints(fingerprint_buf, size_bits);
 
+   /*
+    * Descriptor conditions are the part of the query
+    */
+   QS_DEF(Array<char>, filter_str);
+   _descriptorFilter.toString(filter_str);
+   search_options.appendString(filter_str.ptr(), true);
+   _initResultCache(search_type.ptr(), search_query.ptr(), search_options.ptr());
 }
 
 void MangoPgSearchEngine::_prepareExactSearch(PG_OBJECT scan_desc_ptr) {
@@ -452,6 +469,10 @@ void MangoPgSearchEngine::_prepareSimSearch(PG_OBJECT scan_desc_ptr) {
     * Get block parameters and split search options
     */
    _getBlockParameters(search_options);
+   /*
+    * Get descriptor conditions
+    */
+   _prepareDescriptorFilter(scan_desc, search_options);
    /*
     * Set up matching parameters
     */
@@ -473,6 +494,88 @@ void MangoPgSearchEngine::_prepareSimSearch(PG_OBJECT scan_desc_ptr) {
    int size_bits = fp_len * 8;
    data.setFingerPrints(fingerprint_buf, size_bits);
 
+   /*
+    * Similarity bounds and descriptor conditions are the part of the query
+    */
+   QS_DEF(Array<char>, filter_str);
+   _descriptorFilter.toString(filter_str);
+   QS_DEF(Array<char>, sim_options);
+   ArrayOutput sim_options_out(sim_options);
+   sim_options_out.printf("%f %f %s%s", min_bound, max_bound, search_options.ptr(), filter_str.ptr());
+   sim_options_out.writeChar(0);
+   _initResultCache(search_type.ptr(), search_query.ptr(), sim_options.ptr());
+}
+
+/*
+ * Collects descriptor conditions from the search options and from the mass
+ * scan keys combined with the main query
+ */
+void MangoPgSearchEngine::_prepareDescriptorFilter(PG_OBJECT scan_desc_ptr, Array<char>& search_options) {
+   IndexScanDesc scan_desc = (IndexScanDesc) scan_desc_ptr;
+   _descriptorFilter.clear();
+
+   for (int arg_idx = 1; arg_idx < scan_desc->numberOfKeys; ++arg_idx) {
+      ScanKeyData& key_data = scan_desc->keyData[arg_idx];
+      if(key_data.sk_strategy == BingoPgCommon::MOL_MASS_LESS) {
+         char* mass_string = DatumGetCString(key_data.sk_argument);
+         BufferScanner mass_scanner(mass_string);
+         _descriptorFilter.setMax(MangoDescriptorFilter::DESCRIPTOR_MASS, mass_scanner.readFloat(), true);
+      } else if(key_data.sk_strategy == BingoPgCommon::MOL_MASS_GREAT) {
+         char* mass_string = DatumGetCString(key_data.sk_argument);
+         BufferScanner mass_scanner(mass_string);
+         _descriptorFilter.setMin(MangoDescriptorFilter::DESCRIPTOR_MASS, mass_scanner.readFloat(), true);
+      }
+   }
+
+   _descriptorFilter.extract(search_options);
+}
+
+void MangoPgSearchEngine::_checkSectionDescriptors(int section_idx) {
+   /*
+    * Indexes without the descriptors have the other version and are refused
+    * by readMetaInfo(), so every section must have all of them
+    */
+   const BingoSectionInfoData& section_info = _bufferIndexPtr->getSectionInfo(section_idx);
+   if(section_info.n_descriptors < MangoDescriptorFilter::DESCRIPTORS_COUNT)
+      throw Error("internal error: section %d has %d descriptors while %d expected", section_idx,
+              section_info.n_descriptors, MangoDescriptorFilter::DESCRIPTORS_COUNT);
+}
+
+bool MangoPgSearchEngine::_prefilterSection(int section_idx) {
+   if(_descriptorFilter.isEmpty())
+      return true;
+
+   _checkSectionDescriptors(section_idx);
+
+   const BingoSectionInfoData& section_info = _bufferIndexPtr->getSectionInfo(section_idx);
+   if(section_info.n_structures == 0)
+      return true;
+
+   return _descriptorFilter.matchRange(section_info.descriptors_min, section_info.descriptors_max);
+}
+
+void MangoPgSearchEngine::_filterSection(int section_idx) {
+   if(_descriptorFilter.isEmpty())
+      return;
+
+   _checkSectionDescriptors(section_idx);
+
+   profTimerStart(t0, "mango_pg.filter_descriptors");
+   QS_DEF(Array<float>, values);
+   /*
+    * Read only the columns with conditions
+    */
+   for (int d_idx = 0; d_idx < MangoDescriptorFilter::DESCRIPTORS_COUNT && _sectionBitset.hasBits(); ++d_idx) {
+      if(!_descriptorFilter.hasCondition(d_idx))
+         continue;
+
+      _bufferIndexPtr->getSectionDescriptors(section_idx, d_idx, values);
+
+      for (int str_idx = _sectionBitset.begin(); str_idx != _sectionBitset.end(); str_idx = _sectionBitset.next(str_idx)) {
+         if(!_descriptorFilter.match(d_idx, values[str_idx]))
+            _sectionBitset.set(str_idx, false);
+      }
+   }
 }
 
 void MangoPgSearchEngine::_getScanQueries(uintptr_t arg_datum, Array<char>& str1_out, Array<char>& str2_out) {
@@ -576,156 +679,8 @@ void MangoPgSearchEngine::_getScanQueries(uintptr_t  arg_datum, float& min_bound
    BINGO_PG_HANDLE(throw Error("internal error: can not get scan query: %s", message));
 }
 
-bool MangoPgSearchEngine::_searchNextSim(PG_OBJECT result_ptr) {
-
-   profTimerStart(t0, "mango_pg.search_sim");
-   /*
-    * If there are mathces found on the previous steps
-    */
-   if(_fetchFound) {
-       if(_fetchForNext()) {
-          setItemPointer(result_ptr);
-          return true;
-       } else {
-          _fetchFound = false;
-          ++_currentSection;
-       }
-   }
-   
-   BingoPgFpData& query_data = _queryFpData.ref();
-   BingoPgIndex& bingo_index = *_bufferIndexPtr;
-   QS_DEF(Array<int>, bits_count);
-   QS_DEF(Array<int>, common_ones);
-   BingoPgExternalBitset screening_bitset(BINGO_MOLS_PER_SECTION);
-
-   int* min_bounds, * max_bounds, bingo_res;
-   /*
-    * Read first section
-    */
-   if(_currentSection < 0)
-      _currentSection = _blockBegin;
-   /*
-    * Iterate through the sections
-    */
-   for (; _currentSection < _blockEnd; ++_currentSection) {
-      _currentIdx = -1;
-      /*
-       * Get section existing structures
-       */
-      bingo_index.getSectionBitset(_currentSection, _sectionBitset);
-      int possible_str_count = _sectionBitset.bitsNumber();
-      /*
-       * If there is no bits then screen whole the structures
-       */
-      if (query_data.bitEnd() != 0 && possible_str_count > 0) {
-         /*
-          * Read structures bits count
-          */
-//         profTimerStart(t5, "mango_pg.get_section_bits");
-         bingo_index.getSectionBitsCount(_currentSection, bits_count);
-//         profTimerStop(t5);
-         /*
-          * Prepare min max bounds
-          */
-//         profTimerStart(t3, "mango_pg.get_min_max");
-         bingo_res =  mangoSimilarityGetBitMinMaxBoundsArray(bits_count.size(), bits_count.ptr(), &min_bounds, &max_bounds);
-//         profTimerStop(t3);
-         
-         CORE_HANDLE_ERROR(bingo_res, 1, "molecule search engine: error while getting similarity bounds array", bingoGetError());
-
-         /*
-          * Prepare common bits array
-          */
-         common_ones.resize(bits_count.size());
-         common_ones.zerofill();
-         /*
-          * Iterate through the query bits
-          */
-         int iteration_idx = 0;
-         int fp_count = query_data.bitEnd();
-         for (int fp_idx = query_data.bitBegin(); fp_idx != query_data.bitEnd() && possible_str_count > 0; fp_idx = query_data.bitNext(fp_idx)) {
-            int fp_block = query_data.getBit(fp_idx);
-            /*
-             * Copy passed structures on each iteration step
-             */
-//            profTimerStart(t7, "mango_pg.copy");
-            screening_bitset.copy(_sectionBitset);
-//            profTimerStop(t7);
-
-            /*
-             * Get commons in fingerprint buffer
-             */
-            
-//            profTimerStart(t2, "mango_pg.andwith");
-            bingo_index.andWithBitset(_currentSection, fp_block, screening_bitset);
-//            profTimerStop(t2);
-
-//            profTimerStart(t4, "mango_pg.new_common_ones");
-            int screen_idx = screening_bitset.begin();
-            for (; screen_idx != screening_bitset.end() && possible_str_count > 0; screen_idx = screening_bitset.next(screen_idx)) {
-               /*
-                * Calculate new common ones
-                */
-               int& one_counter = common_ones[screen_idx];
-               ++one_counter;
-               /*
-                * If common ones is out of bounds then it is not passed the screening
-                */
-               if ((one_counter > max_bounds[screen_idx]) || ((one_counter + fp_count - iteration_idx) < min_bounds[screen_idx])) {
-                  _sectionBitset.set(screen_idx, false);
-                  --possible_str_count;
-               }
-            }
-//            profTimerStop(t4);
-            ++iteration_idx;
-         }
-
-         /*
-          * Screen the last time for all the possible structures
-          */
-//         profTimerStart(t6, "mango_pg.lst_screen");
-         int screen_idx = _sectionBitset.begin();
-         for (; screen_idx != _sectionBitset.end() && possible_str_count > 0; screen_idx = _sectionBitset.next(screen_idx)) {
-            int& one_counter = common_ones[screen_idx];
-            if ((one_counter > max_bounds[screen_idx]) || (one_counter < min_bounds[screen_idx])) {
-               /*
-                * Not passed screening
-                */
-               _sectionBitset.set(screen_idx, false);
-               --possible_str_count;
-            }
-         }
-//         profTimerStop(t6);
-
-      }
-      /*
-       * Return false on empty fingerprint
-       */
-      if(query_data.bitEnd() == 0)
-         return false;
-
-      /*
-       * If bitset is not null then matches are found
-       */
-      if (_sectionBitset.hasBits()) {
-         /*
-          * Set first match as an answer
-          */
-         if(_fetchForNext()) {
-            profTimerStop(t0);
-            setItemPointer(result_ptr);
-            /*
-             * Set fetch found to return on the next steps
-             */
-            _fetchFound = true;
-            return true;
-         }
-
-      }
-   }
-
-   /*
-    * No matches or section ends
-    */
-   return false;
+int MangoPgSearchEngine::_getSimilarityBounds(int bits_count, int* target_bits, int** min_bounds, int** max_bounds) {
+   int bingo_res = mangoSimilarityGetBitMinMaxBoundsArray(bits_count, target_bits, min_bounds, max_bounds);
+   CORE_HANDLE_ERROR(bingo_res, 1, "molecule search engine: error while getting similarity bounds array", bingoGetError());
+   return bingo_res;
 }
\ No newline at end of file
@@ -14,6 +14,7 @@
 #include "pg_bingo_context.h"
 #include "bingo_postgres.h"
 #include "bingo_pg_cursor.h"
+#include "core/mango_descriptor_filter.h"
 
 #include <cfloat>
 
@@ -75,7 +76,11 @@ public:
 private:
    MangoPgSearchEngine(const MangoPgSearchEngine&); // no implicit copy
 
-   bool _searchNextSim(PG_OBJECT result_ptr);
+   virtual int _getSimilarityBounds(int bits_count, int* target_bits, int** min_bounds, int** max_bounds);
+   virtual bool _prefilterSection(int section_idx);
+   virtual void _filterSection(int section_idx);
+   void _prepareDescriptorFilter(PG_OBJECT scan_desc, indigo::Array<char>& search_options);
+   void _checkSectionDescriptors(int section_idx);
 
    void _prepareExactQueryStrings(indigo::Array<char>& what_clause, indigo::Array<char>& from_clause, indigo::Array<char>& where_clause);
    void _prepareExactTauStrings(indigo::Array<char>& what_clause, indigo::Array<char>& from_clause, indigo::Array<char>& where_clause);
@@ -97,6 +102,7 @@ private:
 
    int _searchType;
 
+   MangoDescriptorFilter _descriptorFilter;
 };
 #endif	/* MANGO_PG_SEARCH_ENGINE_H */
 
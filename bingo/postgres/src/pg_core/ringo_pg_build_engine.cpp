@@ -158,6 +158,14 @@ void RingoPgBuildEngine::finishShadowProcessing() {
 }
 
 
+void RingoPgBuildEngine::removeShadowInfo(int section_idx, const Array<int>& structures) {
+   _removeShadowRows(_shadowRelName.ptr(), section_idx, structures);
+}
+
+void RingoPgBuildEngine::moveShadowInfo(int section_idx, const Array<int>& structures, PtrArray<BingoPgFpData>& data) {
+   _moveShadowRows(_shadowRelName.ptr(), section_idx, structures, data);
+}
+
 void RingoPgBuildEngine::_processResultCb (void *context) {
    RingoPgBuildEngine* engine = (RingoPgBuildEngine*)context;
    ObjArray<StructCache>& struct_caches = *(engine->_structCaches);
@@ -206,6 +214,16 @@ bool RingoPgBuildEngine::_readPreparedInfo(int* id, RingoPgFpData& data, int fp_
       return false;
    data.setHash(ex_hash);
 
+   /*
+    * Set similarity bits count of the difference fingerprint
+    */
+   int sim_fp_bits_count;
+   bingo_res = ringoIndexReadPreparedSimBitsCount(&sim_fp_bits_count);
+   CORE_HANDLE_WARNING(bingo_res, 1, "reaction build engine: error while get similarity bits count", bingoGetError());
+   if(bingo_res < 1)
+      return false;
+   data.setBitsCount(sim_fp_bits_count);
+
    /*
     * Set common info
     */
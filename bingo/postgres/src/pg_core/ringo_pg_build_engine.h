@@ -31,6 +31,8 @@ public:
    virtual void prepareShadowInfo(const char* schema_name, const char* index_schema);
    virtual void insertShadowInfo(BingoPgFpData&);
    virtual void finishShadowProcessing();
+   virtual void removeShadowInfo(int section_idx, const indigo::Array<int>& structures);
+   virtual void moveShadowInfo(int section_idx, const indigo::Array<int>& structures, indigo::PtrArray<BingoPgFpData>& data);
 
    // hardcode return single threading for reactions due to an instable state
    int getNthreads() {return 1;}
@@ -92,6 +92,9 @@ void RingoPgSearchEngine::prepareQuerySearch(BingoPgIndex& bingo_idx, PG_OBJECT
       case BingoPgCommon::REACT_SMARTS:
          _prepareSmartsSearch(scan_desc);
          break;
+      case BingoPgCommon::REACT_SIM:
+         _prepareSimSearch(scan_desc);
+         break;
       default:
          throw Error("unsupported search type");
    }
@@ -105,10 +108,17 @@ bool RingoPgSearchEngine::searchNext(PG_OBJECT result_ptr) {
    
    if (_searchType == BingoPgCommon::REACT_EXACT) {
       result = _searchNextCursor(result_ptr);
+   } else if(_cacheHit) {
+      result = _searchNextCached(result_ptr);
    } else if(_searchType == BingoPgCommon::REACT_SUB || _searchType == BingoPgCommon::REACT_SMARTS) {
       result = _searchNextSub(result_ptr);
+   } else if(_searchType == BingoPgCommon::REACT_SIM) {
+      result = _searchNextSim(result_ptr);
    }
 
+   if(!result)
+      _putResultCache();
+
    return result;
 }
 
@@ -168,6 +178,7 @@ void RingoPgSearchEngine::_prepareSubSearch(PG_OBJECT scan_desc_ptr) {
    int size_bits = fp_len * 8;
    data.setFingerPrints(fingerprint_buf, size_bits);
 
+   _initResultCache(search_type.ptr(), search_query.ptr(), search_options.ptr());
 }
 
 void RingoPgSearchEngine::_prepareExactSearch(PG_OBJECT scan_desc_ptr) {
@@ -199,6 +210,59 @@ void RingoPgSearchEngine::_prepareSmartsSearch(PG_OBJECT scan_desc_ptr) {
    _prepareSubSearch(scan_desc_ptr);
 }
 
+void RingoPgSearchEngine::_prepareSimSearch(PG_OBJECT scan_desc_ptr) {
+   IndexScanDesc scan_desc = (IndexScanDesc) scan_desc_ptr;
+   QS_DEF(Array<char>, search_type);
+   Array<char> search_query;
+   Array<char> search_options;
+   int bingo_res;
+   float min_bound = 0, max_bound = 1;
+   BingoPgFpData& data = _queryFpData.ref();
+
+   BingoPgCommon::getSearchTypeString(_searchType, search_type, false);
+
+   _getScanQueries(scan_desc->keyData[0].sk_argument, min_bound, max_bound, search_query, search_options);
+   /*
+    * Get block parameters and split search options
+    */
+   _getBlockParameters(search_options);
+   /*
+    * Set up matching parameters
+    */
+   bingo_res = ringoSetupMatch(search_type.ptr(), search_query.ptr(), search_options.ptr());
+   CORE_HANDLE_ERROR(bingo_res, 1, "reaction search engine: can not set rsim search context", bingoGetError());
+
+   if(min_bound > max_bound)
+      throw Error("min bound %f can not be greater then max bound %f", min_bound, max_bound);
+
+   bingo_res = ringoSimilaritySetMinMaxBounds(min_bound, max_bound);
+   CORE_HANDLE_ERROR(bingo_res, 1, "reaction search engine: can not set similarity min max bounds", bingoGetError());
+
+   const char* fingerprint_buf;
+   int fp_len;
+
+   bingo_res = ringoGetQueryFingerprint(&fingerprint_buf, &fp_len);
+   CORE_HANDLE_ERROR(bingo_res, 1, "reaction search engine: can not get query fingerprint", bingoGetError());
+
+   int size_bits = fp_len * 8;
+   data.setFingerPrints(fingerprint_buf, size_bits);
+
+   /*
+    * Similarity bounds are the part of the query
+    */
+   QS_DEF(Array<char>, sim_options);
+   ArrayOutput sim_options_out(sim_options);
+   sim_options_out.printf("%f %f %s", min_bound, max_bound, search_options.ptr());
+   sim_options_out.writeChar(0);
+   _initResultCache(search_type.ptr(), search_query.ptr(), sim_options.ptr());
+}
+
+int RingoPgSearchEngine::_getSimilarityBounds(int bits_count, int* target_bits, int** min_bounds, int** max_bounds) {
+   int bingo_res = ringoSimilarityGetBitMinMaxBoundsArray(bits_count, target_bits, min_bounds, max_bounds);
+   CORE_HANDLE_ERROR(bingo_res, 1, "reaction search engine: error while getting similarity bounds array", bingoGetError());
+   return bingo_res;
+}
+
 void RingoPgSearchEngine::_getScanQueries(uintptr_t arg_datum, indigo::Array<char>& str1_out, indigo::Array<char>& str2_out) {
    /*
     * Get query info
@@ -248,3 +312,53 @@ void RingoPgSearchEngine::_getScanQueries(uintptr_t arg_datum, indigo::Array<cha
    BINGO_PG_HANDLE(throw Error("internal error: can not get scan query: %s", message));
 }
 
+void RingoPgSearchEngine::_getScanQueries(uintptr_t arg_datum, float& min_bound, float& max_bound, indigo::Array<char>& str1_out, indigo::Array<char>& str2_out) {
+   /*
+    * Get query info
+    */
+   BINGO_PG_TRY
+   {
+      HeapTupleHeader query_data = DatumGetHeapTupleHeader(arg_datum);
+      Oid tupType = HeapTupleHeaderGetTypeId(query_data);
+      int32 tupTypmod = HeapTupleHeaderGetTypMod(query_data);
+      TupleDesc tupdesc = lookup_rowtype_tupdesc(tupType, tupTypmod);
+      int ncolumns = tupdesc->natts;
+
+      if (ncolumns != 4)
+         throw Error("internal error: expecting four columns in query but was %d", ncolumns);
+
+      HeapTupleData tuple;
+      /*
+       * Build a temporary HeapTuple control structure
+       */
+      tuple.t_len = HeapTupleHeaderGetDatumLength(query_data);
+      ItemPointerSetInvalid(&(tuple.t_self));
+      tuple.t_tableOid = InvalidOid;
+      tuple.t_data = query_data;
+
+      Datum *values = (Datum *) palloc(ncolumns * sizeof (Datum));
+      bool *nulls = (bool *) palloc(ncolumns * sizeof (bool));
+
+      /*
+       *  Break down the tuple into fields
+       */
+      heap_deform_tuple(&tuple, tupdesc, values, nulls);
+
+      /*
+       * Query tuple consist of query and options
+       */
+      min_bound = DatumGetFloat4(values[0]);
+      max_bound = DatumGetFloat4(values[1]);
+      BingoPgText str1, str2;
+      str1.init(values[2]);
+      str2.init(values[3]);
+
+      str1_out.readString(str1.getString(), true);
+      str2_out.readString(str2.getString(), true);
+
+      pfree(values);
+      pfree(nulls);
+      ReleaseTupleDesc(tupdesc);
+   }
+   BINGO_PG_HANDLE(throw Error("internal error: can not get scan query: %s", message));
+}
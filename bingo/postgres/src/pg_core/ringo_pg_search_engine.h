@@ -57,7 +57,11 @@ private:
    void _prepareSubSearch(PG_OBJECT scan_desc);
    void _prepareExactSearch(PG_OBJECT scan_desc);
    void _prepareSmartsSearch(PG_OBJECT scan_desc);
+   void _prepareSimSearch(PG_OBJECT scan_desc);
    void _getScanQueries(uintptr_t arg_datum, indigo::Array<char>& str1, indigo::Array<char>& str2);
+   void _getScanQueries(uintptr_t arg_datum, float& min_bound, float& max_bound, indigo::Array<char>& str1, indigo::Array<char>& str2);
+
+   virtual int _getSimilarityBounds(int bits_count, int* target_bits, int** min_bounds, int** max_bounds);
 
    static void _errorHandler(const char* message, void* context);
 
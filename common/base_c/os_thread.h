@@ -15,6 +15,8 @@
 #ifndef __os_thread_h__
 #define __os_thread_h__
 
+#include "base_c/defs.h"
+
 //
 // Crossplatform thread support
 //
@@ -39,7 +41,7 @@
 extern "C" {
 #endif
 
-void osThreadCreate (THREAD_RET (THREAD_MOD *func)(void *param), void *param);
+DLLEXPORT void osThreadCreate (THREAD_RET (THREAD_MOD *func)(void *param), void *param);
 
 #ifdef __cplusplus
 }
@@ -57,6 +57,31 @@ void TimeoutCancellationHandler::reset (int mseconds)
    _currentTime = nanoClock();
 }
 
+//
+// LockedCancellationHandler
+//
+
+LockedCancellationHandler::LockedCancellationHandler (CancellationHandler &handler, OsLock &lock) :
+   _handler(handler), _lock(lock)
+{
+}
+
+bool LockedCancellationHandler::isCancelled ()
+{
+   OsLocker locker(_lock);
+
+   if (!_handler.isCancelled())
+      return false;
+
+   _message.readString(_handler.cancelledRequestMessage(), true);
+   return true;
+}
+
+const char* LockedCancellationHandler::cancelledRequestMessage ()
+{
+   return _message.ptr();
+}
+
 //
 // Global thread-local cancellation handler
 //
@@ -17,6 +17,7 @@
 
 #include "base_c/defs.h"
 #include "base_cpp/array.h"
+#include "base_cpp/os_sync_wrapper.h"
 
 #ifdef _WIN32
 #pragma warning(push)
@@ -50,6 +51,23 @@ private:
    qword _currentTime;
 };
 
+// Handler for a worker thread that calls a shared handler under a lock.
+// Handlers are not thread-safe (they write the message), so each thread
+// gets its own instance with the same lock, and keeps its own message.
+class DLLEXPORT LockedCancellationHandler : public CancellationHandler
+{
+public:
+   LockedCancellationHandler (CancellationHandler &handler, OsLock &lock);
+
+   virtual bool isCancelled ();
+   virtual const char* cancelledRequestMessage ();
+
+private:
+   CancellationHandler &_handler;
+   OsLock &_lock;
+   Array<char> _message;
+};
+
 // Global thread-local cancellation handler
 DLLEXPORT CancellationHandler* getCancellationHandler ();
 // Returns previous cancellation handler
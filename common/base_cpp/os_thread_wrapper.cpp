@@ -44,20 +44,23 @@ enum {
    MSG_OK,
    MSG_CONNECT,
    MSG_HANDLE_EXCEPTION,
-   MSG_TERMINATE
+   MSG_TERMINATE,
+   MSG_HANDLE_PARTIAL_RESULT
 };
 
 // Maximum number of results that are kept in queue if
 // _handling_order is HANDLING_ORDER_SERIAL
 static const int _MAX_RESULTS = 10;
 
-OsCommandDispatcher::OsCommandDispatcher (int handling_order, bool same_session_IDs)
+OsCommandDispatcher::OsCommandDispatcher (int handling_order, bool same_session_IDs) :
+   _finishedThreadsSem(0, 0x7FFFFFFF)
 {
    _storedResults.setSize(_MAX_RESULTS);
    _storedResults.zeroFill();
    _handling_order = handling_order;
    _session_id = TL_GET_SESSION_ID();
    _last_unique_command_id = 0;
+   _running_thread_count = 0;
    _same_session_IDs = same_session_IDs;
 }
 
@@ -69,6 +72,14 @@ extern "C" THREAD_RET THREAD_MOD _threadFuncStatic (void *param)
    THREAD_END;
 }
 
+bool OsCommand::flushResult (OsCommandResult &result)
+{
+   if (_dispatcher == 0)
+      throw Exception("OsCommand::flushResult: command is not executed by a dispatcher");
+
+   return _dispatcher->_flushPartialResult(_index, result);
+}
+
 void OsCommandDispatcher::run ()
 {
    _run(3 * osGetProcessorsCount() / 2 + 1);
@@ -91,6 +102,7 @@ void OsCommandDispatcher::_run (int nthreads)
    _exception_to_forward = NULL;
 
    _left_thread_count = nthreads;
+   _running_thread_count = nthreads;
 
    if (_left_thread_count == 0)
    {
@@ -122,6 +134,16 @@ void OsCommandDispatcher::_mainLoop ()
          _onMsgHandleResult();
       if (msg == MSG_HANDLE_EXCEPTION)
          _onMsgHandleException((Exception *)parameter);
+      if (msg == MSG_HANDLE_PARTIAL_RESULT)
+         _onMsgHandlePartialResult();
+   }
+
+   // Threads still access the dispatcher after receiving MSG_NO_TASK,
+   // so wait for them before the dispatcher can be destroyed
+   while (_running_thread_count > 0)
+   {
+      _finishedThreadsSem.Wait();
+      _running_thread_count--;
    }
 
    if (_exception_to_forward != NULL)
@@ -231,6 +253,17 @@ void OsCommandDispatcher::_onMsgHandleResult ()
       throw Exception("cmdDispatcher::_OnMsgHandleResult: internal error");
    index = *(int *)param;
 
+   if (_need_to_terminate)
+   {
+      // Results are not handled anymore, so the order does not matter
+      _privateMessageSystem.SendMsg(MSG_OK);
+      _recvCommandAndResult(result, command);
+      _availableCommands.add(command);
+      _availableResults.add(result);
+      _wakeSyspendedThreads();
+      return;
+   }
+
    if (_handling_order == HANDLING_ORDER_SERIAL)
       if (!_storedResults.isInBound(index))
       {
@@ -270,13 +303,106 @@ void OsCommandDispatcher::_onMsgHandleResult ()
       }
       _storedResults.setOffset(_expected_command_index);
 
-      // Wake up all syspended threads
-      for (int i = 0; i < _syspendedThreads.size(); i++)
-         _syspendedThreads[i]->Post();
-      _syspendedThreads.clear();
+      _wakeSyspendedThreads();
    }
 }
 
+void OsCommandDispatcher::_onMsgHandlePartialResult ()
+{
+   int index, msg;
+   void *param;
+
+   _privateMessageSystem.RecvMsg(&msg, &param);
+   if (msg != MSG_RECV_INDEX)
+      throw Exception("cmdDispatcher::_onMsgHandlePartialResult: internal error");
+   index = *(int *)param;
+
+   if (_need_to_terminate)
+   {
+      _privateMessageSystem.SendMsg(MSG_TERMINATE);
+      return;
+   }
+
+   // Partial result can not be stored, so it is handled only if
+   // all the results of the previous commands are handled
+   if (_handling_order == HANDLING_ORDER_SERIAL && index != _expected_command_index)
+   {
+      _privateMessageSystem.SendMsg(MSG_SYSPEND_RESULT);
+      _privateMessageSystem.RecvMsg(&msg, &param);
+      if (msg != MSG_SYSPEND_SEMAPHORE)
+         throw Exception("cmdDispatcher::_onMsgHandlePartialResult: internal error #2");
+
+      _syspendedThreads.push((OsSemaphore *)param);
+      return;
+   }
+
+   _privateMessageSystem.SendMsg(MSG_OK);
+   _privateMessageSystem.RecvMsg(&msg, &param);
+   if (msg != MSG_RECV_RESULT)
+      throw Exception("cmdDispatcher::_onMsgHandlePartialResult: internal error #3");
+
+   _handleResultWithCheck((OsCommandResult *)param);
+
+   if (_need_to_terminate)
+   {
+      _privateMessageSystem.SendMsg(MSG_TERMINATE);
+      _wakeSyspendedThreads();
+   }
+   else
+      _privateMessageSystem.SendMsg(MSG_OK);
+}
+
+bool OsCommandDispatcher::_flushPartialResult (int index, OsCommandResult &result)
+{
+   if (index < 0)
+   {
+      // Command is executed by _startStandalone()
+      if (!_need_to_terminate)
+         _handleResult(result);
+      result.clear();
+      return !_need_to_terminate;
+   }
+
+   OsSemaphore syspendSem(0, 1);
+   while (true)
+   {
+      int msg;
+      void *param;
+
+      _baseMessageSystem.SendMsg(MSG_HANDLE_PARTIAL_RESULT, NULL);
+      _privateMessageSystem.SendMsg(MSG_RECV_INDEX, &index);
+      _privateMessageSystem.RecvMsg(&msg, &param);
+
+      if (msg == MSG_SYSPEND_RESULT)
+      {
+         // Wait for the results of the previous commands
+         _privateMessageSystem.SendMsg(MSG_SYSPEND_SEMAPHORE, &syspendSem);
+         syspendSem.Wait();
+         continue;
+      }
+      if (msg == MSG_TERMINATE)
+      {
+         result.clear();
+         return false;
+      }
+      if (msg != MSG_OK)
+         throw Exception("cmdDispatcher::_flushPartialResult: internal error");
+
+      _privateMessageSystem.SendMsg(MSG_RECV_RESULT, &result);
+      _privateMessageSystem.RecvMsg(&msg, &param);
+
+      result.clear();
+      return msg == MSG_OK;
+   }
+}
+
+void OsCommandDispatcher::_wakeSyspendedThreads ()
+{
+   for (int i = 0; i < _syspendedThreads.size(); i++)
+      _syspendedThreads[i]->Post();
+   _syspendedThreads.clear();
+}
+
 void OsCommandDispatcher::_onMsgHandleException (Exception *exception)
 {
    OsCommandResult *result;
@@ -287,6 +413,9 @@ void OsCommandDispatcher::_onMsgHandleException (Exception *exception)
    _availableCommands.add(command);
 
    _handleException(exception);
+
+   // Results of the syspended threads are not handled anymore
+   _wakeSyspendedThreads();
 }
 
 void OsCommandDispatcher::_handleException (Exception *exception)
@@ -337,6 +466,9 @@ void OsCommandDispatcher::_threadFunc (void)
       OsCommand *command;
       _recvCommandAndResult(result, command);
 
+      command->_dispatcher = this;
+      command->_index = index;
+
       Exception *exception = NULL;
       try 
       {
@@ -391,6 +523,9 @@ void OsCommandDispatcher::_threadFunc (void)
 
    _cleanupThread();
 
+   // The dispatcher must not be accessed after this point
+   _finishedThreadsSem.Post();
+
    TL_RELEASE_SESSION_ID(initial_SID);
 }
 
@@ -422,6 +557,9 @@ void OsCommandDispatcher::_startStandalone ()
    OsCommandResult *result = _getVacantResult();
    OsCommand *command = _getVacantCommand();
 
+   command->_dispatcher = this;
+   command->_index = -1;
+
    while (_setupCommand(*command))
    {
       command->execute(*result);
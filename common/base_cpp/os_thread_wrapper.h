@@ -29,6 +29,10 @@
 // Session ID for each thread, created by dispatcher, is 
 // released before thread exit automatically via TL_RELEASE_SESSION_ID.
 //
+// Long commands can pass the partial results to the dispatcher by
+// OsCommand::flushResult() to keep the results small. Partial results are
+// handled in the same order as the other results.
+//
 // Note: OsCommand and OsCommandResult objects are reusable,
 // so they shouldn't have specific parameters in 
 // constructors if the same dispatcher object is 
@@ -41,28 +45,48 @@
 #include "base_cpp/os_sync_wrapper.h"
 #include "base_cpp/cyclic_array.h"
 
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
 namespace indigo {
 
-class OsCommandResult
+class DLLEXPORT OsCommandResult
 {
 public:
    virtual ~OsCommandResult () {};
    virtual void clear () {};
 };
 
-class OsCommand
+class OsCommandDispatcher;
+
+class DLLEXPORT OsCommand
 {
 public:
+   OsCommand () : _dispatcher(0), _index(-1) {};
    virtual ~OsCommand () {};
    virtual void clear () {};
    virtual void execute (OsCommandResult &result) = 0;
 
    int unique_id;
+
+protected:
+   // Handles the result of the unfinished command and clears it. Can be
+   // called only from execute(). Returns false if the dispatcher is
+   // terminating, so the rest of the command can be skipped
+   bool flushResult (OsCommandResult &result);
+
+private:
+   friend class OsCommandDispatcher;
+
+   OsCommandDispatcher *_dispatcher;
+   int _index; // -1 if the command is executed in the dispatcher thread
 };
 
 class Exception;
 
-class OsCommandDispatcher
+class DLLEXPORT OsCommandDispatcher
 {
 public:
    enum { HANDLING_ORDER_ANY, HANDLING_ORDER_SERIAL };
@@ -95,12 +119,18 @@ protected:
    virtual void   _cleanupThread   (void) {}
 
 private:
+   friend class OsCommand;
+
    // Methods
    void _startStandalone ();
 
    void _onMsgNeedTask        ();
    void _onMsgHandleResult    ();
    void _onMsgHandleException (Exception *exception);
+   void _onMsgHandlePartialResult ();
+
+   bool _flushPartialResult (int index, OsCommandResult &result);
+   void _wakeSyspendedThreads ();
 
    void _recvCommandAndResult (OsCommandResult * &result, OsCommand * &command);
 
@@ -123,11 +153,13 @@ private:
 
    OsMessageSystem _baseMessageSystem;
    OsMessageSystem _privateMessageSystem;
+   OsSemaphore     _finishedThreadsSem;
 
    int _last_command_index;
    int _expected_command_index;
    int _handling_order;
    int _left_thread_count;
+   int _running_thread_count;
    bool _need_to_terminate;
    qword _session_id;
    int _last_unique_command_id;
@@ -138,6 +170,10 @@ private:
 
 }
 
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+
 int osGetProcessorsCount (void);
 
 #endif // __cmd_thread_h__
@@ -0,0 +1,149 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ * 
+ * This file is part of Indigo toolkit.
+ * 
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ * 
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include <string.h>
+
+#include "base_cpp/sha256.h"
+
+using namespace indigo;
+
+static const dword _k[64] =
+{
+   0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+   0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+   0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+   0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+   0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+   0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+   0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+   0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline dword _rotr (dword x, int n)
+{
+   return (x >> n) | (x << (32 - n));
+}
+
+SHA256::SHA256 ()
+{
+   _state[0] = 0x6a09e667;
+   _state[1] = 0xbb67ae85;
+   _state[2] = 0x3c6ef372;
+   _state[3] = 0xa54ff53a;
+   _state[4] = 0x510e527f;
+   _state[5] = 0x9b05688c;
+   _state[6] = 0x1f83d9ab;
+   _state[7] = 0x5be0cd19;
+   _length = 0;
+   _buffered = 0;
+}
+
+void SHA256::_transform (const byte *block)
+{
+   dword w[64];
+   dword a, b, c, d, e, f, g, h;
+   int i;
+
+   for (i = 0; i < 16; i++)
+      w[i] = ((dword)block[4 * i] << 24) | ((dword)block[4 * i + 1] << 16) |
+             ((dword)block[4 * i + 2] << 8) | (dword)block[4 * i + 3];
+
+   for (i = 16; i < 64; i++)
+   {
+      dword s0 = _rotr(w[i - 15], 7) ^ _rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      dword s1 = _rotr(w[i - 2], 17) ^ _rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+   }
+
+   a = _state[0]; b = _state[1]; c = _state[2]; d = _state[3];
+   e = _state[4]; f = _state[5]; g = _state[6]; h = _state[7];
+
+   for (i = 0; i < 64; i++)
+   {
+      dword s1 = _rotr(e, 6) ^ _rotr(e, 11) ^ _rotr(e, 25);
+      dword ch = (e & f) ^ (~e & g);
+      dword t1 = h + s1 + ch + _k[i] + w[i];
+      dword s0 = _rotr(a, 2) ^ _rotr(a, 13) ^ _rotr(a, 22);
+      dword maj = (a & b) ^ (a & c) ^ (b & c);
+      dword t2 = s0 + maj;
+
+      h = g; g = f; f = e; e = d + t1;
+      d = c; c = b; b = a; a = t1 + t2;
+   }
+
+   _state[0] += a; _state[1] += b; _state[2] += c; _state[3] += d;
+   _state[4] += e; _state[5] += f; _state[6] += g; _state[7] += h;
+}
+
+void SHA256::update (const void *data, int len)
+{
+   const byte *bytes = (const byte *)data;
+
+   _length += len;
+
+   while (len > 0)
+   {
+      int n = 64 - _buffered;
+
+      if (n > len)
+         n = len;
+
+      memcpy(_buffer + _buffered, bytes, n);
+      _buffered += n;
+      bytes += n;
+      len -= n;
+
+      if (_buffered == 64)
+      {
+         _transform(_buffer);
+         _buffered = 0;
+      }
+   }
+}
+
+void SHA256::final (byte *digest)
+{
+   qword bits = _length * 8;
+   byte tail[8];
+   int i;
+
+   // Padding: single one bit, zeros, message length in bits
+   for (i = 0; i < 8; i++)
+      tail[i] = (byte)(bits >> (56 - 8 * i));
+
+   byte one = 0x80;
+   byte zero = 0;
+
+   update(&one, 1);
+   while (_buffered != 56)
+      update(&zero, 1);
+   update(tail, 8);
+
+   for (i = 0; i < 8; i++)
+   {
+      digest[4 * i] = (byte)(_state[i] >> 24);
+      digest[4 * i + 1] = (byte)(_state[i] >> 16);
+      digest[4 * i + 2] = (byte)(_state[i] >> 8);
+      digest[4 * i + 3] = (byte)_state[i];
+   }
+}
+
+void SHA256::get (const void *data, int len, byte *digest)
+{
+   SHA256 sha;
+
+   sha.update(data, len);
+   sha.final(digest);
+}
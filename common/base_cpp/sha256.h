@@ -0,0 +1,46 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ * 
+ * This file is part of Indigo toolkit.
+ * 
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ * 
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __sha256_h__
+#define __sha256_h__
+
+#include "base_c/defs.h"
+
+namespace indigo {
+
+// SHA-256 message digest (FIPS 180-2)
+class DLLEXPORT SHA256
+{
+public:
+   enum { DIGEST_SIZE = 32 };
+
+   SHA256 ();
+
+   void update (const void *data, int len);
+   void final (byte *digest);
+
+   static void get (const void *data, int len, byte *digest);
+
+private:
+   void _transform (const byte *block);
+
+   dword _state[8];
+   qword _length;
+   byte  _buffer[64];
+   int   _buffered;
+};
+
+}
+
+#endif
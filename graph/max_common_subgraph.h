@@ -24,6 +24,7 @@
 #include "math.h"
 #include "base_cpp/obj_list.h"
 #include "base_cpp/cancellation_handler.h"
+#include "base_cpp/os_sync_wrapper.h"
 
 #ifdef _WIN32
 #pragma warning(push)
@@ -32,6 +33,9 @@
 
 namespace indigo {
 
+class McsBranchCommand;
+class McsBranchDispatcher;
+
 class DLLEXPORT MaxCommonSubgraph{
 public:
 
@@ -49,12 +53,25 @@ public:
 
    //parameters for exact method
    struct ParametersForExact{
-      //boolean true if method reached max iteration number
+      //boolean true if method reached max iteration number or time limit
       bool isStopped;
+      //boolean true if the search was stopped by timeLimit
+      bool isTimeLimitReached;
       //max iteration number
       int maxIteration;
       //number of solutions that are finded by exact algorithm
       int numberOfSolutions;
+      //number of threads: one - serial mode, zero - automatic. Threads search
+      //the branches of the first level and the solutions are merged in the
+      //branches order, so the result does not depend on the threads number
+      int threads;
+      //time limit in milliseconds, zero - no limit. When it is reached the search
+      //is stopped as for maxIteration, the solutions found so far are kept and
+      //isTimeLimitReached is set
+      int timeLimit;
+      //keep only the solutions with the largest number of edges. Branches are cut
+      //when the edge labels left can not give a solution of that size
+      bool largestOnly;
    };
 
    //parameters for approximate algorithm
@@ -160,6 +177,12 @@ public:
       void clear();
       //sets maximum iterations number
       void setMaxIteration(int m) {_maxIteration = m; };
+      //sets number of threads: one - serial mode, zero - automatic
+      void setThreadsCount(int n) {_threads = n; };
+      //sets time limit in milliseconds, zero - no limit
+      void setTimeLimit(int ms);
+      //keeps only the largest solutions (see ParametersForExact)
+      void setLargestOnly(bool value) {_largestOnly = value; };
       //set sizes for util variables
       void setSizes(int n1, int n2);
       //adds new RePoint to nodes set
@@ -176,8 +199,10 @@ public:
       int getPointIndex(int i, int j) const;
       //returns number of nodes (RePoints) in resolution graph
       int size() const {return _graph.size(); };
-      //returns true if algorithm has reached maximum iteration
+      //returns true if algorithm has reached maximum iteration or time limit
       bool stopped() { return _stop; };
+      //returns true if algorithm has reached time limit
+      bool timeLimitReached() { return _timeLimitReached; };
       //gets RePoint with index i
       RePoint *getPoint(int i) { return _graph[i]; };
 
@@ -234,7 +259,40 @@ public:
       Pool< ObjList<Solution>::Elem > _pool;
       ObjList<Solution> _solutionObjList;
 
+      int _threads;
+      //time when the search should stop, zero - no limit
+      qword _deadline;
+      bool _timeLimitReached;
+      bool _largestOnly;
+      //number of edges in the largest solution found
+      int _bestBits;
+      //edges of the first and the second graph that have the same set of
+      //compatible edges. Used for the upper bound of the solution size
+      ObjArray<Dbitset> _labelsG1;
+      ObjArray<Dbitset> _labelsG2;
+
+      //graph of the nodes for the branch search in a thread
+      ReGraph* _parent;
+      //guards _bestBits, _nbIteration and _stop of the parent from the branches
+      OsLock _lock;
+
+      RePoint* _point(int i) { return _parent != 0 ? _parent->_graph[i] : _graph[i]; };
+      //searches the branches that start from the nodes [begin, end)
+      void _parse(int begin, int end);
+      void _parseParallel();
+      //exchanges the best size and the iterations with the parent, checks limits
+      void _checkLimits();
+      void _calculateLabels();
+      //upper bound of the solution size for the edges that are left
+      int _labelBound(const Dbitset& pnode_g1, const Dbitset& pnode_g2);
+      Dbitset _labelTmp;
+      //drops the solutions that are smaller than the largest one
+      void _removeSmallSolutions();
+
    private:
+      friend class indigo::McsBranchCommand;
+      friend class indigo::McsBranchDispatcher;
+
       ReGraph(const ReGraph&);//no implicit copy
 
    };
@@ -0,0 +1,77 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __max_common_subgraph_parallel_h__
+#define __max_common_subgraph_parallel_h__
+
+#include "base_cpp/auto_ptr.h"
+#include "base_cpp/cancellation_handler.h"
+#include "base_cpp/os_thread_wrapper.h"
+#include "graph/max_common_subgraph.h"
+
+namespace indigo {
+
+//
+// Exact MCS search of the resolution graph in the worker threads. Each
+// command searches one branch of the first level with its own ReGraph
+// that refers to the nodes of the parent. Branches take the nodes in
+// order when a thread is free, and their solutions are merged into the
+// parent in the same order.
+//
+
+class McsBranchDispatcher : public OsCommandDispatcher
+{
+public:
+   McsBranchDispatcher (MaxCommonSubgraph::ReGraph &regraph);
+
+protected:
+   friend class McsBranchCommand;
+
+   virtual OsCommand* _allocateCommand ();
+   virtual OsCommandResult* _allocateResult ();
+
+   virtual bool _setupCommand (OsCommand &command);
+   virtual void _handleResult (OsCommandResult &result);
+
+   MaxCommonSubgraph::ReGraph &_regraph;
+   int _next;
+   bool _merge_stopped;
+   OsLock _cancellation_lock;
+};
+
+class McsBranchResult : public OsCommandResult
+{
+public:
+   virtual void clear ();
+
+   AutoPtr<MaxCommonSubgraph::ReGraph> branch;
+};
+
+class McsBranchCommand : public OsCommand
+{
+public:
+   McsBranchCommand (McsBranchDispatcher &dispatcher);
+
+   virtual void execute (OsCommandResult &result);
+   virtual void clear ();
+
+   int point_idx;
+
+private:
+   McsBranchDispatcher &_dispatcher;
+};
+
+}
+
+#endif
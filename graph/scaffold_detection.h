@@ -45,6 +45,29 @@ public:
 
    int maxIterations;
 
+   //number of threads for the exact search: one - serial mode, zero - automatic
+   int nthreads;
+   //time limit in milliseconds, zero - no limit. When the limit is reached the
+   //scaffolds found for the already processed graphs are kept
+   int timeLimit;
+   //true if the search was stopped by the time limit
+   bool timeLimitReached;
+
+   //counts of vertices, edges, independent cycles, ring edges and edges of the
+   //largest ring system. A graph can be a substructure of another one only if
+   //none of its counts is greater.
+   struct RingFingerprint {
+      int vertices;
+      int edges;
+      int cycles;
+      int ringEdges;
+      int maxRingSystem;
+   };
+
+   static void getRingFingerprint(Graph& graph, RingFingerprint& fp);
+   static bool mayBeSubstructure(Graph& sub, Graph& super);
+   static bool mayBeSubstructure(const RingFingerprint& sub, const RingFingerprint& super);
+
    DECL_ERROR;
 
 public:
@@ -80,6 +103,8 @@ public:
 
       virtual Graph& getGraphFromSet(int idx) {return _searchStructures->at(_orderArray[idx]); }
       virtual int getGraphSetSize() const {return _graphSetSize; }
+      //returns new copy of graph from set with the same vertex and edge indices
+      virtual Graph* copyGraphFromSet(int idx);
 
       int (*cbSortSolutions) (Graph &graph1, Graph &graph2, void *userdata);
       bool (*cbMatchEdges) (Graph &graph1, Graph &graph2, int i, int j, void *userdata);
@@ -118,11 +143,31 @@ public:
    };
 
 
+   //solutions for one graph from basket and the next graph from set
+   class PairSolutions {
+   public:
+      int basketIdx;
+      //basket graph is a substructure of graph from set and is kept
+      bool substructure;
+      ObjArray< Array<int> > vLists;
+      ObjArray< Array<int> > eLists;
+   };
+
+   //searches solutions for one graph from basket in exact mode
+   void searchExactPair(SubstructureMcs& sub_mcs, MaxCommonSubgraph& mcs, Graph& graph_bask, Graph& graph_set, PairSolutions& solutions);
+   void setupExactSearch(SubstructureMcs& sub_mcs, MaxCommonSubgraph& mcs);
+   //milliseconds left before the time limit
+   int timeLeft() const;
+
 protected:
    //method for extracting exact scaffold from graph set
    void _searchExactScaffold(GraphBasket& basket);
    //method for extracting approximate scaffold from graph set
    void _searchApproximateScaffold(GraphBasket& basket);
+   //adds solutions to basket in the order of basket graphs
+   void _mergeSolutions(GraphBasket& basket, Graph& graph_set, ObjArray<PairSolutions>& solutions);
+
+   qword _startTime;
 private:
    void _searchScaffold(Graph& scaffold, bool approximate);
 };
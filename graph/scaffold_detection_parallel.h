@@ -0,0 +1,68 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __scaffold_detection_parallel_h__
+#define __scaffold_detection_parallel_h__
+
+#include "base_cpp/os_thread_wrapper.h"
+#include "base_cpp/os_sync_wrapper.h"
+#include "graph/scaffold_detection.h"
+
+namespace indigo {
+
+//
+// Exact scaffold search of one graph from the set against all the
+// graphs of the basket in the worker threads. Each command compares
+// one basket graph with its own copy of the set graph, and keeps the
+// solutions in the place of the pair. The basket is not changed.
+//
+
+class ScaffoldDetectionDispatcher : public OsCommandDispatcher
+{
+public:
+   ScaffoldDetectionDispatcher (ScaffoldDetection &detection, ScaffoldDetection::GraphBasket &basket,
+                                int set_idx, ObjArray<ScaffoldDetection::PairSolutions> &solutions);
+
+protected:
+   friend class ScaffoldDetectionCommand;
+
+   virtual OsCommand* _allocateCommand ();
+
+   virtual bool _setupCommand (OsCommand &command);
+
+   ScaffoldDetection &_detection;
+   ScaffoldDetection::GraphBasket &_basket;
+   int _set_idx;
+   ObjArray<ScaffoldDetection::PairSolutions> &_solutions;
+   int _next;
+   OsLock _lock;
+};
+
+class ScaffoldDetectionCommand : public OsCommand
+{
+public:
+   ScaffoldDetectionCommand (ScaffoldDetectionDispatcher &dispatcher);
+
+   virtual void execute (OsCommandResult &result);
+   virtual void clear ();
+
+   int pair_idx;
+
+private:
+   ScaffoldDetectionDispatcher &_dispatcher;
+};
+
+}
+
+#endif
@@ -15,6 +15,8 @@
 #include "base_cpp/array.h"
 #include "base_cpp/cancellation_handler.h"
 #include "graph/max_common_subgraph.h"
+#include "graph/max_common_subgraph_parallel.h"
+#include "base_c/nano.h"
 #include "time.h"
 
 using namespace indigo;
@@ -32,8 +34,12 @@ MaxCommonSubgraph::MaxCommonSubgraph(Graph &subgraph, Graph &supergraph) :
    _supergraph(&supergraph){
 
    parametersForExact.isStopped = false;
+   parametersForExact.isTimeLimitReached = false;
    parametersForExact.maxIteration = -1;
    parametersForExact.numberOfSolutions = 0;
+   parametersForExact.threads = 1;
+   parametersForExact.timeLimit = 0;
+   parametersForExact.largestOnly = false;
 
    parametersForApproximate.error = 0;
    parametersForApproximate.maxIteration = 1000;
@@ -143,6 +149,9 @@ void MaxCommonSubgraph::findExactMCS(){
    
    ReGraph regraph;
    regraph.setMaxIteration(parametersForExact.maxIteration);
+   regraph.setThreadsCount(parametersForExact.threads);
+   regraph.setTimeLimit(parametersForExact.timeLimit);
+   regraph.setLargestOnly(parametersForExact.largestOnly);
 
    ReCreation rc(regraph, *this);
    rc.createRegraph();
@@ -155,6 +164,7 @@ void MaxCommonSubgraph::findExactMCS(){
    regraph.parse(find_all_str);
 
    parametersForExact.isStopped = regraph.stopped();
+   parametersForExact.isTimeLimitReached = regraph.timeLimitReached();
    parametersForExact.numberOfSolutions = rc.createSolutionMaps();
 
 
@@ -581,7 +591,13 @@ MaxCommonSubgraph::ReGraph::ReGraph():
    _secondGraphSize(0), 
    _findAllStructure(true), 
    _stop(false),
-   _solutionObjList(_pool) {
+   _solutionObjList(_pool),
+   _threads(1),
+   _deadline(0),
+   _timeLimitReached(false),
+   _largestOnly(false),
+   _bestBits(0),
+   _parent(0) {
    cancellation_handler = getCancellationHandler();
 }
 
@@ -595,8 +611,17 @@ cbEmbedding(0),
    _secondGraphSize(0),
    _findAllStructure(true),
    _stop(false),
-   _solutionObjList(_pool) {
+   _solutionObjList(_pool),
+   _threads(1),
+   _deadline(0),
+   _timeLimitReached(false),
+   _largestOnly(false),
+   _bestBits(0),
+   _parent(0) {
    setMaxIteration(context.parametersForExact.maxIteration);
+   setThreadsCount(context.parametersForExact.threads);
+   setTimeLimit(context.parametersForExact.timeLimit);
+   setLargestOnly(context.parametersForExact.largestOnly);
    cancellation_handler = getCancellationHandler();
 }
 
@@ -610,14 +635,40 @@ void MaxCommonSubgraph::ReGraph::setSizes(int n1, int n2){
 void MaxCommonSubgraph::ReGraph::clear(){
    _graph.clear();
    _solutionObjList.clear();
+   _bestBits = 0;
+}
+
+void MaxCommonSubgraph::ReGraph::setTimeLimit(int ms){
+   // nanoClock() returns microseconds
+   _deadline = ms > 0 ? nanoClock() + (qword)ms * 1000 : 0;
 }
 
 void MaxCommonSubgraph::ReGraph::parse(bool findAllStructure){
    _size = _graph.size();
    _findAllStructure = findAllStructure;
 
+   if(_largestOnly)
+      _calculateLabels();
 
+   /*
+    * Branches of the first level are independent when all structures are searched,
+    * otherwise the solutions are compared with the given mapping in the search order
+    */
+   if(_threads != 1 && _findAllStructure && _size > 1)
+      _parseParallel();
+   else
+      _parse(0, _size);
 
+   if(_largestOnly)
+      _removeSmallSolutions();
+}
+
+void MaxCommonSubgraph::ReGraph::_parseParallel(){
+   McsBranchDispatcher dispatcher(*this);
+   dispatcher.run(_threads > 0 ? _threads : -1);
+}
+
+void MaxCommonSubgraph::ReGraph::_parse(int begin, int end){
    Dbitset pnode_g1(_firstGraphSize);
    Dbitset pnode_g2(_secondGraphSize);
 
@@ -651,7 +702,13 @@ void MaxCommonSubgraph::ReGraph::parse(bool findAllStructure){
       allowed_g2.push(_secondGraphSize);
       xk[i] = -1;
    }
-   extension[0].set();
+   if(_largestOnly) {
+      _labelTmp.clear();
+      _labelTmp.resize(__max(_firstGraphSize, _secondGraphSize));
+   }
+
+   extension[0].set(begin, end);
+   forbidden[0].set(0, begin);
    allowed_g1[0].set();
    allowed_g2[0].set();
 
@@ -663,14 +720,14 @@ void MaxCommonSubgraph::ReGraph::parse(bool findAllStructure){
          next_level = level + 1;
          xk_level = xk[level];
 
-         forbidden[next_level].bsOrBs(forbidden[level], _graph.at(xk_level)->forbidden);
-         allowed_g1[next_level].bsAndBs(allowed_g1[level], _graph.at(xk_level)->allowed_g1);
-         allowed_g2[next_level].bsAndBs(allowed_g2[level], _graph.at(xk_level)->allowed_g2);
+         forbidden[next_level].bsOrBs(forbidden[level], _point(xk_level)->forbidden);
+         allowed_g1[next_level].bsAndBs(allowed_g1[level], _point(xk_level)->allowed_g1);
+         allowed_g2[next_level].bsAndBs(allowed_g2[level], _point(xk_level)->allowed_g2);
 
          if (traversed[level].isEmpty()) {
-            extension[next_level].bsAndNotBs(_graph.at(xk_level)->extension, forbidden[next_level]);
+            extension[next_level].bsAndNotBs(_point(xk_level)->extension, forbidden[next_level]);
          } else {
-            extension[next_level].bsOrBs(extension[level], _graph.at(xk_level)->extension);
+            extension[next_level].bsOrBs(extension[level], _point(xk_level)->extension);
             extension[next_level].andNotWith(forbidden[next_level]);
          }
 
@@ -679,8 +736,8 @@ void MaxCommonSubgraph::ReGraph::parse(bool findAllStructure){
 
          traversed_g1[next_level].copy(traversed_g1[level]);
          traversed_g2[next_level].copy(traversed_g2[level]);
-         traversed_g1[next_level].set(_graph.at(xk_level)->getid1());
-         traversed_g2[next_level].set(_graph.at(xk_level)->getid2());
+         traversed_g1[next_level].set(_point(xk_level)->getid1());
+         traversed_g2[next_level].set(_point(xk_level)->getid2());
 
          forbidden[level].set(xk_level);
 
@@ -697,16 +754,12 @@ void MaxCommonSubgraph::ReGraph::parse(bool findAllStructure){
             pnode_g1.bsOrBs(allowed_g1[level], traversed_g1[level]);
             pnode_g2.bsOrBs(allowed_g2[level], traversed_g2[level]);
 
-            if (_mustContinue(pnode_g1, pnode_g2)) {
+            if (_mustContinue(pnode_g1, pnode_g2) && (!_largestOnly || _labelBound(pnode_g1, pnode_g2) >= _bestBits)) {
                ++_nbIteration;
                if(_maxIteration > -1 && _nbIteration >= _maxIteration)
                   _stop = true;
-               if(_nbIteration % 10 == 0) {
-                  if(cancellation_handler != 0) {
-                     if(cancellation_handler->isCancelled())
-                        throw Error("mcs search was cancelled: %s", cancellation_handler->cancelledRequestMessage());
-                  }
-               }
+               if(_nbIteration % 10 == 0)
+                  _checkLimits();
             } else { 
                xk[level] = -1;
                --level;
@@ -724,6 +777,97 @@ void MaxCommonSubgraph::ReGraph::parse(bool findAllStructure){
    //printf("iter = %d\n", _nbIteration);
    //printf("size = %d\n", _solutionObjList.size());
 }
+
+void MaxCommonSubgraph::ReGraph::_checkLimits(){
+   /*
+    * Time limit keeps the solutions found so far, so it is checked before the
+    * cancellation handler that may be set up with the same time by the caller
+    */
+   if(_deadline != 0 && nanoClock() >= _deadline) {
+      _stop = true;
+      _timeLimitReached = true;
+   } else if(cancellation_handler != 0) {
+      if(cancellation_handler->isCancelled())
+         throw Error("mcs search was cancelled: %s", cancellation_handler->cancelledRequestMessage());
+   }
+
+   if(_parent == 0)
+      return;
+   /*
+    * Branch is called each 10 iterations. Iterations are counted by the parent,
+    * and the largest solution size is shared between the branches
+    */
+   OsLocker locker(_parent->_lock);
+   _parent->_nbIteration += 10;
+   if(_parent->_maxIteration > -1 && _parent->_nbIteration >= _parent->_maxIteration)
+      _parent->_stop = true;
+   if(_stop)
+      _parent->_stop = true;
+   if(_timeLimitReached)
+      _parent->_timeLimitReached = true;
+   _stop = _parent->_stop;
+
+   if(_bestBits > _parent->_bestBits)
+      _parent->_bestBits = _bestBits;
+   _bestBits = _parent->_bestBits;
+}
+
+void MaxCommonSubgraph::ReGraph::_calculateLabels(){
+   QS_DEF(ObjArray<Dbitset>, compatible);
+   int i, j;
+
+   compatible.clear();
+   for(i = 0; i < _firstGraphSize; i++)
+      compatible.push(_secondGraphSize);
+
+   for(i = 0; i < _graph.size(); i++)
+      compatible[_graph[i]->getid1()].set(_graph[i]->getid2());
+
+   /*
+    * Edges of the first graph are grouped by the sets of the compatible edges of
+    * the second graph. A solution can not have more edges of a group than both graphs have
+    */
+   _labelsG1.clear();
+   _labelsG2.clear();
+   for(i = 0; i < _firstGraphSize; i++) {
+      if(compatible[i].isEmpty())
+         continue;
+      for(j = 0; j < _labelsG2.size(); j++) {
+         if(_labelsG2[j].equals(compatible[i]))
+            break;
+      }
+      if(j == _labelsG2.size()) {
+         _labelsG1.push(_firstGraphSize);
+         _labelsG2.push(_secondGraphSize);
+         _labelsG2[j].copy(compatible[i]);
+      }
+      _labelsG1[j].set(i);
+   }
+}
+
+int MaxCommonSubgraph::ReGraph::_labelBound(const Dbitset& pnode_g1, const Dbitset& pnode_g2){
+   const ReGraph& owner = _parent != 0 ? *_parent : *this;
+   int bound = 0;
+
+   for(int j = 0; j < owner._labelsG1.size(); j++) {
+      _labelTmp.bsAndBs(pnode_g1, owner._labelsG1[j]);
+      int n1 = _labelTmp.bitsNumber();
+      if(n1 == 0)
+         continue;
+      _labelTmp.bsAndBs(pnode_g2, owner._labelsG2[j]);
+      bound += __min(n1, _labelTmp.bitsNumber());
+   }
+   return __min(bound, pnode_g2.bitsNumber());
+}
+
+void MaxCommonSubgraph::ReGraph::_removeSmallSolutions(){
+   for(int i = _solutionObjList.begin(); i != _solutionObjList.end();) {
+      int idx_next = _solutionObjList.next(i);
+      if(_solutionObjList.at(i).numBits < _bestBits)
+         _solutionObjList.remove(i);
+      i = idx_next;
+   }
+}
 void MaxCommonSubgraph::ReGraph::insertSolution(int ins_index, bool ins_after, const Dbitset& sol, const Dbitset& sol_g1, const Dbitset& sol_g2, int num_bits) {
    
    if(_solutionObjList.size() == 0) {
@@ -740,16 +884,24 @@ void MaxCommonSubgraph::ReGraph::insertSolution(int ins_index, bool ins_after, c
    _solutionObjList.at(ins_index).solutionProj2.copy(sol_g2);
    _solutionObjList.at(ins_index).numBits = num_bits;
 
+   if(num_bits > _bestBits) {
+      OsLocker locker(_lock);
+      if(num_bits > _bestBits)
+         _bestBits = num_bits;
+   }
+
    if(cbEmbedding != 0) {
       QS_DEF(Array<int>, sub_edge_map);
       sub_edge_map.resize(_firstGraphSize);
       sub_edge_map.zerofill();
 
       for(int x = sol.nextSetBit(0); x >= 0; x  = sol.nextSetBit(x+1)) {
-         sub_edge_map[_graph.at(x)->getid1()] = _graph.at(x)->getid2();
+         sub_edge_map[_point(x)->getid1()] = _point(x)->getid2();
       }
-      if(!cbEmbedding(0, sub_edge_map.ptr(), 0, userdata))
+      if(!cbEmbedding(0, sub_edge_map.ptr(), 0, userdata)) {
+         OsLocker locker(_lock);
          _stop = true;
+      }
    }
 }
 
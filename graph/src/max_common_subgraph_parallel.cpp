@@ -0,0 +1,153 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include "graph/max_common_subgraph_parallel.h"
+
+using namespace indigo;
+
+//
+// McsBranchDispatcher
+//
+
+McsBranchDispatcher::McsBranchDispatcher (MaxCommonSubgraph::ReGraph &regraph) :
+   OsCommandDispatcher(OsCommandDispatcher::HANDLING_ORDER_SERIAL, false),
+   _regraph(regraph)
+{
+   _next = 0;
+   _merge_stopped = false;
+}
+
+OsCommand * McsBranchDispatcher::_allocateCommand ()
+{
+   return new McsBranchCommand(*this);
+}
+
+OsCommandResult * McsBranchDispatcher::_allocateResult ()
+{
+   return new McsBranchResult();
+}
+
+bool McsBranchDispatcher::_setupCommand (OsCommand &command)
+{
+   if (_next >= _regraph._size)
+      return false;
+
+   McsBranchCommand &cmd = (McsBranchCommand &)command;
+
+   cmd.point_idx = _next++;
+   return true;
+}
+
+void McsBranchDispatcher::_handleResult (OsCommandResult &result)
+{
+   McsBranchResult &res = (McsBranchResult &)result;
+
+   if (_merge_stopped || res.branch.get() == 0)
+      return;
+
+   MaxCommonSubgraph::ReGraph &branch = res.branch.ref();
+
+   for (int i = branch.solBegin(); branch.solIsNotEnd(i); i = branch.solNext(i))
+   {
+      MaxCommonSubgraph::Solution &solution = branch._solutionObjList.at(i);
+
+      _regraph._solution(solution.reSolution, solution.solutionProj1, solution.solutionProj2);
+
+      // The embedding callback asked to stop: the rest is not reported
+      if (_regraph.cbEmbedding != 0)
+      {
+         OsLocker locker(_regraph._lock);
+
+         if (_regraph._stop)
+         {
+            _merge_stopped = true;
+            break;
+         }
+      }
+   }
+}
+
+//
+// McsBranchResult
+//
+
+void McsBranchResult::clear ()
+{
+   branch.free();
+   OsCommandResult::clear();
+}
+
+//
+// McsBranchCommand
+//
+
+McsBranchCommand::McsBranchCommand (McsBranchDispatcher &dispatcher) :
+   _dispatcher(dispatcher)
+{
+   point_idx = -1;
+}
+
+void McsBranchCommand::clear ()
+{
+   point_idx = -1;
+   OsCommand::clear();
+}
+
+void McsBranchCommand::execute (OsCommandResult &result)
+{
+   MaxCommonSubgraph::ReGraph &parent = _dispatcher._regraph;
+   McsBranchResult &res = (McsBranchResult &)result;
+
+   res.branch.reset(new MaxCommonSubgraph::ReGraph());
+
+   MaxCommonSubgraph::ReGraph &branch = res.branch.ref();
+
+   branch._parent = &parent;
+   branch._size = parent._size;
+   branch.setSizes(parent._firstGraphSize, parent._secondGraphSize);
+   branch._findAllStructure = parent._findAllStructure;
+   branch._deadline = parent._deadline;
+   branch._largestOnly = parent._largestOnly;
+
+   // The handler of the parent is checked by all the branches, so each
+   // branch has its own wrapper that serializes the calls
+   AutoPtr<LockedCancellationHandler> cancellation;
+
+   if (parent.cancellation_handler != 0)
+      cancellation.reset(new LockedCancellationHandler(*parent.cancellation_handler,
+                                                       _dispatcher._cancellation_lock));
+   branch.cancellation_handler = cancellation.get();
+
+   {
+      OsLocker locker(parent._lock);
+
+      if (parent._stop)
+         return;
+      branch._bestBits = parent._bestBits;
+   }
+
+   branch._parse(point_idx, point_idx + 1);
+   branch.cancellation_handler = 0;
+
+   // Iterations that were not passed to the parent yet
+   OsLocker locker(parent._lock);
+
+   parent._nbIteration += branch._nbIteration % 10;
+   if (parent._maxIteration > -1 && parent._nbIteration >= parent._maxIteration)
+      parent._stop = true;
+   if (branch._stop)
+      parent._stop = true;
+   if (branch._timeLimitReached)
+      parent._timeLimitReached = true;
+}
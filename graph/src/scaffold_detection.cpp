@@ -13,8 +13,12 @@
  ***************************************************************************/
 
 #include "graph/scaffold_detection.h"
+#include "base_c/nano.h"
 #include "base_cpp/array.h"
+#include "base_cpp/auto_ptr.h"
+#include "base_cpp/cancellation_handler.h"
 #include "graph/max_common_subgraph.h"
+#include "graph/scaffold_detection_parallel.h"
 #include "base_cpp/ptr_array.h"
 
 using namespace indigo;
@@ -30,7 +34,11 @@ cbEmbedding(0),
 embeddingUserdata(0),
 searchStructures(graph_set),
 basketStructures(0),
-maxIterations(0) {
+maxIterations(0),
+nthreads(1),
+timeLimit(0),
+timeLimitReached(false),
+_startTime(0) {
 }
 
 void ScaffoldDetection::_searchScaffold(Graph& scaffold, bool approximate) {
@@ -54,75 +62,197 @@ void ScaffoldDetection::_searchScaffold(Graph& scaffold, bool approximate) {
 }
 
 void ScaffoldDetection::_searchExactScaffold(GraphBasket& basket) {
-   ObjArray< Array<int> > v_lists;
-   ObjArray< Array<int> > e_lists;
+   QS_DEF(ObjArray<PairSolutions>, solutions);
 
    int graphset_size = basket.getGraphSetSize();
    int first_graph_num = 0;
-      
+
    SubstructureMcs sub_mcs;
+   MaxCommonSubgraph mcs(basket.getGraph(0), basket.getGraph(0));
+   setupExactSearch(sub_mcs, mcs);
+
+   basket.cbMatchEdges = cbEdgeWeight;
+   basket.cbMatchVertices = cbVerticesColor;
+   basket.userdata = userdata;
+
+   _startTime = nanoClock();
+   timeLimitReached = false;
+   TimeoutCancellationHandler timeout(timeLimit);
+   AutoPtr<AutoCancellationHandler> timeout_wrapper;
+   if(timeLimit > 0)
+      timeout_wrapper.reset(new AutoCancellationHandler(timeout));
+
+   for(int orgraph = first_graph_num+1; orgraph < graphset_size; orgraph++) {
+
+      Graph& graph_set = basket.getGraphFromSet(orgraph);
+
+      solutions.clear();
+      for(int bgraph = basket.graphBegin(); bgraph >= 0; bgraph = basket.graphNext(bgraph))
+         solutions.push().basketIdx = bgraph;
+
+      /*
+       * Basket is changed only after all the searches for the graph, so
+       * the search that was cancelled by the time limit leaves it as it was
+       */
+      try {
+         if(nthreads != 1 && solutions.size() > 1) {
+            ScaffoldDetectionDispatcher dispatcher(*this, basket, orgraph, solutions);
+            dispatcher.run(nthreads > 0 ? nthreads : -1);
+         } else {
+            for(int i = 0; i < solutions.size(); i++)
+               searchExactPair(sub_mcs, mcs, basket.getGraph(solutions[i].basketIdx), graph_set, solutions[i]);
+         }
+      } catch(Exception&) {
+         if(timeLimit > 0 && timeLeft() <= 0) {
+            timeLimitReached = true;
+            break;
+         }
+         throw;
+      }
+
+      _mergeSolutions(basket, graph_set, solutions);
+      basket.checkAddedGraphs();
+
+      if(cbEmbedding != 0) {
+         if(!cbEmbedding(&orgraph, &graphset_size, 0, embeddingUserdata))
+            break;
+      }
+
+      if(timeLimit > 0 && timeLeft() <= 0) {
+         timeLimitReached = orgraph + 1 < graphset_size;
+         break;
+      }
+   }
+}
+
+void ScaffoldDetection::setupExactSearch(SubstructureMcs& sub_mcs, MaxCommonSubgraph& mcs) {
    sub_mcs.cbMatchEdge = cbEdgeWeight;
    sub_mcs.cbMatchVertex = cbVerticesColor;
    sub_mcs.userdata = userdata;
 
-   MaxCommonSubgraph mcs(basket.getGraph(0), basket.getGraph(0));
    mcs.conditionEdgeWeight = cbEdgeWeight;
    mcs.conditionVerticesColor = cbVerticesColor;
    mcs.userdata = userdata;
    if(maxIterations > 0)
       mcs.parametersForExact.maxIteration = maxIterations;
+   mcs.parametersForExact.threads = nthreads;
+}
 
-   basket.cbMatchEdges = cbEdgeWeight;
-   basket.cbMatchVertices = cbVerticesColor;
-   basket.userdata = userdata;
+void ScaffoldDetection::searchExactPair(SubstructureMcs& sub_mcs, MaxCommonSubgraph& mcs, Graph& graph_bask,
+                                        Graph& graph_set, PairSolutions& solutions) {
+   solutions.vLists.clear();
+   solutions.eLists.clear();
+   solutions.substructure = false;
 
-   for(int orgraph = first_graph_num+1; orgraph < graphset_size; orgraph++) {
+   sub_mcs.setGraphs(graph_bask, graph_set);
+   if(!sub_mcs.isInverted() && mayBeSubstructure(graph_bask, graph_set) && sub_mcs.searchSubstructure(0)) {
+      solutions.substructure = true;
+      return;
+   }
 
-      Graph& graph_set = basket.getGraphFromSet(orgraph);
-      
-      for(int bgraph = basket.graphBegin(); bgraph >= 0; bgraph = basket.graphNext(bgraph)) {
-         Graph& graph_bask = basket.getGraph(bgraph);
+   mcs.setGraphs(graph_bask, graph_set);
+   if(timeLimit > 0)
+      mcs.parametersForExact.timeLimit = __max(timeLeft(), 1);
 
-         sub_mcs.setGraphs(graph_bask, graph_set);
-         if(!sub_mcs.isInverted() && sub_mcs.searchSubstructure(0))
-            continue;
+   MaxCommonSubgraph::ReGraph regraph(mcs);
+   MaxCommonSubgraph::ReCreation build_graph(regraph, mcs);
+   build_graph.createRegraph();
+   regraph.parse(true);
+
+   /*
+    * Throw an exception if max limit was reached
+    */
+   if(regraph.timeLimitReached())
+      throw Error("scaffold detection exact searching time limit reached");
+   if(regraph.stopped())
+      throw Error("scaffold detection exact searching max iteration limit reached");
 
-         mcs.setGraphs(graph_bask, graph_set);
+   build_graph.getSolutionListsSuper(solutions.vLists, solutions.eLists);
+}
 
-         MaxCommonSubgraph::ReGraph regraph(mcs);
-         MaxCommonSubgraph::ReCreation build_graph(regraph, mcs);
-         build_graph.createRegraph();
-         regraph.parse(true);
+void ScaffoldDetection::_mergeSolutions(GraphBasket& basket, Graph& graph_set, ObjArray<PairSolutions>& solutions) {
+   for(int i = 0; i < solutions.size(); i++) {
+      PairSolutions& pair = solutions[i];
 
-         /*
-          * Throw an exception if max limit was reached
-          */
-         if(regraph.stopped())
-            throw Error("scaffold detection exact searching max iteration limit reached");
-         
-         build_graph.getSolutionListsSuper(v_lists, e_lists);
+      if(pair.substructure)
+         continue;
 
+      for(int j = 0; j < pair.eLists.size(); j++)
+         basket.addToNextEmptySpot(graph_set, pair.vLists[j], pair.eLists[j]);
 
-         for(int i = 0; i < e_lists.size(); i++) {
-            basket.addToNextEmptySpot(graph_set, v_lists[i], e_lists[i]);
-         }
+      basket.removeGraph(pair.basketIdx);
+   }
+}
 
-         basket.removeGraph(bgraph);
-      }
-      basket.checkAddedGraphs();
+int ScaffoldDetection::timeLeft() const {
+   return timeLimit - (int)(nanoHowManySeconds(nanoClock() - _startTime) * 1000);
+}
 
-      if(cbEmbedding != 0) {
-         if(!cbEmbedding(&orgraph, &graphset_size, 0, embeddingUserdata))
-            break;
+void ScaffoldDetection::getRingFingerprint(Graph& graph, RingFingerprint& fp) {
+   QS_DEF(Array<int>, system);
+   QS_DEF(Array<int>, stack);
+   int i, j;
+
+   fp.vertices = graph.vertexCount();
+   fp.edges = graph.edgeCount();
+   fp.cycles = fp.edges - fp.vertices + graph.countComponents();
+   fp.ringEdges = 0;
+   fp.maxRingSystem = 0;
+
+   system.clear_resize(graph.vertexEnd());
+   system.fffill();
+
+   //ring systems are the connected parts of the ring edges
+   for(i = graph.vertexBegin(); i != graph.vertexEnd(); i = graph.vertexNext(i)) {
+      if(system[i] >= 0)
+         continue;
+
+      int system_edges = 0;
+
+      system[i] = i;
+      stack.clear();
+      stack.push(i);
+      while(stack.size() > 0) {
+         const Vertex& vertex = graph.getVertex(stack.pop());
+
+         for(j = vertex.neiBegin(); j != vertex.neiEnd(); j = vertex.neiNext(j)) {
+            if(graph.getEdgeTopology(vertex.neiEdge(j)) != TOPOLOGY_RING)
+               continue;
+            system_edges++;
+
+            int nei = vertex.neiVertex(j);
+            if(system[nei] < 0) {
+               system[nei] = i;
+               stack.push(nei);
+            }
+         }
       }
+
+      //each edge is met from both ends
+      system_edges /= 2;
+      fp.ringEdges += system_edges;
+      if(system_edges > fp.maxRingSystem)
+         fp.maxRingSystem = system_edges;
    }
 }
 
+bool ScaffoldDetection::mayBeSubstructure(const RingFingerprint& sub, const RingFingerprint& super) {
+   return sub.vertices <= super.vertices && sub.edges <= super.edges && sub.cycles <= super.cycles &&
+          sub.ringEdges <= super.ringEdges && sub.maxRingSystem <= super.maxRingSystem;
+}
+
+bool ScaffoldDetection::mayBeSubstructure(Graph& sub, Graph& super) {
+   RingFingerprint sub_fp, super_fp;
+
+   getRingFingerprint(sub, sub_fp);
+   getRingFingerprint(super, super_fp);
+   return mayBeSubstructure(sub_fp, super_fp);
+}
+
 void ScaffoldDetection::_searchApproximateScaffold(GraphBasket& basket) {
+   QS_DEF(ObjArray<PairSolutions>, solutions);
    ObjArray< Array<int> > v_maps;
    ObjArray< Array<int> > e_maps;
-   Array<int> v_list;
-   Array<int> e_list;
 
    int graphset_size = basket.getGraphSetSize();
 
@@ -150,47 +280,77 @@ void ScaffoldDetection::_searchApproximateScaffold(GraphBasket& basket) {
    basket.cbMatchVertices = cbVerticesColor;
    basket.userdata = userdata;
 
+   _startTime = nanoClock();
+   timeLimitReached = false;
+
    MaxCommonSubgraph::AdjMatricesStore adjm(mcs, 2 * max_size);
    MaxCommonSubgraph::Greedy greedy(adjm);
    MaxCommonSubgraph::RandomDisDec randdisdec(adjm);
 
+   TimeoutCancellationHandler timeout(timeLimit);
+   AutoPtr<AutoCancellationHandler> timeout_wrapper;
+   if(timeLimit > 0)
+      timeout_wrapper.reset(new AutoCancellationHandler(timeout));
+
+   /*
+    * Random search depends on the state that is left by the previous pairs,
+    * so it is done in one thread in the same order
+    */
    for(int orgraph = 1; orgraph < graphset_size; orgraph++) {
-      
+
       Graph& graph_set = basket.getGraphFromSet(orgraph);
-      
-      for(int bgraph = basket.graphBegin(); bgraph >= 0; bgraph = basket.graphNext(bgraph)) {
-         Graph& graph_bask = basket.getGraph(bgraph);
-         //search sub
-         sub_mcs.setGraphs(graph_bask, graph_set);
-         if(!sub_mcs.isInverted() && sub_mcs.searchSubstructure(0))
-            continue;
-         //search mcs
-
-         mcs.setGraphs(graph_bask, graph_set);
-         adjm.create(graph_bask, graph_set);
-         greedy.greedyMethod();
-         randdisdec.refinementStage();
-
-         adjm.createSolutionMaps();
-         mcs.getSolutionMaps(&v_maps, &e_maps);
-         
-         for(int i = 0; i < e_maps.size(); ++i) {
-             v_list.clear();
-             for(int j = 0 ; j < v_maps[i].size(); ++j) 
-                 if(v_maps[i].at(j) != SubstructureMcs::UNMAPPED)
+
+      solutions.clear();
+      try {
+         for(int bgraph = basket.graphBegin(); bgraph >= 0; bgraph = basket.graphNext(bgraph)) {
+            Graph& graph_bask = basket.getGraph(bgraph);
+            PairSolutions& pair = solutions.push();
+
+            pair.basketIdx = bgraph;
+            pair.substructure = false;
+            //search sub
+            sub_mcs.setGraphs(graph_bask, graph_set);
+            if(!sub_mcs.isInverted() && mayBeSubstructure(graph_bask, graph_set) && sub_mcs.searchSubstructure(0)) {
+               pair.substructure = true;
+               continue;
+            }
+            //search mcs
+
+            mcs.setGraphs(graph_bask, graph_set);
+            adjm.create(graph_bask, graph_set);
+            greedy.greedyMethod();
+            randdisdec.refinementStage();
+
+            adjm.createSolutionMaps();
+            mcs.getSolutionMaps(&v_maps, &e_maps);
+
+            for(int i = 0; i < e_maps.size(); ++i) {
+               Array<int>& v_list = pair.vLists.push();
+               Array<int>& e_list = pair.eLists.push();
+
+               for(int j = 0 ; j < v_maps[i].size(); ++j)
+                  if(v_maps[i].at(j) != SubstructureMcs::UNMAPPED)
                      v_list.push(v_maps[i].at(j));
 
-             e_list.clear();
-             for(int j = 0 ; j < e_maps[i].size(); ++j) 
-                 if(e_maps[i].at(j) != SubstructureMcs::UNMAPPED)
+               for(int j = 0 ; j < e_maps[i].size(); ++j)
+                  if(e_maps[i].at(j) != SubstructureMcs::UNMAPPED)
                      e_list.push(e_maps[i].at(j));
 
-             if(v_list.size() > 1) 
-                basket.addToNextEmptySpot(graph_set, v_list, e_list);
-             
+               if(v_list.size() <= 1) {
+                  pair.vLists.pop();
+                  pair.eLists.pop();
+               }
+            }
          }
-         basket.removeGraph(bgraph);
+      } catch(Exception&) {
+         if(timeLimit > 0 && timeLeft() <= 0) {
+            timeLimitReached = true;
+            break;
+         }
+         throw;
       }
+
+      _mergeSolutions(basket, graph_set, solutions);
       basket.checkAddedGraphs();
 
       if(cbEmbedding != 0) {
@@ -198,6 +358,10 @@ void ScaffoldDetection::_searchApproximateScaffold(GraphBasket& basket) {
             break;
       }
 
+      if(timeLimit > 0 && timeLeft() <= 0) {
+         timeLimitReached = orgraph + 1 < graphset_size;
+         break;
+      }
    }
 
 }
@@ -298,6 +462,8 @@ void ScaffoldDetection::GraphBasket::checkAddedGraphs() {
    for(int x = added_iter.nextSetBit(0); x >= 0; x = added_iter.nextSetBit(x+1)) {
       add_to_basket = true;
       for(int y = graphBegin(); y >= 0; y = graphNext(y)) {
+         if(!mayBeSubstructure(getGraph(x), getGraph(y)) && !mayBeSubstructure(getGraph(y), getGraph(x)))
+            continue;
          sub_mcs.setGraphs(getGraph(x), getGraph(y));
          if(sub_mcs.searchSubstructure(0)) {
             add_to_basket = false;
@@ -365,6 +531,18 @@ int ScaffoldDetection::GraphBasket::getMaxGraphIndex() {
 
    return 0;
 }
+namespace {
+   //gives access to the index preserving clone
+   class GraphCopy : public Graph {
+   public:
+      GraphCopy(const Graph& other) {_cloneGraph_KeepIndices(other); }
+   };
+}
+
+Graph* ScaffoldDetection::GraphBasket::copyGraphFromSet(int idx) {
+   return new GraphCopy(getGraphFromSet(idx));
+}
+
 void ScaffoldDetection::GraphBasket::addToNextEmptySpot(Graph& graph, Array<int>& v_list, Array<int>& e_list) {
    pickOutNextGraph().makeEdgeSubgraph(graph, v_list, e_list, 0, 0);
 }
@@ -0,0 +1,100 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include "graph/scaffold_detection_parallel.h"
+
+#include "base_cpp/auto_ptr.h"
+#include "base_cpp/cancellation_handler.h"
+
+using namespace indigo;
+
+//
+// ScaffoldDetectionDispatcher
+//
+
+ScaffoldDetectionDispatcher::ScaffoldDetectionDispatcher (ScaffoldDetection &detection,
+   ScaffoldDetection::GraphBasket &basket, int set_idx,
+   ObjArray<ScaffoldDetection::PairSolutions> &solutions) :
+   OsCommandDispatcher(OsCommandDispatcher::HANDLING_ORDER_ANY, false),
+   _detection(detection), _basket(basket), _set_idx(set_idx), _solutions(solutions)
+{
+   _next = 0;
+}
+
+OsCommand * ScaffoldDetectionDispatcher::_allocateCommand ()
+{
+   return new ScaffoldDetectionCommand(*this);
+}
+
+bool ScaffoldDetectionDispatcher::_setupCommand (OsCommand &command)
+{
+   if (_next >= _solutions.size())
+      return false;
+
+   ScaffoldDetectionCommand &cmd = (ScaffoldDetectionCommand &)command;
+
+   cmd.pair_idx = _next++;
+   return true;
+}
+
+//
+// ScaffoldDetectionCommand
+//
+
+ScaffoldDetectionCommand::ScaffoldDetectionCommand (ScaffoldDetectionDispatcher &dispatcher) :
+   _dispatcher(dispatcher)
+{
+   pair_idx = -1;
+}
+
+void ScaffoldDetectionCommand::clear ()
+{
+   pair_idx = -1;
+   OsCommand::clear();
+}
+
+void ScaffoldDetectionCommand::execute (OsCommandResult &result)
+{
+   ScaffoldDetection &detection = _dispatcher._detection;
+   ScaffoldDetection::PairSolutions &pair = _dispatcher._solutions[pair_idx];
+   AutoPtr<Graph> graph_set;
+
+   // Matching callbacks may fill the lazy data of the graphs, so the
+   // set graph is copied for each pair
+   {
+      OsLocker locker(_dispatcher._lock);
+      graph_set.reset(_dispatcher._basket.copyGraphFromSet(_dispatcher._set_idx));
+   }
+
+   // Cancellation handler is thread-local
+   TimeoutCancellationHandler timeout(1);
+   AutoPtr<AutoCancellationHandler> timeout_wrapper;
+
+   if (detection.timeLimit > 0)
+   {
+      int time_left = detection.timeLeft();
+
+      timeout.reset(time_left > 0 ? time_left : 1);
+      timeout_wrapper.reset(new AutoCancellationHandler(timeout));
+   }
+
+   SubstructureMcs sub_mcs;
+   MaxCommonSubgraph mcs(graph_set.ref(), graph_set.ref());
+
+   detection.setupExactSearch(sub_mcs, mcs);
+   // Pairs are already searched in threads
+   mcs.parametersForExact.threads = 1;
+   detection.searchExactPair(sub_mcs, mcs, _dispatcher._basket.getGraph(pair.basketIdx),
+                             graph_set.ref(), pair);
+}
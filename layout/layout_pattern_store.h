@@ -0,0 +1,93 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __layout_pattern_store_h__
+#define __layout_pattern_store_h__
+
+#include "base_cpp/array.h"
+#include "base_cpp/ptr_array.h"
+#include "base_cpp/exception.h"
+#include "base_cpp/os_sync_wrapper.h"
+#include "layout/layout_pattern.h"
+
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+namespace indigo {
+
+class BaseMolecule;
+class Scanner;
+
+// Process-wide store of the ring system layout templates, hashed by
+// the Morgan code and the atom and bond counts of the ring system.
+// Built-in templates are added on the first use. Templates from the
+// user libraries are added at any time and are tried before the
+// built-in ones. Templates are never changed or removed, so the found
+// ones are used by all threads without holding the lock.
+class DLLEXPORT LayoutPatternStore
+{
+public:
+   LayoutPatternStore ();
+
+   static LayoutPatternStore & getInstance ();
+
+   // Templates that can match the ring system, in the matching order
+   void find (long morgan_code, int n_vertices, int n_edges, Array<PatternLayout *> &patterns);
+
+   // Every ring system of the molecules from a Molfile or SDF with
+   // 2D coordinates becomes a template. Returns the number of templates.
+   int loadLibrary (Scanner &scanner);
+   int loadLibrary (const char *filename);
+
+   int count ();
+
+   DECL_ERROR;
+
+protected:
+   struct _Entry
+   {
+      long morgan_code;
+      int  n_vertices;
+      int  n_edges;
+      bool user;
+      int  next;
+   };
+
+   PtrArray<PatternLayout> _patterns;
+   Array<_Entry> _entries;
+   Array<int>    _buckets;
+   bool          _builtin_added;
+   OsLock        _lock;
+
+   void _addBuiltinPatterns ();
+   int  _addMolecule (BaseMolecule &mol, const char *name);
+   void _addPattern (PatternLayout *pattern, bool user);
+   void _link (int idx);
+   void _rehash (int n_buckets);
+
+   static dword _hash (long morgan_code, int n_vertices, int n_edges);
+
+private:
+   LayoutPatternStore (const LayoutPatternStore &); // no implicit copy
+};
+
+}
+
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+
+#endif
@@ -35,12 +35,22 @@ public:
 
    void make ();
 
+   // Layout after an edit: atoms farther than incremental_radius bonds
+   // from the changed atoms and bonds keep their coordinates, the others
+   // are laid out again. Ring systems with a changed atom are laid out
+   // as a whole. Bond length is taken from the kept part of the drawing.
+   void makeIncremental (const Array<int> &changed_atoms, const Array<int> &changed_bonds);
+
    void setCancellationHandler (CancellationHandler* cancellation);
 
    float bond_length;
    bool respect_existing_layout;
    Filter *filter;
    int  max_iterations;
+   // Threads for the independent components and ring systems:
+   // 1 - serial mode (default), 0 - automatic
+   int  nthreads;
+   int  incremental_radius;
    
    DECL_ERROR;
 
@@ -59,6 +69,11 @@ protected:
 
    void _init ();
 
+   void  _findAffectedAtoms (const Array<int> &changed_atoms, const Array<int> &changed_bonds, Array<int> &affected);
+   bool  _findFixedPieces (const Array<int> &affected);
+   float _fixedBondLength ();
+   void  _restoreFixedPieces ();
+
    Metalayout _ml;
    BaseMolecule          &_molecule;
    AutoPtr<BaseMolecule> _molCollapsed;
@@ -68,6 +83,13 @@ protected:
    Array<BaseMolecule*>  _map;
    bool _query;
    bool _hasMulGroups;
+
+   // Incremental layout: fixed piece of each atom (-1 for the atoms
+   // to lay out) and 1 for the pieces kept in place by the layout graph,
+   // the other pieces are moved after the layout as rigid bodies
+   bool       _incremental;
+   Array<int> _pieces;
+   Array<int> _main_pieces;
 };
 
 }
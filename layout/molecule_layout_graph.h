@@ -110,6 +110,10 @@ public:
    const BaseMolecule *getMolecule (const int **molecule_edge_mapping) { *molecule_edge_mapping = _molecule_edge_mapping; return _molecule; }
 
    int max_iterations;
+
+   // Threads for the independent connected components and ring systems:
+   // 1 - serial mode (default), 0 - automatic
+   int nthreads;
       
    CancellationHandler* cancellation;
    
@@ -123,6 +127,8 @@ public:
    DECL_ERROR;
 
 protected:
+   friend class MoleculeLayoutGraphCommand;
+   friend class LayoutPatternStore;
 
    struct Cycle
    {
@@ -163,15 +169,13 @@ protected:
    };
 
    // patterns
-   void _initPatterns ();
-   static int _pattern_cmp  (PatternLayout &p1, PatternLayout &p2, void *context);
-   static int _pattern_cmp2 (PatternLayout &p1, int n_v, int n_e, long code);
    static bool _match_pattern_bond (Graph &subgraph, Graph &supergraph, int self_idx, int other_idx, void *userdata);
    static int  _pattern_embedding (Graph &subgraph, Graph &supergraph, int *core_sub, int *core_super, void *userdata);
 
    static bool _path_handle (Graph &graph, const Array<int> &vertices, const Array<int> &edges, void *context);
 
    // for whole graph
+   void _layoutComponent (float bond_length, const Array<Vec2f> &src_layout);
    void _assignAbsoluteCoordinates (float bond_length);
    void _findFirstVertexIdx (int n_comp, Array<int> & fixed_components, ObjArray<MoleculeLayoutGraph> &bc_components, bool all_trivial);
    bool _prepareAssignedList (Array<int> &assigned_list, BiconnectedDecomposer &bc_decom, ObjArray<MoleculeLayoutGraph> &bc_components, Array<int> &bc_tree);
@@ -265,8 +269,6 @@ protected:
    const int *_molecule_edge_mapping;
    
    bool _flipped; // component was flipped after attaching
-
-   TL_DECL(ObjArray<PatternLayout>, _patterns);
 };
 
 }
@@ -0,0 +1,153 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __molecule_layout_parallel_h__
+#define __molecule_layout_parallel_h__
+
+#include "base_cpp/os_thread_wrapper.h"
+#include "base_cpp/obj_array.h"
+#include "layout/molecule_layout_graph.h"
+
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+namespace indigo {
+
+class BaseMolecule;
+
+//
+// Layout of the independent parts of a layout graph in the worker
+// threads: connected components of the molecule or ring systems
+// (nontrivial biconnected components) of one connected component.
+// Each command lays out one part, so the parts of very different
+// size are spread between the threads evenly.
+//
+
+class MoleculeLayoutGraphDispatcher : public OsCommandDispatcher
+{
+public:
+   enum
+   {
+      CONNECTED_COMPONENTS,
+      RING_SYSTEMS
+   };
+
+   MoleculeLayoutGraphDispatcher (int task, ObjArray<MoleculeLayoutGraph> &components,
+                                  const Array<int> &indices);
+
+   // For CONNECTED_COMPONENTS
+   float bond_length;
+   const ObjArray< Array<Vec2f> > *src_layouts;
+
+   // For RING_SYSTEMS
+   const MoleculeLayoutGraph *supergraph;
+   Array<int> *fixed_components;
+
+protected:
+   friend class MoleculeLayoutGraphCommand;
+
+   virtual OsCommand* _allocateCommand ();
+
+   virtual bool _setupCommand (OsCommand &command);
+
+   int _task;
+   ObjArray<MoleculeLayoutGraph> &_components;
+   const Array<int> &_indices;
+   int _next;
+};
+
+class MoleculeLayoutGraphCommand : public OsCommand
+{
+public:
+   MoleculeLayoutGraphCommand (MoleculeLayoutGraphDispatcher &dispatcher);
+
+   virtual void execute (OsCommandResult &result);
+   virtual void clear ();
+
+   int component_idx;
+
+private:
+   MoleculeLayoutGraphDispatcher &_dispatcher;
+};
+
+//
+// Layout of many molecules with the same settings. Molecules are split
+// between the worker threads and laid out in place, one MoleculeLayout
+// per molecule. Errors are collected instead of being thrown.
+//
+
+class DLLEXPORT MoleculeLayoutBatch
+{
+public:
+   MoleculeLayoutBatch ();
+
+   // nthreads: 1 - serial mode, 0 - automatic
+   void make (Array<BaseMolecule *> &molecules, int nthreads);
+
+   float bond_length;
+   int   max_iterations;
+   // Time limit for each molecule in milliseconds, zero means no limit
+   int   cancellation_timeout;
+
+   // Error message for each molecule, empty if the molecule is laid out
+   ObjArray< Array<char> > errors;
+
+   int failedCount () const;
+
+protected:
+   friend class MoleculeLayoutBatchCommand;
+
+   void _makeOne (int idx);
+
+   Array<BaseMolecule *> *_molecules;
+};
+
+class MoleculeLayoutBatchDispatcher : public OsCommandDispatcher
+{
+public:
+   MoleculeLayoutBatchDispatcher (MoleculeLayoutBatch &batch, int count);
+
+protected:
+   virtual OsCommand* _allocateCommand ();
+
+   virtual bool _setupCommand (OsCommand &command);
+
+   MoleculeLayoutBatch &_batch;
+   int _count;
+   int _next_molecule;
+};
+
+class MoleculeLayoutBatchCommand : public OsCommand
+{
+public:
+   MoleculeLayoutBatchCommand (MoleculeLayoutBatch &batch);
+
+   virtual void execute (OsCommandResult &result);
+   virtual void clear ();
+
+   int molecule_idx;
+
+private:
+   MoleculeLayoutBatch &_batch;
+};
+
+}
+
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+
+#endif
@@ -0,0 +1,335 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include "layout/layout_pattern_store.h"
+
+#include "base_cpp/auto_ptr.h"
+#include "base_cpp/scanner.h"
+#include "base_cpp/tlscont.h"
+#include "graph/biconnected_decomposer.h"
+#include "graph/filter.h"
+#include "layout/molecule_layout_graph.h"
+#include "molecule/molecule.h"
+#include "molecule/molfile_loader.h"
+#include "molecule/sdf_loader.h"
+
+using namespace indigo;
+
+IMPL_ERROR(LayoutPatternStore, "layout pattern store");
+
+static ThreadSafeStaticObj<LayoutPatternStore> _layout_pattern_store;
+
+static int _float_cmp (const float &f1, const float &f2, void *context)
+{
+   if (f1 < f2)
+      return -1;
+   if (f1 > f2)
+      return 1;
+   return 0;
+}
+
+LayoutPatternStore::LayoutPatternStore ()
+{
+   _builtin_added = false;
+   _buckets.clear_resize(256);
+   _buckets.fffill();
+}
+
+LayoutPatternStore & LayoutPatternStore::getInstance ()
+{
+   return _layout_pattern_store.ref();
+}
+
+dword LayoutPatternStore::_hash (long morgan_code, int n_vertices, int n_edges)
+{
+   dword hash = (dword)morgan_code;
+
+   hash = hash * 0x9E3779B1 + n_vertices;
+   hash = hash * 0x9E3779B1 + n_edges;
+   return hash ^ (hash >> 16);
+}
+
+void LayoutPatternStore::find (long morgan_code, int n_vertices, int n_edges, Array<PatternLayout *> &patterns)
+{
+   OsLocker locker(_lock);
+
+   if (!_builtin_added)
+      _addBuiltinPatterns();
+
+   patterns.clear();
+
+   int idx = _buckets[_hash(morgan_code, n_vertices, n_edges) & (_buckets.size() - 1)];
+
+   for (; idx != -1; idx = _entries[idx].next)
+   {
+      const _Entry &entry = _entries[idx];
+
+      if (entry.morgan_code == morgan_code && entry.n_vertices == n_vertices &&
+          entry.n_edges == n_edges)
+         patterns.push(_patterns[idx]);
+   }
+}
+
+int LayoutPatternStore::count ()
+{
+   OsLocker locker(_lock);
+
+   if (!_builtin_added)
+      _addBuiltinPatterns();
+
+   return _patterns.size();
+}
+
+int LayoutPatternStore::loadLibrary (const char *filename)
+{
+   FileScanner scanner(filename);
+
+   return loadLibrary(scanner);
+}
+
+int LayoutPatternStore::loadLibrary (Scanner &scanner)
+{
+   SdfLoader loader(scanner);
+   PtrArray<Molecule> molecules;
+
+   // Whole library is parsed before the store is locked
+   while (!loader.isEOF())
+   {
+      loader.readNext();
+
+      BufferScanner record(loader.data);
+      MolfileLoader mf_loader(record);
+      Molecule &mol = molecules.add(new Molecule());
+
+      mf_loader.loadMolecule(mol);
+
+      if (!mol.have_xyz)
+         throw Error("template %d has no coordinates", molecules.size());
+   }
+
+   OsLocker locker(_lock);
+
+   if (!_builtin_added)
+      _addBuiltinPatterns();
+
+   int count = 0;
+
+   for (int i = 0; i < molecules.size(); i++)
+      count += _addMolecule(*molecules[i], "user template");
+
+   return count;
+}
+
+int LayoutPatternStore::_addMolecule (BaseMolecule &mol, const char *name)
+{
+   QS_DEF(Array<int>, vertices);
+   QS_DEF(Array<int>, mapping);
+   QS_DEF(Array<float>, lengths);
+   BiconnectedDecomposer bc_decom(mol);
+   int n_comp = bc_decom.decompose();
+   int count = 0;
+   int i, j;
+
+   mapping.clear_resize(mol.vertexEnd());
+
+   for (i = 0; i < n_comp; i++)
+   {
+      Filter comp;
+
+      bc_decom.getComponent(i, comp);
+      comp.collectGraphVertices(mol, vertices);
+
+      // Single edges are not ring systems
+      if (vertices.size() < 3)
+         continue;
+
+      // Coordinates are scaled to the median bond length
+      // and shifted to the lowest atom, as for the built-in templates
+      AutoPtr<PatternLayout> pattern(new PatternLayout());
+      int lowest = vertices[0];
+
+      pattern->setName(name);
+
+      mapping.fffill();
+      for (j = 0; j < vertices.size(); j++)
+      {
+         mapping[vertices[j]] = j;
+         if (mol.getAtomXyz(vertices[j]).y < mol.getAtomXyz(lowest).y)
+            lowest = vertices[j];
+      }
+
+      lengths.clear();
+      for (j = mol.edgeBegin(); j < mol.edgeEnd(); j = mol.edgeNext(j))
+      {
+         const Edge &edge = mol.getEdge(j);
+
+         if (mapping[edge.beg] < 0 || mapping[edge.end] < 0)
+            continue;
+
+         Vec2f v1, v2;
+
+         Vec2f::projectZ(v1, mol.getAtomXyz(edge.beg));
+         Vec2f::projectZ(v2, mol.getAtomXyz(edge.end));
+         lengths.push(Vec2f::dist(v1, v2));
+      }
+
+      lengths.qsort(_float_cmp, 0);
+
+      float scale = lengths[lengths.size() / 2];
+
+      if (scale < EPSILON)
+         throw Error("template has zero bond length");
+
+      const Vec3f &origin = mol.getAtomXyz(lowest);
+
+      for (j = 0; j < vertices.size(); j++)
+      {
+         const Vec3f &pos = mol.getAtomXyz(vertices[j]);
+
+         pattern->addAtom((pos.x - origin.x) / scale, (pos.y - origin.y) / scale);
+      }
+
+      for (j = mol.edgeBegin(); j < mol.edgeEnd(); j = mol.edgeNext(j))
+      {
+         const Edge &edge = mol.getEdge(j);
+
+         if (mapping[edge.beg] >= 0 && mapping[edge.end] >= 0)
+            pattern->addBond(mapping[edge.beg], mapping[edge.end], mol.getBondOrder(j));
+      }
+
+      // Outline is built the same way as for the ring systems without a template
+      MoleculeLayoutGraph graph;
+
+      graph.makeOnGraph(pattern.ref());
+
+      for (j = graph.vertexBegin(); j < graph.vertexEnd(); j = graph.vertexNext(j))
+         graph.getPos(j) = pattern->getAtom(graph.getVertexExtIdx(j)).pos;
+
+      graph._buildOutline();
+
+      const Array<Vec2f> &outline = *graph._outline.get();
+
+      for (j = 0; j < outline.size(); j++)
+         pattern->addOutlinePoint(outline[j].x, outline[j].y);
+
+      _addPattern(pattern.release(), true);
+      count++;
+   }
+
+   return count;
+}
+
+void LayoutPatternStore::_addPattern (PatternLayout *pattern, bool user)
+{
+   pattern->calcMorganCode();
+
+   int idx = _patterns.size();
+   _Entry &entry = _entries.push();
+
+   _patterns.add(pattern);
+
+   entry.morgan_code = pattern->morganCode();
+   entry.n_vertices = pattern->vertexCount();
+   entry.n_edges = pattern->edgeCount();
+   entry.user = user;
+   entry.next = -1;
+
+   if (_entries.size() > _buckets.size())
+      _rehash(_buckets.size() * 2);
+   else
+      _link(idx);
+}
+
+void LayoutPatternStore::_link (int idx)
+{
+   _Entry &entry = _entries[idx];
+   int &head = _buckets[_hash(entry.morgan_code, entry.n_vertices, entry.n_edges) & (_buckets.size() - 1)];
+
+   // User templates go before the others, the last library first.
+   // Built-in templates keep their order.
+   if (entry.user || head == -1)
+   {
+      entry.next = head;
+      head = idx;
+      return;
+   }
+
+   int last = head;
+
+   while (_entries[last].next != -1)
+      last = _entries[last].next;
+
+   entry.next = -1;
+   _entries[last].next = idx;
+}
+
+void LayoutPatternStore::_rehash (int n_buckets)
+{
+   _buckets.clear_resize(n_buckets);
+   _buckets.fffill();
+
+   for (int i = 0; i < _entries.size(); i++)
+      _link(i);
+}
+
+void LayoutPatternStore::_addBuiltinPatterns ()
+{
+   struct LayoutPattenItem
+   {
+      enum { _ADD_ATOM, _ADD_BOND, _OUTLINE_POINT };
+      int type;
+      int idx_or_type;
+      int v1, v2;
+      float x, y;
+   };
+
+   _builtin_added = true;
+
+   #define BEGIN_PATTERN(name)  \
+   { \
+      AutoPtr<PatternLayout> pattern(new PatternLayout()); \
+      PatternLayout &p = pattern.ref(); p.setName(name);   \
+      static LayoutPattenItem _items[] = {
+
+   #define ADD_ATOM(idx, x, y) { LayoutPattenItem::_ADD_ATOM, idx, -1, -1, x, y},
+   #define ADD_BOND(idx1, idx2, type) { LayoutPattenItem::_ADD_BOND, type, idx1, idx2, -1.f, -1.f},
+   #define OUTLINE_POINT(idx, x, y) { LayoutPattenItem::_OUTLINE_POINT, idx, -1, -1, x, y},
+   //#define FIX_PATTERN
+
+   #define END_PATTERN() \
+      }; \
+      for (int i = 0; i < NELEM(_items); i++) \
+      { \
+         LayoutPattenItem &item = _items[i]; \
+         if (item.type == LayoutPattenItem::_ADD_ATOM) \
+            if (p.addAtom(item.x, item.y) != item.idx_or_type) \
+               throw Error("incorrect atom order in the pattern '%s'", p.getName()); \
+         if (item.type == LayoutPattenItem::_ADD_BOND) \
+            p.addBond(item.v1, item.v2, item.idx_or_type); \
+         if (item.type == LayoutPattenItem::_OUTLINE_POINT) \
+            if (p.addOutlinePoint(item.x, item.y) != item.idx_or_type)  \
+               throw Error("incorrect outline order in the pattern '%s'", p.getName()); \
+      } \
+      _addPattern(pattern.release(), false); \
+   }
+
+   #include "layout_patterns.inc"
+
+   #undef BEGIN_PATTERN
+   //#undef FIX_PATTERN
+   #undef ADD_ATOM
+   #undef ADD_BOND
+   #undef OUTLINE_POINT
+   #undef END_PATTERN
+}
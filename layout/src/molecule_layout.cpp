@@ -14,6 +14,7 @@
 
 #include "base_cpp/array.h"
 #include "base_cpp/obj_array.h"
+#include "graph/biconnected_decomposer.h"
 #include "graph/filter.h"
 #include "layout/molecule_layout.h"
 
@@ -21,6 +22,15 @@ using namespace indigo;
 
 IMPL_ERROR(MoleculeLayout, "molecule_layout");
 
+static int _float_cmp (const float &f1, const float &f2, void *context)
+{
+   if (f1 < f2)
+      return -1;
+   if (f1 > f2)
+      return 1;
+   return 0;
+}
+
 MoleculeLayout::MoleculeLayout (BaseMolecule &molecule) :
 _molecule(molecule)
 {
@@ -35,6 +45,9 @@ void MoleculeLayout::_init ()
    respect_existing_layout = false;
    filter = 0;
    max_iterations = 20;
+   nthreads = 1;
+   incremental_radius = 1;
+   _incremental = false;
    _query = false;
    _atomMapping.clear();
 
@@ -320,10 +333,15 @@ void MoleculeLayout::_updateDataSGroups ()
 void MoleculeLayout::_make ()
 {
    _layout_graph.max_iterations = max_iterations;
+   _layout_graph.nthreads = nthreads;
 
    // 0. Find 2D coordinates via proxy _layout_graph object
    _makeLayout();
 
+   // Put the kept atoms back to their places
+   if (_incremental)
+      _restoreFixedPieces();
+
    // 1. Update data-sgroup label position before changing molecule atoms positions
    _updateDataSGroups();
 
@@ -387,6 +405,7 @@ void MoleculeLayout::make ()
             BaseMolecule& mol = *frags[j];
             MoleculeLayout layout(mol);
             layout.max_iterations = max_iterations;
+            layout.nthreads = nthreads;
             layout.bond_length = bond_length;
             layout.make();
             _pushMol(line, mol); // add molecule to metalayout AFTER its own layout is determined
@@ -404,6 +423,368 @@ void MoleculeLayout::make ()
    }
 }
 
+void MoleculeLayout::makeIncremental (const Array<int> &changed_atoms, const Array<int> &changed_bonds)
+{
+   // Atoms of the collapsed multiple groups can not be traced
+   // to the molecule, so such molecules are laid out from scratch
+   if (_hasMulGroups)
+   {
+      make();
+      return;
+   }
+
+   QS_DEF(Array<int>, affected);
+   QS_DEF(Array<int>, valid);
+   int i;
+
+   _findAffectedAtoms(changed_atoms, changed_bonds, affected);
+
+   if (!_findFixedPieces(affected))
+   {
+      make();
+      return;
+   }
+
+   valid.clear_resize(_bm->vertexEnd());
+   for (i = _bm->vertexBegin(); i < _bm->vertexEnd(); i = _bm->vertexNext(i))
+      valid[i] = (_pieces[i] == -1 || !_main_pieces[_pieces[i]]) ? 1 : 0;
+
+   Filter new_filter(valid.ptr(), Filter::EQ, 1);
+   Filter *saved_filter = filter;
+   float saved_bond_length = bond_length;
+   float fixed_bond_length = _fixedBondLength();
+
+   // New atoms are drawn in the scale of the existing ones
+   if (fixed_bond_length > EPSILON)
+      bond_length = fixed_bond_length;
+
+   filter = &new_filter;
+   _incremental = true;
+
+   _make();
+
+   _incremental = false;
+   filter = saved_filter;
+   bond_length = saved_bond_length;
+}
+
+void MoleculeLayout::_findAffectedAtoms (const Array<int> &changed_atoms, const Array<int> &changed_bonds, Array<int> &affected)
+{
+   QS_DEF(Array<int>, queue);
+   QS_DEF(Array<int>, dist);
+   QS_DEF(Array<int>, vertices);
+   int i, j;
+
+   dist.clear_resize(_bm->vertexEnd());
+   dist.fffill();
+   queue.clear();
+
+   for (i = 0; i < changed_atoms.size(); i++)
+   {
+      int idx = changed_atoms[i];
+
+      if (idx < _bm->vertexBegin() || idx >= _bm->vertexEnd() || _bm->vertexNext(idx - 1) != idx)
+         throw Error("incorrect atom index %d", idx);
+
+      if (dist[idx] == -1)
+      {
+         dist[idx] = 0;
+         queue.push(idx);
+      }
+   }
+
+   for (i = 0; i < changed_bonds.size(); i++)
+   {
+      int idx = changed_bonds[i];
+
+      if (idx < _bm->edgeBegin() || idx >= _bm->edgeEnd() || _bm->edgeNext(idx - 1) != idx)
+         throw Error("incorrect bond index %d", idx);
+
+      const Edge &edge = _bm->getEdge(idx);
+
+      if (dist[edge.beg] == -1)
+      {
+         dist[edge.beg] = 0;
+         queue.push(edge.beg);
+      }
+      if (dist[edge.end] == -1)
+      {
+         dist[edge.end] = 0;
+         queue.push(edge.end);
+      }
+   }
+
+   for (i = 0; i < queue.size(); i++)
+   {
+      int v = queue[i];
+
+      if (dist[v] >= incremental_radius)
+         continue;
+
+      const Vertex &vertex = _bm->getVertex(v);
+
+      for (j = vertex.neiBegin(); j < vertex.neiEnd(); j = vertex.neiNext(j))
+      {
+         int nei = vertex.neiVertex(j);
+
+         if (dist[nei] == -1)
+         {
+            dist[nei] = dist[v] + 1;
+            queue.push(nei);
+         }
+      }
+   }
+
+   affected.clear_resize(_bm->vertexEnd());
+   for (i = 0; i < affected.size(); i++)
+      affected[i] = (dist[i] >= 0) ? 1 : 0;
+
+   // A ring system can not be partly fixed
+   BiconnectedDecomposer bc_decom(*_bm);
+   int n_comp = bc_decom.decompose();
+
+   for (i = 0; i < n_comp; i++)
+   {
+      Filter comp;
+
+      bc_decom.getComponent(i, comp);
+      comp.collectGraphVertices(*_bm, vertices);
+
+      if (vertices.size() < 3)
+         continue;
+
+      for (j = 0; j < vertices.size(); j++)
+         if (affected[vertices[j]])
+            break;
+
+      if (j == vertices.size())
+         continue;
+
+      for (j = 0; j < vertices.size(); j++)
+         affected[vertices[j]] = 1;
+   }
+}
+
+bool MoleculeLayout::_findFixedPieces (const Array<int> &affected)
+{
+   QS_DEF(Array<int>, queue);
+   QS_DEF(Array<int>, piece_size);
+   QS_DEF(Array<int>, main_piece);
+   int i, j, k;
+
+   _pieces.clear_resize(_bm->vertexEnd());
+   _pieces.fffill();
+   piece_size.clear();
+
+   for (i = _bm->vertexBegin(); i < _bm->vertexEnd(); i = _bm->vertexNext(i))
+   {
+      if (affected[i] || _pieces[i] != -1)
+         continue;
+
+      int piece = piece_size.size();
+
+      queue.clear();
+      queue.push(i);
+      _pieces[i] = piece;
+
+      for (j = 0; j < queue.size(); j++)
+      {
+         const Vertex &vertex = _bm->getVertex(queue[j]);
+
+         for (k = vertex.neiBegin(); k < vertex.neiEnd(); k = vertex.neiNext(k))
+         {
+            int nei = vertex.neiVertex(k);
+
+            if (!affected[nei] && _pieces[nei] == -1)
+            {
+               _pieces[nei] = piece;
+               queue.push(nei);
+            }
+         }
+      }
+
+      piece_size.push(queue.size());
+   }
+
+   if (piece_size.size() == 0)
+      return false;
+
+   // The largest piece of each connected component stays in place
+   const Array<int> &decomposition = _bm->getDecomposition();
+
+   main_piece.clear_resize(_bm->countComponents());
+   main_piece.fffill();
+
+   for (i = _bm->vertexBegin(); i < _bm->vertexEnd(); i = _bm->vertexNext(i))
+   {
+      int piece = _pieces[i];
+      int &main = main_piece[decomposition[i]];
+
+      if (piece != -1 && (main == -1 || piece_size[piece] > piece_size[main]))
+         main = piece;
+   }
+
+   _main_pieces.clear_resize(piece_size.size());
+   _main_pieces.zerofill();
+
+   for (i = 0; i < main_piece.size(); i++)
+      if (main_piece[i] != -1)
+         _main_pieces[main_piece[i]] = 1;
+
+   return true;
+}
+
+float MoleculeLayout::_fixedBondLength ()
+{
+   QS_DEF(Array<float>, lengths);
+
+   lengths.clear();
+
+   for (int i = _bm->edgeBegin(); i < _bm->edgeEnd(); i = _bm->edgeNext(i))
+   {
+      const Edge &edge = _bm->getEdge(i);
+
+      if (_pieces[edge.beg] == -1 || _pieces[edge.end] == -1)
+         continue;
+
+      Vec2f v1, v2;
+
+      Vec2f::projectZ(v1, _bm->getAtomXyz(edge.beg));
+      Vec2f::projectZ(v2, _bm->getAtomXyz(edge.end));
+      lengths.push(Vec2f::dist(v1, v2));
+   }
+
+   if (lengths.size() == 0)
+      return 0;
+
+   lengths.qsort(_float_cmp, 0);
+   return lengths[lengths.size() / 2];
+}
+
+void MoleculeLayout::_restoreFixedPieces ()
+{
+   QS_DEF(Array<int>, vertex_idx);
+   QS_DEF(Array<int>, anchors);
+   QS_DEF(Array<Vec2f>, old_min);
+   QS_DEF(Array<Vec2f>, old_max);
+   QS_DEF(Array<Vec2f>, new_min);
+   QS_DEF(Array<Vec2f>, new_max);
+   QS_DEF(Array<Vec2f>, shifts);
+   QS_DEF(Array<int>, shift_counts);
+   int i, j;
+
+   const Array<int> &decomposition = _bm->getDecomposition();
+   int n_comp = _bm->countComponents();
+
+   vertex_idx.clear_resize(_bm->vertexEnd());
+   vertex_idx.fffill();
+   for (i = _layout_graph.vertexBegin(); i < _layout_graph.vertexEnd(); i = _layout_graph.vertexNext(i))
+      vertex_idx[_layout_graph.getVertexExtIdx(i)] = i;
+
+   anchors.clear_resize(n_comp);
+   anchors.fffill();
+   old_min.clear_resize(n_comp);
+   old_max.clear_resize(n_comp);
+   new_min.clear_resize(n_comp);
+   new_max.clear_resize(n_comp);
+   shifts.clear_resize(n_comp);
+   shift_counts.clear_resize(n_comp);
+   shift_counts.zerofill();
+
+   // Each connected component is moved back to the place of its main
+   // piece, components without fixed atoms keep their old center
+   for (i = _bm->vertexBegin(); i < _bm->vertexEnd(); i = _bm->vertexNext(i))
+   {
+      int comp = decomposition[i];
+      Vec2f old_pos;
+
+      Vec2f::projectZ(old_pos, _bm->getAtomXyz(i));
+
+      const Vec2f &new_pos = _layout_graph.getPos(vertex_idx[i]);
+
+      if (shift_counts[comp]++ == 0)
+      {
+         old_min[comp] = old_max[comp] = old_pos;
+         new_min[comp] = new_max[comp] = new_pos;
+      }
+      else
+      {
+         old_min[comp].min(old_pos);
+         old_max[comp].max(old_pos);
+         new_min[comp].min(new_pos);
+         new_max[comp].max(new_pos);
+      }
+
+      if (anchors[comp] == -1 && _pieces[i] != -1 && _main_pieces[_pieces[i]])
+      {
+         anchors[comp] = i;
+         shifts[comp].diff(old_pos, new_pos);
+      }
+   }
+
+   for (i = 0; i < n_comp; i++)
+   {
+      if (anchors[i] != -1)
+         continue;
+
+      Vec2f old_center, new_center;
+
+      old_center.lineCombin2(old_min[i], 0.5f, old_max[i], 0.5f);
+      new_center.lineCombin2(new_min[i], 0.5f, new_max[i], 0.5f);
+      shifts[i].diff(old_center, new_center);
+   }
+
+   for (i = _bm->vertexBegin(); i < _bm->vertexEnd(); i = _bm->vertexNext(i))
+      _layout_graph.getPos(vertex_idx[i]).add(shifts[decomposition[i]]);
+
+   // Other pieces follow their atoms attached to the laid out part
+   shifts.clear_resize(_main_pieces.size());
+   shift_counts.clear_resize(_main_pieces.size());
+   shift_counts.zerofill();
+
+   for (i = 0; i < shifts.size(); i++)
+      shifts[i].set(0, 0);
+
+   for (i = _bm->vertexBegin(); i < _bm->vertexEnd(); i = _bm->vertexNext(i))
+   {
+      int piece = _pieces[i];
+
+      if (piece == -1 || _main_pieces[piece])
+         continue;
+
+      const Vertex &vertex = _bm->getVertex(i);
+
+      for (j = vertex.neiBegin(); j < vertex.neiEnd(); j = vertex.neiNext(j))
+         if (_pieces[vertex.neiVertex(j)] == -1)
+            break;
+
+      if (j == vertex.neiEnd())
+         continue;
+
+      Vec2f old_pos, shift;
+
+      Vec2f::projectZ(old_pos, _bm->getAtomXyz(i));
+      shift.diff(_layout_graph.getPos(vertex_idx[i]), old_pos);
+      shifts[piece].add(shift);
+      shift_counts[piece]++;
+   }
+
+   for (i = _bm->vertexBegin(); i < _bm->vertexEnd(); i = _bm->vertexNext(i))
+   {
+      int piece = _pieces[i];
+
+      if (piece == -1)
+         continue;
+
+      Vec2f &pos = _layout_graph.getPos(vertex_idx[i]);
+
+      Vec2f::projectZ(pos, _bm->getAtomXyz(i));
+
+      if (!_main_pieces[piece] && shift_counts[piece] > 0)
+         pos.addScaled(shifts[piece], 1.f / shift_counts[piece]);
+   }
+}
+
 void MoleculeLayout::setCancellationHandler (CancellationHandler* cancellation)
 {
    _layout_graph.cancellation = cancellation;
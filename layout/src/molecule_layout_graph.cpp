@@ -15,11 +15,10 @@
 #include "graph/biconnected_decomposer.h"
 #include "graph/morgan_code.h"
 #include "layout/molecule_layout_graph.h"
+#include "layout/molecule_layout_parallel.h"
 
 using namespace indigo;
 
-TL_DEF(MoleculeLayoutGraph, ObjArray<PatternLayout>, _patterns);
-
 IMPL_ERROR(MoleculeLayoutGraph, "layout_graph");
 
 MoleculeLayoutGraph::MoleculeLayoutGraph ()
@@ -30,6 +29,7 @@ MoleculeLayoutGraph::MoleculeLayoutGraph ()
    _molecule = 0;
    _molecule_edge_mapping = 0;
    max_iterations = 0;
+   nthreads = 1;
    cancellation = 0;
    _flipped = false;
 }
@@ -235,14 +235,9 @@ void MoleculeLayoutGraph::copyLayoutTo (MoleculeLayoutGraph &other, const Array<
 
 void MoleculeLayoutGraph::layout (BaseMolecule &molecule, float bond_length, const Filter *filter, bool respect_existing)
 {
-   TL_GET(ObjArray<PatternLayout>, _patterns);
-
    if (molecule.vertexCount() == 0)
       return;
 
-   if (_patterns.size() == 0)
-      _initPatterns();
-
    int n_components = countComponents();
 
    if (fabs(bond_length) < EPSILON)
@@ -300,102 +295,8 @@ void MoleculeLayoutGraph::_makeComponentsTree (BiconnectedDecomposer &decon,
    }
 }
 
-int MoleculeLayoutGraph::_pattern_cmp (PatternLayout &p1, PatternLayout &p2, void *context)
-{
-   long diff = p2.morganCode() - p1.morganCode();
-
-   if (diff != 0)
-      return diff;
-
-   diff = p2.vertexCount() + p2.edgeCount() - p1.vertexCount() - p1.edgeCount();
-
-   if (diff != 0)
-      return diff;
-
-   diff = p2.vertexCount() - p1.vertexCount();
-
-   if (diff != 0)
-      return diff;
-
-   return p2.edgeCount() - p1.edgeCount();
-}
-
-int MoleculeLayoutGraph::_pattern_cmp2 (PatternLayout &p1, int n_v, int n_e, long code)
-{
-   long diff = code - p1.morganCode();
-
-   if (diff != 0)
-      return diff;
-
-   diff = n_v + n_e - p1.vertexCount() - p1.edgeCount();
-
-   if (diff != 0)
-      return diff;
-
-   diff = n_v - p1.vertexCount();
-
-   if (diff != 0)
-      return diff;
-
-   return n_e - p1.edgeCount();
-}
-
-void MoleculeLayoutGraph::_initPatterns ()
-{
-   TL_GET(ObjArray<PatternLayout>, _patterns);
-
-   struct LayoutPattenItem
-   {
-      enum { _ADD_ATOM, _ADD_BOND, _OUTLINE_POINT }; 
-      int type;
-      int idx_or_type;
-      int v1, v2;
-      float x, y;
-   };
-
-   #define BEGIN_PATTERN(name)  \
-   { \
-      PatternLayout &p = _patterns.push(); p.setName(name);   \
-      static LayoutPattenItem _items[] = {
-
-   #define ADD_ATOM(idx, x, y) { LayoutPattenItem::_ADD_ATOM, idx, -1, -1, x, y},
-   #define ADD_BOND(idx1, idx2, type) { LayoutPattenItem::_ADD_BOND, type, idx1, idx2, -1.f, -1.f},
-   #define OUTLINE_POINT(idx, x, y) { LayoutPattenItem::_OUTLINE_POINT, idx, -1, -1, x, y},
-   //#define FIX_PATTERN
-
-   #define END_PATTERN() \
-      }; \
-      for (int i = 0; i < NELEM(_items); i++) \
-      { \
-         LayoutPattenItem &item = _items[i]; \
-         if (item.type == LayoutPattenItem::_ADD_ATOM) \
-            if (p.addAtom(item.x, item.y) != item.idx_or_type) \
-               throw Error("incorrect atom order in the pattern '%s'", p.getName()); \
-         if (item.type == LayoutPattenItem::_ADD_BOND) \
-            p.addBond(item.v1, item.v2, item.idx_or_type); \
-         if (item.type == LayoutPattenItem::_OUTLINE_POINT) \
-            if (p.addOutlinePoint(item.x, item.y) != item.idx_or_type)  \
-               throw Error("incorrect outline order in the pattern '%s'", p.getName()); \
-      } \
-   }
-
-   #include "layout_patterns.inc"
-
-   #undef BEGIN_PATTERN
-   //#undef FIX_PATTERN
-   #undef ADD_ATOM
-   #undef ADD_BOND
-   #undef OUTLINE_POINT
-   #undef END_PATTERN
-
-   for (int i = 0; i < _patterns.size(); i++)
-      _patterns[i].calcMorganCode();
-   _patterns.qsort(_pattern_cmp, 0);
-}
-
 void MoleculeLayoutGraph::_layoutMultipleComponents (BaseMolecule & molecule, bool respect_existing, const Filter * filter, float bond_length)
 {
-   QS_DEF(Array<Vec2f>, src_layout);
    QS_DEF(Array<int>, molecule_edge_mapping);
 
    int n_components = countComponents();
@@ -409,8 +310,11 @@ void MoleculeLayoutGraph::_layoutMultipleComponents (BaseMolecule & molecule, bo
       molecule_edge_mapping[i] = getEdgeExtIdx(i);
 
    ObjArray<MoleculeLayoutGraph> components;
+   ObjArray< Array<Vec2f> > src_layouts;
+   QS_DEF(Array<int>, nontrivial);
 
    components.reserve(n_components);
+   nontrivial.clear();
 
    for (i = 0; i < n_components; i++)
    {
@@ -421,10 +325,13 @@ void MoleculeLayoutGraph::_layoutMultipleComponents (BaseMolecule & molecule, bo
 
       component.makeLayoutSubgraph(*this, comp_filter);
       component.max_iterations = max_iterations;
+      component.nthreads = nthreads;
 
       component._molecule = &molecule;
       component._molecule_edge_mapping = molecule_edge_mapping.ptr();
 
+      Array<Vec2f> &src_layout = src_layouts.push();
+
       src_layout.clear_resize(component.vertexEnd());
 
       if (respect_existing)
@@ -441,18 +348,50 @@ void MoleculeLayoutGraph::_layoutMultipleComponents (BaseMolecule & molecule, bo
          for (j = component.vertexBegin(); j < component.vertexEnd(); j = component.vertexNext(j))
             if (!filter->valid(component.getVertexExtIdx(j)))
             {
+               // Layout is made for the unit bond length and scaled in the end
                component._fixed_vertices[j] = 1;
                component._n_fixed++;
                component._layout_vertices[j].pos = getPos(component.getVertexExtIdx(j));
+               component._layout_vertices[j].pos.scale(1.f / bond_length);
             }
       }
 
       if (component.vertexCount() > 1)
+         nontrivial.push(i);
+   }
+
+   // Components share only the cancellation handler, so they can be
+   // laid out in parallel. Single atoms are not worth a thread.
+   OsLock cancellation_lock;
+   PtrArray<LockedCancellationHandler> cancellations;
+
+   if (nthreads != 1 && nontrivial.size() > 1)
+   {
+      // Components are already processed in parallel
+      for (i = 0; i < nontrivial.size(); i++)
       {
-         component._calcMorganCodes();
-         component._assignAbsoluteCoordinates(bond_length);
+         MoleculeLayoutGraph &component = components[nontrivial[i]];
+
+         component.nthreads = 1;
+         if (cancellation != 0)
+            component.cancellation = &cancellations.add(new LockedCancellationHandler(*cancellation, cancellation_lock));
       }
-      component._assignFinalCoordinates(bond_length, src_layout);
+
+      MoleculeLayoutGraphDispatcher dispatcher(MoleculeLayoutGraphDispatcher::CONNECTED_COMPONENTS,
+                                               components, nontrivial);
+
+      dispatcher.bond_length = bond_length;
+      dispatcher.src_layouts = &src_layouts;
+      dispatcher.run(nthreads > 0 ? nthreads : -1);
+
+      for (i = 0; i < n_components; i++)
+         if (components[i].vertexCount() <= 1)
+            components[i]._layoutComponent(bond_length, src_layouts[i]);
+   }
+   else
+   {
+      for (i = 0; i < n_components; i++)
+         components[i]._layoutComponent(bond_length, src_layouts[i]);
    }
 
    // position components
@@ -599,11 +538,18 @@ void MoleculeLayoutGraph::_layoutSingleComponent (BaseMolecule &molecule, bool r
       for (int i = vertexBegin(); i < vertexEnd(); i = vertexNext(i))
          if (!filter->valid(i))
          {
+            // Layout is made for the unit bond length and scaled in the end
             _fixed_vertices[i] = 1;
             _n_fixed++;
+            getPos(i).scale(1.f / bond_length);
          }
    }
 
+   _layoutComponent(bond_length, src_layout);
+}
+
+void MoleculeLayoutGraph::_layoutComponent (float bond_length, const Array<Vec2f> &src_layout)
+{
    if (vertexCount() > 1)
    {
       _calcMorganCodes();
@@ -14,6 +14,8 @@
 
 #include "layout/molecule_layout_graph.h"
 #include "layout/attachment_layout.h"
+#include "layout/layout_pattern_store.h"
+#include "layout/molecule_layout_parallel.h"
 #include "graph/biconnected_decomposer.h"
 #include "graph/cycle_enumerator.h"
 #include "graph/embedding_enumerator.h"
@@ -1006,9 +1008,14 @@ void MoleculeLayoutGraph::_findFixedComponents (BiconnectedDecomposer &bc_decom,
 
 bool MoleculeLayoutGraph::_assignComponentsRelativeCoordinates (ObjArray<MoleculeLayoutGraph> & bc_components, Array<int> &fixed_components, BiconnectedDecomposer &bc_decom)
 {
+   QS_DEF(Array<int>, ring_systems);
+   QS_DEF(Array<int>, fixed_before);
    bool all_trivial = true;
    int n_comp = bc_decom.componentsCount();
 
+   ring_systems.clear();
+   fixed_before.copy(fixed_components);
+
    // Possible solutions:
    // 1. a) vertex code is calculated inside component (doesn't depend on neighbors) or
    //    b) vertex code is calculated respecting whole graph
@@ -1042,36 +1049,57 @@ bool MoleculeLayoutGraph::_assignComponentsRelativeCoordinates (ObjArray<Molecul
             component._layout_edges[j].is_cyclic = true;
             _layout_edges[component._layout_edges[j].ext_idx].is_cyclic = true;
          }
+
+         ring_systems.push(i);
       }
+      else
+         component._assignRelativeCoordinates(fixed_components[i], *this);
+   }
+
+   // Ring systems are laid out independently of each other and
+   // only read the supergraph, so they can go to the worker threads
+   if (nthreads != 1 && ring_systems.size() > 1)
+   {
+      MoleculeLayoutGraphDispatcher dispatcher(MoleculeLayoutGraphDispatcher::RING_SYSTEMS,
+                                               bc_components, ring_systems);
+
+      dispatcher.supergraph = this;
+      dispatcher.fixed_components = &fixed_components;
+      dispatcher.run(nthreads > 0 ? nthreads : -1);
+   }
+   else
+   {
+      for (int i = 0; i < ring_systems.size(); i++)
+         bc_components[ring_systems[i]]._assignRelativeCoordinates(fixed_components[ring_systems[i]], *this);
+   }
 
-      int fixed = fixed_components[i];
+   bool fixed_changed = false;
 
-      component._assignRelativeCoordinates(fixed, *this);
+   for (int i = 0; i < n_comp; i++)
+      if (fixed_components[i] != fixed_before[i])
+         fixed_changed = true;
 
-      if (fixed != fixed_components[i])
+   if (fixed_changed)
+   {
+      // update fixed vertices
+      _fixed_vertices.resize(vertexEnd());
+      _fixed_vertices.zerofill();
+      _n_fixed = 0;
+      for (int j = 0; j < n_comp; j++)
       {
-         fixed_components[i] = fixed;
-
-         // update fixed vertices
-         _fixed_vertices.resize(vertexEnd());
-         _fixed_vertices.zerofill();
-         _n_fixed = 0;
-         for (int j = 0; j < n_comp; j++)
-         {
-            if (!fixed_components[j])
-               continue;
+         if (!fixed_components[j])
+            continue;
 
-            Filter fix_filter;
+         Filter fix_filter;
 
-            bc_decom.getComponent(j, fix_filter);
+         bc_decom.getComponent(j, fix_filter);
 
-            for (int k = vertexBegin(); k < vertexEnd(); k = vertexNext(k))
-               if (!_fixed_vertices[k])
-               {
-                  _fixed_vertices[k] = 1;
-                  _n_fixed++;
-               }
-         }
+         for (int k = vertexBegin(); k < vertexEnd(); k = vertexNext(k))
+            if (!_fixed_vertices[k])
+            {
+               _fixed_vertices[k] = 1;
+               _n_fixed++;
+            }
       }
    }
    return all_trivial;
@@ -1103,7 +1131,7 @@ void MoleculeLayoutGraph::_assignRelativeSingleEdge (int &fixed_component, const
 bool MoleculeLayoutGraph::_tryToFindPattern (int &fixed_component)
 {
    // try to find pattern      
-   TL_GET(ObjArray<PatternLayout>, _patterns);
+   QS_DEF(Array<PatternLayout *>, patterns);
 
    MorganCode morgan(*this);
    QS_DEF(Array<long>, morgan_codes);
@@ -1115,40 +1143,13 @@ bool MoleculeLayoutGraph::_tryToFindPattern (int &fixed_component)
    for (int i = vertexBegin(); i < vertexEnd(); i = vertexNext(i))
       morgan_code += morgan_codes[i];
 
-   int left = 0;
-   int right = _patterns.size() - 1;
-   int pat_idx = 0;
-   int cmp;
-
-   while (left < right)
-   {
-      if (right - left == 1)
-      {
-         if (_pattern_cmp2(_patterns[left], vertexCount(), edgeCount(), morgan_code) == 0)
-            pat_idx = left;
-         else if (_pattern_cmp2(_patterns[right], vertexCount(), edgeCount(), morgan_code) == 0) 
-            pat_idx = right;
-         break;
-      }
-
-      pat_idx = (right + left) / 2;
+   LayoutPatternStore::getInstance().find(morgan_code, vertexCount(), edgeCount(), patterns);
 
-      cmp = _pattern_cmp2(_patterns[pat_idx], vertexCount(), edgeCount(), morgan_code);
-
-      if (cmp < 0)
-         left = pat_idx;
-      else
-         right = pat_idx;
-   }
-
-   while (pat_idx > 0 && _pattern_cmp2(_patterns[pat_idx - 1], vertexCount(), edgeCount(), morgan_code) == 0)
-      pat_idx--;
-
-   while (pat_idx < _patterns.size() && _pattern_cmp2(_patterns[pat_idx], vertexCount(), edgeCount(), morgan_code) == 0)
+   for (int i = 0; i < patterns.size(); i++)
    {
       // Match pattern
       // TODO: check different attachment points
-      PatternLayout &pattern = _patterns[pat_idx];
+      PatternLayout &pattern = *patterns[i];
 
       EmbeddingEnumerator ee(*this);
 
@@ -1163,8 +1164,6 @@ bool MoleculeLayoutGraph::_tryToFindPattern (int &fixed_component)
             fixed_component = 1;
          return true;
       }
-
-      pat_idx++;
    }
 
    return false;
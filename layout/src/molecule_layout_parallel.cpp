@@ -0,0 +1,192 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include "layout/molecule_layout_parallel.h"
+
+#include "base_cpp/cancellation_handler.h"
+#include "layout/molecule_layout.h"
+
+using namespace indigo;
+
+//
+// MoleculeLayoutGraphDispatcher
+//
+
+MoleculeLayoutGraphDispatcher::MoleculeLayoutGraphDispatcher (int task,
+   ObjArray<MoleculeLayoutGraph> &components, const Array<int> &indices) :
+   OsCommandDispatcher(OsCommandDispatcher::HANDLING_ORDER_ANY, false),
+   _task(task), _components(components), _indices(indices)
+{
+   bond_length = 1.f;
+   src_layouts = 0;
+   supergraph = 0;
+   fixed_components = 0;
+   _next = 0;
+}
+
+OsCommand * MoleculeLayoutGraphDispatcher::_allocateCommand ()
+{
+   return new MoleculeLayoutGraphCommand(*this);
+}
+
+bool MoleculeLayoutGraphDispatcher::_setupCommand (OsCommand &command)
+{
+   if (_next >= _indices.size())
+      return false;
+
+   MoleculeLayoutGraphCommand &cmd = (MoleculeLayoutGraphCommand &)command;
+
+   cmd.component_idx = _indices[_next++];
+   return true;
+}
+
+//
+// MoleculeLayoutGraphCommand
+//
+
+MoleculeLayoutGraphCommand::MoleculeLayoutGraphCommand (MoleculeLayoutGraphDispatcher &dispatcher) :
+   _dispatcher(dispatcher)
+{
+   component_idx = -1;
+}
+
+void MoleculeLayoutGraphCommand::clear ()
+{
+   component_idx = -1;
+   OsCommand::clear();
+}
+
+void MoleculeLayoutGraphCommand::execute (OsCommandResult &result)
+{
+   MoleculeLayoutGraph &component = _dispatcher._components[component_idx];
+
+   if (_dispatcher._task == MoleculeLayoutGraphDispatcher::CONNECTED_COMPONENTS)
+      component._layoutComponent(_dispatcher.bond_length, _dispatcher.src_layouts->at(component_idx));
+   else
+   {
+      // Each ring system has its own fixed flag
+      component._assignRelativeCoordinates(_dispatcher.fixed_components->at(component_idx),
+                                           *_dispatcher.supergraph);
+   }
+}
+
+//
+// MoleculeLayoutBatch
+//
+
+MoleculeLayoutBatch::MoleculeLayoutBatch ()
+{
+   bond_length = 1.f;
+   max_iterations = 0;
+   cancellation_timeout = 0;
+   _molecules = 0;
+}
+
+void MoleculeLayoutBatch::make (Array<BaseMolecule *> &molecules, int nthreads)
+{
+   _molecules = &molecules;
+
+   errors.clear();
+   for (int i = 0; i < molecules.size(); i++)
+      errors.push();
+
+   if (nthreads == 1 || molecules.size() < 2)
+   {
+      for (int i = 0; i < molecules.size(); i++)
+         _makeOne(i);
+      return;
+   }
+
+   MoleculeLayoutBatchDispatcher dispatcher(*this, molecules.size());
+
+   dispatcher.run(nthreads > 0 ? nthreads : -1);
+}
+
+int MoleculeLayoutBatch::failedCount () const
+{
+   int count = 0;
+
+   for (int i = 0; i < errors.size(); i++)
+      if (errors[i].size() > 0)
+         count++;
+
+   return count;
+}
+
+void MoleculeLayoutBatch::_makeOne (int idx)
+{
+   try
+   {
+      MoleculeLayout ml(*_molecules->at(idx));
+      TimeoutCancellationHandler cancellation(cancellation_timeout);
+
+      ml.bond_length = bond_length;
+      ml.max_iterations = max_iterations;
+      ml.setCancellationHandler(&cancellation);
+      ml.make();
+   }
+   catch (Exception &e)
+   {
+      errors[idx].readString(e.message(), true);
+   }
+}
+
+//
+// MoleculeLayoutBatchDispatcher
+//
+
+MoleculeLayoutBatchDispatcher::MoleculeLayoutBatchDispatcher (MoleculeLayoutBatch &batch, int count) :
+   OsCommandDispatcher(OsCommandDispatcher::HANDLING_ORDER_ANY, false),
+   _batch(batch), _count(count)
+{
+   _next_molecule = 0;
+}
+
+OsCommand * MoleculeLayoutBatchDispatcher::_allocateCommand ()
+{
+   return new MoleculeLayoutBatchCommand(_batch);
+}
+
+bool MoleculeLayoutBatchDispatcher::_setupCommand (OsCommand &command)
+{
+   if (_next_molecule >= _count)
+      return false;
+
+   MoleculeLayoutBatchCommand &cmd = (MoleculeLayoutBatchCommand &)command;
+
+   cmd.molecule_idx = _next_molecule++;
+   return true;
+}
+
+//
+// MoleculeLayoutBatchCommand
+//
+
+MoleculeLayoutBatchCommand::MoleculeLayoutBatchCommand (MoleculeLayoutBatch &batch) :
+   _batch(batch)
+{
+   molecule_idx = -1;
+}
+
+void MoleculeLayoutBatchCommand::clear ()
+{
+   molecule_idx = -1;
+   OsCommand::clear();
+}
+
+void MoleculeLayoutBatchCommand::execute (OsCommandResult &result)
+{
+   // Each molecule has its own error slot
+   _batch._makeOne(molecule_idx);
+}
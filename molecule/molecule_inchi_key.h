@@ -0,0 +1,44 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ * 
+ * This file is part of Indigo toolkit.
+ * 
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ * 
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __molecule_inchi_key_h__
+#define __molecule_inchi_key_h__
+
+#include "base_cpp/array.h"
+#include "base_cpp/exception.h"
+
+namespace indigo {
+
+// Standard InChIKey of a standard InChI string, computed the same way
+// as by the InChI library: SHA-256 of the main layers (formula,
+// connections, hydrogens, charge) and of the other layers, base-26
+// encoded, followed by the standard, version and protonation flags.
+class DLLEXPORT MoleculeInChIKey
+{
+public:
+   // Starts with "InChI=1S/"
+   static bool isStandard (const char *inchi);
+
+   static void compute (const char *inchi, Array<char> &key);
+
+   DECL_ERROR;
+
+protected:
+   static void _triplet (dword bits, Array<char> &key);
+   static void _dublet (dword bits, Array<char> &key);
+};
+
+}
+
+#endif
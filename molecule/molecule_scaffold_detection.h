@@ -37,6 +37,7 @@ class MoleculeScaffoldDetection: public ScaffoldDetection {
       virtual void addToNextEmptySpot(Graph& graph, Array<int> &v_list, Array<int> &e_list);
 
       virtual Graph& getGraphFromSet(int idx) {return (Graph&)_searchStructures->at(_orderArray[idx]); }
+      virtual Graph* copyGraphFromSet(int idx);
 
       virtual int getMaxGraphIndex();
 
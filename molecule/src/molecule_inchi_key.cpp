@@ -0,0 +1,162 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ * 
+ * This file is part of Indigo toolkit.
+ * 
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ * 
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "base_cpp/sha256.h"
+#include "molecule/molecule_inchi_key.h"
+
+using namespace indigo;
+
+IMPL_ERROR(MoleculeInChIKey, "InChIKey");
+
+static const char *_std_prefix = "InChI=1S/";
+
+bool MoleculeInChIKey::isStandard (const char *inchi)
+{
+   return strncmp(inchi, _std_prefix, strlen(_std_prefix)) == 0;
+}
+
+static bool _isInChIChar (char c)
+{
+   if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'))
+      return true;
+   return strchr("()*+,-./;=?@", c) != 0 && c != 0;
+}
+
+// Triplets of letters for 14 bits: all of them in the alphabetical
+// order, except the ones starting with 'E' and the ones from "TAA"
+// to "TTV", as in the InChI library
+void MoleculeInChIKey::_triplet (dword bits, Array<char> &key)
+{
+   for (int c = 0; c < 26; c++)
+   {
+      if (c == 'E' - 'A')
+         continue;
+
+      dword skipped = (c == 'T' - 'A') ? 516 : 0;
+
+      if (bits < 676 - skipped)
+      {
+         bits += skipped;
+         key.push('A' + c);
+         key.push('A' + bits / 26);
+         key.push('A' + bits % 26);
+         return;
+      }
+      bits -= 676 - skipped;
+   }
+}
+
+// Pairs of letters for 9 bits, in the alphabetical order
+void MoleculeInChIKey::_dublet (dword bits, Array<char> &key)
+{
+   key.push('A' + bits / 26);
+   key.push('A' + bits % 26);
+}
+
+void MoleculeInChIKey::compute (const char *inchi, Array<char> &key)
+{
+   if (!isStandard(inchi))
+      throw Error("not a standard InChI");
+
+   // InChI ends at the first character that can not be in it
+   int len = strlen(_std_prefix);
+
+   while (_isInChIChar(inchi[len]))
+      len++;
+
+   int start = strlen(_std_prefix);
+
+   if (start == len)
+      throw Error("empty InChI");
+
+   // Main layers go up to the first layer that is not /c, /h, /q
+   // or /p. Protonation is encoded by a flag instead of the hash.
+   int end = len, proto = -1;
+   int i;
+
+   for (i = start; i < len - 1; i++)
+   {
+      if (inchi[i] != '/')
+         continue;
+
+      char c = inchi[i + 1];
+
+      if (c == 'c' || c == 'h' || c == 'q')
+         continue;
+      if (c == 'p')
+      {
+         proto = i;
+         continue;
+      }
+      if (c == 'f' || c == 'r')
+         throw Error("fixed-H and reconnected layers are not allowed in a standard InChI");
+
+      end = i;
+      break;
+   }
+
+   char proto_flag = 'N';
+
+   if (proto != -1)
+   {
+      if (end - proto < 3)
+         throw Error("empty protonation layer");
+
+      int nprotons = strtol(inchi + proto + 2, 0, 10);
+
+      if (nprotons == 0)
+         throw Error("zero protonation layer");
+
+      if (nprotons > 12 || nprotons < -12)
+         proto_flag = 'A';
+      else if (nprotons > 0)
+         proto_flag = "OPQRSTUVWXYZ"[nprotons - 1];
+      else
+         proto_flag = "MLKJIHGFEDCB"[-nprotons - 1];
+   }
+
+   byte major[SHA256::DIGEST_SIZE];
+   byte minor[SHA256::DIGEST_SIZE];
+
+   SHA256::get(inchi + start, (proto != -1 ? proto : end) - start, major);
+
+   // Other layers are hashed twice over, if they are not too long
+   SHA256 sha;
+   int minor_len = len - end;
+
+   sha.update(inchi + end, minor_len);
+   if (minor_len > 0 && minor_len < 255)
+      sha.update(inchi + end, minor_len);
+   sha.final(minor);
+
+   key.clear();
+
+   _triplet(major[0] | (major[1] & 0x3f) << 8, key);
+   _triplet(((major[1] & 0xc0) | major[2] << 8 | (major[3] & 0x0f) << 16) >> 6, key);
+   _triplet(((major[3] & 0xf0) | major[4] << 8 | (major[5] & 0x03) << 16) >> 4, key);
+   _triplet(((major[5] & 0xfc) | major[6] << 8) >> 2, key);
+   _dublet(major[7] | (major[8] & 0x01) << 8, key);
+   key.push('-');
+   _triplet(minor[0] | (minor[1] & 0x3f) << 8, key);
+   _triplet(((minor[1] & 0xc0) | minor[2] << 8 | (minor[3] & 0x0f) << 16) >> 6, key);
+   _dublet(((minor[3] & 0xf0) | (minor[4] & 0x1f) << 8) >> 4, key);
+   key.push('S');
+   key.push('A');
+   key.push('-');
+   key.push(proto_flag);
+   key.push(0);
+}
@@ -15,6 +15,7 @@
 #include "molecule/molecule_scaffold_detection.h"
 #include "molecule/max_common_submolecule.h"
 #include "base_cpp/array.h"
+#include "base_cpp/auto_ptr.h"
 #include "molecule/molecule_exact_matcher.h"
 #include "molecule/query_molecule.h"
 #include "molecule/molecule_substructure_matcher.h"
@@ -231,6 +232,12 @@ int MoleculeScaffoldDetection::MoleculeBasket::getMaxGraphIndex() {
    return 0;
 }
 
+Graph* MoleculeScaffoldDetection::MoleculeBasket::copyGraphFromSet(int idx) {
+   AutoPtr<Molecule> mol(new Molecule());
+   mol->clone_KeepIndices(_searchStructures->at(_orderArray[idx]));
+   return mol.release();
+}
+
 Graph& MoleculeScaffoldDetection::MoleculeBasket::getGraph(int index) const {
    if(index >= _basketStructures->size())
       throw Error("basket size < index");
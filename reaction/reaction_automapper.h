@@ -17,6 +17,8 @@
 
 #include "base_cpp/array.h"
 #include "base_cpp/ptr_array.h"
+#include "base_cpp/red_black.h"
+#include "base_cpp/os_sync_wrapper.h"
 #include "molecule/max_common_submolecule.h"
 #include "base_cpp/cancellation_handler.h"
 
@@ -74,7 +76,9 @@ public:
       AAM_REGEN_CLEAR = 3,
 
       MAX_PERMUTATIONS_NUMBER = 5000,
-      MIN_PERMUTATION_SIZE = 3
+      MIN_PERMUTATION_SIZE = 3,
+      //maximum number of memoized reactant searches for one product
+      MAX_SEARCH_CACHE_SIZE = 20000
    };
    
    ReactionAutomapper(BaseReaction& reaction);
@@ -83,6 +87,9 @@ public:
 
    void correctReactingCenters(bool change_null_map) { _checkAtomMapping(true, false, change_null_map); }
 
+   //copies atom flags, aromaticity options and time limit from other automapper
+   void copySettings(const ReactionAutomapper& other);
+
    /*
     * Special flags
     */
@@ -93,11 +100,26 @@ public:
 
    AromaticityOptions arom_options;
 
+   /*
+    * Time limit in milliseconds (0 - no limit). The time is shared between
+    * the products, and the best mapping found within it is kept
+    */
+   int time_limit;
+   /*
+    * Number of threads for the reactant permutations (1 - serial, 0 - auto).
+    * When there is one permutation the threads search the exact mcs
+    */
+   int nthreads;
+
    DECL_ERROR;
 
    CancellationHandler* cancellation;
 
 private:
+   friend class ReactionAutomapperDispatcher;
+   friend class ReactionAutomapperCommand;
+   friend class RSubstructureMcs;
+
    //parameter for dimerization and dissociation
     enum {
       _MIN_VERTEX_SUB = 3
@@ -108,13 +130,19 @@ private:
    //sets up input mapping
    void _initMappings(BaseReaction& reaction);
    //searches AAM using mcs and substructure functions
-   void _createReactionMap();
+   void _createReactionMap(qword start_time);
    //controls AAM due to reacting centers in reaction; this could change reacting centers or AAM
 
    void _cleanReactants(BaseReaction& reaction);
 
-   int _handleWithProduct(const Array<int>& reactant_cons, Array<int>& product_mapping_tmp, BaseReaction& reaction, int product, ReactionMapMatchingData& react_map_match) ;
-   bool _chooseBestMapping(BaseReaction& reaction, Array<int>& product_mapping, int product, int map_complete);
+   int _handleWithProduct(const Array<int>& reactant_cons, Array<int>& product_mapping_tmp, BaseReaction& init_reaction, BaseReaction& reaction, int product, ReactionMapMatchingData& react_map_match, int& used_vertices);
+   bool _chooseBestMapping(BaseReaction& reaction, Array<int>& product_mapping, int product, int map_complete, int used_vertices);
+   //memoized results of reactant search for the product atoms left
+   void _searchCacheKey(BaseMolecule& product_cut, int react, Array<char>& key) const;
+   bool _findCachedSearch(const char* key, Array<int>& map);
+   void _cacheSearch(const char* key, const Array<int>& map);
+   //milliseconds left from the time limit started at start_time
+   static int _timeLeft(qword start_time, int limit);
    bool _checkAtomMapping(bool change_rc, bool change_aam, bool change_rc_null);
 
    //arranges all maps to AAM
@@ -142,6 +170,13 @@ private:
    int _maxVertUsed;
    int _maxCompleteMap;
    int _mode;
+
+   RedBlackStringObjMap< Array<int> > _searchCache;
+   OsLock _searchCacheLock;
+   qword _productStartTime;
+   int _productTimeLimit;
+   //threads for the exact mcs search of the current product
+   int _mcsThreads;
 };
 
 
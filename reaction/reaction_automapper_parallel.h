@@ -0,0 +1,168 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ * 
+ * This file is part of Indigo toolkit.
+ * 
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ * 
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __reaction_automapper_parallel__
+#define __reaction_automapper_parallel__
+
+#include "base_cpp/os_thread_wrapper.h"
+#include "base_cpp/auto_ptr.h"
+#include "base_cpp/obj_array.h"
+#include "reaction/base_reaction.h"
+
+namespace indigo {
+
+class ReactionAutomapper;
+class ReactionMapMatchingData;
+
+//
+// Classes for the parallel evaluation of the reactant permutations for
+// one product. Each worker maps the product for its own permutations,
+// and the best mapping is chosen in the main thread in the order of
+// the serial mode.
+//
+
+class ReactionAutomapperDispatcher : public OsCommandDispatcher
+{
+public:
+   enum
+   {
+      BATCH_SIZE = 4
+   };
+
+   ReactionAutomapperDispatcher( ReactionAutomapper &ram, BaseReaction &reaction,
+      ObjArray< Array<int> > &permutations, int product, ReactionMapMatchingData &react_map_match );
+
+protected:
+   virtual OsCommand*         _allocateCommand ();
+   virtual OsCommandResult*   _allocateResult  ();
+
+   virtual bool _setupCommand (OsCommand &command);
+   virtual void _handleResult (OsCommandResult &result);
+
+   ReactionAutomapper &_ram;
+   BaseReaction &_reaction;
+   ObjArray< Array<int> > &_permutations;
+   int _product;
+   ReactionMapMatchingData &_react_map_match;
+
+   // Copy of the reaction for the workers, the AAM of the original
+   // reaction is changed in the main thread
+   AutoPtr<BaseReaction> _reaction_copy;
+   OsLock _reaction_copy_lock;
+
+   int _next_permutation;
+   bool _finished;
+};
+
+class ReactionAutomapperCommand : public OsCommand
+{
+public:
+   ReactionAutomapperCommand( ReactionAutomapper &ram, BaseReaction &reaction, OsLock &reaction_lock,
+      ObjArray< Array<int> > &permutations, int product, ReactionMapMatchingData &react_map_match );
+
+   virtual void execute (OsCommandResult &result);
+   virtual void clear ();
+
+   int begin;
+   int end;
+
+private:
+   ReactionAutomapper &_ram;
+   BaseReaction &_reaction;
+   OsLock &_reaction_lock;
+   ObjArray< Array<int> > &_permutations;
+   int _product;
+   ReactionMapMatchingData &_react_map_match;
+};
+
+class ReactionAutomapperResult : public OsCommandResult
+{
+public:
+   virtual void clear ();
+
+   ObjArray< Array<int> > mappings;
+   Array<int> map_complete;
+   Array<int> used_vertices;
+};
+
+//
+// Automapping of many reactions with the same settings. Reactions are
+// split between the worker threads, and each reaction is mapped in place
+// by its own automapper. Errors are collected instead of being thrown.
+//
+
+class ReactionAutomapperBatch
+{
+public:
+   ReactionAutomapperBatch( const ReactionAutomapper &settings );
+
+   // nthreads: 1 - serial mode, 0 - automatic
+   // NULL items are not mapped and get an error
+   void automap( Array<BaseReaction *> &reactions, int mode, int nthreads );
+
+   // Mapping time for each reaction in milliseconds
+   Array<int> times;
+   // Error message for each reaction, empty if the reaction is mapped
+   ObjArray< Array<char> > errors;
+
+   int failedCount() const;
+
+protected:
+   friend class ReactionAutomapperBatchCommand;
+
+   void _automapOne( int idx );
+
+   const ReactionAutomapper &_settings;
+   Array<BaseReaction *> *_reactions;
+   int _mode;
+};
+
+class ReactionAutomapperBatchDispatcher : public OsCommandDispatcher
+{
+public:
+   enum
+   {
+      BATCH_SIZE = 4
+   };
+
+   ReactionAutomapperBatchDispatcher( ReactionAutomapperBatch &batch, int count );
+
+protected:
+   virtual OsCommand* _allocateCommand ();
+
+   virtual bool _setupCommand (OsCommand &command);
+
+   ReactionAutomapperBatch &_batch;
+   int _count;
+   int _next_reaction;
+};
+
+class ReactionAutomapperBatchCommand : public OsCommand
+{
+public:
+   ReactionAutomapperBatchCommand( ReactionAutomapperBatch &batch );
+
+   virtual void execute (OsCommandResult &result);
+   virtual void clear ();
+
+   int begin;
+   int end;
+
+private:
+   ReactionAutomapperBatch &_batch;
+};
+
+}
+
+#endif /* __reaction_automapper_parallel__ */
@@ -67,6 +67,9 @@ public:
    
    void (*product_proc)( Molecule &product, Array<int> &monomers_indices, void *userdata );
    void *userdata;
+   Array<char> *product_smiles; /* if not NULL - canonical SMILES of the product passed to product_proc */
+   QueryMolecule *prepared_reactant; /* if not NULL - reactant query prepared by prepareReactantQuery() for the transformation */
+   int simple_transform; /* -1 - simplicity is checked for each transformation, 0 or 1 - result of checkForSimplicity() */
    bool is_multistep_reaction;
    bool is_self_react;
    bool is_one_tube;
@@ -86,68 +89,33 @@ public:
 
    int buildProduct( void );
 
-   bool performSingleTransformation( Molecule &molecule, Array<int> &forbidden_atoms, Array<int> &original_hydrogens, bool &need_layout );
-
-private:
-   ReactionEnumeratorContext &_context;
-
-   QueryReaction &_reaction;
-   int _reactant_idx;
-
-   int _is_simple_transform;
-
-   int &_product_count;
-
-   ObjArray< Array<int> > &_tubes_monomers;
-   Array<int> &_product_aam_array;
-   RedBlackStringMap<int> &_smiles_array;
-   ReactionMonomers &_reaction_monomers;
+   /* Builds only the products with the given monomer for the first reactant.
+      Returns 0 if the enumeration should not be continued with the next monomers */
+   int buildProductFromMonomer( int monomer_idx );
 
-   CP_DECL;
-   TL_CP_DECL(Array<int>, _fragments_aam_array);
-   TL_CP_DECL(QueryMolecule, _full_product);
-   TL_CP_DECL(Array<int>, _product_monomers);
-   TL_CP_DECL(Molecule, _fragments);
-   TL_CP_DECL(Array<int>, _is_needless_atom);
-   TL_CP_DECL(Array<int>, _is_needless_bond);
-   TL_CP_DECL(Array<int>, _bonds_mapping_sub);
-   TL_CP_DECL(Array<int>, _bonds_mapping_super);
-   TL_CP_DECL(ObjArray< Array<int> >, _att_points);
-   TL_CP_DECL(MoleculeSubstructureMatcher::FragmentMatchCache, _fmcache);
-   TL_CP_DECL(Array<int>, _monomer_forbidden_atoms);
-   TL_CP_DECL(Array<int>, _product_forbidden_atoms);
-
-   TL_CP_DECL(Array<int>, _original_hydrogens);
-
-   AromaticityMatcher *_am;
-   EmbeddingEnumerator *_ee;
-   int _tube_idx;
-   int _deep_level;
-   bool _is_frag_search;
-   bool _is_rg_exist;
-
-   int _findCurTube( void );
-
-   bool _isMonomerFromCurTube( int monomer_idx );
-   
-   static void _foldHydrogens( BaseMolecule &molecule, Array<int> *atoms_to_keep = 0, Array<int> *original_hydrogens = 0 );
+   bool performSingleTransformation( Molecule &molecule, Array<int> &forbidden_atoms, Array<int> &original_hydrogens, bool &need_layout );
 
-   void _productProcess( void );
+   /* Prepares the reactant query for the embedding enumerator. The query
+      is the same for all the monomers, so it can be prepared only once */
+   static void prepareReactantQuery( QueryMolecule &reactant, const AromaticityOptions &arom_options,
+                                     QueryMolecule &ee_reactant );
 
-   bool _checkForSimplicity()
+   /* Returns true if the transformation keeps the structure and changes only
+      the atoms and bonds properties, so the molecule layout is not needed */
+   static bool checkForSimplicity( QueryReaction &reaction )
    {
-      if (_reaction.reactantsCount() != 1 || _reaction.productsCount() != 1)
+      if (reaction.reactantsCount() != 1 || reaction.productsCount() != 1)
          return false;
       
-      QueryMolecule &reactant = _reaction.getQueryMolecule(_reaction.reactantBegin());
-      QueryMolecule &product = _reaction.getQueryMolecule(_reaction.productBegin());
+      QueryMolecule &reactant = reaction.getQueryMolecule(reaction.reactantBegin());
+      QueryMolecule &product = reaction.getQueryMolecule(reaction.productBegin());
 
       if ((reactant.vertexCount() != product.vertexCount()) || 
           (reactant.edgeCount() != product.edgeCount()))
          return false;
 
-      Array<int> &reactant_aam = _reaction.getAAMArray(_reaction.reactantBegin());
-      Array<int> &product_aam = _reaction.getAAMArray(_reaction.productBegin());
+      Array<int> &reactant_aam = reaction.getAAMArray(reaction.reactantBegin());
+      Array<int> &product_aam = reaction.getAAMArray(reaction.productBegin());
 
       Array<int> aam_mapping;
       aam_mapping.resize(reactant.vertexEnd());
@@ -194,6 +162,54 @@ private:
       return true;
    }
 
+private:
+   ReactionEnumeratorContext &_context;
+
+   QueryReaction &_reaction;
+   int _reactant_idx;
+
+   int _is_simple_transform;
+
+   int &_product_count;
+
+   ObjArray< Array<int> > &_tubes_monomers;
+   Array<int> &_product_aam_array;
+   RedBlackStringMap<int> &_smiles_array;
+   ReactionMonomers &_reaction_monomers;
+
+   CP_DECL;
+   TL_CP_DECL(Array<int>, _fragments_aam_array);
+   TL_CP_DECL(QueryMolecule, _full_product);
+   TL_CP_DECL(Array<int>, _product_monomers);
+   TL_CP_DECL(Molecule, _fragments);
+   TL_CP_DECL(Array<int>, _is_needless_atom);
+   TL_CP_DECL(Array<int>, _is_needless_bond);
+   TL_CP_DECL(Array<int>, _bonds_mapping_sub);
+   TL_CP_DECL(Array<int>, _bonds_mapping_super);
+   TL_CP_DECL(ObjArray< Array<int> >, _att_points);
+   TL_CP_DECL(MoleculeSubstructureMatcher::FragmentMatchCache, _fmcache);
+   TL_CP_DECL(Array<int>, _monomer_forbidden_atoms);
+   TL_CP_DECL(Array<int>, _product_forbidden_atoms);
+
+   TL_CP_DECL(Array<int>, _original_hydrogens);
+
+   AromaticityMatcher *_am;
+   EmbeddingEnumerator *_ee;
+   int _tube_idx;
+   int _deep_level;
+   bool _is_frag_search;
+   bool _is_rg_exist;
+
+   int _findCurTube( void );
+
+   bool _buildWithMonomer( int monomer_idx );
+
+   bool _isMonomerFromCurTube( int monomer_idx );
+   
+   static void _foldHydrogens( BaseMolecule &molecule, Array<int> *atoms_to_keep = 0, Array<int> *original_hydrogens = 0 );
+
+   void _productProcess( void );
+
    bool _nextMatchProcess( EmbeddingEnumerator &ee, const QueryMolecule &reactant, 
       const Molecule &monomer );
 
@@ -201,7 +217,7 @@ private:
 
    bool _startEmbeddingEnumerator( Molecule &monomer );
 
-   void _changeQueryNode( QueryMolecule &ee_reactant, int change_atom_idx );
+   static void _changeQueryNode( QueryMolecule &ee_reactant, int change_atom_idx );
 
    void _findFragAtoms( Array<byte> &unfrag_mon_atoms, QueryMolecule &submolecule, 
       Molecule &fragment, int *core_sub, int *core_super );
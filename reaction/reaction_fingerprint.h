@@ -36,6 +36,19 @@ public:
    byte * get ();
    byte * getSim ();
 
+   // Reaction difference fingerprint for the similarity search:
+   // similarity bits of the products that are absent in the reactants
+   // followed by the bits of the reactants that are absent in the
+   // products, fingerprintSizeSim() * 2 bytes. Not built if skip_sim is set.
+   byte * getDiff ();
+
+   // Reacting centers of the reactants and products for the substructure
+   // screening: changed bonds hashed with the elements of their atoms,
+   // fingerprintSizeReactingCenters() bytes. Not built if skip_ord is set.
+   byte * getReactingCenters ();
+
+   static int fingerprintSizeReactingCenters ();
+
    void parseFingerprintType(const char *type, bool query);
 
    DECL_ERROR;
@@ -47,6 +60,9 @@ protected:
    CP_DECL;
    TL_CP_DECL(Array<byte>, _fingerprint);
 
+   void _buildReactingCenters (byte *fp);
+   void _addReactingCenterBits (byte *fp, int side, int rc_flag, int elem1, int elem2);
+
 private:
    ReactionFingerprintBuilder (const ReactionFingerprintBuilder &); // no implicit copy
 };
@@ -30,8 +30,10 @@ public:
    bool is_multistep_reaction;    /* if true - all reactants in monomer take part in reaction, false - one */
    bool is_self_react; /* if true - monomer's molecule can react with itself, false - can't */
    bool is_one_tube;   /* if true - all monomers are in one test-tube */
+   bool is_same_keeping; /* if true - duplicate products are not removed, so their SMILES are not kept in memory */
    int max_product_count;
    int max_deep_level;
+   int nthreads;       /* 1 - serial enumeration, 0 - number of threads is chosen automatically */
    void *userdata;
 
    AromaticityOptions arom_options;
@@ -56,16 +58,25 @@ public:
    void (*product_proc)( Molecule &product, Array<int> &monomers_indices, void *userdata );
 
 private:
+   friend class ReactionProductEnumeratorDispatcher;
+   friend class ReactionProductEnumeratorCommand;
+
    bool _is_rg_exist;
    int _product_count;
    QueryReaction &_reaction;
    ReactionEnumeratorState::ReactionMonomers _reaction_monomers;
+   ReactionEnumeratorContext _context;
+   QueryMolecule _all_products;
    CP_DECL;
    TL_CP_DECL(Array<int>, _product_aam_array);
    TL_CP_DECL(RedBlackStringMap<int>, _smiles_array);
    TL_CP_DECL(ObjArray< Array<int> >, _tubes_monomers);
 
+   void _beginProducts( void );
+
    void _buildTubesGrid( void );
+
+   void _setupState( ReactionEnumeratorState &rpe_state );
 };
 
 }
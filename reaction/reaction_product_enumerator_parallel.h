@@ -0,0 +1,95 @@
+/****************************************************************************
+ * Copyright (C) 2010-2011 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __reaction_product_enumerator_parallel__
+#define __reaction_product_enumerator_parallel__
+
+#include "base_cpp/os_thread_wrapper.h"
+#include "base_cpp/obj_array.h"
+#include "molecule/molecule.h"
+#include "molecule/query_molecule.h"
+
+namespace indigo {
+
+class ReactionProductEnumerator;
+class ReactionEnumeratorContext;
+class ReactionProductEnumeratorResult;
+
+//
+// Classes for the parallel enumeration. The monomers for the first
+// reactant are split between the worker threads, each worker has its
+// own enumeration state. Products are deduplicated and passed to
+// product_proc in the main thread in the order of the serial mode.
+// Workers pass the products by portions of MAX_RESULT_PRODUCTS, so a
+// monomer with many products does not keep all of them in memory.
+//
+
+class ReactionProductEnumeratorDispatcher : public OsCommandDispatcher
+{
+public:
+   ReactionProductEnumeratorDispatcher( ReactionProductEnumerator &rpe,
+      ReactionEnumeratorContext &context, QueryMolecule &full_product );
+
+protected:
+   virtual OsCommand*         _allocateCommand ();
+   virtual OsCommandResult*   _allocateResult  ();
+
+   virtual bool _setupCommand (OsCommand &command);
+   virtual void _handleResult (OsCommandResult &result);
+
+   ReactionProductEnumerator &_rpe;
+   ReactionEnumeratorContext &_context;
+   QueryMolecule &_full_product;
+   int _next_monomer;
+};
+
+class ReactionProductEnumeratorCommand : public OsCommand
+{
+public:
+   ReactionProductEnumeratorCommand( ReactionProductEnumerator &rpe,
+      ReactionEnumeratorContext &context, QueryMolecule &full_product );
+
+   virtual void execute (OsCommandResult &result);
+   virtual void clear ();
+
+   enum { MAX_RESULT_PRODUCTS = 100 };
+
+   int monomer_idx;
+
+private:
+   ReactionProductEnumerator &_rpe;
+   ReactionEnumeratorContext &_context;
+   QueryMolecule &_full_product;
+
+   ReactionProductEnumeratorResult *_result;
+   bool _is_terminated;
+
+   static void _productProc( Molecule &product, Array<int> &monomers_indices, void *userdata );
+};
+
+class ReactionProductEnumeratorResult : public OsCommandResult
+{
+public:
+   virtual void clear ();
+
+   ObjArray<Molecule> products;
+   ObjArray< Array<int> > monomers;
+   ObjArray< Array<char> > smiles;
+
+   Array<char> current_smiles;
+};
+
+}
+
+#endif /* __reaction_product_enumerator_parallel__ */
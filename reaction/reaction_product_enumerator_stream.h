@@ -0,0 +1,86 @@
+/****************************************************************************
+ * Copyright (C) 2010-2011 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __reaction_product_enumerator_stream__
+#define __reaction_product_enumerator_stream__
+
+#include "base_c/os_thread.h"
+#include "base_cpp/auto_ptr.h"
+#include "base_cpp/exception.h"
+#include "base_cpp/obj_array.h"
+#include "base_cpp/os_sync_wrapper.h"
+#include "reaction/reaction.h"
+
+namespace indigo {
+
+class ReactionProductEnumerator;
+
+//
+// Products are enumerated by buildProducts() in a producer thread and
+// passed to the caller through a buffer of the fixed size. The producer
+// is suspended while the buffer is full, so the embeddings of each
+// monomer are enumerated only once however slowly the products are
+// taken. The enumerator must not be used by the caller while the stream
+// is started. The producer thread has its own session ID.
+//
+
+class ReactionProductEnumeratorStream
+{
+public:
+   DECL_ERROR;
+
+   ReactionProductEnumeratorStream( ReactionProductEnumerator &rpe, int max_buffered );
+   ~ReactionProductEnumeratorStream();
+
+   /* Starts the enumeration from the beginning */
+   void start( void );
+
+   /* Stops the producer thread, the products that were not taken are lost */
+   void stop( void );
+
+   /* Takes the next product as a reaction with the monomers as reactants.
+      Returns false if there are no more products */
+   bool next( Reaction &reaction );
+
+   /* The same as next() without copying the product */
+   bool skip( void );
+
+private:
+   ReactionProductEnumerator &_rpe;
+
+   ObjArray<Reaction> _buffer;
+   int _head;
+   int _count;
+   bool _started;
+   bool _finished;
+   bool _stopping;
+   AutoPtr<Exception> _exception;
+
+   OsLock _lock;
+   AutoPtr<OsSemaphore> _filled; /* posted for each built product and at the end */
+   AutoPtr<OsSemaphore> _vacant; /* posted for each taken product and on stop */
+   AutoPtr<OsSemaphore> _exited;
+
+   bool _take( Reaction *reaction );
+
+   void _threadFunc( void );
+
+   static THREAD_RET THREAD_MOD _threadFuncStatic( void *param );
+
+   static void _productProc( Molecule &product, Array<int> &monomers_indices, void *userdata );
+};
+
+}
+
+#endif /* __reaction_product_enumerator_stream__ */
@@ -32,12 +32,41 @@ namespace indigo
    public:
       DECL_ERROR;
 
+      /* Data of the reaction that does not depend on the transformed molecule.
+         It is not changed by transform(), so it can be shared between threads */
+      class PreparedReaction
+      {
+      public:
+         PreparedReaction( void );
+
+         void clear( void );
+
+         AromaticityOptions arom_options;
+         QueryReaction merged_reaction;
+         QueryMolecule reactant;       /* prepared query of the merged reactant */
+         bool is_simple;
+         Array<int> elements_count;    /* minimal count of each element in the matching molecule */
+
+      private:
+         PreparedReaction( const PreparedReaction & ); // no implicit copy
+      };
+
       ReactionTransformation( void );
 
       bool transform(Molecule &molecule, QueryReaction &reaction);
       
       bool transform(ReusableObjArray<Molecule> &molecules, QueryReaction &reaction);
 
+      void prepare(QueryReaction &reaction, PreparedReaction &prepared);
+
+      bool transform(Molecule &molecule, PreparedReaction &prepared);
+
+      /* Transforms the molecules using nthreads threads, 0 - automatic threads count */
+      void transform(Array<Molecule *> &molecules, PreparedReaction &prepared, int nthreads);
+
+      /* Returns false if the molecule can not be matched by the reactant */
+      static bool screen(Molecule &molecule, const PreparedReaction &prepared);
+
       AromaticityOptions arom_options;
 
       bool layout_flag;
@@ -46,7 +75,6 @@ namespace indigo
 
    private:
       CP_DECL;
-      TL_CP_DECL(QueryReaction, _merged_reaction);
       TL_CP_DECL(Molecule, _cur_monomer);
 
       static void _product_proc( Molecule &product, Array<int> &monomers_indices, 
@@ -55,7 +83,7 @@ namespace indigo
       void _mergeReactionComponents( QueryReaction &reaction, int mol_type, 
                                      QueryMolecule &merged_molecule, Array<int> &merged_aam);
    
-      void _generateMergedReaction( QueryReaction &reaction );
+      void _generateMergedReaction( QueryReaction &reaction, QueryReaction &merged_reaction );
    };
 }
 
@@ -0,0 +1,75 @@
+/****************************************************************************
+ * Copyright (C) 2010-2011 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __reaction_transformation_parallel__
+#define __reaction_transformation_parallel__
+
+#include "base_cpp/os_thread_wrapper.h"
+#include "base_cpp/os_sync_wrapper.h"
+#include "reaction/reaction_transformation.h"
+
+namespace indigo {
+
+//
+// Classes for the parallel transformation of the molecules. The prepared
+// reaction is shared between the worker threads, and each worker
+// transforms its own part of the molecules.
+//
+
+class ReactionTransformationDispatcher : public OsCommandDispatcher
+{
+public:
+   enum
+   {
+      BATCH_SIZE = 16
+   };
+
+   ReactionTransformationDispatcher( ReactionTransformation &rt, Array<Molecule *> &molecules,
+      ReactionTransformation::PreparedReaction &prepared );
+
+protected:
+   virtual OsCommand* _allocateCommand ();
+
+   virtual bool _setupCommand (OsCommand &command);
+
+   ReactionTransformation &_rt;
+   Array<Molecule *> &_molecules;
+   ReactionTransformation::PreparedReaction &_prepared;
+   int _next_molecule;
+   // Guards the cancellation handler of the transformation
+   OsLock _cancellation_lock;
+};
+
+class ReactionTransformationCommand : public OsCommand
+{
+public:
+   ReactionTransformationCommand( ReactionTransformation &rt, Array<Molecule *> &molecules,
+      ReactionTransformation::PreparedReaction &prepared, OsLock &cancellation_lock );
+
+   virtual void execute (OsCommandResult &result);
+   virtual void clear ();
+
+   int begin;
+   int end;
+
+private:
+   ReactionTransformation &_rt;
+   Array<Molecule *> &_molecules;
+   ReactionTransformation::PreparedReaction &_prepared;
+   OsLock &_cancellation_lock;
+};
+
+}
+
+#endif /* __reaction_transformation_parallel__ */
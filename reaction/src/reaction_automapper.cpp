@@ -22,6 +22,9 @@
 #include "graph/automorphism_search.h"
 #include "reaction/crf_saver.h"
 #include "molecule/molecule_neighbourhood_counters.h"
+#include "reaction/reaction_automapper_parallel.h"
+#include "base_c/nano.h"
+#include "base_cpp/output.h"
 
 using namespace indigo;
 
@@ -32,12 +35,26 @@ ignore_atom_charges(false),
 ignore_atom_valence(false),
 ignore_atom_isotopes(false),
 ignore_atom_radicals(false),
+time_limit(0),
+nthreads(1),
 cancellation(0),
 _initReaction(reaction),
 _maxMapUsed(0),
 _maxVertUsed(0),
 _maxCompleteMap(0),
-_mode(AAM_REGEN_DISCARD){
+_mode(AAM_REGEN_DISCARD),
+_productStartTime(0),
+_productTimeLimit(0),
+_mcsThreads(1){
+}
+
+void ReactionAutomapper::copySettings(const ReactionAutomapper& other) {
+   ignore_atom_charges = other.ignore_atom_charges;
+   ignore_atom_valence = other.ignore_atom_valence;
+   ignore_atom_isotopes = other.ignore_atom_isotopes;
+   ignore_atom_radicals = other.ignore_atom_radicals;
+   arom_options = other.arom_options;
+   time_limit = other.time_limit;
 }
 
 void ReactionAutomapper::automap(int mode) {
@@ -49,7 +66,15 @@ void ReactionAutomapper::automap(int mode) {
     * Set cancellation handler
     */
    AAMCancellationWrapper canc_wrapper(cancellation);
-   
+   /*
+    * Set time limit for the whole mapping
+    */
+   TimeoutCancellationHandler total_timeout(time_limit);
+   AutoPtr<AutoCancellationHandler> total_timeout_wrapper;
+   if (time_limit > 0)
+      total_timeout_wrapper.reset(new AutoCancellationHandler(total_timeout));
+   qword start_time = nanoClock();
+
    /*
     * Check input atom mapping (if any)
     */
@@ -63,7 +88,7 @@ void ReactionAutomapper::automap(int mode) {
    /*
     * Create AAM map
     */
-   _createReactionMap();
+   _createReactionMap(start_time);
    _setupReactionInvMap(react_mapping, mol_mappings);
 
    _considerDissociation();
@@ -234,7 +259,7 @@ void ReactionAutomapper::_initMappings(BaseReaction& reaction){
    }
 }
 
-void ReactionAutomapper::_createReactionMap(){
+void ReactionAutomapper::_createReactionMap(qword start_time){
    QS_DEF(ObjArray< Array<int> >, reactant_permutations);
    QS_DEF(Array<int>, product_mapping_tmp);
    
@@ -253,29 +278,56 @@ void ReactionAutomapper::_createReactionMap(){
     */
    _createPermutations(reaction, reactant_permutations);
 
+   int products_left = reaction.productsCount();
+
    for(int product = reaction.productBegin(); product < reaction.productEnd(); product = reaction.productNext(product)){
       product_mapping_tmp.clear_resize(reaction.getAAMArray(product).size());
 
       _maxMapUsed = 0;
       _maxVertUsed = 0;
       _maxCompleteMap = 0;
-
-      for(int pmt = 0; pmt < reactant_permutations.size(); pmt++) {
-         reaction_clone->clone(reaction, 0, 0, 0);
-         /*
-          * Apply new permutation
-          */
-         int map_complete = _handleWithProduct(reactant_permutations[pmt], product_mapping_tmp, reaction_clone.ref(), product, react_map_match);
-         /*
-          * Collect statistic and choose the best mapping
-          */
-         if(_chooseBestMapping(reaction, product_mapping_tmp, product, map_complete))
-            break;
-         /*
-          * Check for cancellation
-          */
-         if(cancellation && cancellation->isCancelled())
-            break;
+      _searchCache.clear();
+      /*
+       * Share the time left between the products left
+       */
+      _productStartTime = nanoClock();
+      _productTimeLimit = 0;
+      if (time_limit > 0)
+         _productTimeLimit = __max(1, _timeLeft(start_time, time_limit) / products_left);
+      products_left--;
+
+      TimeoutCancellationHandler product_timeout(_productTimeLimit);
+      AutoPtr<AutoCancellationHandler> product_timeout_wrapper;
+      if (_productTimeLimit > 0)
+         product_timeout_wrapper.reset(new AutoCancellationHandler(product_timeout));
+
+      _mcsThreads = nthreads;
+      if (nthreads != 1 && reactant_permutations.size() > 1) {
+         // Permutations are searched in threads, so the mcs search is serial
+         _mcsThreads = 1;
+         ReactionAutomapperDispatcher dispatcher(*this, reaction, reactant_permutations, product, react_map_match);
+         dispatcher.run(nthreads > 0 ? nthreads : -1);
+      } else {
+         for(int pmt = 0; pmt < reactant_permutations.size(); pmt++) {
+            reaction_clone->clone(reaction, 0, 0, 0);
+            /*
+             * Apply new permutation
+             */
+            int used_vertices = 0;
+            int map_complete = _handleWithProduct(reactant_permutations[pmt], product_mapping_tmp, reaction, reaction_clone.ref(), product, react_map_match, used_vertices);
+            /*
+             * Collect statistic and choose the best mapping
+             */
+            if(_chooseBestMapping(reaction, product_mapping_tmp, product, map_complete, used_vertices))
+               break;
+            /*
+             * Check for cancellation
+             */
+            if(cancellation && cancellation->isCancelled())
+               break;
+            if(_productTimeLimit > 0 && product_timeout.isCancelled())
+               break;
+         }
       }
       _usedVertices.zerofill();
       for(int k = reaction.productBegin(); k <= product; k = reaction.productNext(k)){
@@ -287,6 +339,7 @@ void ReactionAutomapper::_createReactionMap(){
       }
 //      _cleanReactants(reaction);
    }
+   _searchCache.clear();
 }
 
 void ReactionAutomapper::_cleanReactants(BaseReaction& reaction) {
@@ -304,16 +357,15 @@ void ReactionAutomapper::_cleanReactants(BaseReaction& reaction) {
    }
 }
 
-int ReactionAutomapper::_handleWithProduct(const Array<int>& reactant_cons, Array<int>& product_mapping_tmp, BaseReaction& reaction, int product, ReactionMapMatchingData& react_map_match) {
+int ReactionAutomapper::_handleWithProduct(const Array<int>& reactant_cons, Array<int>& product_mapping_tmp, BaseReaction& init_reaction, BaseReaction& reaction, int product, ReactionMapMatchingData& react_map_match, int& used_vertices) {
    
    QS_DEF(Array<int>, matching_map);
    QS_DEF(Array<int>, rsub_map_in);
    QS_DEF(Array<int>, rsub_map_out);
    QS_DEF(Array<int>, vertices_to_remove);
+   QS_DEF(Array<char>, cache_key);
    int map_complete = 0;
 
-   BaseReaction& _reaction = _reactionCopy.ref();
-
    BaseMolecule& product_cut = reaction.getBaseMolecule(product);
    /*
     *delete hydrogens
@@ -323,39 +375,71 @@ int ReactionAutomapper::_handleWithProduct(const Array<int>& reactant_cons, Arra
       if(product_cut.getAtomNumber(k) == ELEM_H)
          vertices_to_remove.push(k);
    product_cut.removeAtoms(vertices_to_remove);
+   /*
+    * Atom valences and radicals are cached before the atoms are cut off,
+    * so the searches depend only on the atoms left and can be memoized.
+    * Only the properties compared by the atom conditions are calculated
+    */
+   if (!product_cut.isQueryMolecule()) {
+      for(int k = product_cut.vertexBegin(); k < product_cut.vertexEnd(); k = product_cut.vertexNext(k)) {
+         if(product_cut.isRSite(k) || product_cut.isPseudoAtom(k))
+            continue;
+         try {
+            if(!ignore_atom_valence)
+               product_cut.getAtomValence(k);
+            if(!ignore_atom_radicals)
+               product_cut.getAtomRadical(k);
+         } catch (Exception& e) {
+            throw Error("product atom %d: %s", k, e.message());
+         }
+      }
+   }
 
    product_mapping_tmp.zerofill();
    
-   _usedVertices[0] = 0;
+   used_vertices = 0;
 
    for(int perm_idx = 0; perm_idx < reactant_cons.size(); perm_idx++){
       int react = reactant_cons.at(perm_idx);
+      /*
+       * Permutations with the same reactants before leave the same product
+       * atoms, so the search result is taken from the cache
+       */
+      _searchCacheKey(product_cut, react, cache_key);
 
-      int react_vsize = reaction.getBaseMolecule(react).vertexEnd();
-      rsub_map_in.resize(react_vsize);
-      for(int k = 0; k < react_vsize; k++)
-         rsub_map_in[k] = SubstructureMcs::UNMAPPED;
+      if (!_findCachedSearch(cache_key.ptr(), rsub_map_out)) {
+         int react_vsize = reaction.getBaseMolecule(react).vertexEnd();
+         rsub_map_in.resize(react_vsize);
+         for(int k = 0; k < react_vsize; k++)
+            rsub_map_in[k] = SubstructureMcs::UNMAPPED;
 
 
-      bool map_exc = false;
-      if(_mode != AAM_REGEN_DISCARD){
-         for(int m = product_cut.vertexBegin(); m < product_cut.vertexEnd(); m = product_cut.vertexNext(m)){
-            react_map_match.getAtomMap(product, react, m, &matching_map);
+         bool map_exc = false;
+         if(_mode != AAM_REGEN_DISCARD){
+            for(int m = product_cut.vertexBegin(); m < product_cut.vertexEnd(); m = product_cut.vertexNext(m)){
+               react_map_match.getAtomMap(product, react, m, &matching_map);
 
-            for(int k = 0; k < matching_map.size();k++) {
-               rsub_map_in[matching_map[k]] = m;
-               map_exc = true;
-               break;
+               for(int k = 0; k < matching_map.size();k++) {
+                  rsub_map_in[matching_map[k]] = m;
+                  map_exc = true;
+                  break;
+               }
             }
          }
-      }
 
-      if(!map_exc) 
-         rsub_map_in.clear();
-      RSubstructureMcs react_sub_mcs(reaction, react, product, *this);
-      bool find_sub = react_sub_mcs.searchSubstructureReact(_reaction.getBaseMolecule(react), &rsub_map_in, &rsub_map_out);
-      if (!find_sub) {
-         react_sub_mcs.searchMaxCommonSubReact(&rsub_map_in, &rsub_map_out);
+         if(!map_exc) 
+            rsub_map_in.clear();
+         RSubstructureMcs react_sub_mcs(reaction, react, product, *this);
+         bool find_sub = react_sub_mcs.searchSubstructureReact(init_reaction.getBaseMolecule(react), &rsub_map_in, &rsub_map_out);
+         if (!find_sub) {
+            react_sub_mcs.searchMaxCommonSubReact(&rsub_map_in, &rsub_map_out);
+         }
+         /*
+          * Interrupted search is not complete and is not cached
+          */
+         CancellationHandler* timeout = getCancellationHandler();
+         if (timeout == 0 || !timeout->isCancelled())
+            _cacheSearch(cache_key.ptr(), rsub_map_out);
       }
 
       bool cur_used = false;
@@ -371,7 +455,7 @@ int ReactionAutomapper::_handleWithProduct(const Array<int>& reactant_cons, Arra
             cur_used = true;
             product_mapping_tmp[v] = reaction.getAAM(react, j);
             if (_usedVertices[product_mapping_tmp[v]] == 0)
-               ++_usedVertices[0];
+               ++used_vertices;
             product_cut.removeAtom(v);
          }
       }
@@ -386,7 +470,7 @@ int ReactionAutomapper::_handleWithProduct(const Array<int>& reactant_cons, Arra
    return map_complete;
 }
 
-bool ReactionAutomapper::_chooseBestMapping(BaseReaction& reaction, Array<int>& product_mapping,  int product, int map_complete) {
+bool ReactionAutomapper::_chooseBestMapping(BaseReaction& reaction, Array<int>& product_mapping,  int product, int map_complete, int used_vertices) {
    int map_used = 0, total_map_used;
    for (int map_idx = 0; map_idx < product_mapping.size(); ++map_idx)
       if (product_mapping[map_idx] > 0) 
@@ -395,10 +479,10 @@ bool ReactionAutomapper::_chooseBestMapping(BaseReaction& reaction, Array<int>&
          
    bool map_u = map_used > _maxMapUsed;
    bool map_c = (map_used == _maxMapUsed) && (map_complete > _maxCompleteMap);
-   bool map_v = (map_used == _maxMapUsed) && (map_complete == _maxCompleteMap) && (_usedVertices[0] > _maxVertUsed); 
+   bool map_v = (map_used == _maxMapUsed) && (map_complete == _maxCompleteMap) && (used_vertices > _maxVertUsed); 
    if(map_u || map_c || map_v){
       _maxMapUsed = map_used;
-      _maxVertUsed = _usedVertices[0];
+      _maxVertUsed = used_vertices;
       _maxCompleteMap = map_complete;
       reaction.getAAMArray(product).copy(product_mapping);
       /*
@@ -409,12 +493,58 @@ bool ReactionAutomapper::_chooseBestMapping(BaseReaction& reaction, Array<int>&
          if(_usedVertices[i]) 
             ++total_map_used;
       }
-      if((total_map_used + _usedVertices[0]) >= (_usedVertices.size() - 1))
+      if((total_map_used + used_vertices) >= (_usedVertices.size() - 1))
          return true;
    }
    return false;
 }
 
+void ReactionAutomapper::_searchCacheKey(BaseMolecule& product_cut, int react, Array<char>& key) const {
+   ArrayOutput output(key);
+
+   output.printf("%d:", react);
+   /*
+    * Bitset of the product atoms left
+    */
+   int bits = 0, nbits = 0;
+   for (int v = 0; v < product_cut.vertexEnd(); v++) {
+      if (product_cut.hasVertex(v))
+         bits |= 1 << nbits;
+      if (++nbits == 4) {
+         output.printf("%x", bits);
+         bits = nbits = 0;
+      }
+   }
+   if (nbits > 0)
+      output.printf("%x", bits);
+   output.writeChar(0);
+}
+
+bool ReactionAutomapper::_findCachedSearch(const char* key, Array<int>& map) {
+   OsLocker locker(_searchCacheLock);
+
+   Array<int>* cached = _searchCache.at2(key);
+   if (cached == 0)
+      return false;
+
+   map.copy(*cached);
+   return true;
+}
+
+void ReactionAutomapper::_cacheSearch(const char* key, const Array<int>& map) {
+   OsLocker locker(_searchCacheLock);
+
+   if (_searchCache.size() >= MAX_SEARCH_CACHE_SIZE || _searchCache.find(key))
+      return;
+
+   _searchCache.value(_searchCache.insert(key)).copy(map);
+}
+
+int ReactionAutomapper::_timeLeft(qword start_time, int limit) {
+   int elapsed = (int)(nanoHowManySeconds(nanoClock() - start_time) * 1000);
+   return limit - elapsed;
+}
+
 
 bool ReactionAutomapper::_checkAtomMapping(bool change_rc, bool change_aam, bool change_rc_null) {
 
@@ -1280,7 +1410,7 @@ void RSubstructureMcs::setUpFlags(const ReactionAutomapper& context) {
 bool RSubstructureMcs::searchSubstructure(Array<int>* map) {
    bool result = false;
 
-   if (_context.cancellation) {
+   if (_context.cancellation || _context.time_limit > 0) {
       try {
          result = SubstructureMcs::searchSubstructure(map);
       } catch (Exception& e) {
@@ -1404,6 +1534,13 @@ bool RSubstructureMcs::searchMaxCommonSubReact(const Array<int>* in_map, Array<i
       
    MaxCommonSubmolecule mcs(*sub_molecule, *super_molecule);
    mcs.parametersForExact.maxIteration = MAX_ITERATION_NUMBER; 
+   mcs.parametersForExact.threads = _context._mcsThreads;
+   /*
+    * Exact search that reached the time left for the product is finished
+    * by the approximate one instead of being cancelled
+    */
+   if (_context._productTimeLimit > 0)
+      mcs.parametersForExact.timeLimit = __max(1, ReactionAutomapper::_timeLeft(_context._productStartTime, _context._productTimeLimit));
    mcs.conditionVerticesColor = atomConditionReact;
    mcs.conditionEdgeWeight = bondConditionReact;
    mcs.cbSolutionTerm = cbMcsSolutionTerm;  
@@ -1669,7 +1806,7 @@ int RSubstructureMcs::_searchSubstructure(EmbeddingEnumerator& emb_enum, const A
       return result;
 
    int proc = 1;
-   if (_context.cancellation) {
+   if (_context.cancellation || _context.time_limit > 0) {
       try {
          proc = emb_enum.process();
       } catch (Exception& e) {
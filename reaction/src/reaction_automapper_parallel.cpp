@@ -0,0 +1,288 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ * 
+ * This file is part of Indigo toolkit.
+ * 
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ * 
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include "reaction/reaction_automapper_parallel.h"
+
+#include "base_c/nano.h"
+#include "base_cpp/cancellation_handler.h"
+#include "reaction/reaction_automapper.h"
+
+using namespace indigo;
+
+//
+// ReactionAutomapperDispatcher
+//
+
+ReactionAutomapperDispatcher::ReactionAutomapperDispatcher( ReactionAutomapper &ram,
+   BaseReaction &reaction, ObjArray< Array<int> > &permutations, int product,
+   ReactionMapMatchingData &react_map_match ) :
+   OsCommandDispatcher(OsCommandDispatcher::HANDLING_ORDER_SERIAL, false),
+   _ram(ram), _reaction(reaction), _permutations(permutations), _product(product),
+   _react_map_match(react_map_match)
+{
+   _reaction_copy.reset(reaction.neu());
+   _reaction_copy->clone(reaction, 0, 0, 0);
+
+   _next_permutation = 0;
+   _finished = false;
+}
+
+OsCommand * ReactionAutomapperDispatcher::_allocateCommand ()
+{
+   return new ReactionAutomapperCommand(_ram, _reaction_copy.ref(), _reaction_copy_lock,
+      _permutations, _product, _react_map_match);
+}
+
+OsCommandResult * ReactionAutomapperDispatcher::_allocateResult ()
+{
+   return new ReactionAutomapperResult;
+}
+
+bool ReactionAutomapperDispatcher::_setupCommand (OsCommand &command)
+{
+   if (_finished || _next_permutation >= _permutations.size())
+      return false;
+
+   ReactionAutomapperCommand &cmd = (ReactionAutomapperCommand &)command;
+
+   cmd.begin = _next_permutation;
+   cmd.end = __min(_next_permutation + (int)BATCH_SIZE, _permutations.size());
+   _next_permutation = cmd.end;
+   return true;
+}
+
+void ReactionAutomapperDispatcher::_handleResult (OsCommandResult &result)
+{
+   ReactionAutomapperResult &res = (ReactionAutomapperResult &)result;
+
+   if (_finished)
+      return;
+
+   for (int i = 0; i < res.mappings.size(); i++)
+   {
+      if (_ram._chooseBestMapping(_reaction, res.mappings[i], _product,
+             res.map_complete[i], res.used_vertices[i]))
+      {
+         _finished = true;
+         break;
+      }
+   }
+
+   if (_ram.cancellation != 0 && _ram.cancellation->isCancelled())
+      _finished = true;
+   if (_ram._productTimeLimit > 0 &&
+       ReactionAutomapper::_timeLeft(_ram._productStartTime, _ram._productTimeLimit) <= 0)
+      _finished = true;
+
+   if (_finished)
+      markToTerminate();
+}
+
+//
+// ReactionAutomapperCommand
+//
+
+ReactionAutomapperCommand::ReactionAutomapperCommand( ReactionAutomapper &ram,
+   BaseReaction &reaction, OsLock &reaction_lock, ObjArray< Array<int> > &permutations,
+   int product, ReactionMapMatchingData &react_map_match ) :
+   _ram(ram), _reaction(reaction), _reaction_lock(reaction_lock),
+   _permutations(permutations), _product(product), _react_map_match(react_map_match)
+{
+   begin = end = 0;
+}
+
+void ReactionAutomapperCommand::clear ()
+{
+   begin = end = 0;
+   OsCommand::clear();
+}
+
+void ReactionAutomapperCommand::execute (OsCommandResult &result)
+{
+   ReactionAutomapperResult &res = (ReactionAutomapperResult &)result;
+
+   // Cancellation handler is thread-local, so the time left
+   // for the product is set for each worker
+   TimeoutCancellationHandler timeout(0);
+   AutoPtr<AutoCancellationHandler> timeout_wrapper;
+   if (_ram._productTimeLimit > 0)
+   {
+      timeout.reset(__max(1, ReactionAutomapper::_timeLeft(_ram._productStartTime, _ram._productTimeLimit)));
+      timeout_wrapper.reset(new AutoCancellationHandler(timeout));
+   }
+
+   AutoPtr<BaseReaction> init_reaction;
+   AutoPtr<BaseReaction> reaction_clone;
+   {
+      OsLocker locker(_reaction_lock);
+
+      init_reaction.reset(_reaction.neu());
+      init_reaction->clone(_reaction, 0, 0, 0);
+   }
+   reaction_clone.reset(_reaction.neu());
+
+   for (int pmt = begin; pmt < end; pmt++)
+   {
+      if (_ram._productTimeLimit > 0 && timeout.isCancelled())
+         break;
+
+      reaction_clone->clone(init_reaction.ref(), 0, 0, 0);
+
+      Array<int> &mapping = res.mappings.push();
+      int used_vertices = 0;
+
+      mapping.clear_resize(init_reaction->getAAMArray(_product).size());
+      res.map_complete.push(_ram._handleWithProduct(_permutations[pmt], mapping,
+         init_reaction.ref(), reaction_clone.ref(), _product, _react_map_match, used_vertices));
+      res.used_vertices.push(used_vertices);
+   }
+}
+
+//
+// ReactionAutomapperResult
+//
+
+void ReactionAutomapperResult::clear ()
+{
+   mappings.clear();
+   map_complete.clear();
+   used_vertices.clear();
+}
+
+//
+// ReactionAutomapperBatch
+//
+
+ReactionAutomapperBatch::ReactionAutomapperBatch( const ReactionAutomapper &settings ) :
+   _settings(settings), _reactions(0), _mode(ReactionAutomapper::AAM_REGEN_DISCARD)
+{
+}
+
+void ReactionAutomapperBatch::automap( Array<BaseReaction *> &reactions, int mode, int nthreads )
+{
+   _reactions = &reactions;
+   _mode = mode;
+
+   times.clear_resize(reactions.size());
+   times.zerofill();
+   errors.clear();
+   for (int i = 0; i < reactions.size(); i++)
+      errors.push();
+
+   if (nthreads == 1 || reactions.size() < 2)
+   {
+      for (int i = 0; i < reactions.size(); i++)
+         _automapOne(i);
+      return;
+   }
+
+   ReactionAutomapperBatchDispatcher dispatcher(*this, reactions.size());
+
+   dispatcher.run(nthreads > 0 ? nthreads : -1);
+}
+
+int ReactionAutomapperBatch::failedCount() const
+{
+   int count = 0;
+
+   for (int i = 0; i < errors.size(); i++)
+      if (errors[i].size() > 0)
+         count++;
+
+   return count;
+}
+
+void ReactionAutomapperBatch::_automapOne( int idx )
+{
+   if (_reactions->at(idx) == 0)
+   {
+      errors[idx].readString("not a reaction", true);
+      return;
+   }
+
+   BaseReaction &reaction = *_reactions->at(idx);
+   qword start_time = nanoClock();
+
+   try
+   {
+      if (_mode == ReactionAutomapper::AAM_REGEN_CLEAR)
+         reaction.clearAAM();
+      else
+      {
+         ReactionAutomapper ram(reaction);
+
+         ram.copySettings(_settings);
+         ram.automap(_mode);
+      }
+   }
+   catch (Exception &e)
+   {
+      errors[idx].readString(e.message(), true);
+   }
+
+   times[idx] = (int)(nanoHowManySeconds(nanoClock() - start_time) * 1000);
+}
+
+//
+// ReactionAutomapperBatchDispatcher
+//
+
+ReactionAutomapperBatchDispatcher::ReactionAutomapperBatchDispatcher(
+   ReactionAutomapperBatch &batch, int count ) :
+   OsCommandDispatcher(OsCommandDispatcher::HANDLING_ORDER_ANY, false),
+   _batch(batch), _count(count)
+{
+   _next_reaction = 0;
+}
+
+OsCommand * ReactionAutomapperBatchDispatcher::_allocateCommand ()
+{
+   return new ReactionAutomapperBatchCommand(_batch);
+}
+
+bool ReactionAutomapperBatchDispatcher::_setupCommand (OsCommand &command)
+{
+   if (_next_reaction >= _count)
+      return false;
+
+   ReactionAutomapperBatchCommand &cmd = (ReactionAutomapperBatchCommand &)command;
+
+   cmd.begin = _next_reaction;
+   cmd.end = __min(_next_reaction + (int)BATCH_SIZE, _count);
+   _next_reaction = cmd.end;
+   return true;
+}
+
+//
+// ReactionAutomapperBatchCommand
+//
+
+ReactionAutomapperBatchCommand::ReactionAutomapperBatchCommand( ReactionAutomapperBatch &batch ) :
+   _batch(batch)
+{
+   begin = end = 0;
+}
+
+void ReactionAutomapperBatchCommand::clear ()
+{
+   begin = end = 0;
+   OsCommand::clear();
+}
+
+void ReactionAutomapperBatchCommand::execute (OsCommandResult &result)
+{
+   // Each reaction has its own slot for the time and error
+   for (int i = begin; i < end; i++)
+      _batch._automapOne(i);
+}
@@ -179,6 +179,9 @@ ReactionEnumeratorState::ReactionEnumeratorState(ReactionEnumeratorContext &cont
 
    product_proc = NULL;
    userdata = NULL;
+   product_smiles = NULL;
+   prepared_reactant = NULL;
+   simple_transform = -1;
 }
 
 ReactionEnumeratorState::ReactionEnumeratorState( ReactionEnumeratorState &cur_rpe_state ) : 
@@ -251,6 +254,9 @@ ReactionEnumeratorState::ReactionEnumeratorState( ReactionEnumeratorState &cur_r
 
    product_proc = cur_rpe_state.product_proc;
    userdata = cur_rpe_state.userdata;
+   product_smiles = cur_rpe_state.product_smiles;
+   prepared_reactant = cur_rpe_state.prepared_reactant;
+   simple_transform = cur_rpe_state.simple_transform;
 }
 
 int ReactionEnumeratorState::buildProduct( void )
@@ -269,33 +275,52 @@ int ReactionEnumeratorState::buildProduct( void )
       return 0;
    
    for (int i = 0; i < _reaction_monomers._monomers.size(); i++)
-   {
-      QS_DEF(Molecule, ee_monomer);
-      ee_monomer.clear();
-      ee_monomer.clone(_reaction_monomers._monomers[i], NULL, NULL);
-      ee_monomer.cis_trans.build(NULL);
+      if (!_buildWithMonomer(i))
+         return 0;
 
-      if (!is_one_tube)
-         if (!_isMonomerFromCurTube(i))
-            continue;
+   return 0;
+}
 
-      if (!is_self_react)
-         if ((_reaction_monomers._deep_levels[i] != 0) && (_product_monomers.find(i) != -1))
-            continue;
+int ReactionEnumeratorState::buildProductFromMonomer( int monomer_idx )
+{
+   if (_product_count >= max_product_count)
+      return 0;
 
-      ReactionEnumeratorState rpe_state(*this);
+   if (_reactant_idx == _reaction.reactantEnd() || is_transform)
+      return 0;
 
-      rpe_state._deep_level += _reaction_monomers._deep_levels[i];
+   if (!_buildWithMonomer(monomer_idx))
+      return 0;
 
-      if (rpe_state._deep_level - 1 > rpe_state.max_deep_level)
-         return 0;
+   return 1;
+}
 
-      rpe_state._product_monomers.push(i);
-      
-      rpe_state._startEmbeddingEnumerator(ee_monomer);
-   }
+bool ReactionEnumeratorState::_buildWithMonomer( int monomer_idx )
+{
+   QS_DEF(Molecule, ee_monomer);
+   ee_monomer.clear();
+   ee_monomer.clone(_reaction_monomers._monomers[monomer_idx], NULL, NULL);
+   ee_monomer.cis_trans.build(NULL);
 
-   return 0;
+   if (!is_one_tube)
+      if (!_isMonomerFromCurTube(monomer_idx))
+         return true;
+
+   if (!is_self_react)
+      if ((_reaction_monomers._deep_levels[monomer_idx] != 0) && (_product_monomers.find(monomer_idx) != -1))
+         return true;
+
+   ReactionEnumeratorState rpe_state(*this);
+
+   rpe_state._deep_level += _reaction_monomers._deep_levels[monomer_idx];
+
+   if (rpe_state._deep_level - 1 > rpe_state.max_deep_level)
+      return false;
+
+   rpe_state._product_monomers.push(monomer_idx);
+   
+   rpe_state._startEmbeddingEnumerator(ee_monomer);
+   return true;
 }
 
 int ReactionEnumeratorState::_findCurTube( void )
@@ -415,10 +440,15 @@ void ReactionEnumeratorState::_productProcess( void )
          (*found_count)++;
          return;
       }
-      _product_count++;
       _smiles_array.insert(cur_smiles.ptr(), 1);
+
+      if (product_smiles != NULL)
+         product_smiles->copy(cur_smiles);
    }
 
+   if (!is_transform)
+      _product_count++;
+
    for (int i = 0; i < _product_monomers.size(); i++)
    {
       if (_reaction_monomers._monomers[_product_monomers[i]].name.size() == 0)
@@ -547,7 +577,10 @@ bool ReactionEnumeratorState::performSingleTransformation( Molecule &molecule, A
 {
    is_transform = true;
 
-   _is_simple_transform = _checkForSimplicity();
+   if (simple_transform >= 0)
+      _is_simple_transform = (simple_transform != 0);
+   else
+      _is_simple_transform = checkForSimplicity(_reaction);
 
    if (forbidden_atoms.size() != molecule.vertexEnd())
       throw Error("forbidden atoms array size is incorrect");
@@ -571,14 +604,14 @@ bool ReactionEnumeratorState::performSingleTransformation( Molecule &molecule, A
 }
 
 
-bool ReactionEnumeratorState::_startEmbeddingEnumerator( Molecule &monomer )
+void ReactionEnumeratorState::prepareReactantQuery( QueryMolecule &reactant, 
+                  const AromaticityOptions &arom_options, QueryMolecule &ee_reactant )
 {
-   QS_DEF(QueryMolecule, ee_reactant);
    ee_reactant.clear();
-   ee_reactant.clone(_reaction.getQueryMolecule(_reactant_idx), NULL, NULL);
+   ee_reactant.clone(reactant, NULL, NULL);
    ee_reactant.cis_trans.build(NULL);
 
-   ee_reactant.aromatize(_context.arom_options);
+   ee_reactant.aromatize(arom_options);
 
    for (int i = ee_reactant.edgeBegin(); i != ee_reactant.edgeEnd(); i = ee_reactant.edgeNext(i))
    {
@@ -605,6 +638,19 @@ bool ReactionEnumeratorState::_startEmbeddingEnumerator( Molecule &monomer )
       if (vertex.degree() == 2)
          _changeQueryNode(ee_reactant, j);
    }
+}
+
+bool ReactionEnumeratorState::_startEmbeddingEnumerator( Molecule &monomer )
+{
+   QS_DEF(QueryMolecule, ee_reactant);
+
+   if (is_transform && prepared_reactant != NULL)
+   {
+      ee_reactant.clear();
+      ee_reactant.clone(*prepared_reactant, NULL, NULL);
+   }
+   else
+      prepareReactantQuery(_reaction.getQueryMolecule(_reactant_idx), _context.arom_options, ee_reactant);
 
    QS_DEF(Molecule, ee_monomer);
    ee_monomer.clear();
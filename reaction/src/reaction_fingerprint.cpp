@@ -16,6 +16,9 @@
 #include "molecule/molecule_fingerprint.h"
 #include "reaction/base_reaction.h"
 #include "base_c/bitarray.h"
+#include "molecule/elements.h"
+#include "reaction/reaction.h"
+#include "molecule/molecule_substructure_matcher.h"
 
 using namespace indigo;
 
@@ -39,8 +42,9 @@ TL_CP_GET(_fingerprint)
 void ReactionFingerprintBuilder::process ()
 {
    int i, one_fp_size = _parameters.fingerprintSizeExtOrdSim();
+   int sim_size = _parameters.fingerprintSizeSim();
    
-   _fingerprint.clear_resize(one_fp_size * 2);
+   _fingerprint.clear_resize(one_fp_size * 2 + sim_size * 2 + fingerprintSizeReactingCenters());
    _fingerprint.zerofill();
            
    for (i = _reaction.reactantBegin(); i < _reaction.reactantEnd(); i = _reaction.reactantNext(i))
@@ -77,6 +81,152 @@ void ReactionFingerprintBuilder::process ()
       bitOr(getSim() + + _parameters.fingerprintSizeSim(),
             builder.getSim(), _parameters.fingerprintSizeSim());
    }
+
+   if (!skip_sim)
+   {
+      const byte *reactants_sim = getSim();
+      const byte *products_sim = getSim() + sim_size;
+      byte *diff = getDiff();
+
+      for (i = 0; i < sim_size; i++)
+      {
+         diff[i] = products_sim[i] & ~reactants_sim[i];
+         diff[i + sim_size] = reactants_sim[i] & ~products_sim[i];
+      }
+   }
+
+   if (!skip_ord)
+      _buildReactingCenters(getReactingCenters());
+}
+
+int ReactionFingerprintBuilder::fingerprintSizeReactingCenters ()
+{
+   return 32;
+}
+
+void ReactionFingerprintBuilder::_buildReactingCenters (byte *fp)
+{
+   int size = fingerprintSizeReactingCenters();
+   int i, j;
+
+   if (!query)
+   {
+      // Unmarked bonds of the target match any reacting center
+      // of the query, so such reactions can not be screened out
+      bool marked = false;
+
+      for (i = _reaction.begin(); i != _reaction.end() && !marked; i = _reaction.next(i))
+      {
+         BaseMolecule &mol = _reaction.getBaseMolecule(i);
+
+         for (j = mol.edgeBegin(); j != mol.edgeEnd(); j = mol.edgeNext(j))
+            if (_reaction.getReactingCenter(i, j) != RC_UNMARKED)
+            {
+               marked = true;
+               break;
+            }
+      }
+
+      if (!marked)
+      {
+         memset(fp, 0xFF, size);
+         return;
+      }
+   }
+
+   QS_DEF(Array<int>, ignored);
+
+   for (i = _reaction.begin(); i != _reaction.end(); i = _reaction.next(i))
+   {
+      int side = _reaction.getSideType(i);
+
+      if (side != BaseReaction::REACTANT && side != BaseReaction::PRODUCT)
+         continue;
+
+      BaseMolecule &mol = _reaction.getBaseMolecule(i);
+
+      // Query hydrogens that ReactionSubstructureMatcher::_prepare_ee() leaves
+      // out of the matching, their bonds are not required in the target
+      ignored.clear_resize(mol.vertexEnd());
+      ignored.zerofill();
+      if (query && mol.isQueryMolecule())
+         MoleculeSubstructureMatcher::markIgnoredQueryHydrogens(mol.asQueryMolecule(), ignored.ptr(), 0, 1);
+
+      for (j = mol.edgeBegin(); j != mol.edgeEnd(); j = mol.edgeNext(j))
+      {
+         const Edge &edge = mol.getEdge(j);
+         int rc = _reaction.getReactingCenter(i, j);
+         int elem1 = mol.getAtomNumber(edge.beg);
+         int elem2 = mol.getAtomNumber(edge.end);
+
+         if (query)
+         {
+            // The same conditions as in ReactionSubstructureMatcher::_match_bonds(),
+            // unchanged and unmarked query bonds match any target bond
+            if (rc == RC_NOT_CENTER || rc == RC_UNMARKED || rc == RC_UNCHANGED)
+               continue;
+            if (ignored[edge.beg] || ignored[edge.end])
+               continue;
+
+            // Query atoms without a definite element and hydrogens
+            // (that can be implicit in the target) match any atom
+            if (elem1 <= ELEM_H || elem1 >= ELEM_MAX)
+               elem1 = 0;
+            if (elem2 <= ELEM_H || elem2 >= ELEM_MAX)
+               elem2 = 0;
+
+            if (rc == RC_CENTER)
+               _addReactingCenterBits(fp, side, RC_CENTER, elem1, elem2);
+            if (rc != RC_CENTER && (rc & RC_MADE_OR_BROKEN))
+               _addReactingCenterBits(fp, side, RC_MADE_OR_BROKEN, elem1, elem2);
+            if (rc != RC_CENTER && (rc & RC_ORDER_CHANGED))
+               _addReactingCenterBits(fp, side, RC_ORDER_CHANGED, elem1, elem2);
+         }
+         else
+         {
+            // The target bond sets the bits of all the query reacting
+            // centers it matches, with and without the atom elements
+            bool center = (rc == RC_UNMARKED || (rc != RC_UNCHANGED && rc != RC_NOT_CENTER));
+            bool made_or_broken = (rc == RC_UNMARKED || (rc & RC_MADE_OR_BROKEN));
+            bool order_changed = (rc == RC_UNMARKED || (rc & RC_ORDER_CHANGED));
+            int k;
+
+            for (k = 0; k < 4; k++)
+            {
+               int e1 = (k & 1) ? elem1 : 0;
+               int e2 = (k & 2) ? elem2 : 0;
+
+               if (center)
+                  _addReactingCenterBits(fp, side, RC_CENTER, e1, e2);
+               if (made_or_broken)
+                  _addReactingCenterBits(fp, side, RC_MADE_OR_BROKEN, e1, e2);
+               if (order_changed)
+                  _addReactingCenterBits(fp, side, RC_ORDER_CHANGED, e1, e2);
+            }
+         }
+      }
+   }
+}
+
+void ReactionFingerprintBuilder::_addReactingCenterBits (byte *fp, int side, int rc_flag,
+                                                         int elem1, int elem2)
+{
+   // Elements are unordered, unknown element is zero
+   if (elem1 < elem2)
+   {
+      int tmp = elem1;
+
+      elem1 = elem2;
+      elem2 = tmp;
+   }
+
+   unsigned seed = ((side * 16 + rc_flag) * 256 + elem1) * 256 + elem2;
+
+   seed = seed * 0x8088405 + 1;
+
+   unsigned k = (unsigned)(((qword)(fingerprintSizeReactingCenters() * 8) * seed) >> 32);
+
+   bitSetBit(fp, k, 1);
 }
 
 byte * ReactionFingerprintBuilder::get ()
@@ -89,6 +239,16 @@ byte * ReactionFingerprintBuilder::getSim ()
    return _fingerprint.ptr() + _parameters.fingerprintSizeExtOrd() * 2;
 }
 
+byte * ReactionFingerprintBuilder::getDiff ()
+{
+   return _fingerprint.ptr() + _parameters.fingerprintSizeExtOrdSim() * 2;
+}
+
+byte * ReactionFingerprintBuilder::getReactingCenters ()
+{
+   return getDiff() + _parameters.fingerprintSizeSim() * 2;
+}
+
 void ReactionFingerprintBuilder::parseFingerprintType(const char *type, bool query) {
    this->query = query;
 
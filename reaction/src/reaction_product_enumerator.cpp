@@ -16,6 +16,7 @@
 
 #include "reaction/reaction_product_enumerator.h"
 #include "reaction/reaction_enumerator_state.h"
+#include "reaction/reaction_product_enumerator_parallel.h"
 
 #include "base_cpp/gray_codes.h"
 #include "base_c/bitarray.h"
@@ -35,7 +36,7 @@ CP_DEF(ReactionProductEnumerator);
 
 ReactionProductEnumerator::ReactionProductEnumerator( QueryReaction &reaction ) : 
         is_multistep_reaction(false), is_self_react(false),
-        is_one_tube(false), max_product_count(1000), max_deep_level(2),
+        is_one_tube(false), is_same_keeping(false), max_product_count(1000), max_deep_level(2), nthreads(1),
         _reaction(reaction),
         CP_INIT, TL_CP_GET(_product_aam_array), TL_CP_GET(_smiles_array), TL_CP_GET(_tubes_monomers)
 {
@@ -91,8 +92,32 @@ int ReactionProductEnumerator::getMonomersCount( int reactant_idx )
 
 void ReactionProductEnumerator::buildProducts( void )
 {
-   QS_DEF(QueryMolecule, all_products);
-   all_products.clear();
+   _beginProducts();
+
+   /* Products of the multistep reactions become monomers, so they
+      can not be enumerated in parallel */
+   if (nthreads != 1 && !is_multistep_reaction)
+   {
+      ReactionProductEnumeratorDispatcher dispatcher(*this, _context, _all_products);
+
+      dispatcher.run(nthreads > 0 ? nthreads : -1);
+      return;
+   }
+
+   ReactionEnumeratorState rpe_state(_context, _reaction, _all_products, 
+                      _product_aam_array, _smiles_array, _reaction_monomers, 
+                      _product_count, _tubes_monomers);
+
+   _setupState(rpe_state);
+   rpe_state.product_proc = product_proc;
+   rpe_state.userdata = userdata;
+
+   rpe_state.buildProduct();
+}
+
+void ReactionProductEnumerator::_beginProducts( void )
+{
+   _all_products.clear();
 
    for (int i = 0; i < _reaction_monomers.size(); i++)
    {
@@ -104,6 +129,7 @@ void ReactionProductEnumerator::buildProducts( void )
    }
 
    /* Building of monomer tubes grid */
+   _tubes_monomers.clear();
    if (!is_one_tube)
       _buildTubesGrid();
 
@@ -113,33 +139,28 @@ void ReactionProductEnumerator::buildProducts( void )
       QS_DEF(Array<int>, mapping);
       mapping.clear();
 
-      all_products.mergeWithMolecule(product, &mapping);
-      _product_aam_array.expand(all_products.vertexEnd());
+      _all_products.mergeWithMolecule(product, &mapping);
+      _product_aam_array.expand(_all_products.vertexEnd());
       for (int j = product.vertexBegin(); j != product.vertexEnd(); j = product.vertexNext(j))
          _product_aam_array[mapping[j]] = _reaction.getAAM(i, j);
    }
 
-   all_products.cis_trans.build(NULL);
+   _all_products.cis_trans.build(NULL);
 
    _smiles_array.clear();
    _product_count = 0;
 
-   ReactionEnumeratorContext context;
-   context.arom_options = arom_options;
-
-   ReactionEnumeratorState rpe_state(context, _reaction, all_products, 
-                      _product_aam_array, _smiles_array, _reaction_monomers, 
-                      _product_count, _tubes_monomers);
+   _context.arom_options = arom_options;
+}
 
-   rpe_state.product_proc = product_proc;
-   rpe_state.userdata = userdata;
+void ReactionProductEnumerator::_setupState( ReactionEnumeratorState &rpe_state )
+{
    rpe_state.is_multistep_reaction = is_multistep_reaction;
    rpe_state.is_self_react = is_self_react;
    rpe_state.max_deep_level = max_deep_level;
    rpe_state.max_product_count = max_product_count;
    rpe_state.is_one_tube = is_one_tube;
-
-   rpe_state.buildProduct();
+   rpe_state.is_same_keeping = is_same_keeping;
 }
 
 void ReactionProductEnumerator::_buildTubesGrid( void )
@@ -0,0 +1,182 @@
+/****************************************************************************
+ * Copyright (C) 2010-2011 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include "reaction/reaction_product_enumerator_parallel.h"
+
+#include "base_cpp/tlscont.h"
+#include "base_cpp/red_black.h"
+#include "reaction/reaction_product_enumerator.h"
+#include "reaction/reaction_enumerator_state.h"
+
+using namespace indigo;
+
+//
+// ReactionProductEnumeratorDispatcher
+//
+
+ReactionProductEnumeratorDispatcher::ReactionProductEnumeratorDispatcher(
+   ReactionProductEnumerator &rpe, ReactionEnumeratorContext &context, QueryMolecule &full_product ) :
+   OsCommandDispatcher(OsCommandDispatcher::HANDLING_ORDER_SERIAL, false),
+   _rpe(rpe), _context(context), _full_product(full_product)
+{
+   _next_monomer = 0;
+}
+
+OsCommand * ReactionProductEnumeratorDispatcher::_allocateCommand ()
+{
+   return new ReactionProductEnumeratorCommand(_rpe, _context, _full_product);
+}
+
+OsCommandResult * ReactionProductEnumeratorDispatcher::_allocateResult ()
+{
+   return new ReactionProductEnumeratorResult;
+}
+
+bool ReactionProductEnumeratorDispatcher::_setupCommand (OsCommand &command)
+{
+   if (_next_monomer >= _rpe._reaction_monomers.size())
+      return false;
+
+   if (_rpe._product_count >= _rpe.max_product_count)
+      return false;
+
+   ReactionProductEnumeratorCommand &cmd = (ReactionProductEnumeratorCommand &)command;
+
+   cmd.monomer_idx = _next_monomer++;
+   return true;
+}
+
+void ReactionProductEnumeratorDispatcher::_handleResult (OsCommandResult &result)
+{
+   ReactionProductEnumeratorResult &res = (ReactionProductEnumeratorResult &)result;
+
+   for (int i = 0; i < res.products.size(); i++)
+   {
+      if (_rpe._product_count >= _rpe.max_product_count)
+      {
+         markToTerminate();
+         return;
+      }
+
+      // Each worker skips its own duplicates, and the products found by
+      // the previous workers are skipped here
+      if (!_rpe.is_same_keeping)
+      {
+         const char *smiles = res.smiles[i].ptr();
+         int *found_count = _rpe._smiles_array.at2(smiles);
+
+         if (found_count != 0)
+         {
+            (*found_count)++;
+            continue;
+         }
+
+         _rpe._smiles_array.insert(smiles, 1);
+      }
+
+      _rpe._product_count++;
+
+      if (_rpe.product_proc != 0)
+         _rpe.product_proc(res.products[i], res.monomers[i], _rpe.userdata);
+   }
+}
+
+//
+// ReactionProductEnumeratorCommand
+//
+
+ReactionProductEnumeratorCommand::ReactionProductEnumeratorCommand(
+   ReactionProductEnumerator &rpe, ReactionEnumeratorContext &context, QueryMolecule &full_product ) :
+   _rpe(rpe), _context(context), _full_product(full_product)
+{
+   monomer_idx = -1;
+   _result = 0;
+   _is_terminated = false;
+}
+
+void ReactionProductEnumeratorCommand::clear ()
+{
+   monomer_idx = -1;
+   _result = 0;
+   _is_terminated = false;
+   OsCommand::clear();
+}
+
+void ReactionProductEnumeratorCommand::execute (OsCommandResult &result)
+{
+   ReactionProductEnumeratorResult &res = (ReactionProductEnumeratorResult &)result;
+
+   QS_DEF(RedBlackStringMap<int>, smiles_array);
+   smiles_array.clear();
+   int product_count = 0;
+
+   // The reaction and monomers are shared between the workers and are
+   // only read, because multistep reactions are enumerated serially
+   ReactionEnumeratorState rpe_state(_context, _rpe._reaction, _full_product,
+                      _rpe._product_aam_array, smiles_array, _rpe._reaction_monomers,
+                      product_count, _rpe._tubes_monomers);
+
+   _rpe._setupState(rpe_state);
+   rpe_state.product_proc = _productProc;
+   rpe_state.userdata = this;
+   rpe_state.product_smiles = &res.current_smiles;
+
+   _result = &res;
+
+   try
+   {
+      rpe_state.buildProductFromMonomer(monomer_idx);
+   }
+   catch (Exception &)
+   {
+      // Enumeration is interrupted by _productProc() if the
+      // dispatcher does not need the products anymore
+      if (!_is_terminated)
+         throw;
+   }
+}
+
+void ReactionProductEnumeratorCommand::_productProc( Molecule &product, Array<int> &monomers_indices, void *userdata )
+{
+   ReactionProductEnumeratorCommand &cmd = *(ReactionProductEnumeratorCommand *)userdata;
+   ReactionProductEnumeratorResult &res = *cmd._result;
+
+   Molecule &new_product = res.products.push();
+   new_product.clone(product, NULL, NULL);
+   new_product.name.copy(product.name);
+
+   res.monomers.push().copy(monomers_indices);
+   res.smiles.push().copy(res.current_smiles);
+
+   if (res.products.size() >= MAX_RESULT_PRODUCTS)
+   {
+      if (!cmd.flushResult(res))
+      {
+         cmd._is_terminated = true;
+         throw ReactionProductEnumerator::Error("enumeration is terminated");
+      }
+   }
+}
+
+//
+// ReactionProductEnumeratorResult
+//
+
+void ReactionProductEnumeratorResult::clear ()
+{
+   products.clear();
+   monomers.clear();
+   smiles.clear();
+   current_smiles.clear();
+}
@@ -0,0 +1,215 @@
+/****************************************************************************
+ * Copyright (C) 2010-2011 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include "reaction/reaction_product_enumerator_stream.h"
+
+#include "base_cpp/tlscont.h"
+#include "reaction/reaction_product_enumerator.h"
+
+using namespace indigo;
+
+IMPL_ERROR(ReactionProductEnumeratorStream, "Reaction product enumerator stream");
+
+ReactionProductEnumeratorStream::ReactionProductEnumeratorStream( ReactionProductEnumerator &rpe, int max_buffered ) :
+   _rpe(rpe)
+{
+   if (max_buffered < 1)
+      throw Error("invalid buffer size %d", max_buffered);
+
+   _buffer.resize(max_buffered);
+   _head = 0;
+   _count = 0;
+   _started = false;
+   _finished = false;
+   _stopping = false;
+}
+
+ReactionProductEnumeratorStream::~ReactionProductEnumeratorStream()
+{
+   stop();
+}
+
+void ReactionProductEnumeratorStream::start( void )
+{
+   stop();
+
+   _head = 0;
+   _count = 0;
+   _finished = false;
+   _stopping = false;
+   _exception.reset(0);
+
+   // Semaphores are created again because the stopped producer
+   // leaves them with arbitrary counts
+   _filled.reset(new OsSemaphore(0, _buffer.size() + 1));
+   _vacant.reset(new OsSemaphore(_buffer.size(), _buffer.size() + 1));
+   _exited.reset(new OsSemaphore(0, 1));
+
+   _rpe.product_proc = _productProc;
+   _rpe.userdata = this;
+
+   _started = true;
+   osThreadCreate(_threadFuncStatic, this);
+}
+
+void ReactionProductEnumeratorStream::stop( void )
+{
+   if (!_started)
+      return;
+
+   {
+      OsLocker locker(_lock);
+      _stopping = true;
+   }
+
+   // Wake up the producer waiting for a vacant place
+   _vacant->Post();
+   _exited->Wait();
+   _started = false;
+}
+
+bool ReactionProductEnumeratorStream::next( Reaction &reaction )
+{
+   return _take(&reaction);
+}
+
+bool ReactionProductEnumeratorStream::skip( void )
+{
+   return _take(0);
+}
+
+bool ReactionProductEnumeratorStream::_take( Reaction *reaction )
+{
+   if (!_started)
+      return false;
+
+   {
+      OsLocker locker(_lock);
+
+      if (_finished && _count == 0)
+      {
+         if (_exception.get() != 0)
+            _exception->throwSelf();
+         return false;
+      }
+   }
+
+   _filled->Wait();
+
+   int pos;
+   {
+      OsLocker locker(_lock);
+
+      if (_count == 0)
+      {
+         // The producer has finished
+         if (_exception.get() != 0)
+            _exception->throwSelf();
+         return false;
+      }
+      pos = _head;
+   }
+
+   // The producer does not touch the filled places
+   if (reaction != 0)
+      reaction->clone(_buffer[pos], 0, 0, 0);
+
+   {
+      OsLocker locker(_lock);
+      _head = (_head + 1) % _buffer.size();
+      _count--;
+   }
+
+   _vacant->Post();
+   return true;
+}
+
+THREAD_RET THREAD_MOD ReactionProductEnumeratorStream::_threadFuncStatic( void *param )
+{
+   ReactionProductEnumeratorStream *stream = (ReactionProductEnumeratorStream *)param;
+
+   stream->_threadFunc();
+   THREAD_END;
+}
+
+void ReactionProductEnumeratorStream::_threadFunc( void )
+{
+   qword session_id = TL_GET_SESSION_ID();
+
+   Exception *exception = 0;
+   try
+   {
+      _rpe.buildProducts();
+   }
+   catch (Exception &e)
+   {
+      exception = e.clone();
+   }
+   catch (...)
+   {
+      exception = Exception("Unknown exception").clone();
+   }
+
+   {
+      OsLocker locker(_lock);
+
+      // Exception thrown by _productProc() on stop is not forwarded
+      if (_stopping)
+         delete exception;
+      else
+         _exception.reset(exception);
+      _finished = true;
+   }
+
+   _filled->Post();
+
+   // The stream must not be accessed after this point
+   _exited->Post();
+
+   TL_RELEASE_SESSION_ID(session_id);
+}
+
+void ReactionProductEnumeratorStream::_productProc( Molecule &product, Array<int> &monomers_indices, void *userdata )
+{
+   ReactionProductEnumeratorStream &stream = *(ReactionProductEnumeratorStream *)userdata;
+
+   stream._vacant->Wait();
+
+   int pos;
+   {
+      OsLocker locker(stream._lock);
+
+      if (stream._stopping)
+         throw Error("enumeration is stopped");
+      pos = (stream._head + stream._count) % stream._buffer.size();
+   }
+
+   // Monomers are copied here, because the monomers list of the
+   // multistep reactions is changed by the enumeration
+   Reaction &reaction = stream._buffer[pos];
+   reaction.clear();
+
+   for (int i = 0; i < monomers_indices.size(); i++)
+      reaction.addReactantCopy(stream._rpe.getMonomer(monomers_indices[i]), 0, 0);
+
+   reaction.addProductCopy(product, 0, 0);
+   reaction.name.copy(product.name);
+
+   {
+      OsLocker locker(stream._lock);
+      stream._count++;
+   }
+
+   stream._filled->Post();
+}
@@ -14,6 +14,7 @@
 
 #include "reaction/reaction_transformation.h"
 #include "reaction/reaction_enumerator_state.h"
+#include "reaction/reaction_transformation_parallel.h"
 #include "layout/molecule_layout.h"
 #include "molecule/elements.h"
 
@@ -23,9 +24,21 @@ IMPL_ERROR(ReactionTransformation, "Reaction transformation");
 
 CP_DEF(ReactionTransformation);
 
-ReactionTransformation::ReactionTransformation( void ) : CP_INIT, TL_CP_GET(_merged_reaction), TL_CP_GET(_cur_monomer)
+ReactionTransformation::PreparedReaction::PreparedReaction( void )
+{
+   clear();
+}
+
+void ReactionTransformation::PreparedReaction::clear( void )
+{
+   merged_reaction.clear();
+   reactant.clear();
+   is_simple = false;
+   elements_count.clear();
+}
+
+ReactionTransformation::ReactionTransformation( void ) : CP_INIT, TL_CP_GET(_cur_monomer)
 {
-   _merged_reaction.clear();
    _cur_monomer.clear();
    layout_flag = true;
    cancellation = 0;
@@ -33,17 +46,88 @@ ReactionTransformation::ReactionTransformation( void ) : CP_INIT, TL_CP_GET(_mer
 
 bool ReactionTransformation::transform( Molecule &molecule, QueryReaction &reaction )
 {
-   _generateMergedReaction(reaction);
-   
-   int reactant_idx = _merged_reaction.reactantBegin();
-   int product_idx = _merged_reaction.productBegin();
+   QS_DEF(PreparedReaction, prepared);
+
+   prepare(reaction, prepared);
+
+   return transform(molecule, prepared);
+}
+
+void ReactionTransformation::prepare( QueryReaction &reaction, PreparedReaction &prepared )
+{
+   prepared.clear();
+   prepared.arom_options = arom_options;
+
+   _generateMergedReaction(reaction, prepared.merged_reaction);
+
+   QueryMolecule &reactant = prepared.merged_reaction.getQueryMolecule(
+      prepared.merged_reaction.reactantBegin());
 
+   ReactionEnumeratorState::prepareReactantQuery(reactant, arom_options, prepared.reactant);
+
+   prepared.is_simple = ReactionEnumeratorState::checkForSimplicity(prepared.merged_reaction);
+
+   // Reactant atoms are mapped to the different molecule atoms, except R-sites.
+   // Hydrogens are skipped, because the implicit ones are unfolded for matching.
+   prepared.elements_count.clear_resize(ELEM_MAX);
+   prepared.elements_count.zerofill();
+
+   for (int i = reactant.vertexBegin(); i != reactant.vertexEnd(); i = reactant.vertexNext(i))
+   {
+      if (reactant.isRSite(i))
+         continue;
+
+      int number = reactant.getAtomNumber(i);
+
+      if (number < ELEM_MIN || number >= ELEM_MAX || number == ELEM_H)
+         continue;
+
+      prepared.elements_count[number]++;
+   }
+}
+
+bool ReactionTransformation::screen( Molecule &molecule, const PreparedReaction &prepared )
+{
+   QS_DEF(Array<int>, elements_count);
+   elements_count.clear_resize(ELEM_MAX);
+   elements_count.zerofill();
+
+   for (int i = molecule.vertexBegin(); i != molecule.vertexEnd(); i = molecule.vertexNext(i))
+   {
+      int number = molecule.getAtomNumber(i);
+
+      if (number >= ELEM_MIN && number < ELEM_MAX)
+         elements_count[number]++;
+   }
+
+   for (int i = ELEM_MIN; i < prepared.elements_count.size(); i++)
+      if (elements_count[i] < prepared.elements_count[i])
+         return false;
+
+   return true;
+}
+
+bool ReactionTransformation::transform( Molecule &molecule, PreparedReaction &prepared )
+{
    bool has_coord = BaseMolecule::hasCoord(molecule);
 
+   if (!screen(molecule, prepared))
+   {
+      // Same as for the molecule without any match below
+      if (has_coord)
+         molecule.stereocenters.markBonds();
+      return true;
+   }
+
+   QueryReaction &merged_reaction = prepared.merged_reaction;
+
+   int reactant_idx = merged_reaction.reactantBegin();
+   int product_idx = merged_reaction.productBegin();
+
    QS_DEF(QueryMolecule, cur_full_product);
    cur_full_product.clear();
-   cur_full_product.clone(_merged_reaction.getQueryMolecule(product_idx), NULL, NULL);
-   Array<int> &cur_cur_monomer_aam_array = _merged_reaction.getAAMArray(product_idx);
+   cur_full_product.clone(merged_reaction.getQueryMolecule(product_idx), NULL, NULL);
+   Array<int> &cur_cur_monomer_aam_array = merged_reaction.getAAMArray(product_idx);
    QS_DEF(RedBlackStringMap<int>, cur_smiles_array);
    cur_smiles_array.clear();
    QS_DEF(ReactionEnumeratorState::ReactionMonomers, cur_reaction_monomers);
@@ -55,9 +139,9 @@ bool ReactionTransformation::transform( Molecule &molecule, QueryReaction &react
    int product_count = 0;
 
    ReactionEnumeratorContext context;
-   context.arom_options = arom_options;
+   context.arom_options = prepared.arom_options;
 
-   ReactionEnumeratorState re_state(context, _merged_reaction, cur_full_product, 
+   ReactionEnumeratorState re_state(context, merged_reaction, cur_full_product, 
       cur_cur_monomer_aam_array, cur_smiles_array, cur_reaction_monomers, 
       product_count, cur_tubes_monomers);
    
@@ -66,6 +150,8 @@ bool ReactionTransformation::transform( Molecule &molecule, QueryReaction &react
    re_state.is_same_keeping = true;
    re_state.is_self_react = false;
    re_state.is_transform = true;
+   re_state.prepared_reactant = &prepared.reactant;
+   re_state.simple_transform = prepared.is_simple ? 1 : 0;
    re_state.userdata = this;
    re_state.product_proc = _product_proc;
 
@@ -111,13 +197,31 @@ bool ReactionTransformation::transform( Molecule &molecule, QueryReaction &react
 
 bool ReactionTransformation::transform(ReusableObjArray<Molecule> &molecules, QueryReaction &reaction)
 {
+   QS_DEF(PreparedReaction, prepared);
+
+   prepare(reaction, prepared);
+
    for (int i = 0; i < molecules.size(); i++)
-      if (!transform(molecules[i], reaction))
+      if (!transform(molecules[i], prepared))
          return false;
 
    return true;
 }
 
+void ReactionTransformation::transform( Array<Molecule *> &molecules, PreparedReaction &prepared, int nthreads )
+{
+   if (nthreads == 1)
+   {
+      for (int i = 0; i < molecules.size(); i++)
+         transform(*molecules[i], prepared);
+      return;
+   }
+
+   ReactionTransformationDispatcher dispatcher(*this, molecules, prepared);
+
+   dispatcher.run(nthreads > 0 ? nthreads : -1);
+}
+
 void ReactionTransformation::_product_proc( Molecule &product, Array<int> &monomers_indices, 
                                             void *userdata )
 {
@@ -148,7 +252,7 @@ void ReactionTransformation::_mergeReactionComponents( QueryReaction &reaction,
    }
 }
 
-void ReactionTransformation::_generateMergedReaction( QueryReaction &reaction )
+void ReactionTransformation::_generateMergedReaction( QueryReaction &reaction, QueryReaction &merged_reaction )
 {
    QS_DEF(QueryMolecule, merged_reactant);
    merged_reactant.clear();
@@ -168,22 +272,22 @@ void ReactionTransformation::_generateMergedReaction( QueryReaction &reaction )
    // Products merging
    _mergeReactionComponents(reaction, BaseReaction::PRODUCT, merged_cur_monomer, product_aam);
    
-   _merged_reaction.clear();
+   merged_reaction.clear();
 
-   int reactant_idx = _merged_reaction.addReactant();
-   int product_idx = _merged_reaction.addProduct();
+   int reactant_idx = merged_reaction.addReactant();
+   int product_idx = merged_reaction.addProduct();
 
-   QueryMolecule &reactant = _merged_reaction.getQueryMolecule(reactant_idx);
-   QueryMolecule &product = _merged_reaction.getQueryMolecule(product_idx);
+   QueryMolecule &reactant = merged_reaction.getQueryMolecule(reactant_idx);
+   QueryMolecule &product = merged_reaction.getQueryMolecule(product_idx);
 
    reactant.clone(merged_reactant, NULL, NULL);
    product.clone(merged_cur_monomer, NULL, NULL);
 
-   Array<int> &r_aam = _merged_reaction.getAAMArray(reactant_idx);
+   Array<int> &r_aam = merged_reaction.getAAMArray(reactant_idx);
    r_aam.clear();
    r_aam.concat(reactant_aam);
 
-   Array<int> &p_aam = _merged_reaction.getAAMArray(product_idx);
+   Array<int> &p_aam = merged_reaction.getAAMArray(product_idx);
    p_aam.clear();
    p_aam.concat(product_aam);
 }
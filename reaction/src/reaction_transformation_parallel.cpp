@@ -0,0 +1,88 @@
+/****************************************************************************
+ * Copyright (C) 2010-2011 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include "reaction/reaction_transformation_parallel.h"
+
+#include "base_cpp/auto_ptr.h"
+#include "base_cpp/cancellation_handler.h"
+
+using namespace indigo;
+
+//
+// ReactionTransformationDispatcher
+//
+
+ReactionTransformationDispatcher::ReactionTransformationDispatcher( ReactionTransformation &rt,
+   Array<Molecule *> &molecules, ReactionTransformation::PreparedReaction &prepared ) :
+   OsCommandDispatcher(OsCommandDispatcher::HANDLING_ORDER_ANY, false),
+   _rt(rt), _molecules(molecules), _prepared(prepared)
+{
+   _next_molecule = 0;
+}
+
+OsCommand * ReactionTransformationDispatcher::_allocateCommand ()
+{
+   return new ReactionTransformationCommand(_rt, _molecules, _prepared, _cancellation_lock);
+}
+
+bool ReactionTransformationDispatcher::_setupCommand (OsCommand &command)
+{
+   if (_next_molecule >= _molecules.size())
+      return false;
+
+   ReactionTransformationCommand &cmd = (ReactionTransformationCommand &)command;
+
+   cmd.begin = _next_molecule;
+   cmd.end = __min(_next_molecule + (int)BATCH_SIZE, _molecules.size());
+   _next_molecule = cmd.end;
+   return true;
+}
+
+//
+// ReactionTransformationCommand
+//
+
+ReactionTransformationCommand::ReactionTransformationCommand( ReactionTransformation &rt,
+   Array<Molecule *> &molecules, ReactionTransformation::PreparedReaction &prepared,
+   OsLock &cancellation_lock ) :
+   _rt(rt), _molecules(molecules), _prepared(prepared), _cancellation_lock(cancellation_lock)
+{
+   begin = end = 0;
+}
+
+void ReactionTransformationCommand::clear ()
+{
+   begin = end = 0;
+   OsCommand::clear();
+}
+
+void ReactionTransformationCommand::execute (OsCommandResult &result)
+{
+   // Temporary data of the transformation is thread-local,
+   // so each worker uses its own transformation object
+   ReactionTransformation rt;
+   AutoPtr<LockedCancellationHandler> cancellation;
+
+   rt.arom_options = _rt.arom_options;
+   rt.layout_flag = _rt.layout_flag;
+   if (_rt.cancellation != 0)
+   {
+      // The handler of the caller is not thread-safe
+      cancellation.reset(new LockedCancellationHandler(*_rt.cancellation, _cancellation_lock));
+      rt.cancellation = cancellation.get();
+   }
+
+   for (int i = begin; i < end; i++)
+      rt.transform(*_molecules[i], _prepared);
+}
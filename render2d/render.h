@@ -28,6 +28,7 @@ public:
 
 protected:
    float _getObjScale (int item);
+   static float _getObjScale (RenderItemFactory& factory, int item);
    int _getMaxWidth ();
    int _getMaxHeight ();
    float _getScale (int w, int h);
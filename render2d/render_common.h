@@ -403,6 +403,7 @@ struct CanvasOptions {
    MultilineTextLayout titleAlign;
 
    int gridColumnNumber;
+   int gridThreads; // default is one - serial mode, zero - automatic
 private:
    CanvasOptions (const CanvasOptions&);
 };
@@ -446,6 +447,7 @@ public:
    bool showCycles; // for diagnostic purposes
    bool agentsBelowArrow;
    bool collapseSuperatoms;
+   bool svgDirect;
    Array<char> atomColorProp;
 private:
    RenderOptions (const RenderOptions& );
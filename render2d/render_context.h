@@ -20,6 +20,7 @@
 #include <cairo-svg.h>
 
 #include "render_common.h"
+#include "render_svg_writer.h"
 
 namespace indigo {
 
@@ -43,12 +44,16 @@ public:
    void initNullContext ();
    void initContext (int width, int height);
    void closeContext (bool discard);
+   void initTileContext (const RenderContext& canvas, int x, int y, int width, int height);
+   void drawTile (const RenderContext& tile);
    void translate (float dx, float dy);
    void scale (float s);
    void storeTransform ();
    void restoreTransform ();
    void resetTransform ();
    void removeStoredTransform ();
+   void getTransform (cairo_matrix_t& t);
+   void setTransform (const cairo_matrix_t& t);
    void drawRectangle (const Vec2f& p, const Vec2f& sz);
    void drawItemBackground (const RenderItem& item);
    void drawTextItemText (const TextItem& ti);
@@ -128,6 +133,8 @@ private:
    static cairo_status_t writer (void *closure, const unsigned char *data, unsigned int length);
 
    void _drawGraphItem (GraphItem& gi);
+   void _fill ();
+   void _stroke ();
    void lineTo (const Vec2f& v);
    void lineToRel (float x, float y);
    void lineToRel (const Vec2f& v);
@@ -193,6 +200,8 @@ private:
    cairo_t* _cr;
    cairo_surface_t* _surface;
    void* _meta_hdc;
+   RenderSvgWriter _svg;
+   bool _svgDirect;
 
 public:
    RenderSettings _settings;
@@ -15,10 +15,29 @@
 #ifndef __render_grid_h__
 #define __render_grid_h__
 
+#include "base_cpp/os_thread_wrapper.h"
+#include "base_cpp/ptr_array.h"
 #include "render.h"
+#include "render_item_factory.h"
 
 namespace indigo {
 
+// Object of the grid with its own render context and item factory, so
+// that it is measured and rasterized in a worker thread
+struct RenderGridCell {
+   RenderGridCell (const RenderOptions& opt, float sf, float lwf);
+
+   RenderContext rc;
+   RenderItemFactory factory;
+   int obj;
+   // Tile position and size in the device space
+   int x, y, width, height;
+   // Tiles of the same wave do not overlap
+   int wave;
+   // Transform of the object relative to the tile
+   cairo_matrix_t transform;
+};
+
 class RenderGrid : Render {
 public:
    RenderGrid (RenderContext& rc, RenderItemFactory& factory, const CanvasOptions& cnvOpt, int bondLength, bool bondLengthSet);
@@ -35,8 +54,25 @@ public:
    int commentOffset;
    int comment;
 
+   // Settings of the render context, for the contexts of the cells
+   float relativeThickness;
+   float bondLineWidthFactor;
+
 private:
+   friend class RenderGridCommand;
+   friend class RenderGridDispatcher;
+
    void _drawComment();
+   bool _isParallel ();
+   void _prepareCells ();
+   void _estimateCell (int idx);
+   void _placeCell (int idx);
+   int _assignWaves ();
+   void _initCellTile (int idx);
+   void _rasterizeCell (int idx);
+   void _drawCell (int idx);
+   RenderItemBase& _getObj (int i);
+   RenderItemMolecule& _getObjMolecule (int i);
 
    int nRows;
    float scale;
@@ -47,12 +83,71 @@ private:
    Vec2f clientArea;
    Vec2f commentSize;
    int _width, _height;
+   PtrArray<RenderGridCell> _cells;
 
    float _getScaleGivenSize (int w, int h);
    int _getDefaultWidth (const float s);
    int _getDefaultHeight (const float s);
 };
 
+//
+// Parallel mode of the grid for the raster output. Each command takes
+// one cell: in the ESTIMATE task the object is measured, in the
+// RASTERIZE task it is drawn into its own tile. Tiles are copied from
+// the canvas and painted back on it in the main thread. Overlapping
+// tiles belong to the different waves that are run one after another,
+// so the result is the same as in the serial mode.
+//
+
+class RenderGridDispatcher : public OsCommandDispatcher
+{
+public:
+   enum
+   {
+      ESTIMATE,
+      RASTERIZE
+   };
+
+   RenderGridDispatcher (RenderGrid& grid, int task, int wave = 0);
+
+protected:
+   virtual OsCommand* _allocateCommand ();
+   virtual OsCommandResult* _allocateResult ();
+
+   virtual bool _setupCommand (OsCommand& command);
+   virtual void _handleResult (OsCommandResult& result);
+
+   RenderGrid& _grid;
+   int _task;
+   int _wave;
+   int _next;
+};
+
+class RenderGridCommand : public OsCommand
+{
+public:
+   RenderGridCommand (RenderGrid& grid, int task);
+
+   virtual void execute (OsCommandResult& result);
+   virtual void clear ();
+
+   int cell_idx;
+
+private:
+   RenderGrid& _grid;
+   int _task;
+};
+
+class RenderGridResult : public OsCommandResult
+{
+public:
+   RenderGridResult ();
+
+   virtual void clear ();
+
+   int cell_idx;
+};
+
 }
 
 #endif //__render_grid_h__
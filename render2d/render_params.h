@@ -24,10 +24,31 @@ class BaseMolecule;
 class Reaction;
 class Scanner;
 class Output;
+class RenderContext;
 class RenderItemFactory;
 
 enum RENDER_MODE {RENDER_MOL, RENDER_RXN, RENDER_NONE};
 
+// Prepared molecule with its item tree and the estimated sizes of the
+// items. These do not depend on the size of the picture or on the
+// colors, so the tree is drawn again while the molecule and the
+// options that change the items stay the same.
+class RenderTree {
+public:
+   RenderTree ();
+   ~RenderTree ();
+
+   Array<char> key;
+   AutoPtr<BaseMolecule> mol;
+   AutoPtr<RenderContext> rc;
+   AutoPtr<RenderItemFactory> factory;
+   int obj;
+   int comment;
+   bool estimated;
+private:
+   RenderTree (const RenderTree&);
+};
+
 class RenderParams {
 public:
    RenderParams ();
@@ -49,6 +70,12 @@ public:
    ObjArray<Array <char> > titles;
    Array<int> refAtoms;
 
+   // Identifies the source molecule of 'mol' for the kept item trees.
+   // Empty if the tree of the molecule must not be kept.
+   Array<char> sourceKey;
+   enum { MAX_TREES = 4 };
+   PtrArray<RenderTree> trees;
+
    RenderOptions rOpt;
    CanvasOptions cnvOpt;
 };
@@ -57,11 +84,18 @@ class RenderParamInterface {
 public:
    DECL_ERROR;
    static void render (RenderParams& params);
+   // True if the item tree for 'sourceKey' and the current options is
+   // kept, so that 'mol' does not have to be set
+   static bool hasTree (RenderParams& params);
    static int multilineTextUnit (RenderItemFactory& factory, int type, const Array<char>& titleStr, const float spacing, const MultilineTextLayout::Alignment alignment);
 
 private:
    static void _prepareMolecule (RenderParams& params, BaseMolecule& bm);
    static void _prepareReaction (RenderParams& params, BaseReaction& rxn);
+   static void _prepareGrid (RenderParams& params);
+   static void _getTreeKey (RenderParams& params, Array<char>& key);
+   static RenderTree* _findTree (RenderParams& params, const Array<char>& key);
+   static void _renderTree (RenderParams& params);
    static bool needsLayoutSub (BaseMolecule& mol);
    static bool needsLayout (BaseMolecule& mol);
    RenderParamInterface ();
@@ -29,6 +29,8 @@ public:
 
    int obj;
    int comment;
+   // Items are initialized and their sizes are estimated already
+   bool estimated;
    float scale;
    int commentOffset;
    Vec2f objSize;
@@ -0,0 +1,87 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#ifndef __render_svg_writer_h__
+#define __render_svg_writer_h__
+
+#include <cairo.h>
+
+#include "base_cpp/array.h"
+#include "base_cpp/red_black.h"
+
+namespace indigo {
+
+class Output;
+
+// SVG document made directly from the paths and the text of a cairo
+// context, instead of drawing them on the cairo SVG surface. The text
+// is written as <text> elements, and a path that is drawn more than
+// once at different positions (dots, wedges, charge signs) is written
+// once to <defs> and then referenced by <use>. Coordinates are taken
+// in the device space and rounded to 0.01.
+class RenderSvgWriter
+{
+public:
+   RenderSvgWriter ();
+
+   void begin (int width, int height, const char *font_family);
+
+   // Same as cairo_fill(), cairo_stroke() and cairo_paint() with the
+   // current path, source and line settings of the context
+   void fill (cairo_t *cr);
+   void stroke (cairo_t *cr);
+   void paint (cairo_t *cr);
+
+   // Same as cairo_show_text() at the current point with the font size
+   // of the context
+   void showText (cairo_t *cr, const char *font_family, bool bold, const char *text);
+
+   void end (Output &output);
+
+protected:
+   struct _Element
+   {
+      int shape;     // index of the shape, or -1 for the markup only
+      int x, y;      // position of the shape in 0.01 units
+      int markup;    // offset of the attributes or of the whole element
+   };
+
+   int _width;
+   int _height;
+   Array<char> _font_family;
+   Array<char> _markup;
+   Array<char> _defs;
+   Array<char> _shapes;
+   Array<int>  _shape_offsets;
+   Array<int>  _shape_uses;
+   Array<_Element> _elements;
+   RedBlackStringMap<int> _shape_map;
+   RedBlackStringMap<int> _gradient_map;
+
+   void _addPath (cairo_t *cr, const Array<char> &attrs, bool shared);
+   void _addMarkup (const Array<char> &markup);
+   void _getSource (cairo_t *cr, Array<char> &paint, bool &shared);
+
+   static void _writeValue (Array<char> &buf, double value);
+   static void _writeCoord (Array<char> &buf, int value, bool first);
+   static void _writeColor (Array<char> &buf, double r, double g, double b);
+   static void _writeText (Array<char> &buf, const char *text);
+
+private:
+   RenderSvgWriter (const RenderSvgWriter &); // no implicit copy
+};
+
+}
+
+#endif //__render_svg_writer_h__
@@ -42,14 +42,19 @@ Render::~Render()
 {}
 
 float Render::_getObjScale (int item)
+{
+   return _getObjScale(_factory, item);
+}
+
+float Render::_getObjScale (RenderItemFactory& factory, int item)
 {
    float avgBondLength = 1.0f;
-   int bondCount = _factory.getItem(item).getBondCount();
-   int atomCount = _factory.getItem(item).getAtomCount();
+   int bondCount = factory.getItem(item).getBondCount();
+   int atomCount = factory.getItem(item).getAtomCount();
    if (bondCount > 0) {
-      avgBondLength = _factory.getItem(item).getTotalBondLength() / bondCount;
+      avgBondLength = factory.getItem(item).getTotalBondLength() / bondCount;
    } else {
-      avgBondLength = _factory.getItem(item).getTotalClosestAtomDistance() / atomCount;
+      avgBondLength = factory.getItem(item).getTotalClosestAtomDistance() / atomCount;
    }
    if (avgBondLength < 1e-4)
       avgBondLength = 1.0f;
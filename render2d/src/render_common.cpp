@@ -337,6 +337,7 @@ void CanvasOptions::clear ()
    titleAlign.clear();
    titleOffset = 0;
    gridColumnNumber = 1;
+   gridThreads = 1;
    comment.clear();
    titleProp.clear();
    titleProp.appendString("^NAME", true);
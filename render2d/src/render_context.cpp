@@ -114,7 +114,7 @@ void RenderContext::storeAndDestroyMetafile (bool discard)
 CP_DEF(RenderContext);
 
 RenderContext::RenderContext (const RenderOptions& ropt, float sf, float lwf): CP_INIT, TL_CP_GET(_fontfamily), TL_CP_GET(transforms),
-metafileFontsToCurves(false), _cr(NULL), _surface(NULL), _meta_hdc(NULL), opt(ropt), _pattern(NULL)
+metafileFontsToCurves(false), _cr(NULL), _surface(NULL), _meta_hdc(NULL), _svgDirect(false), opt(ropt), _pattern(NULL)
 {
    _settings.init(sf, lwf);
    bprintf(_fontfamily, "Arial");
@@ -274,7 +274,10 @@ void RenderContext::fillBackground()
 {
    cairo_set_source_rgb(_cr, opt.backgroundColor.x, opt.backgroundColor.y, opt.backgroundColor.z);
    cairoCheckStatus();
-   cairo_paint(_cr);
+   if (_svgDirect)
+      _svg.paint(_cr);
+   else
+      cairo_paint(_cr);
    cairoCheckStatus();
 }
 
@@ -299,12 +302,64 @@ void RenderContext::initContext (int width, int height)
    if (_surface != NULL || _cr != NULL)
       throw Error("context is already open (or invalid)");
 
-   createSurface(writer, opt.output, _width, _height);
+   // The SVG surface is still used for the text measurements, but the
+   // document is made by the writer
+   _svgDirect = opt.mode == MODE_SVG && opt.svgDirect;
+   if (_svgDirect)
+      _svg.begin(_width, _height, _fontfamily.ptr());
+
+   createSurface(_svgDirect ? NULL : writer, opt.output, _width, _height);
    _cr = cairo_create(_surface);
    if (opt.backgroundColor.x >= 0 && opt.backgroundColor.y >= 0 && opt.backgroundColor.z >= 0)
       fillBackground();
 }
 
+// Transparent raster surface for a part of the picture, that is
+// drawn separately and then painted with drawTile()
+void RenderContext::initTileContext (const RenderContext& canvas, int x, int y, int width, int height)
+{
+   _width = width;
+   _height = height;
+   if (_surface != NULL || _cr != NULL)
+      throw Error("context is already open (or invalid)");
+   if (canvas._surface == NULL)
+      throw Error("canvas context is not open");
+
+   _surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, _width, _height);
+   cairoCheckStatus();
+   cairo_surface_set_device_offset(_surface, -x, -y);
+   _cr = cairo_create(_surface);
+
+   // The tile starts from the canvas pixels, so the antialiased edges
+   // are blended with the background exactly as on the canvas
+   cairo_surface_flush(canvas._surface);
+   cairo_set_source_surface(_cr, canvas._surface, 0, 0);
+   cairo_set_operator(_cr, CAIRO_OPERATOR_SOURCE);
+   cairo_paint(_cr);
+   cairo_set_operator(_cr, CAIRO_OPERATOR_OVER);
+   cairoCheckStatus();
+}
+
+void RenderContext::drawTile (const RenderContext& tile)
+{
+   if (tile._surface == NULL)
+      throw Error("tile context is not open");
+
+   double x, y;
+
+   cairo_surface_flush(tile._surface);
+   cairo_surface_get_device_offset(tile._surface, &x, &y);
+   cairo_save(_cr);
+   cairo_identity_matrix(_cr);
+   cairo_rectangle(_cr, -x, -y, tile._width, tile._height);
+   cairo_clip(_cr);
+   cairo_set_source_surface(_cr, tile._surface, 0, 0);
+   cairo_set_operator(_cr, CAIRO_OPERATOR_SOURCE);
+   cairo_paint(_cr);
+   cairo_restore(_cr);
+   cairoCheckStatus();
+}
+
 void RenderContext::closeContext (bool discard)
 {
    if (_cr != NULL)
@@ -313,6 +368,13 @@ void RenderContext::closeContext (bool discard)
       _cr = NULL;
    }
 
+   if (_svgDirect)
+   {
+      if (!discard)
+         _svg.end(*opt.output);
+      _svgDirect = false;
+   }
+
    switch (opt.mode)
    {
    case MODE_NONE:
@@ -376,6 +438,18 @@ void RenderContext::removeStoredTransform ()
    transforms.pop();
 }
 
+void RenderContext::getTransform (cairo_matrix_t& t)
+{
+   cairo_get_matrix(_cr, &t);
+   cairoCheckStatus();
+}
+
+void RenderContext::setTransform (const cairo_matrix_t& t)
+{
+   cairo_set_matrix(_cr, &t);
+   cairoCheckStatus();
+}
+
 void RenderContext::resetTransform ()
 {
    cairo_matrix_t t;
@@ -396,7 +470,7 @@ void RenderContext::drawRectangle (const Vec2f& p, const Vec2f& sz)
    cairo_rectangle(_cr, p.x, p.y, sz.x, sz.y);
    cairoCheckStatus();
    checkPathNonEmpty();
-   cairo_fill(_cr);
+   _fill();
    cairoCheckStatus();
 }
 
@@ -410,7 +484,7 @@ void RenderContext::drawItemBackground (const RenderItem& item)
       setSingleSource(CWC_WHITE);
 
    checkPathNonEmpty();
-   cairo_fill(_cr);
+   _fill();
    cairoCheckStatus();
 }
 
@@ -452,7 +526,7 @@ void RenderContext::drawLine (const Vec2f& v0, const Vec2f& v1)
    lineTo(v1);
    checkPathNonEmpty();
    bbIncludePath(true);
-   cairo_stroke(_cr);
+   _stroke();
    cairoCheckStatus();
 }
 
@@ -464,10 +538,26 @@ void RenderContext::drawPoly (const Array<Vec2f>& v)
    lineTo(v[0]);
    checkPathNonEmpty();
    bbIncludePath(true);
-   cairo_stroke(_cr);
+   _stroke();
    cairoCheckStatus();
 }
 
+void RenderContext::_fill ()
+{
+   if (_svgDirect)
+      _svg.fill(_cr);
+   else
+      cairo_fill(_cr);
+}
+
+void RenderContext::_stroke ()
+{
+   if (_svgDirect)
+      _svg.stroke(_cr);
+   else
+      cairo_stroke(_cr);
+}
+
 void RenderContext::checkPathNonEmpty () const
 {
 #ifdef DEBUG
@@ -488,7 +578,7 @@ void RenderContext::fillQuad (const Vec2f& v0, const Vec2f& v1, const Vec2f& v2,
    lineTo(v3);
    checkPathNonEmpty();
    bbIncludePath(false);
-   cairo_fill(_cr);
+   _fill();
    cairoCheckStatus();
 }
 
@@ -502,7 +592,7 @@ void RenderContext::fillHex (const Vec2f& v0, const Vec2f& v1, const Vec2f& v2,
    lineTo(v5);
    checkPathNonEmpty();
    bbIncludePath(false);
-   cairo_fill(_cr);
+   _fill();
    cairoCheckStatus();
 }
 
@@ -524,7 +614,7 @@ void RenderContext::fillQuadStripes (const Vec2f& v0r, const Vec2f& v0l, const V
    }
    checkPathNonEmpty();
    bbIncludePath(true);
-   cairo_stroke(_cr);
+   _stroke();
    cairoCheckStatus();
 }
 
@@ -537,7 +627,7 @@ void RenderContext::fillPentagon (const Vec2f& v0, const Vec2f& v1, const Vec2f&
    lineTo(v4);
    checkPathNonEmpty();
    bbIncludePath(false);
-   cairo_fill(_cr);
+   _fill();
    cairoCheckStatus();
 }
 
@@ -551,7 +641,7 @@ void RenderContext::drawQuad (const Vec2f& v0, const Vec2f& v1, const Vec2f& v2,
    cairoCheckStatus();
    checkPathNonEmpty();
    bbIncludePath(true);
-   cairo_stroke(_cr);
+   _stroke();
    cairoCheckStatus();
 }
 
@@ -579,7 +669,7 @@ void RenderContext::drawTriangleZigzag (const Vec2f& v0, const Vec2f& v1, const
    }
    checkPathNonEmpty();
    bbIncludePath(true);
-   cairo_stroke(_cr);
+   _stroke();
    cairoCheckStatus();
    cairo_set_line_join(_cr, CAIRO_LINE_JOIN_BEVEL);
    cairoCheckStatus();
@@ -592,7 +682,7 @@ void RenderContext::drawCircle (const Vec2f& center, const float r)
    cairoCheckStatus();
    checkPathNonEmpty();
    bbIncludePath(true);
-   cairo_stroke(_cr);
+   _stroke();
    cairoCheckStatus();
    cairo_new_path(_cr);
 }
@@ -603,7 +693,7 @@ void RenderContext::fillCircle (const Vec2f& center, const float r)
    cairoCheckStatus();
    checkPathNonEmpty();
    bbIncludePath(false);
-   cairo_fill(_cr);
+   _fill();
    cairoCheckStatus();
 }
 
@@ -615,7 +705,7 @@ void RenderContext::drawArc (const Vec2f& center, const float r, const float a0,
    cairoCheckStatus();
    checkPathNonEmpty();
    bbIncludePath(true);
-   cairo_stroke(_cr);
+   _stroke();
    cairoCheckStatus();
 }
 
@@ -674,7 +764,7 @@ void RenderContext::drawAttachmentPoint (RenderItemAttachmentPoint& ri)
    lineTo(ri.p1);
    checkPathNonEmpty();
    bbIncludePath(false);
-   cairo_stroke(_cr);
+   _stroke();
    cairoCheckStatus();
 
    Vec2f n;
@@ -699,7 +789,7 @@ void RenderContext::drawAttachmentPoint (RenderItemAttachmentPoint& ri)
    }
    checkPathNonEmpty();
    bbIncludePath(false);
-   cairo_stroke(_cr);
+   _stroke();
    cairoCheckStatus();
 
    QS_DEF(TextItem, ti);
@@ -782,7 +872,7 @@ void RenderContext::_drawGraphItem (GraphItem& gi)
    }
    checkPathNonEmpty();
    bbIncludePath(false);
-   cairo_fill(_cr);
+   _fill();
    cairoCheckStatus();
 }
 
@@ -799,7 +889,7 @@ void RenderContext::drawBracket (RenderItemBracket& bracket)
 
    checkPathNonEmpty();
    bbIncludePath(false);
-   cairo_stroke(_cr);
+   _stroke();
    cairoCheckStatus();
 }
 
@@ -808,7 +898,7 @@ void RenderContext::fillRect (double x, double y, double w, double h)
    cairo_rectangle(_cr, x, y, w, h);
    cairoCheckStatus();
    checkPathNonEmpty();
-   cairo_fill(_cr);
+   _fill();
    cairoCheckStatus();
 }
 
@@ -823,7 +913,7 @@ void RenderContext::drawEquality (const Vec2f& pos, const float linewidth, const
    setLineWidth(linewidth);
    checkPathNonEmpty();
    bbIncludePath(true);
-   cairo_stroke(_cr);
+   _stroke();
    cairoCheckStatus();
 }
 
@@ -839,7 +929,7 @@ void RenderContext::drawPlus (const Vec2f& pos, const float linewidth, const flo
    setLineWidth(linewidth);
    checkPathNonEmpty();
    bbIncludePath(true);
-   cairo_stroke(_cr);
+   _stroke();
    cairoCheckStatus();
 }
 
@@ -870,7 +960,7 @@ void RenderContext::drawArrow (const Vec2f& p1, const Vec2f& p2, const float wid
    lineTo(p);
    checkPathNonEmpty();
    bbIncludePath(false);
-   cairo_fill(_cr);
+   _fill();
    cairoCheckStatus();
 }
 
@@ -116,7 +116,7 @@ void RenderContext::fontsDrawText(const TextItem& ti, const Vec3f& color, bool b
       cairo_rectangle(_cr, ti.bbp.x + ti.bbsz.x / 4, ti.bbp.y + ti.bbsz.y / 4, ti.bbsz.x/2, ti.bbsz.y/2);
       bbIncludePath(false);
       cairo_set_line_width(_cr, _settings.unit / 2);
-      cairo_stroke(_cr);
+      _stroke();
       return;
    }
    moveToRel(ti.relpos);
@@ -133,11 +133,14 @@ void RenderContext::fontsDrawText(const TextItem& ti, const Vec3f& color, bool b
       cairo_text_path(_cr, ti.text.ptr());
       _tlock.unlock();
       cairoCheckStatus();
-      cairo_fill(_cr);
+      _fill();
       cairoCheckStatus();
    } else {
       _tlock.lock();
-      cairo_show_text(_cr, ti.text.ptr());
+      if (_svgDirect)
+         _svg.showText(_cr, _fontfamily.ptr(), bold, ti.text.ptr());
+      else
+         cairo_show_text(_cr, ti.text.ptr());
       _tlock.unlock();
       cairoCheckStatus();
    }
@@ -31,8 +31,15 @@ using namespace indigo;
 
 IMPL_ERROR(RenderGrid, "RenderGrid");
 
+RenderGridCell::RenderGridCell (const RenderOptions& opt, float sf, float lwf) :
+   rc(opt, sf, lwf), factory(rc), obj(-1), x(0), y(0), width(0), height(0), wave(0)
+{
+   rc.fontsClear();
+}
+
 RenderGrid::RenderGrid (RenderContext& rc, RenderItemFactory& factory, const CanvasOptions& cnvOpt, int bondLength, bool bondLengthSet) :
-   Render(rc, factory, cnvOpt, bondLength, bondLengthSet), nColumns(cnvOpt.gridColumnNumber), comment(-1)
+   Render(rc, factory, cnvOpt, bondLength, bondLengthSet), nColumns(cnvOpt.gridColumnNumber), comment(-1),
+   relativeThickness(1.0f), bondLineWidthFactor(1.0f)
 {}
 
 RenderGrid::~RenderGrid()
@@ -77,6 +84,11 @@ void RenderGrid::draw ()
       commentOffset = _cnvOpt.commentOffset;
    }
 
+   bool parallel = _isParallel();
+   _cells.clear();
+   if (parallel)
+      _prepareCells();
+
    maxsz.set(0,0);
    Vec2f refSizeLT, refSizeRB;
    Array<float> columnExtentLeft, columnExtentRight, rowExtentTop, rowExtentBottom;
@@ -89,15 +101,17 @@ void RenderGrid::draw ()
    rowExtentTop.fill(0);
    rowExtentBottom.fill(0);
    for (int i = 0; i < objs.size(); ++i) {
-      if (enableRefAtoms)
-         _factory.getItemMolecule(objs[i]).refAtom = refAtoms[i];
-      _factory.getItem(objs[i]).init();
-      _factory.getItem(objs[i]).setObjScale(_getObjScale(objs[i]));
-      _factory.getItem(objs[i]).estimateSize();
+      if (!parallel) {
+         if (enableRefAtoms)
+            _factory.getItemMolecule(objs[i]).refAtom = refAtoms[i];
+         _factory.getItem(objs[i]).init();
+         _factory.getItem(objs[i]).setObjScale(_getObjScale(objs[i]));
+         _factory.getItem(objs[i]).estimateSize();
+      }
       if (enableRefAtoms) {
-         const Vec2f& r = _factory.getItemMolecule(objs[i]).refAtomPos;
+         const Vec2f& r = _getObjMolecule(i).refAtomPos;
          Vec2f d;
-         d.diff(_factory.getItemMolecule(objs[i]).size, r);
+         d.diff(_getObjMolecule(i).size, r);
          refSizeLT.max(r);
          int col = i % nColumns;
          int row = i / nColumns;
@@ -107,7 +121,7 @@ void RenderGrid::draw ()
          rowExtentBottom[row] = __max(rowExtentBottom[row], d.y);
          refSizeRB.max(d);
       } else {
-         maxsz.max(_factory.getItem(objs[i]).size);
+         maxsz.max(_getObj(i).size);
       }
    }
    if (enableRefAtoms)
@@ -156,20 +170,23 @@ void RenderGrid::draw ()
          {
             int y = i / nColumns;
             int x = i % nColumns;
-            Vec2f size(_factory.getItem(objs[i]).size);
+            Vec2f size(_getObj(i).size);
 
             _rc.translate(x * (cellsz.x + _cnvOpt.gridMarginX), y * (cellsz.y + _cnvOpt.gridMarginY));
             _rc.storeTransform();
             {
                if (enableRefAtoms) {
                   _rc.translate(0.5f * (cellsz.x - (columnExtentRight[x] + columnExtentLeft[x]) * scale), 0.5f * (maxsz.y - (rowExtentBottom[y]+ rowExtentTop[y])) * scale);
-                  const Vec2f r = _factory.getItemMolecule(objs[i]).refAtomPos;
+                  const Vec2f r = _getObjMolecule(i).refAtomPos;
                   _rc.translate((columnExtentLeft[x] - r.x) * scale, (rowExtentTop[y] - r.y) * scale);
                } else {
                   _rc.translate(0.5f * (cellsz.x - size.x * scale), 0.5f * (maxsz.y - size.y) * scale);
                }
                _rc.scale(scale);
-               _factory.getItem(objs[i]).render();
+               if (parallel)
+                  _placeCell(i);
+               else
+                  _factory.getItem(objs[i]).render();
             }
             _rc.restoreTransform();
             _rc.removeStoredTransform();
@@ -184,6 +201,14 @@ void RenderGrid::draw ()
          _rc.restoreTransform();
          _rc.removeStoredTransform();
       }
+
+      if (parallel) {
+         int waves = _assignWaves();
+         for (int w = 0; w < waves; w++) {
+            RenderGridDispatcher dispatcher(*this, RenderGridDispatcher::RASTERIZE, w);
+            dispatcher.run(_cnvOpt.gridThreads > 0 ? _cnvOpt.gridThreads : -1);
+         }
+      }
    }
    _rc.restoreTransform();
    _rc.removeStoredTransform();
@@ -193,6 +218,126 @@ void RenderGrid::draw ()
    }
 }
 
+// Only the raster output is drawn by parts. Vector output goes through
+// one context, and the SVG surfaces are not used concurrently at all.
+bool RenderGrid::_isParallel ()
+{
+   return _cnvOpt.gridThreads != 1 && objs.size() > 1 && _opt.mode == MODE_PNG;
+}
+
+RenderItemBase& RenderGrid::_getObj (int i)
+{
+   if (_cells.size() > 0)
+      return _cells[i]->factory.getItem(_cells[i]->obj);
+   return _factory.getItem(objs[i]);
+}
+
+RenderItemMolecule& RenderGrid::_getObjMolecule (int i)
+{
+   if (_cells.size() > 0)
+      return _cells[i]->factory.getItemMolecule(_cells[i]->obj);
+   return _factory.getItemMolecule(objs[i]);
+}
+
+void RenderGrid::_prepareCells ()
+{
+   bool enableRefAtoms = refAtoms.size() > 0 && _factory.isItemMolecule(objs[0]);
+
+   for (int i = 0; i < objs.size(); ++i) {
+      RenderGridCell& cell = _cells.add(new RenderGridCell(_opt, relativeThickness, bondLineWidthFactor));
+      cell.rc.setDefaultScale((float)_bondLength);
+      if (_factory.isItemMolecule(objs[i])) {
+         cell.obj = cell.factory.addItemMolecule();
+         cell.factory.getItemMolecule(cell.obj).mol = _factory.getItemMolecule(objs[i]).mol;
+         if (enableRefAtoms)
+            cell.factory.getItemMolecule(cell.obj).refAtom = refAtoms[i];
+      } else {
+         cell.obj = cell.factory.addItemReaction();
+         cell.factory.getItemReaction(cell.obj).rxn = _factory.getItemReaction(objs[i]).rxn;
+      }
+   }
+
+   RenderGridDispatcher dispatcher(*this, RenderGridDispatcher::ESTIMATE);
+   dispatcher.run(_cnvOpt.gridThreads > 0 ? _cnvOpt.gridThreads : -1);
+}
+
+void RenderGrid::_estimateCell (int idx)
+{
+   RenderGridCell& cell = *_cells[idx];
+   RenderItemBase& item = cell.factory.getItem(cell.obj);
+
+   item.init();
+   item.setObjScale(_getObjScale(cell.factory, cell.obj));
+   item.estimateSize();
+}
+
+// Called instead of the drawing of the object, with the same transform
+void RenderGrid::_placeCell (int idx)
+{
+   RenderGridCell& cell = *_cells[idx];
+   cairo_matrix_t& t = cell.transform;
+   // Room for the antialiasing and the line ends, and for the debug
+   // indices and arcs that are not counted in the object size
+   float extent = _settings.bondLineWidth;
+   if (_opt.showAtomIds || _opt.showBondIds || _opt.showBondEndIds || _opt.showNeighborArcs)
+      extent += 4 * _settings.fzz[FONT_SIZE_INDICES] + _settings.boundExtent;
+   int margin = 2 + (int)ceil(extent * scale);
+
+   // The tile is aligned to the pixels, so the object is rasterized
+   // exactly as it is on the canvas
+   _rc.getTransform(t);
+   cell.x = (int)floor(t.x0) - margin;
+   cell.y = (int)floor(t.y0) - margin;
+   cell.width = (int)ceil(t.x0 - cell.x + _getObj(idx).size.x * scale) + margin;
+   cell.height = (int)ceil(t.y0 - cell.y + _getObj(idx).size.y * scale) + margin;
+}
+
+// A tile goes to the wave after all the earlier tiles it overlaps
+int RenderGrid::_assignWaves ()
+{
+   int waves = 0;
+
+   for (int i = 0; i < _cells.size(); i++) {
+      RenderGridCell& cell = *_cells[i];
+
+      cell.wave = 0;
+      for (int j = 0; j < i; j++) {
+         const RenderGridCell& prev = *_cells[j];
+
+         if (cell.x < prev.x + prev.width && prev.x < cell.x + cell.width &&
+             cell.y < prev.y + prev.height && prev.y < cell.y + cell.height)
+            cell.wave = __max(cell.wave, prev.wave + 1);
+      }
+      waves = __max(waves, cell.wave + 1);
+   }
+   return waves;
+}
+
+// Called in the main thread, the canvas is not changed meanwhile
+void RenderGrid::_initCellTile (int idx)
+{
+   RenderGridCell& cell = *_cells[idx];
+
+   cell.rc.initTileContext(_rc, cell.x, cell.y, cell.width, cell.height);
+}
+
+void RenderGrid::_rasterizeCell (int idx)
+{
+   RenderGridCell& cell = *_cells[idx];
+
+   cell.rc.init();
+   cell.rc.setTransform(cell.transform);
+   cell.factory.getItem(cell.obj).render();
+}
+
+void RenderGrid::_drawCell (int idx)
+{
+   RenderGridCell& cell = *_cells[idx];
+
+   _rc.drawTile(cell.rc);
+   cell.rc.closeContext(true);
+}
+
 int RenderGrid::_getDefaultWidth (const float s)
 {
    return (int)ceil(__max(__max(maxsz.x * s, maxTitleSize.x) * nColumns + _cnvOpt.gridMarginX * (nColumns - 1), commentSize.x) + outerMargin.x * 2);
@@ -216,3 +361,92 @@ float RenderGrid::_getScaleGivenSize(int w, int h)
       return x / totalScaleableSize.x;
    return y / totalScaleableSize.y;
 }
+
+//
+// RenderGridDispatcher
+//
+
+RenderGridDispatcher::RenderGridDispatcher (RenderGrid& grid, int task, int wave) :
+   OsCommandDispatcher(OsCommandDispatcher::HANDLING_ORDER_ANY, false),
+   _grid(grid), _task(task), _wave(wave)
+{
+   _next = 0;
+}
+
+OsCommand * RenderGridDispatcher::_allocateCommand ()
+{
+   return new RenderGridCommand(_grid, _task);
+}
+
+OsCommandResult * RenderGridDispatcher::_allocateResult ()
+{
+   return new RenderGridResult();
+}
+
+bool RenderGridDispatcher::_setupCommand (OsCommand& command)
+{
+   if (_task == RASTERIZE)
+      while (_next < _grid._cells.size() && _grid._cells[_next]->wave != _wave)
+         _next++;
+
+   if (_next >= _grid._cells.size())
+      return false;
+
+   RenderGridCommand& cmd = (RenderGridCommand&)command;
+
+   cmd.cell_idx = _next++;
+   if (_task == RASTERIZE)
+      _grid._initCellTile(cmd.cell_idx);
+   return true;
+}
+
+void RenderGridDispatcher::_handleResult (OsCommandResult& result)
+{
+   RenderGridResult& res = (RenderGridResult&)result;
+
+   // The tile is painted and released in the main thread
+   if (_task == RASTERIZE)
+      _grid._drawCell(res.cell_idx);
+}
+
+//
+// RenderGridCommand
+//
+
+RenderGridCommand::RenderGridCommand (RenderGrid& grid, int task) :
+   _grid(grid), _task(task)
+{
+   cell_idx = -1;
+}
+
+void RenderGridCommand::clear ()
+{
+   cell_idx = -1;
+   OsCommand::clear();
+}
+
+void RenderGridCommand::execute (OsCommandResult& result)
+{
+   RenderGridResult& res = (RenderGridResult&)result;
+
+   if (_task == RenderGridDispatcher::ESTIMATE)
+      _grid._estimateCell(cell_idx);
+   else
+      _grid._rasterizeCell(cell_idx);
+   res.cell_idx = cell_idx;
+}
+
+//
+// RenderGridResult
+//
+
+RenderGridResult::RenderGridResult ()
+{
+   cell_idx = -1;
+}
+
+void RenderGridResult::clear ()
+{
+   cell_idx = -1;
+   OsCommandResult::clear();
+}
@@ -182,6 +182,7 @@ void RenderOptions::clear()
    showCycles = false;
    agentsBelowArrow = true;
    collapseSuperatoms = false;
+   svgDirect = false;
    atomColorProp.clear();
 }
 
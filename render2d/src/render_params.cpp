@@ -22,6 +22,7 @@
 #include "layout/metalayout.h"
 #include "layout/reaction_layout.h"
 #include "layout/molecule_layout.h"
+#include "layout/molecule_layout_parallel.h"
 #include "molecule/molecule_arom.h"
 #include "molecule/molecule_dearom.h"
 #include "molecule/molecule_auto_loader.h"
@@ -43,6 +44,17 @@
 
 using namespace indigo;
 
+RenderTree::RenderTree () : obj(-1), comment(-1), estimated(false)
+{
+}
+
+RenderTree::~RenderTree ()
+{
+   // Items refer to the context, the context is removed after them
+   factory.reset(NULL);
+   rc.reset(NULL);
+}
+
 RenderParams::RenderParams ()
 {
    clear();
@@ -70,6 +82,8 @@ void RenderParams::clear ()
    rOpt.clear();
    cnvOpt.clear();
    clearArrays();
+   sourceKey.clear();
+   trees.clear();
 }
 
 IMPL_ERROR(RenderParamInterface, "render param interface");
@@ -148,6 +162,145 @@ void RenderParamInterface::_prepareReaction (RenderParams& params, BaseReaction&
    }
 }
 
+void RenderParamInterface::_prepareGrid (RenderParams& params)
+{
+   // Objects of the grid are laid out in the worker threads
+   Array<BaseMolecule *> mols;
+
+   for (int i = 0; i < params.mols.size(); ++i)
+      if (needsLayout(*params.mols[i]))
+         mols.push(params.mols[i]);
+   for (int i = 0; i < params.rxns.size(); ++i)
+   {
+      BaseReaction& rxn = *params.rxns[i];
+      for (int j = rxn.begin(); j < rxn.end(); j = rxn.next(j))
+         if (needsLayout(rxn.getBaseMolecule(j)))
+            mols.push(&rxn.getBaseMolecule(j));
+   }
+
+   MoleculeLayoutBatch batch;
+   // Same limit as the MoleculeLayout default
+   batch.max_iterations = 20;
+   batch.make(mols, params.cnvOpt.gridThreads);
+
+   for (int i = 0; i < mols.size(); ++i)
+   {
+      if (batch.errors[i].size() > 0)
+         throw Error("%s", batch.errors[i].ptr());
+
+      BaseMolecule& mol = *mols[i];
+      mol.clearBondDirections();
+      mol.stereocenters.markBonds();
+      mol.allene_stereo.markBonds();
+   }
+}
+
+void RenderParamInterface::_getTreeKey (RenderParams& params, Array<char>& key)
+{
+   // Options that change the items or their estimated sizes. Colors are
+   // taken at drawing time, and the size of the picture only scales it.
+   const RenderOptions& opt = params.rOpt;
+   const CanvasOptions& cnvOpt = params.cnvOpt;
+   ArrayOutput output(key);
+
+   output.printf("%s|%d %.9g %.9g %.9g", params.sourceKey.ptr(), opt.mode, params.relativeThickness,
+      params.bondLineWidthFactor, cnvOpt.bondLength);
+   output.printf("|%d %d %d %d %d %.9g", opt.labelMode, opt.highlightedLabelsVisible,
+      opt.boldBondDetection, opt.implHVisible, opt.highlightThicknessEnable,
+      opt.highlightThicknessFactor);
+   output.printf("|%d %d %d %d %d %d %d", opt.showBondIds, opt.showBondEndIds,
+      opt.atomBondIdsFromOne, opt.showNeighborArcs, opt.showAtomIds, opt.showValences,
+      opt.atomColoring);
+   output.printf("|%d %d %d %d %d %d", opt.stereoMode, opt.showReactingCenterUnchanged,
+      opt.centerDoubleBondWhenStereoAdjacent, opt.showCycles, opt.agentsBelowArrow,
+      opt.collapseSuperatoms);
+   output.printf("|%.9g %.9g %d|", opt.commentFontFactor, opt.commentSpacing,
+      cnvOpt.commentAlign.inbox_alignment);
+   output.writeArray(cnvOpt.comment);
+   // Data S-groups with this name are turned into the atom colors
+   output.writeChar('|');
+   output.writeArray(opt.atomColorProp);
+   output.writeChar(0);
+}
+
+RenderTree* RenderParamInterface::_findTree (RenderParams& params, const Array<char>& key)
+{
+   for (int i = 0; i < params.trees.size(); ++i)
+      if (strcmp(params.trees[i]->key.ptr(), key.ptr()) == 0)
+         return params.trees[i];
+   return NULL;
+}
+
+bool RenderParamInterface::hasTree (RenderParams& params)
+{
+   QS_DEF(Array<char>, key);
+
+   if (params.sourceKey.size() == 0)
+      return false;
+   _getTreeKey(params, key);
+   return _findTree(params, key) != NULL;
+}
+
+void RenderParamInterface::_renderTree (RenderParams& params)
+{
+   QS_DEF(Array<char>, key);
+   bool bondLengthSet = params.cnvOpt.bondLength > 0;
+   int bondLength = (int)(bondLengthSet ? params.cnvOpt.bondLength : 100);
+
+   _getTreeKey(params, key);
+
+   RenderTree* tree = _findTree(params, key);
+
+   if (tree == NULL) {
+      if (params.mol.get() == NULL)
+         throw Error("No object to render specified");
+
+      AutoPtr<RenderTree> new_tree(new RenderTree());
+
+      new_tree->key.copy(key);
+      new_tree->mol.reset(params.mol.release());
+      _prepareMolecule(params, new_tree->mol.ref());
+
+      new_tree->rc.reset(new RenderContext(params.rOpt, params.relativeThickness, params.bondLineWidthFactor));
+      new_tree->rc->setDefaultScale((float)bondLength);
+      new_tree->factory.reset(new RenderItemFactory(new_tree->rc.ref()));
+      new_tree->obj = new_tree->factory->addItemMolecule();
+      new_tree->factory->getItemMolecule(new_tree->obj).mol = new_tree->mol.get();
+
+      if (params.cnvOpt.comment.size() > 0) {
+         new_tree->comment = multilineTextUnit(new_tree->factory.ref(), RenderItemAuxiliary::AUX_COMMENT,
+            params.cnvOpt.comment, params.rOpt.commentSpacing * params.rOpt.commentFontFactor,
+            params.cnvOpt.commentAlign.inbox_alignment);
+      }
+
+      // The oldest tree is dropped
+      if (params.trees.size() >= RenderParams::MAX_TREES)
+         params.trees.remove(0);
+      tree = &params.trees.add(new_tree.release());
+   }
+
+   RenderSingle render(tree->rc.ref(), tree->factory.ref(), params.cnvOpt, bondLength, bondLengthSet);
+   render.obj = tree->obj;
+   render.comment = tree->comment;
+   render.estimated = tree->estimated;
+
+   try {
+      render.draw();
+      tree->rc->closeContext(false);
+   } catch (...) {
+      // The tree may be left half-estimated, so it is not kept
+      tree->rc->closeContext(true);
+      for (int i = 0; i < params.trees.size(); ++i) {
+         if (params.trees[i] == tree) {
+            params.trees.remove(i);
+            break;
+         }
+      }
+      throw;
+   }
+   tree->estimated = true;
+}
+
 int RenderParamInterface::multilineTextUnit (RenderItemFactory& factory, int type, const Array<char>& titleStr, const float spacing, const MultilineTextLayout::Alignment alignment)
 {
    int title = factory.addItemColumn();
@@ -183,6 +336,12 @@ void RenderParamInterface::render (RenderParams& params)
    if (params.rmode == RENDER_NONE)
       throw Error("No object to render specified");
 
+   if (params.rmode == RENDER_MOL && params.mols.size() == 0 &&
+       params.sourceKey.size() > 0 && params.rOpt.mode != MODE_CDXML) {
+      _renderTree(params);
+      return;
+   }
+
    RenderContext rc(params.rOpt, params.relativeThickness, params.bondLineWidthFactor);
 
    bool bondLengthSet = params.cnvOpt.bondLength > 0;
@@ -193,6 +352,7 @@ void RenderParamInterface::render (RenderParams& params)
    int obj = -1;
    Array<int> objs;
    Array<int> titles;
+   bool parallelGrid = params.cnvOpt.gridThreads != 1;
    if (params.rmode == RENDER_MOL) {
       if (params.mols.size() == 0) {
          obj = factory.addItemMolecule();
@@ -203,7 +363,8 @@ void RenderParamInterface::render (RenderParams& params)
          for (int i = 0; i < params.mols.size(); ++i) {
             int mol = factory.addItemMolecule();
             BaseMolecule& bm = *params.mols[i];
-            _prepareMolecule(params, bm);
+            if (!parallelGrid)
+               _prepareMolecule(params, bm);
             factory.getItemMolecule(mol).mol = &bm;
             objs.push(mol);
 
@@ -225,7 +386,8 @@ void RenderParamInterface::render (RenderParams& params)
          for (int i = 0; i < params.rxns.size(); ++i) {
             int rxn = factory.addItemReaction();
             BaseReaction& br = *params.rxns[i];
-            _prepareReaction(params, br);
+            if (!parallelGrid)
+               _prepareReaction(params, br);
             factory.getItemReaction(rxn).rxn = &br;
             objs.push(rxn);
 
@@ -240,6 +402,9 @@ void RenderParamInterface::render (RenderParams& params)
       throw Error("Invalid rendering mode: %i", params.rmode);
    }
 
+   if (obj < 0 && parallelGrid)
+      _prepareGrid(params);
+
    int comment = -1;
    if (params.cnvOpt.comment.size() > 0) {
       comment = multilineTextUnit(factory, RenderItemAuxiliary::AUX_COMMENT,
@@ -266,6 +431,8 @@ void RenderParamInterface::render (RenderParams& params)
       render.comment = comment;
       render.titles.copy(titles);
       render.refAtoms.copy(params.refAtoms);
+      render.relativeThickness = params.relativeThickness;
+      render.bondLineWidthFactor = params.bondLineWidthFactor;
       render.draw();
    }
    rc.closeContext(false);
@@ -31,7 +31,8 @@ using namespace indigo;
 
 IMPL_ERROR(RenderSingle, "RenderSingle");
 
-RenderSingle::RenderSingle (RenderContext& rc, RenderItemFactory& factory, const CanvasOptions& cnvOpt, int bondLength, bool bondLengthSet) : Render(rc, factory, cnvOpt, bondLength, bondLengthSet)
+RenderSingle::RenderSingle (RenderContext& rc, RenderItemFactory& factory, const CanvasOptions& cnvOpt, int bondLength, bool bondLengthSet) : Render(rc, factory, cnvOpt, bondLength, bondLengthSet),
+   obj(-1), comment(-1), estimated(false)
 {}
 
 RenderSingle::~RenderSingle()
@@ -71,18 +72,22 @@ void RenderSingle::draw ()
    height = _cnvOpt.height;
    _rc.fontsClear();
 
-   _factory.getItem(obj).init();
+   if (!estimated) {
+      _factory.getItem(obj).init();
 
-   float objScale = _getObjScale(obj);
-   _factory.getItem(obj).setObjScale(objScale);
-   _factory.getItem(obj).estimateSize();
+      float objScale = _getObjScale(obj);
+      _factory.getItem(obj).setObjScale(objScale);
+      _factory.getItem(obj).estimateSize();
+   }
    objSize.copy(_factory.getItem(obj).size);
 
    commentSize.set(0,0);
    commentOffset = 0;
    if (comment >= 0) {
-      _factory.getItem(comment).init();
-      _factory.getItem(comment).estimateSize();
+      if (!estimated) {
+         _factory.getItem(comment).init();
+         _factory.getItem(comment).estimateSize();
+      }
       commentSize.copy(_factory.getItem(comment).size);
       commentOffset = _cnvOpt.commentOffset;
    }
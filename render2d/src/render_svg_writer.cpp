@@ -0,0 +1,512 @@
+/****************************************************************************
+ * Copyright (C) 2009-2013 GGA Software Services LLC
+ *
+ * This file is part of Indigo toolkit.
+ *
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/
+
+#include <math.h>
+
+#include "base_cpp/output.h"
+#include "base_cpp/tlscont.h"
+#include "render_svg_writer.h"
+
+using namespace indigo;
+
+static int _round (double value)
+{
+   return (int)floor(value * 100 + 0.5);
+}
+
+RenderSvgWriter::RenderSvgWriter ()
+{
+   _width = 0;
+   _height = 0;
+}
+
+void RenderSvgWriter::begin (int width, int height, const char *font_family)
+{
+   _width = width;
+   _height = height;
+   _font_family.readString(font_family, true);
+   _markup.clear();
+   _defs.clear();
+   _shapes.clear();
+   _shape_offsets.clear();
+   _shape_uses.clear();
+   _elements.clear();
+   _shape_map.clear();
+   _gradient_map.clear();
+}
+
+void RenderSvgWriter::fill (cairo_t *cr)
+{
+   QS_DEF(Array<char>, paint);
+   QS_DEF(Array<char>, attrs);
+   bool shared;
+
+   _getSource(cr, paint, shared);
+
+   ArrayOutput output(attrs);
+
+   output.writeString(" fill=\"");
+   output.writeArray(paint);
+   output.writeChar('"');
+   _addPath(cr, attrs, shared);
+}
+
+void RenderSvgWriter::stroke (cairo_t *cr)
+{
+   QS_DEF(Array<char>, paint);
+   QS_DEF(Array<char>, attrs);
+   QS_DEF(Array<double>, dashes);
+   bool shared;
+
+   _getSource(cr, paint, shared);
+
+   cairo_matrix_t m;
+
+   cairo_get_matrix(cr, &m);
+
+   double scale = sqrt(fabs(m.xx * m.yy - m.xy * m.yx));
+   ArrayOutput output(attrs);
+
+   output.writeString(" fill=\"none\" stroke=\"");
+   output.writeArray(paint);
+   output.writeString("\" stroke-width=\"");
+   _writeValue(attrs, cairo_get_line_width(cr) * scale);
+   output.writeChar('"');
+
+   cairo_line_join_t join = cairo_get_line_join(cr);
+
+   if (join == CAIRO_LINE_JOIN_BEVEL)
+      output.writeString(" stroke-linejoin=\"bevel\"");
+   else if (join == CAIRO_LINE_JOIN_ROUND)
+      output.writeString(" stroke-linejoin=\"round\"");
+
+   cairo_line_cap_t cap = cairo_get_line_cap(cr);
+
+   if (cap == CAIRO_LINE_CAP_ROUND)
+      output.writeString(" stroke-linecap=\"round\"");
+   else if (cap == CAIRO_LINE_CAP_SQUARE)
+      output.writeString(" stroke-linecap=\"square\"");
+
+   int n_dashes = cairo_get_dash_count(cr);
+
+   if (n_dashes > 0)
+   {
+      double offset;
+
+      dashes.clear_resize(n_dashes);
+      cairo_get_dash(cr, dashes.ptr(), &offset);
+
+      output.writeString(" stroke-dasharray=\"");
+      for (int i = 0; i < n_dashes; i++)
+      {
+         if (i > 0)
+            output.writeChar(',');
+         _writeValue(attrs, dashes[i] * scale);
+      }
+      output.writeChar('"');
+
+      if (_round(offset * scale) != 0)
+      {
+         output.writeString(" stroke-dashoffset=\"");
+         _writeValue(attrs, offset * scale);
+         output.writeChar('"');
+      }
+   }
+
+   _addPath(cr, attrs, shared);
+}
+
+void RenderSvgWriter::paint (cairo_t *cr)
+{
+   QS_DEF(Array<char>, paint);
+   QS_DEF(Array<char>, markup);
+   bool shared;
+
+   _getSource(cr, paint, shared);
+
+   ArrayOutput output(markup);
+
+   output.printf("<rect width=\"%d\" height=\"%d\" fill=\"", _width, _height);
+   output.writeArray(paint);
+   output.writeString("\"/>");
+   _addMarkup(markup);
+}
+
+void RenderSvgWriter::showText (cairo_t *cr, const char *font_family, bool bold, const char *text)
+{
+   QS_DEF(Array<char>, paint);
+   QS_DEF(Array<char>, markup);
+   bool shared;
+
+   _getSource(cr, paint, shared);
+
+   double x, y;
+   cairo_matrix_t m, fm;
+
+   cairo_get_current_point(cr, &x, &y);
+   cairo_user_to_device(cr, &x, &y);
+   cairo_get_matrix(cr, &m);
+   cairo_get_font_matrix(cr, &fm);
+
+   ArrayOutput output(markup);
+
+   output.writeString("<text x=\"");
+   _writeCoord(markup, _round(x), true);
+   output.writeString("\" y=\"");
+   _writeCoord(markup, _round(y), true);
+   output.writeString("\" font-size=\"");
+   _writeValue(markup, fm.yy * sqrt(fabs(m.xx * m.yy - m.xy * m.yx)));
+   output.writeChar('"');
+   if (strcmp(font_family, _font_family.ptr()) != 0)
+   {
+      output.writeString(" font-family=\"");
+      _writeText(markup, font_family);
+      output.writeChar('"');
+   }
+   if (bold)
+      output.writeString(" font-weight=\"bold\"");
+   output.writeString(" fill=\"");
+   output.writeArray(paint);
+   output.writeString("\">");
+   _writeText(markup, text);
+   output.writeString("</text>");
+   _addMarkup(markup);
+}
+
+void RenderSvgWriter::end (Output &output)
+{
+   QS_DEF(Array<int>, ids);
+   int i, n_shared = 0;
+
+   ids.clear_resize(_shape_uses.size());
+   for (i = 0; i < _shape_uses.size(); i++)
+      ids[i] = _shape_uses[i] > 1 ? n_shared++ : -1;
+
+   output.printf("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+   output.printf("<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" "
+                 "width=\"%dpt\" height=\"%dpt\" viewBox=\"0 0 %d %d\" version=\"1.1\">\n",
+                 _width, _height, _width, _height);
+
+   if (n_shared > 0 || _defs.size() > 0)
+   {
+      output.printf("<defs>\n");
+      output.writeArray(_defs);
+      for (i = 0; i < _shape_uses.size(); i++)
+         if (ids[i] >= 0)
+            output.printf("<path id=\"s%d\" d=\"M0 0%s\"/>\n", ids[i], _shapes.ptr() + _shape_offsets[i]);
+      output.printf("</defs>\n");
+   }
+
+   QS_DEF(Array<char>, pos);
+
+   pos.clear();
+   _writeText(pos, _font_family.ptr());
+   output.writeString("<g font-family=\"");
+   output.writeArray(pos);
+   output.writeString("\" stroke-miterlimit=\"10\">\n");
+
+   for (i = 0; i < _elements.size(); i++)
+   {
+      const _Element &element = _elements[i];
+      const char *markup = _markup.ptr() + element.markup;
+
+      if (element.shape < 0)
+      {
+         output.printf("%s\n", markup);
+         continue;
+      }
+
+      pos.clear();
+      _writeCoord(pos, element.x, true);
+      pos.push('"');
+
+      if (ids[element.shape] >= 0)
+      {
+         output.printf("<use xlink:href=\"#s%d\" x=\"", ids[element.shape]);
+         output.writeArray(pos);
+         output.writeString(" y=\"");
+      }
+      else
+      {
+         output.writeString("<path d=\"M");
+         pos.pop();
+         output.writeArray(pos);
+         output.writeChar(' ');
+      }
+
+      pos.clear();
+      _writeCoord(pos, element.y, true);
+      output.writeArray(pos);
+
+      if (ids[element.shape] >= 0)
+         output.printf("\"%s/>\n", markup);
+      else
+         output.printf("%s\"%s/>\n", _shapes.ptr() + _shape_offsets[element.shape], markup);
+   }
+
+   output.printf("</g>\n</svg>\n");
+}
+
+void RenderSvgWriter::_addPath (cairo_t *cr, const Array<char> &attrs, bool shared)
+{
+   QS_DEF(Array<char>, shape);
+   cairo_matrix_t m;
+
+   // The path in the device space
+   cairo_get_matrix(cr, &m);
+   cairo_identity_matrix(cr);
+   cairo_path_t *path = cairo_copy_path(cr);
+   cairo_set_matrix(cr, &m);
+   cairo_new_path(cr);
+
+   // Segments are written relative to the first point, so the same
+   // shape at another position gives the same string
+   int x0 = 0, y0 = 0, x = 0, y = 0, start_x = 0, start_y = 0;
+   bool started = false;
+
+   shape.clear();
+   for (int i = 0; i < path->num_data; i += path->data[i].header.length)
+   {
+      const cairo_path_data_t *data = path->data + i;
+      cairo_path_data_type_t type = data->header.type;
+
+      if (type == CAIRO_PATH_CLOSE_PATH)
+      {
+         shape.push('z');
+         x = start_x;
+         y = start_y;
+         continue;
+      }
+
+      if (type == CAIRO_PATH_MOVE_TO)
+      {
+         int next = i + data->header.length;
+
+         // Moves that are not followed by a segment draw nothing
+         if (next >= path->num_data || path->data[next].header.type == CAIRO_PATH_MOVE_TO)
+            continue;
+
+         if (!started)
+         {
+            x0 = x = start_x = _round(data[1].point.x);
+            y0 = y = start_y = _round(data[1].point.y);
+            started = true;
+            continue;
+         }
+      }
+
+      int n_points = type == CAIRO_PATH_CURVE_TO ? 3 : 1;
+      int px = x, py = y;
+
+      shape.push(type == CAIRO_PATH_MOVE_TO ? 'm' : (type == CAIRO_PATH_LINE_TO ? 'l' : 'c'));
+      for (int j = 1; j <= n_points; j++)
+      {
+         x = _round(data[j].point.x);
+         y = _round(data[j].point.y);
+         _writeCoord(shape, x - px, j == 1);
+         _writeCoord(shape, y - py, false);
+      }
+
+      if (type == CAIRO_PATH_MOVE_TO)
+      {
+         start_x = x;
+         start_y = y;
+      }
+   }
+
+   cairo_path_destroy(path);
+
+   if (!started)
+      return;
+
+   shape.push(0);
+
+   int *found = shared ? _shape_map.at2(shape.ptr()) : 0;
+   int idx;
+
+   if (found != 0)
+      idx = *found;
+   else
+   {
+      idx = _shape_offsets.size();
+      if (shared)
+         _shape_map.insert(shape.ptr(), idx);
+      _shape_offsets.push(_shapes.size());
+      _shape_uses.push(0);
+      _shapes.concat(shape);
+   }
+
+   _shape_uses[idx]++;
+
+   _Element &element = _elements.push();
+
+   element.shape = idx;
+   element.x = x0;
+   element.y = y0;
+   element.markup = _markup.size();
+   _markup.concat(attrs);
+   _markup.push(0);
+}
+
+void RenderSvgWriter::_addMarkup (const Array<char> &markup)
+{
+   _Element &element = _elements.push();
+
+   element.shape = -1;
+   element.x = element.y = 0;
+   element.markup = _markup.size();
+   _markup.concat(markup);
+   _markup.push(0);
+}
+
+void RenderSvgWriter::_getSource (cairo_t *cr, Array<char> &paint, bool &shared)
+{
+   cairo_pattern_t *source = cairo_get_source(cr);
+
+   paint.clear();
+   shared = true;
+
+   if (cairo_pattern_get_type(source) == CAIRO_PATTERN_TYPE_LINEAR)
+   {
+      // The gradient is in the device space, so the shape is not moved
+      // with <use>
+      double x1, y1, x2, y2;
+      cairo_matrix_t pm;
+
+      cairo_pattern_get_linear_points(source, &x1, &y1, &x2, &y2);
+      cairo_pattern_get_matrix(source, &pm);
+      cairo_matrix_invert(&pm);
+      cairo_matrix_transform_point(&pm, &x1, &y1);
+      cairo_matrix_transform_point(&pm, &x2, &y2);
+      cairo_user_to_device(cr, &x1, &y1);
+      cairo_user_to_device(cr, &x2, &y2);
+
+      QS_DEF(Array<char>, gradient);
+      ArrayOutput output(gradient);
+
+      output.writeString(" gradientUnits=\"userSpaceOnUse\" x1=\"");
+      _writeCoord(gradient, _round(x1), true);
+      output.writeString("\" y1=\"");
+      _writeCoord(gradient, _round(y1), true);
+      output.writeString("\" x2=\"");
+      _writeCoord(gradient, _round(x2), true);
+      output.writeString("\" y2=\"");
+      _writeCoord(gradient, _round(y2), true);
+      output.writeString("\">\n");
+
+      int n_stops;
+
+      cairo_pattern_get_color_stop_count(source, &n_stops);
+      for (int i = 0; i < n_stops; i++)
+      {
+         double offset, r, g, b, a;
+
+         cairo_pattern_get_color_stop_rgba(source, i, &offset, &r, &g, &b, &a);
+         output.writeString("<stop offset=\"");
+         _writeValue(gradient, offset);
+         output.writeString("\" stop-color=\"");
+         _writeColor(gradient, r, g, b);
+         output.writeString("\"/>\n");
+      }
+      output.writeChar(0);
+
+      // Both lines of a double bond have the same gradient
+      int *found = _gradient_map.at2(gradient.ptr());
+      int id;
+
+      if (found != 0)
+         id = *found;
+      else
+      {
+         id = _gradient_map.size();
+         _gradient_map.insert(gradient.ptr(), id);
+
+         char buf[32];
+         int len = snprintf(buf, sizeof(buf), "<linearGradient id=\"g%d\"", id);
+
+         _defs.concat(buf, len);
+         _defs.concat(gradient.ptr(), gradient.size() - 1);
+         _defs.concat("</linearGradient>\n", 18);
+      }
+
+      ArrayOutput paint_output(paint);
+
+      paint_output.printf("url(#g%d)", id);
+      shared = false;
+      return;
+   }
+
+   double r = 0, g = 0, b = 0, a = 1;
+
+   cairo_pattern_get_rgba(source, &r, &g, &b, &a);
+   _writeColor(paint, r, g, b);
+}
+
+void RenderSvgWriter::_writeValue (Array<char> &buf, double value)
+{
+   _writeCoord(buf, _round(value), true);
+}
+
+// Number in 0.01 units with the trailing zeros omitted. Non-negative
+// numbers are separated from the previous one with a space.
+void RenderSvgWriter::_writeCoord (Array<char> &buf, int value, bool first)
+{
+   char str[32];
+   int len;
+
+   if (value < 0)
+   {
+      buf.push('-');
+      value = -value;
+   }
+   else if (!first)
+      buf.push(' ');
+
+   int frac = value % 100;
+
+   if (frac == 0)
+      len = snprintf(str, sizeof(str), "%d", value / 100);
+   else if (frac % 10 == 0)
+      len = snprintf(str, sizeof(str), "%d.%d", value / 100, frac / 10);
+   else
+      len = snprintf(str, sizeof(str), "%d.%02d", value / 100, frac);
+
+   buf.concat(str, len);
+}
+
+void RenderSvgWriter::_writeColor (Array<char> &buf, double r, double g, double b)
+{
+   char str[8];
+
+   snprintf(str, sizeof(str), "#%02x%02x%02x", (int)floor(r * 255 + 0.5),
+            (int)floor(g * 255 + 0.5), (int)floor(b * 255 + 0.5));
+   buf.concat(str, 7);
+}
+
+void RenderSvgWriter::_writeText (Array<char> &buf, const char *text)
+{
+   for (; *text != 0; text++)
+   {
+      if (*text == '&')
+         buf.concat("&amp;", 5);
+      else if (*text == '<')
+         buf.concat("&lt;", 4);
+      else if (*text == '>')
+         buf.concat("&gt;", 4);
+      else if (*text == '"')
+         buf.concat("&quot;", 6);
+      else
+         buf.push(*text);
+   }
+}
@@ -340,8 +340,8 @@ int INChITo_Atom(INCHI_IOSTREAM *inp_molfile, MOL_COORD **szCoord,
     /* plain tags */
     static const char sStructHdrPln[]         = "Structure:";
     static const char sStructHdrPlnNoLblVal[] = " is missing";
-    static char sStructHdrPlnAuxStart[64] =""; /*"$1.1Beta/";*/
-    static int  lenStructHdrPlnAuxStart = 0;
+    static INCHI_TLS char sStructHdrPlnAuxStart[64] =""; /*"$1.1Beta/";*/
+    static INCHI_TLS int  lenStructHdrPlnAuxStart = 0;
     static const char sStructHdrPlnRevAt[]    = "/rA:";
     static const char sStructHdrPlnRevBn[]    = "/rB:";
     static const char sStructHdrPlnRevXYZ[]   = "/rC:";
@@ -1633,9 +1633,9 @@ static void remove_alt_bond_marks(inp_ATOM *at, int num_atoms)
 /***************************************************************************************/
 int SetForbiddenEdges( BN_STRUCT *pBNS, inp_ATOM *at, int num_atoms, int forbidden_mask )
 {
-    static U_CHAR el_number_O;
-    static U_CHAR el_number_C;
-    static U_CHAR el_number_N;
+    static INCHI_TLS U_CHAR el_number_O;
+    static INCHI_TLS U_CHAR el_number_C;
+    static INCHI_TLS U_CHAR el_number_N;
 
     int i, j, neigh, num_found;
     BNS_IEDGE iedge;
@@ -1718,7 +1718,7 @@ int SetForbiddenEdges( BN_STRUCT *pBNS, inp_ATOM *at, int num_atoms, int forbidd
 /************************************************************************/
 int TempFix_NH_NH_Bonds( BN_STRUCT *pBNS, inp_ATOM *at, int num_atoms )
 {
-    static U_CHAR el_number_N;
+    static INCHI_TLS U_CHAR el_number_N;
     int i, j, neigh, num_found;
     BNS_IEDGE iedge;
     S_CHAR    edge_forbidden_mask = BNS_EDGE_FORBIDDEN_TEMP;
@@ -1753,7 +1753,7 @@ int TempFix_NH_NH_Bonds( BN_STRUCT *pBNS, inp_ATOM *at, int num_atoms )
 /************************************************************************/
 int CorrectFixing_NH_NH_Bonds( BN_STRUCT *pBNS, inp_ATOM *at, int num_atoms )
 {
-    static U_CHAR el_number_N;
+    static INCHI_TLS U_CHAR el_number_N;
     int i, j, neigh, num_found;
     BNS_IEDGE iedge;
     S_CHAR    edge_forbidden_mask = BNS_EDGE_FORBIDDEN_TEMP;
@@ -1798,8 +1798,8 @@ int fix_special_bonds( BN_STRUCT *pBNS, inp_ATOM *at, int num_atoms, int forbidd
 #else
     static const char    el[] = "N;P;As;Sb;O;S;Se;Te;C;Si";   /* 8 elements + C, Si */
 #endif
-    static char    en[12];         /* same number: 8 elements */
-    static int     ne=0;           /* will be 8 and 10 */
+    static INCHI_TLS char    en[12];         /* same number: 8 elements */
+    static INCHI_TLS int     ne=0;           /* will be 8 and 10 */
 
 #define ELEM_N_FST  0
 #define ELEM_N_LEN  4
@@ -2294,7 +2294,7 @@ int is_Z_atom( U_CHAR el_number )
 #endif
         el_len
     } Z_ELNUMBER;
-    static U_CHAR el_numb[el_len];
+    static INCHI_TLS U_CHAR el_numb[el_len];
 /*
     return is_el_a_metal( (int)el_number );
 */
@@ -2331,10 +2331,10 @@ int is_Z_atom( U_CHAR el_number )
 /***************************************************************************************/
 int IsZOX( inp_ATOM *atom, int at_x, int ord )
 {  /* detect O==Z--X, O=O,S,Se,Te */
-    static U_CHAR el_number_O  = 0;
-    static U_CHAR el_number_S  = 0;
-    static U_CHAR el_number_Se = 0;
-    static U_CHAR el_number_Te = 0;
+    static INCHI_TLS U_CHAR el_number_O  = 0;
+    static INCHI_TLS U_CHAR el_number_S  = 0;
+    static INCHI_TLS U_CHAR el_number_Se = 0;
+    static INCHI_TLS U_CHAR el_number_Te = 0;
     inp_ATOM *at_Z = atom + atom[at_x].neighbor[ord];
 
     int i, neigh, num_O;
@@ -2369,19 +2369,19 @@ int IsZOX( inp_ATOM *atom, int at_x, int ord )
 /***************************************************************************************/
 int GetAtomChargeType( inp_ATOM *atom, int at_no, int nAtTypeTotals[], int *pMask, int bSubtract  )
 {
-    static U_CHAR el_number_C  = 0;
-    static U_CHAR el_number_O  = 0;
-    static U_CHAR el_number_S  = 0;
-    static U_CHAR el_number_Se = 0;
-    static U_CHAR el_number_Te = 0;
-    static U_CHAR el_number_P  = 0;
-    static U_CHAR el_number_N  = 0;
-    static U_CHAR el_number_H  = 0;
-
-    static U_CHAR el_number_F  = 0;
-    static U_CHAR el_number_Cl = 0;
-    static U_CHAR el_number_Br = 0;
-    static U_CHAR el_number_I  = 0;
+    static INCHI_TLS U_CHAR el_number_C  = 0;
+    static INCHI_TLS U_CHAR el_number_O  = 0;
+    static INCHI_TLS U_CHAR el_number_S  = 0;
+    static INCHI_TLS U_CHAR el_number_Se = 0;
+    static INCHI_TLS U_CHAR el_number_Te = 0;
+    static INCHI_TLS U_CHAR el_number_P  = 0;
+    static INCHI_TLS U_CHAR el_number_N  = 0;
+    static INCHI_TLS U_CHAR el_number_H  = 0;
+
+    static INCHI_TLS U_CHAR el_number_F  = 0;
+    static INCHI_TLS U_CHAR el_number_Cl = 0;
+    static INCHI_TLS U_CHAR el_number_Br = 0;
+    static INCHI_TLS U_CHAR el_number_I  = 0;
     
     inp_ATOM *at = atom + at_no;
 #if ( FIX_NORM_BUG_ADD_ION_PAIR == 1 )
@@ -9181,7 +9181,7 @@ int FindPathCap( BN_STRUCT* pBNS, Edge *SwitchEdge, Vertex x, Vertex y, int delt
   */
     Vertex w, z, iwz;
     int    cap, delta2;
-    static int level;
+    static INCHI_TLS int level;
 
     if ( level ++ > 50 ) {
 #ifdef _DEBUG
@@ -10008,7 +10008,7 @@ int AddRemoveIsoProtonsRestr( inp_ATOM *at, int num_atoms, NUM_H num_protons_to_
     int   nNumSuccess = 0, min_at, max_at, num_H, num_iso_H, num_expl_H, num_expl_iso_H;
     int   iCurIso; /* 0=> 1H, 1=> D, 2=> T */
     int   iCurMode, iCurMode1, iCurMode2; /* 0=> Not Endpoints, 1=> Endpoints */
-    static U_CHAR el_number_H = 0;
+    static INCHI_TLS U_CHAR el_number_H = 0;
 
     /* distribute isotopes from  heaviest to lightest; pick up atoms in order 1. Not endpoints; 2. Endpoints */
     iCurMode1 = 0;
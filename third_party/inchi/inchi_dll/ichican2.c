@@ -88,13 +88,13 @@ typedef U_SHORT  bitWord;
 #define BIT_WORD_MASK  ((bitWord)~0)
 */
 
-static bitWord *bBit = NULL;
-static int    num_bit = 0;     
+static INCHI_TLS bitWord *bBit = NULL;
+static INCHI_TLS int    num_bit = 0;     
 /*bitWord      mark_bit; */    /* highest bit in AT_NUMB */
 /*bitWord      mask_bit; */    /* ~mark_bit */
 
-AT_NUMB       rank_mark_bit;
-AT_NUMB       rank_mask_bit;
+INCHI_TLS AT_NUMB       rank_mark_bit;
+INCHI_TLS AT_NUMB       rank_mask_bit;
 
 
 typedef AT_NUMB    Node;
@@ -1252,7 +1252,7 @@ void CtPartFill( Graph *G, CANON_DATA *pCD, Partition *p,
 #ifdef INCHI_CANON_USE_HASH
     CtHash  hash = 0;
 #endif
-        static int count; /* for debug only */
+        static INCHI_TLS int count; /* for debug only */
         count ++;
 
 
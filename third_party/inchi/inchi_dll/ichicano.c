@@ -63,14 +63,14 @@
  *   Globals for sorting
  */
 
-const NEIGH_LIST      *pNeighList_RankForSort; 
-const ATOM_INVARIANT2 *pAtomInvariant2ForSort;
-const AT_NUMB         *pNeighborsForSort;
-const AT_RANK         *pn_RankForSort;
+INCHI_TLS const NEIGH_LIST      *pNeighList_RankForSort; 
+INCHI_TLS const ATOM_INVARIANT2 *pAtomInvariant2ForSort;
+INCHI_TLS const AT_NUMB         *pNeighborsForSort;
+INCHI_TLS const AT_RANK         *pn_RankForSort;
 
-AT_RANK nMaxAtNeighRankForSort;
+INCHI_TLS AT_RANK nMaxAtNeighRankForSort;
 
-int nNumCompNeighborsRanksCountEql;
+INCHI_TLS int nNumCompNeighborsRanksCountEql;
 
 
 #define tsort insertions_sort
@@ -115,10 +115,10 @@ static clock_t InchiClock(void)
 #define INCHI_CLOCK_T(X) (clock_t)( (double)(X) / 1000.0 * (double)CLOCKS_PER_SEC )
 const clock_t FullMaxClock = (clock_t)(-1);
 const clock_t HalfMaxClock = (clock_t)(-1) / 2;
-clock_t MaxPositiveClock = 0;
-clock_t MinNegativeClock = 0;
-clock_t HalfMaxPositiveClock = 0;
-clock_t HalfMinNegativeClock = 0;
+INCHI_TLS clock_t MaxPositiveClock = 0;
+INCHI_TLS clock_t MinNegativeClock = 0;
+INCHI_TLS clock_t HalfMaxPositiveClock = 0;
+INCHI_TLS clock_t HalfMinNegativeClock = 0;
 
 static void FillMaxMinClock(void); /* keep compiler happy */
 
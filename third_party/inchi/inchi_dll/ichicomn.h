@@ -49,14 +49,14 @@
  * Globals for sorting
  */
 
-extern const NEIGH_LIST      *pNeighList_RankForSort; 
-extern const ATOM_INVARIANT2 *pAtomInvariant2ForSort;
-extern const AT_NUMB         *pNeighborsForSort;
-extern const AT_RANK         *pn_RankForSort;
+extern INCHI_TLS const NEIGH_LIST      *pNeighList_RankForSort; 
+extern INCHI_TLS const ATOM_INVARIANT2 *pAtomInvariant2ForSort;
+extern INCHI_TLS const AT_NUMB         *pNeighborsForSort;
+extern INCHI_TLS const AT_RANK         *pn_RankForSort;
 
-extern AT_RANK         nMaxAtNeighRankForSort;
+extern INCHI_TLS AT_RANK         nMaxAtNeighRankForSort;
 
-extern int             nNumCompNeighborsRanksCountEql;
+extern INCHI_TLS int             nNumCompNeighborsRanksCountEql;
 
 
 #define tsort insertions_sort
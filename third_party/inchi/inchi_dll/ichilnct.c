@@ -69,7 +69,7 @@ int INChIToInchi_Input( INCHI_IOSTREAM *inp_molfile, inchi_Input *orig_at_data,
 /* This contains executable code. Included in lReadAux.c, e_ReadINCH.c, ReadINCH.c,  */
 #include "aux2atom.h"
 
-extern int bLibInchiSemaphore;
+extern INCHI_TLS int bLibInchiSemaphore;
 
 
 
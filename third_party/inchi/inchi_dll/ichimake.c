@@ -1560,9 +1560,9 @@ void mystrrev( char *p )
 /*                Find DFS order for CT(canon. numbers and Hs) output                    */
 /*****************************************************************************************/
 
-static AT_NUMB   *gDfs4CT_nDfsNumber;
-static AT_NUMB   *gDfs4CT_nNumDescendants;
-static int        gDfs4CT_nCurrentAtom;
+static INCHI_TLS AT_NUMB   *gDfs4CT_nDfsNumber;
+static INCHI_TLS AT_NUMB   *gDfs4CT_nNumDescendants;
+static INCHI_TLS int        gDfs4CT_nCurrentAtom;
 
 /**********************************************************************************************/
 static int CompareDfsDescendants4CT( const void *a1, const void *a2 )
@@ -4692,7 +4692,7 @@ int CheckCanonNumberingCorrectness(int num_atoms, int num_at_tg,
     AT_NUMB *pCanonRank; /* canonical ranks of the atoms or tautomeric groups */
     AT_NUMB *pCanonRankAtoms=NULL;
     
-    static int count=0; /* for debug only */
+    static INCHI_TLS int count=0; /* for debug only */
     count ++;
 
     pCanonRankAtoms = (AT_NUMB *)inchi_calloc( num_at_tg+1, sizeof(pCanonRankAtoms[0]) );
@@ -91,7 +91,7 @@ int WriteOrigBonds(int num_inp_atoms, inp_ATOM *at, int *i,
 void GetSaveOptLetters(unsigned char save_opt_bits, char* let1, char* let2);
 
 
-char VER_STRING[64];
+INCHI_TLS char VER_STRING[64];
 
 const char sCompDelim[]       = ";"; /* component delimiter */
 const char sIdenticalValues[] = "*"; /* identical component */
@@ -380,7 +380,7 @@ typedef enum tagCopySegmentType
 const char *getInchiStateReadErr(int stat)
 {
     int i, bRecMet = 0;
-    static char szMsg[128];
+    static INCHI_TLS char szMsg[128];
     if ( stat >= IST_HAPPENED_IN_RECMET ) 
     {
         bRecMet = 1;
@@ -729,7 +729,7 @@ int ReadWriteInChI(INCHI_IOSTREAM *pInp, INCHI_IOSTREAM *pOut, INCHI_IOSTREAM *p
             if ( szCurHdr && ip && ip->first_struct_number > 0 ) 
             {
                 /* check whether the structure should be skipped */
-                static char szStruct[] = "Structure:";
+                static INCHI_TLS char szStruct[] = "Structure:";
                 char *pStrNum = strstr(szCurHdr, szStruct);
                 long cur_struct_number;
                 if ( pStrNum ) 
@@ -1812,7 +1812,7 @@ int CountStereoTypes( INChI *pInChI, int *num_known_SB, int *num_known_SC,
                                      int *num_unk_und_SB, int *num_unk_und_SC,
                                      int *num_SC_PIII, int *num_SC_AsIII)
 {
-    static U_CHAR el_number_P=0, el_number_As=0;
+    static INCHI_TLS U_CHAR el_number_P=0, el_number_As=0;
     INChI_Stereo *Stereo;
     int           i, ret;
     AT_NUMB       nAtNumber;
@@ -4715,7 +4715,7 @@ int ParseSegmentIsoExchgH( const char *str, int bMobileH, REM_PROTONS nNumProton
     /* Pass 1: count bonds and find actual numbers of  atom */
     const char *p, *q, *pStart, *pEnd;
     int  ret=0, num, i, i_prev;
-    static char abc_h[] = "hdt";
+    static INCHI_TLS char abc_h[] = "hdt";
 
     if ( str[0] != 'h' )
         return 0;
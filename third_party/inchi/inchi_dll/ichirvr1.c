@@ -698,8 +698,8 @@ int bMayBeACationInMobileHLayer( inp_ATOM *at, VAL_AT *pVA, int iat, int bMobile
 {
     static const char szEl[] = "N;P;O;S;Se;Te;";
     static const char cVal[] = {4,4,3,3, 3, 3, 0};
-    static char en[8];
-    static int  ne;
+    static INCHI_TLS char en[8];
+    static INCHI_TLS int  ne;
     int    i, j, neigh;
     char   *p;
     if ( !bMobileH || !at[iat].num_H ) {
@@ -110,7 +110,7 @@ static int FillTgDiffHChgFH( TgDiffHChgFH tdhc[], int max_tdhc, inp_ATOM at2[],
 /************************************************************/
 int bHas_N_V( inp_ATOM *at2, int num_atoms )
 {
-    static U_CHAR el_number_N;
+    static INCHI_TLS U_CHAR el_number_N;
     int i, num_found = 0;
     if ( !el_number_N ) {
         el_number_N = get_periodic_table_number( "N" );
@@ -139,7 +139,7 @@ int FixSb0DParities( inp_ATOM *at, /* inp_ATOM *at_removed_H, int num_removed_H,
 /******************************************************************/
 
 
-static double         *pDoubleForSort;
+static INCHI_TLS double         *pDoubleForSort;
 
 /**********************************************************************************/
 int comp_AT_NUMB( const void* a1, const void* a2)
@@ -111,7 +111,7 @@ int GetOtherSaltType( inp_ATOM *at, int at_no, int *s_subtype );
 
 /*****************************************************************************/
 /*  Tautomers: Sorting globals												 */
-AT_RANK        *pn_tRankForSort;
+INCHI_TLS AT_RANK        *pn_tRankForSort;
 /*****************************************************************************/
 
 
@@ -119,8 +119,8 @@ AT_RANK        *pn_tRankForSort;
 /*****************************************************************************/
 int is_centerpoint_elem( U_CHAR el_number )
 {
-    static U_CHAR el_numb[12];
-    static int len;
+    static INCHI_TLS U_CHAR el_numb[12];
+    static INCHI_TLS int len;
     int i;
     if ( !el_numb[0] && !len ) {
         el_numb[len++] = (U_CHAR)get_periodic_table_number( "C" );
@@ -149,8 +149,8 @@ int is_centerpoint_elem( U_CHAR el_number )
 /*****************************************************************************/
 int is_centerpoint_elem_KET( U_CHAR el_number )
 {
-    static U_CHAR el_numb[1];
-    static int len;
+    static INCHI_TLS U_CHAR el_numb[1];
+    static INCHI_TLS int len;
     int i;
     if ( !el_numb[0] && !len ) {
         el_numb[len++] = (U_CHAR)get_periodic_table_number( "C" );
@@ -169,8 +169,8 @@ int is_centerpoint_elem_KET( U_CHAR el_number )
 /*****************************************************************************/
 int is_centerpoint_elem_strict( U_CHAR el_number )
 {
-    static U_CHAR el_numb[6];
-    static int len;
+    static INCHI_TLS U_CHAR el_numb[6];
+    static INCHI_TLS int len;
     int i;
     if ( !el_numb[0] && !len ) {
         el_numb[len++] = (U_CHAR)get_periodic_table_number( "C" );
@@ -192,8 +192,8 @@ int is_centerpoint_elem_strict( U_CHAR el_number )
 /*****************************************************************************/
 int get_endpoint_valence( U_CHAR el_number )
 {
-    static U_CHAR el_numb[6];
-    static int len, len2;
+    static INCHI_TLS U_CHAR el_numb[6];
+    static INCHI_TLS int len, len2;
     int i;
     if ( !el_numb[0] && !len ) {
         el_numb[len++] = (U_CHAR)get_periodic_table_number( "O" );
@@ -218,8 +218,8 @@ int get_endpoint_valence( U_CHAR el_number )
 /*****************************************************************************/
 int get_endpoint_valence_KET( U_CHAR el_number )
 {
-    static U_CHAR el_numb[2];
-    static int len, len2;
+    static INCHI_TLS U_CHAR el_numb[2];
+    static INCHI_TLS int len, len2;
     int i;
     if ( !el_numb[0] && !len ) {
         el_numb[len++] = (U_CHAR)get_periodic_table_number( "O" );
@@ -429,7 +429,7 @@ int nGetEndpointInfo_KET( inp_ATOM *atom, int iat, ENDPOINT_INFO *eif )
     S_CHAR cChargeSubtype;
 
     /*
-    static U_CHAR el_number_O, el_number_C;
+    static INCHI_TLS U_CHAR el_number_O, el_number_C;
 
     if ( !el_number_O ) {
         el_number_O = (U_CHAR)get_periodic_table_number( "O" );
@@ -1689,11 +1689,11 @@ quick_exit:
 /*****************************************************************************/
 int GetSaltChargeType(inp_ATOM *at, int at_no, T_GROUP_INFO *t_group_info, int *s_subtype )
 {
-    static int el_number_C  = 0;
-    static int el_number_O  = 0;
-    static int el_number_S  = 0;
-    static int el_number_Se = 0;
-    static int el_number_Te = 0;
+    static INCHI_TLS int el_number_C  = 0;
+    static INCHI_TLS int el_number_O  = 0;
+    static INCHI_TLS int el_number_S  = 0;
+    static INCHI_TLS int el_number_Se = 0;
+    static INCHI_TLS int el_number_Te = 0;
 
 /* 
    type (returned value):
@@ -1807,7 +1807,7 @@ int GetSaltChargeType(inp_ATOM *at, int at_no, T_GROUP_INFO *t_group_info, int *
 /*****************************************************************************/
 int bDoNotMergeNonTautAtom(inp_ATOM *at, int at_no)
 {
-    static int el_number_N  = 0;
+    static INCHI_TLS int el_number_N  = 0;
 
     if ( !el_number_N ) {
         el_number_N  = get_periodic_table_number( "N" );
@@ -1826,10 +1826,10 @@ int GetOtherSaltChargeType( inp_ATOM *at, int at_no, T_GROUP_INFO *t_group_info,
 {
    /* static int el_number_C  = 0; */
    /* static int el_number_N  = 0; */
-    static int el_number_O  = 0;
-    static int el_number_S  = 0;
-    static int el_number_Se = 0;
-    static int el_number_Te = 0;
+    static INCHI_TLS int el_number_O  = 0;
+    static INCHI_TLS int el_number_S  = 0;
+    static INCHI_TLS int el_number_Se = 0;
+    static INCHI_TLS int el_number_Te = 0;
 
 /* 
    type (returned value):
@@ -1946,12 +1946,12 @@ int GetOtherSaltChargeType( inp_ATOM *at, int at_no, T_GROUP_INFO *t_group_info,
 /*****************************************************************************/
 int GetOtherSaltType( inp_ATOM *at, int at_no, int *s_subtype )
 {
-    static int el_number_C  = 0;
+    static INCHI_TLS int el_number_C  = 0;
    /* static int el_number_N  = 0; */
    /* static int el_number_O  = 0; */
-    static int el_number_S  = 0;
-    static int el_number_Se = 0;
-    static int el_number_Te = 0;
+    static INCHI_TLS int el_number_S  = 0;
+    static INCHI_TLS int el_number_Se = 0;
+    static INCHI_TLS int el_number_Te = 0;
 
 /* 
    type (returned value):
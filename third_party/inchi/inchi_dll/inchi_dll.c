@@ -99,7 +99,7 @@ static int GetINCHI1(inchi_Input *inp, inchi_Output *out, int bStdFormat);
 
 /*************************************************************************/
 
-int bInterrupted = 0;
+INCHI_TLS int bInterrupted = 0;
 
 /********************************************************************
  *
@@ -159,7 +159,7 @@ EXPIMP_TEMPLATE INCHI_API void INCHI_DECL FreeStructFromINCHI( inchi_OutputStruc
  *
  ********************************************************************/
 
-int bLibInchiSemaphore = 0;
+INCHI_TLS int bLibInchiSemaphore = 0;
 
 
 EXPIMP_TEMPLATE INCHI_API int INCHI_DECL GetStdINCHI( inchi_Input *inp, inchi_Output *out )
@@ -1293,7 +1293,7 @@ int SetAtomAndBondProperties( inp_ATOM *at, inchi_Atom *ati, int a1,
 {
     int valence, chem_valence, num_alt_bonds, j, n1;
     int nRadical, nCharge;
-    static int el_number_H = 0;
+    static INCHI_TLS int el_number_H = 0;
     
     if ( !el_number_H ) {
         el_number_H = get_periodic_table_number( "H" );
@@ -1779,7 +1779,7 @@ int INCHI_DECL GetINCHIfromINCHI( inchi_InputINCHI *inpInChI, inchi_Output *out
     STRUCT_DATA struct_data;
     STRUCT_DATA *sd = &struct_data;    
     
-    static char szMainOption[] = " ?InChI2InChI";
+    static INCHI_TLS char szMainOption[] = " ?InChI2InChI";
 
     int i;
     char      szSdfDataValue[MAX_SDF_VALUE+1];
@@ -2085,7 +2085,7 @@ EXPIMP_TEMPLATE INCHI_API int INCHI_DECL GetStructFromINCHI( inchi_InputINCHI *i
     INCHI_IOSTREAM *output_file = inchi_file, *log_file = inchi_file+1, *input_file = inchi_file+2;
     
 
-    static char szMainOption[] = " ?InChI2Struct";
+    static INCHI_TLS char szMainOption[] = " ?InChI2Struct";
 
 
     int i;
@@ -43,6 +43,16 @@
 
 #include <stdio.h>
 
+/* Library state is kept per thread, so that the library */
+/* can be called from several threads at the same time   */
+#if defined(_MSC_VER)
+#define INCHI_TLS __declspec(thread)
+#elif defined(__GNUC__)
+#define INCHI_TLS __thread
+#else
+#define INCHI_TLS
+#endif
+
     
 
 
@@ -378,7 +378,7 @@ exit_function:
 const char *ErrMsg( int nErrorCode )
 {
     const char *p;
-    static char szErrMsg[64];
+    static INCHI_TLS char szErrMsg[64];
     switch( nErrorCode ) {
         case 0:                      p = "";                      break;
         case CT_OVERFLOW:            p = "ARRAY OVERFLOW";        break;
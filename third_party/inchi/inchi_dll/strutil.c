@@ -131,13 +131,13 @@ int the_only_doublet_neigh(inp_ATOM *at, int i1, int *ineigh1, int *ineigh2)
 int fix_odd_things( int num_atoms, inp_ATOM *at, int bFixBug, int bFixNonUniformDraw )
 {   /*                           0 1 2  3  4 5 6  7                       8  9  */
     static const char    el[] = "N;P;As;Sb;O;S;Se;Te;";   /* 8 elements + C, Si */
-    static U_CHAR  en[10];              /* same number: 8 elements */
-    static int     ne=0, ne2;           /* will be 8 and 10 */
-    static int     el_number_P;
-    static int     el_number_H;
-    static int     el_number_C;
-    static int     el_number_O;
-    static int     el_number_Si;
+    static INCHI_TLS U_CHAR  en[10];              /* same number: 8 elements */
+    static INCHI_TLS int     ne=0, ne2;           /* will be 8 and 10 */
+    static INCHI_TLS int     el_number_P;
+    static INCHI_TLS int     el_number_H;
+    static INCHI_TLS int     el_number_C;
+    static INCHI_TLS int     el_number_O;
+    static INCHI_TLS int     el_number_Si;
 
 #define FIRST_NEIGHB2  4
 #define FIRST_CENTER2  5
@@ -891,8 +891,8 @@ int remove_ion_pairs( int num_atoms, inp_ATOM *at )
 #else
     static const char    el[] = "N;P;As;Sb;O;S;Se;Te;C;Si";   /* 8 elements + C, Si */
 #endif
-    static char    en[12];         /* same number: 8 elements */
-    static int     ne=0;           /* will be 8 and 10 */
+    static INCHI_TLS char    en[12];         /* same number: 8 elements */
+    static INCHI_TLS int     ne=0;           /* will be 8 and 10 */
 
 #define ELEM_N_FST  0
 #define ELEM_N_LEN  4
@@ -1978,8 +1978,8 @@ int bIsAmmoniumSalt( inp_ATOM *at, int i, int *piO, int *pk, S_CHAR *num_explici
 {
     /* NH4(+charge)-O(-charge)-C -> NH3 + HO-C; any charge including 0, any C except charged or radical */
     /* F, Cl, Br, I */
-    static U_CHAR el_number_C=0, el_number_O=0, el_number_H=0, el_number_N=0;
-    static U_CHAR el_number_F=0, el_number_Cl=0, el_number_Br=0, el_number_I=0;
+    static INCHI_TLS U_CHAR el_number_C=0, el_number_O=0, el_number_H=0, el_number_N=0;
+    static INCHI_TLS U_CHAR el_number_F=0, el_number_Cl=0, el_number_Br=0, el_number_I=0;
     int num_H, num_non_iso_H, num_impl_iso_H, bDisconnect = 1;
     int j, val, neigh, iO=-1, iC, k=-1;
     if ( 0 == el_number_C ) {
@@ -2070,7 +2070,7 @@ int DisconnectAmmoniumSalt ( inp_ATOM *at, int iN, int iO, int k, S_CHAR *num_ex
     /* Note: iO = at[iN].neighbor[k], at[iN] is N, at[iO].neighbor[0] is either N=at[iN] or C=at[iC] */
     int nMove_H_iso_diff = -1; /* do not move explicit H */
     int j, neigh, iso_diff, neigh_pos;
-    static U_CHAR el_number_H = 0;
+    static INCHI_TLS U_CHAR el_number_H = 0;
     int    val = at[iN].valence;
 
     if ( !el_number_H ) {
@@ -2157,8 +2157,8 @@ int bIsMetalSalt( inp_ATOM *at, int i )
 {
     int type, val, k, iO, iC, j, neigh;
     int bDisconnect = 1;
-    static U_CHAR el_number_C=0, el_number_O=0, el_number_H=0;
-    static U_CHAR el_number_F=0, el_number_Cl=0, el_number_Br=0, el_number_I=0;
+    static INCHI_TLS U_CHAR el_number_C=0, el_number_O=0, el_number_H=0;
+    static INCHI_TLS U_CHAR el_number_F=0, el_number_Cl=0, el_number_Br=0, el_number_I=0;
     if ( 0 == el_number_C ) {
         /* one time initialization */
         el_number_C = get_periodic_table_number( "C" );
@@ -2448,8 +2448,8 @@ int DisconnectMetals( ORIG_ATOM_DATA *orig_inp_data, int bCheckMetalValence, INC
     int i, j, k, n, iO, num_changes, val, bRadOrMultBonds;
     int num_impl_H, num_at, err, num_disconnected;
     S_CHAR num_explicit_H[NUM_H_ISOTOPES+1];
-    static char elnumber_Heteroat[16] = {'\0', };
-    static int  num_halogens;
+    static INCHI_TLS char elnumber_Heteroat[16] = {'\0', };
+    static INCHI_TLS int  num_halogens;
     inp_ATOM  *at             = NULL;
     S_CHAR    *bMetal         = NULL;
     inp_ATOM  *atom           = orig_inp_data->at;
@@ -3101,7 +3101,7 @@ int get_iat_number( int el_number, const int el_num[], int el_num_len )
 int bHeteroAtomMayHaveXchgIsoH( inp_ATOM *atom, int iat )
 {
     inp_ATOM *at = atom + iat, *at2;
-    static int el_num[IAT_MAX];
+    static INCHI_TLS int el_num[IAT_MAX];
     int j, val, is_O=0, is_Cl=0, is_N=0, is_H=0, num_H, iat_numb, bAccept, cur_num_iso_H;
     
     if ( !el_num[IAT_H]) {
@@ -3178,7 +3178,7 @@ int bHeteroAtomMayHaveXchgIsoH( inp_ATOM *atom, int iat )
 /****************************************************************************************/
 int bNumHeterAtomHasIsotopicH( inp_ATOM *atom, int num_atoms )
 {
-    static int el_num[IAT_MAX];
+    static INCHI_TLS int el_num[IAT_MAX];
     int i, j, val, is_O=0, is_Cl=0, is_N=0, is_H=0, num_H, iat_numb, bAccept, num_iso_H, cur_num_iso_H, num_iso_atoms;
     inp_ATOM *at, *at2;
     /* one time initialization */
@@ -530,7 +530,7 @@ int get_num_H (const char* elname, int inp_num_H, S_CHAR inp_num_iso_H[],
                int bAliased, int bDoNotAddH, int bHasMetalNeighbor )
 {
     int val, i, el_number, num_H = 0, num_iso_H;
-    static int el_number_N = 0, el_number_S, el_number_O, el_number_C;
+    static INCHI_TLS int el_number_N = 0, el_number_S, el_number_O, el_number_C;
     if ( !el_number_N ) {
         el_number_N = get_el_number( "N" );
         el_number_S = get_el_number( "S" );
@@ -798,7 +798,7 @@ int nBondsValToMetal( inp_ATOM* at, int iat )
 /************************************************************************/
 int num_of_H( inp_ATOM *at, int iat )
 {
-    static int el_number_H;
+    static INCHI_TLS int el_number_H;
     int    i, n, num_explicit_H = 0;
     inp_ATOM *a = at + iat;
     if ( !el_number_H )
@@ -0,0 +1,240 @@
+/****************************************************************************
+ * Copyright (C) 2010-2013 GGA Software Services LLC
+ * 
+ * This file is part of Indigo toolkit.
+ * 
+ * This file may be distributed and/or modified under the terms of the
+ * GNU General Public License version 3 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.
+ * 
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ ***************************************************************************/ 
+
+//
+// This is a command line utility for the automatic atom-to-atom
+// mapping of reactions in RXN, RDF or reaction SMILES format
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "indigo.h"
+
+void onError (const char *message, void *context)
+{
+   fflush(stdout);
+   fprintf(stderr, "%s\n", message);
+   fflush(stderr);
+   exit(-1);
+}
+
+void usage ()
+{
+   printf(
+      "Usage:\n"
+      "  indigo-aam filename.{rxn,smi,rsmi,rdf,rdf.gz} [parameters]\n"
+      "  indigo-aam - SMILES [parameters]\n"
+      "Parameters:\n"
+      "  -mode <string>   Automapping mode (default is 'discard')\n"
+      "  -threads <n>     Number of threads, 0 for all the cores (default is 1)\n"
+      "  -timeout <ms>    Time limit for a single reaction (default is none)\n"
+      "  -chunk <n>       Number of reactions mapped at once (default is 1000)\n"
+      "  -time            Output the mapping time of each reaction\n"
+      "Each reaction gives one line of output: the mapped reaction SMILES\n"
+      "or 'error: ' followed by the error message.\n"
+      "Examples:\n"
+      "   indigo-aam infile.rdf -threads 0 > results.smi\n"
+      "   indigo-aam infile.smi -mode 'discard ignore_charges' -timeout 10000\n"
+      "   indigo-aam - 'CC(=O)O.OCC>>CC(=O)OCC'\n"
+      );
+}
+
+// Errors are printed in place of the reaction SMILES, so the output
+// lines still correspond to the input reactions
+void printError (const char *message)
+{
+   printf("error: %s", message);
+}
+
+// Maps the reactions of the array and prints the results
+// in the same order as they were read
+void processChunk (int array, const char *mode, int print_time)
+{
+   int i, count = indigoCount(array);
+
+   indigoAutomapBatch(array, mode);
+
+   for (i = 0; i < count; i++)
+   {
+      int rxn = indigoAt(array, i);
+
+      indigoSetErrorHandler(0, 0);
+      if (indigoHasProperty(rxn, "aam-error") > 0)
+         printError(indigoGetProperty(rxn, "aam-error"));
+      else
+      {
+         const char *res = indigoSmiles(rxn);
+
+         if (res != 0)
+            printf("%s", res);
+         else
+            printError(indigoGetLastError());
+      }
+      indigoSetErrorHandler(onError, 0);
+
+      if (print_time)
+         printf("\t%s", indigoGetProperty(rxn, "aam-time"));
+      printf("\n");
+      indigoFree(rxn);
+   }
+   indigoClear(array);
+}
+
+int main (int argc, char *argv[])
+{
+   const char *mode = "discard";
+   int chunk = 1000;
+   int print_time = 0;
+   int i = 2;
+   const char *filename = 0;
+   const char *ext = 0;
+   int array;
+
+   if (argc < 2)
+   {
+      usage();
+      return -1;
+   }
+
+   if (strcmp(argv[1], "-") != 0)
+      filename = argv[1];
+   else if (argc >= 3 && strcmp(argv[1], "-") == 0)
+      i = 3;
+   else
+   {
+      usage();
+      return -1;
+   }
+
+   indigoSetErrorHandler(onError, 0);
+
+   while (i < argc)
+   {
+      if (strcmp(argv[i], "-time") == 0)
+         print_time = 1;
+      else if (strcmp(argv[i], "-mode") == 0 || strcmp(argv[i], "-threads") == 0 ||
+               strcmp(argv[i], "-timeout") == 0 || strcmp(argv[i], "-chunk") == 0)
+      {
+         const char *param = argv[i];
+
+         if (++i >= argc)
+         {
+            fprintf(stderr, "expecting a value after %s\n", param);
+            return -1;
+         }
+
+         if (strcmp(param, "-mode") == 0)
+            mode = argv[i];
+         else if (strcmp(param, "-threads") == 0)
+            indigoSetOptionInt("aam-threads", atoi(argv[i]));
+         else if (strcmp(param, "-timeout") == 0)
+            indigoSetOptionInt("aam-timeout", atoi(argv[i]));
+         else
+         {
+            chunk = atoi(argv[i]);
+            if (chunk < 1)
+            {
+               fprintf(stderr, "%s is bad chunk size\n", argv[i]);
+               return -1;
+            }
+         }
+      }
+      else
+      {
+         fprintf(stderr, "unknown parameter: %s\n", argv[i]);
+         return -1;
+      }
+      i++;
+   }
+
+   array = indigoCreateArray();
+
+   if (filename == 0)
+   {
+      int rxn = indigoLoadReactionFromString(argv[2]);
+      indigoArrayAdd(array, rxn);
+      indigoFree(rxn);
+      processChunk(array, mode, print_time);
+      indigoFree(array);
+      return 0;
+   }
+
+   if (strlen(filename) > 4 && filename[strlen(filename) - 4] == '.')
+      ext = filename + strlen(filename) - 3;
+   else if (strlen(filename) > 5 && filename[strlen(filename) - 5] == '.')
+      ext = filename + strlen(filename) - 4;
+   else if (strlen(filename) > 7 && filename[strlen(filename) - 7] == '.')
+      ext = filename + strlen(filename) - 6;
+   else
+   {
+      fprintf(stderr, "input file format not recognized\n");
+      return -1;
+   }
+
+   if (strcmp(ext, "rxn") == 0)
+   {
+      int rxn = indigoLoadReactionFromFile(filename);
+      indigoArrayAdd(array, rxn);
+      indigoFree(rxn);
+      processChunk(array, mode, print_time);
+   }
+   else if (strcmp(ext, "rdf") == 0 || strcmp(ext, "rdf.gz") == 0 ||
+            strcmp(ext, "smi") == 0 || strcmp(ext, "rsmi") == 0)
+   {
+      int item, iter;
+
+      if (strstr(ext, "rdf") != NULL)
+         iter = indigoIterateRDFile(filename);
+      else
+         iter = indigoIterateSmilesFile(filename);
+
+      // Reactions are mapped in chunks, so the threads are busy
+      // and the whole file is not loaded into memory
+      while ((item = indigoNext(iter)))
+      {
+         char *error = 0;
+
+         indigoSetErrorHandler(0, 0);
+         if (indigoArrayAdd(array, item) == -1)
+            error = strdup(indigoGetLastError());
+         indigoSetErrorHandler(onError, 0);
+         indigoFree(item);
+
+         if (error != 0)
+         {
+            // Results of the loaded reactions are printed first,
+            // so the output order is the same as the input order
+            processChunk(array, mode, print_time);
+            printError(error);
+            printf("\n");
+            free(error);
+         }
+
+         if (indigoCount(array) >= chunk)
+            processChunk(array, mode, print_time);
+      }
+      if (indigoCount(array) > 0)
+         processChunk(array, mode, print_time);
+      indigoFree(iter);
+   }
+   else
+   {
+      fprintf(stderr, "input file format not recognized\n");
+      return -1;
+   }
+   indigoFree(array);
+   return 0;
+}
@@ -18,6 +18,8 @@
 #include <ctype.h>
 
 #include "base_c/defs.h"
+#include "base_c/os_sync.h"
+#include "base_c/os_thread.h"
 #include "indigo.h"
 #include "indigo-renderer.h"
 
@@ -32,6 +34,8 @@ void usage (void)
            "  indigo-depict infile.smi outfile.{sdf,rdf,cml} [parameters]\n"
            "  indigo-depict - SMILES outfile.{png,svg,pdf} [parameters]\n"
            "  indigo-depict - SMILES outfile.{mol,rxn,cml} [parameters]\n"
+           "  indigo-depict -stdin outfile_%%s.{png,svg,pdf} [parameters]\n"
+           "  indigo-depict infile.{sdf,rdf,cml,smi} outfile.{png,svg,pdf} -concat [parameters]\n"
            "\nParameters:\n"
            "-w <number>\n"
            "   Picture width in pixels\n"
@@ -100,6 +104,10 @@ void usage (void)
            "   Show bond numbers (for debugging purposes only)\n"
            "-onebased\n"
            "   Start atom and bond indices from one (default is from zero)\n"
+           "-threads <number>\n"
+           "   Render multiple structures in the given number of threads (default is 1)\n"
+           "-concat\n"
+           "   Write all the pictures into one file, each one after a '<name> <size>' line\n"
            "-help\n"
            "   Print this help message\n"
            "\n"
@@ -109,6 +117,7 @@ void usage (void)
            "   indigo-depict database.smi database.sdf\n"
            "   indigo-depict - \"CC.[O-][*-]([O-])=O\" query.png -query\n"
            "   indigo-depict - \"OCO>>CC(C)N\" reaction.rxn\n"
+           "   indigo-depict -stdin cache/%%s.png -threads 8 -w 300 -h 300\n"
            );
 }
 
@@ -211,7 +220,8 @@ enum
    MODE_MULTILINE_SMILES,
    MODE_SDF,
    MODE_RDF,
-   MODE_MULTIPLE_CML
+   MODE_MULTIPLE_CML,
+   MODE_STDIN
 };
 
 enum
@@ -269,11 +279,21 @@ typedef struct tagParams {
    const char *comment;
    const char *comment_field;
    int comment_name;
+   int threads;
+   int concat;
+   int options_start;
 } Params;
 
+int parseOptions (Params* p, int argc, char *argv[]);
+
 int parseParams (Params* p, int argc, char *argv[]) {
    int i;
-   if (strcmp(argv[1], "-") == 0)
+   if (strcmp(argv[1], "-stdin") == 0)
+   {
+      p->mode = MODE_STDIN;
+      i = 2;
+   }
+   else if (strcmp(argv[1], "-") == 0)
    {
       if (_isReaction(argv[2]))
       {
@@ -353,11 +373,27 @@ int parseParams (Params* p, int argc, char *argv[]) {
    p->outfile_ext[3] = 0;
    strncpy(p->outfile_ext, p->outfile + strlen(p->outfile) - 3, 3);
 
+   p->options_start = i;
+   if (parseOptions(p, argc, argv) < 0)
+      return -1;
+
+   if (p->hydro_set && p->query_set)
+   {
+      fprintf(stderr, "-hydro conflicts with -query (implicit hydrogens do not exist in queries)\n");
+   }
+   return 0;
+}
+
+// Sets the options of the current session. Called once more
+// for the session of each worker thread in the batch mode.
+int parseOptions (Params* p, int argc, char *argv[]) {
+   int i;
+
    indigoSetOptionBool("treat-x-as-pseudoatom", 1);
    indigoSetOptionBool("render-coloring", 1);
    indigoSetOptionBool("render-highlight-color-enabled", 1);
 
-   for (; i < argc; i++)
+   for (i = p->options_start; i < argc; i++)
    {
       if (strcmp(argv[i], "-w") == 0)
       {
@@ -728,6 +764,22 @@ int parseParams (Params* p, int argc, char *argv[]) {
          indigoSetOptionBool("render-bond-ids-visible", 1);
       else if (strcmp(argv[i], "-onebased") == 0)
          indigoSetOptionBool("render-atom-bond-ids-from-one", 1);
+      else if (strcmp(argv[i], "-threads") == 0)
+      {
+         if (++i == argc)
+         {
+            fprintf(stderr, "expecting number after -threads\n");
+            return -1;
+         }
+
+         if (sscanf(argv[i], "%d", &p->threads) != 1 || p->threads <= 0)
+         {
+            fprintf(stderr, "%s is not a valid number of threads\n", argv[i]);
+            return -1;
+         }
+      }
+      else if (strcmp(argv[i], "-concat") == 0)
+         p->concat = 1;
       else if (strcmp(argv[i], "-help") == 0)
       {
          usage();
@@ -747,35 +799,303 @@ int parseParams (Params* p, int argc, char *argv[]) {
       indigoSetOptionInt("render-image-width", p->width);
    if (p->height > 0)
       indigoSetOptionInt("render-image-height", p->height);
-
-   if (p->hydro_set && p->query_set)
-   {
-      fprintf(stderr, "-hydro conflicts with -query (implicit hydrogens do not exist in queries)\n");
-   }
    return 0;
 }
 
-void _setComment (int obj, Params *p) {
+const char * _getComment (int obj, Params *p) {
    if (p->comment_name) {
       const char *name = indigoName(obj);
-      if (name != NULL && *name != 0) {
-         indigoSetOption("render-comment", name);
-         return;
-      }
+      if (name != NULL && *name != 0)
+         return name;
    }
    if (p->comment_field != NULL) {
       if (indigoHasProperty(obj, p->comment_field)) {
          const char *prop = indigoGetProperty(obj, p->comment_field);
-         if (prop != NULL && *prop != 0) {
-            indigoSetOption("render-comment", prop);
-            return;
-         }
+         if (prop != NULL && *prop != 0)
+            return prop;
+      }
+   }
+   if (p->comment != NULL && *p->comment != 0)
+      return p->comment;
+   return NULL;
+}
+
+void _setComment (int obj, Params *p) {
+   const char *comment = _getComment(obj, p);
+
+   if (comment != NULL)
+      indigoSetOption("render-comment", comment);
+}
+
+char * _copyString (const char *str) {
+   char *copy = (char *)malloc(strlen(str) + 1);
+
+   strcpy(copy, str);
+   return copy;
+}
+
+// Reads a line of any length without the line break.
+// Returns NULL at the end of the input.
+char * _readLine (FILE *f, char **buf, int *size) {
+   int len = 0;
+
+   for (;;) {
+      if (*size - len < 2) {
+         *size = *size * 2 + 256;
+         *buf = (char *)realloc(*buf, *size);
       }
+      if (fgets(*buf + len, *size - len, f) == NULL) {
+         if (len == 0)
+            return NULL;
+         break;
+      }
+      len += (int)strlen(*buf + len);
+      if ((*buf)[len - 1] == '\n')
+         break;
    }
-   if (p->comment != NULL && *p->comment != 0) {
-      indigoSetOption("render-comment", p->comment);
-      return;
+
+   while (len > 0 && ((*buf)[len - 1] == '\n' || (*buf)[len - 1] == '\r'))
+      len--;
+   (*buf)[len] = 0;
+   return *buf;
+}
+
+//
+// Batch mode: the main thread reads the structures and puts their
+// text into a queue, the worker threads load and render them.
+// Each worker has its own Indigo session with the same options.
+//
+
+#define BATCH_QUEUE_SIZE 64
+
+typedef struct tagBatchJob {
+   char *data;       // NULL tells the worker to stop
+   char *name;       // put in place of '%s' in the output file name
+   char *comment;
+   int comment_set;  // the comment is taken from the structure if not set
+   int reaction;
+} BatchJob;
+
+typedef struct tagBatch {
+   Params *p;
+   int argc;
+   char **argv;
+   BatchJob queue[BATCH_QUEUE_SIZE];
+   int head, tail;
+   os_mutex lock;    // queue, output file and console
+   os_semaphore free_slots, ready_jobs, finished;
+   FILE *concat;
+} Batch;
+
+int _loadBatchJob (Params *p, BatchJob *job) {
+   if (job->reaction) {
+      if (p->smarts_set)
+         return indigoLoadReactionSmartsFromString(job->data);
+      if (p->query_set)
+         return indigoLoadQueryReactionFromString(job->data);
+      return indigoLoadReactionFromString(job->data);
    }
+   if (p->smarts_set)
+      return indigoLoadSmartsFromString(job->data);
+   if (p->query_set)
+      return indigoLoadQueryMoleculeFromString(job->data);
+   return indigoLoadMoleculeFromString(job->data);
+}
+
+void _renderBatchJob (Batch *b, Params *p, BatchJob *job) {
+   char outfilename[4096];
+   const char *comment = job->comment;
+   char *buf = NULL;
+   int size = 0, obj, out = -1, rc = -1;
+
+   obj = _loadBatchJob(p, job);
+
+   if (obj >= 0 && _prepare(obj, p->aromatization) >= 0) {
+      if (!job->comment_set)
+         comment = _getComment(obj, p);
+      indigoSetOption("render-comment", comment != NULL ? comment : "");
+
+      if (b->concat != NULL) {
+         out = indigoWriteBuffer();
+         if (out >= 0 && (rc = indigoRender(obj, out)) >= 0)
+            rc = indigoToBuffer(out, &buf, &size);
+      } else {
+         snprintf(outfilename, sizeof(outfilename), p->outfile, job->name);
+         rc = indigoRenderToFile(obj, outfilename);
+      }
+   }
+
+   osMutexLock(&b->lock);
+   if (rc < 0)
+      printf("saving %s... %s\n", job->name, indigoGetLastError());
+   else {
+      if (b->concat != NULL) {
+         fprintf(b->concat, "%s %d\n", job->name, size);
+         fwrite(buf, 1, size, b->concat);
+      }
+      printf("saving %s... \n", job->name);
+   }
+   fflush(stdout);
+   osMutexUnlock(&b->lock);
+
+   if (out >= 0)
+      indigoFree(out);
+   if (obj >= 0)
+      indigoFree(obj);
+}
+
+THREAD_RET THREAD_MOD _batchWorker (void *param) {
+   Batch *b = (Batch *)param;
+   Params p = *b->p;
+   qword session = indigoAllocSessionId();
+   BatchJob job;
+
+   indigoSetSessionId(session);
+   indigoSetOption("ignore-stereochemistry-errors", "on");
+   parseOptions(&p, b->argc, b->argv);
+   indigoSetOption("render-output-format", p.outfile_ext);
+
+   for (;;) {
+      osSemaphoreWait(&b->ready_jobs);
+      osMutexLock(&b->lock);
+      job = b->queue[b->head];
+      b->head = (b->head + 1) % BATCH_QUEUE_SIZE;
+      osMutexUnlock(&b->lock);
+      osSemaphorePost(&b->free_slots);
+
+      if (job.data == NULL)
+         break;
+
+      _renderBatchJob(b, &p, &job);
+
+      free(job.data);
+      free(job.name);
+      free(job.comment);
+   }
+
+   indigoReleaseSessionId(session);
+   osSemaphorePost(&b->finished);
+   THREAD_END;
+}
+
+// The job takes the strings, they are freed by the worker
+void _submitBatchJob (Batch *b, char *data, char *name, int comment_set,
+                      char *comment, int reaction) {
+   BatchJob *job;
+
+   osSemaphoreWait(&b->free_slots);
+   osMutexLock(&b->lock);
+   job = &b->queue[b->tail];
+   job->data = data;
+   job->name = name;
+   job->comment = comment;
+   job->comment_set = comment_set;
+   job->reaction = reaction;
+   b->tail = (b->tail + 1) % BATCH_QUEUE_SIZE;
+   osMutexUnlock(&b->lock);
+   osSemaphorePost(&b->ready_jobs);
+}
+
+// Renders the items of the iterator, or the SMILES lines of the
+// standard input if there is no iterator
+int renderBatch (Params *p, int argc, char *argv[], int iter) {
+   Batch b;
+   char number[100];
+   int i, item;
+
+   b.p = p;
+   b.argc = argc;
+   b.argv = argv;
+   b.head = b.tail = 0;
+   b.concat = NULL;
+
+   if (p->concat) {
+      b.concat = fopen(p->outfile, "wb");
+      if (b.concat == NULL) {
+         fprintf(stderr, "Can not open %s for writing\n", p->outfile);
+         return -1;
+      }
+   }
+
+   osMutexCreate(&b.lock);
+   osSemaphoreCreate(&b.free_slots, BATCH_QUEUE_SIZE, BATCH_QUEUE_SIZE);
+   osSemaphoreCreate(&b.ready_jobs, 0, BATCH_QUEUE_SIZE);
+   osSemaphoreCreate(&b.finished, 0, p->threads);
+
+   for (i = 0; i < p->threads; i++)
+      osThreadCreate(_batchWorker, &b);
+
+   i = -1;
+
+   if (iter < 0) {
+      char *line = NULL;
+      int size = 0;
+
+      while (_readLine(stdin, &line, &size) != NULL) {
+         if (*line == 0)
+            continue;
+         snprintf(number, sizeof(number), "%d", ++i);
+         _submitBatchJob(&b, _copyString(line), _copyString(number), 0, NULL, _isReaction(line));
+      }
+      free(line);
+   } else {
+      while ((item = indigoNext(iter))) {
+         char *data, *name, *comment = NULL;
+         const char *str;
+         int reaction;
+
+         ++i;
+
+         // Strings returned by Indigo are copied at once, as the
+         // next call can reuse the same buffer
+         if (p->id) {
+            if (!indigoHasProperty(item, p->id)) {
+               fprintf(stderr, "item #%d does not have %s, skipping\n", i, p->id);
+               indigoFree(item);
+               continue;
+            }
+            name = _copyString(indigoGetProperty(item, p->id));
+         } else {
+            snprintf(number, sizeof(number), "%d", i);
+            name = _copyString(number);
+         }
+
+         data = _copyString(indigoRawData(item));
+
+         if (p->mode == MODE_RDF)
+            reaction = 1;
+         else if (p->mode == MODE_MULTIPLE_CML)
+            reaction = (strstr(data, "<reaction") != NULL);
+         else if (p->mode == MODE_MULTILINE_SMILES)
+            reaction = _isReaction(data);
+         else
+            reaction = 0;
+
+         // SDF/RDF fields are not loaded with the structure text
+         indigoSetErrorHandler(0, 0);
+         if ((str = _getComment(item, p)) != NULL)
+            comment = _copyString(str);
+         indigoSetErrorHandler(onError, 0);
+
+         _submitBatchJob(&b, data, name, 1, comment, reaction);
+
+         indigoFree(item);
+      }
+   }
+
+   for (i = 0; i < p->threads; i++)
+      _submitBatchJob(&b, NULL, NULL, 1, NULL, 0);
+   for (i = 0; i < p->threads; i++)
+      osSemaphoreWait(&b.finished);
+
+   osSemaphoreDelete(&b.finished);
+   osSemaphoreDelete(&b.ready_jobs);
+   osSemaphoreDelete(&b.free_slots);
+   osMutexDelete(&b.lock);
+
+   if (b.concat != NULL)
+      fclose(b.concat);
+   return 0;
 }
 
 int main (int argc, char *argv[])
@@ -801,6 +1121,8 @@ int main (int argc, char *argv[])
    p.comment_field = NULL;
    p.comment = NULL;
    p.comment_name = 0;
+   p.threads = 1;
+   p.concat = 0;
 
    if (argc <= 2)
       USAGE();
@@ -831,6 +1153,19 @@ int main (int argc, char *argv[])
       p.action = ACTION_RENDER;
    }
 
+   if (p.concat && p.action != ACTION_RENDER)
+      ERROR("-concat is supported only for pictures\n");
+
+   if (p.mode == MODE_STDIN) {
+      if (p.action != ACTION_RENDER)
+         ERROR("on standard input, only pictures are supported\n");
+      if (p.id != NULL)
+         ERROR("on standard input, setting '-id' is not allowed\n");
+      if (!p.concat && strstr(p.outfile, "%s") == NULL)
+         ERROR("on multiple output, output file name must have '%%s'\n");
+      return renderBatch(&p, argc, argv, -1);
+   }
+
    // read in the input
    reader = (p.file_to_load != NULL) ? indigoReadFile(p.file_to_load) : indigoReadString(p.string_to_load);
 
@@ -901,9 +1236,17 @@ int main (int argc, char *argv[])
          return -1;
       }
 
-      if ((p.out_ext == OEXT_MOL || p.out_ext == OEXT_RXN || p.out_ext == OEXT_OTHER) && !have_percent_s)
+      if ((p.out_ext == OEXT_MOL || p.out_ext == OEXT_RXN || p.out_ext == OEXT_OTHER) && !have_percent_s && !p.concat)
          ERROR("on multiple output, output file name must have '%%s'\n");
 
+      if (p.action == ACTION_RENDER && (p.threads > 1 || p.concat)) {
+         int rc = renderBatch(&p, argc, argv, obj);
+
+         indigoFree(reader);
+         indigoFree(obj);
+         return rc;
+      }
+
       if (p.out_ext == OEXT_SDF || p.out_ext == OEXT_RDF ||
          (p.out_ext == OEXT_CML && !have_percent_s))
       {